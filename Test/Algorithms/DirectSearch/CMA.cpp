@@ -49,3 +49,56 @@ BOOST_AUTO_TEST_CASE( CMA_Rosenbrock )
 	std::cout << "\nTesting: " << optimizer.name() << " with " << function.name() << std::endl;
 	test_function( optimizer, function, _trials = 10, _iterations = 1000, _epsilon = 1E-10 );
 }
+
+namespace{
+//Cigar function which declares that it can be evaluated concurrently
+class ThreadSafeCigar : public Cigar{
+public:
+	ThreadSafeCigar(std::size_t numberOfVariables):Cigar(numberOfVariables){
+		m_features |= IS_THREAD_SAFE;
+	}
+
+	double eval(const SearchPointType &p) const {
+		double sum = sqr(p(0));
+		for (unsigned int i = 1; i < p.size(); i++)
+			sum += alpha() * sqr(p(i));
+		SHARK_CRITICAL_REGION{
+			m_evaluationCounter++;
+		}
+		return sum;
+	}
+};
+
+template<class Optimizer>
+void testBatchEvaluation(){
+	Cigar function(5);
+	ThreadSafeCigar threadSafeFunction(5);
+	BOOST_REQUIRE(!function.isThreadSafe());
+	BOOST_REQUIRE(threadSafeFunction.isThreadSafe());
+	RealVector start(5,1.0);
+
+	//the offspring are sampled before the evaluation, thus both runs draw the same random numbers
+	Optimizer serial;
+	Rng::seed(42);
+	serial.init(function, start);
+	for(std::size_t i = 0; i != 100; ++i)
+		serial.step(function);
+
+	Optimizer parallel;
+	Rng::seed(42);
+	parallel.init(threadSafeFunction, start);
+	for(std::size_t i = 0; i != 100; ++i)
+		parallel.step(threadSafeFunction);
+
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), threadSafeFunction.evaluationCounter());
+	BOOST_CHECK_EQUAL(serial.solution().value, parallel.solution().value);
+	for(std::size_t i = 0; i != 5; ++i)
+		BOOST_CHECK_EQUAL(serial.solution().point(i), parallel.solution().point(i));
+}
+}
+
+BOOST_AUTO_TEST_CASE( CMA_Batch_Evaluation )
+{
+	testBatchEvaluation<CMA>();
+	testBatchEvaluation<ElitistCMA>();
+}
@@ -47,3 +47,63 @@ BOOST_AUTO_TEST_CASE( CMSA_Rosenbrock )
 	// TODO: Results here do not correspond to results in Beyer's paper.
 	test_function( optimizer, function, _trials = 10, _iterations = 1000, _epsilon = 1E-10 );
 }
+
+namespace{
+//Cigar function which allows concurrent evaluation and fails at the given evaluation
+class ThreadSafeCigar : public Cigar{
+public:
+	ThreadSafeCigar(std::size_t numberOfVariables, std::size_t failingEvaluation = 0)
+	:Cigar(numberOfVariables), m_failingEvaluation(failingEvaluation){
+		m_features |= IS_THREAD_SAFE;
+	}
+
+	double eval(const SearchPointType &p) const {
+		double sum = sqr(p(0));
+		for (unsigned int i = 1; i < p.size(); i++)
+			sum += alpha() * sqr(p(i));
+		bool fail = false;
+		SHARK_CRITICAL_REGION{
+			m_evaluationCounter++;
+			fail = m_evaluationCounter == m_failingEvaluation;
+		}
+		if(fail)
+			throw SHARKEXCEPTION("[ThreadSafeCigar::eval] evaluation failed");
+		return sum;
+	}
+private:
+	std::size_t m_failingEvaluation;
+};
+}
+
+BOOST_AUTO_TEST_CASE( CMSA_Batch_Evaluation )
+{
+	Cigar function(5);
+	ThreadSafeCigar threadSafeFunction(5);
+	BOOST_REQUIRE(!function.isThreadSafe());
+	BOOST_REQUIRE(threadSafeFunction.isThreadSafe());
+	RealVector start(5,1.0);
+
+	//the offspring are sampled before the evaluation, thus both runs draw the same random numbers
+	CMSA serial;
+	Rng::seed(42);
+	serial.init(function, start);
+	for(std::size_t i = 0; i != 100; ++i)
+		serial.step(function);
+
+	CMSA parallel;
+	Rng::seed(42);
+	parallel.init(threadSafeFunction, start);
+	for(std::size_t i = 0; i != 100; ++i)
+		parallel.step(threadSafeFunction);
+
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), threadSafeFunction.evaluationCounter());
+	BOOST_CHECK_EQUAL(serial.solution().value, parallel.solution().value);
+	for(std::size_t i = 0; i != 5; ++i)
+		BOOST_CHECK_EQUAL(serial.solution().point(i), parallel.solution().point(i));
+
+	//an exception of a single offspring is passed on after the offspring are evaluated
+	ThreadSafeCigar failingFunction(5,3);
+	CMSA failing;
+	failing.init(failingFunction, start);
+	BOOST_CHECK_THROW(failing.step(failingFunction), Exception);
+}
@@ -394,6 +394,67 @@ BOOST_AUTO_TEST_CASE( AdditiveEpsMOCMA_Serialization ) {
 	}
 
 }
+namespace{
+//DTLZ2 which allows concurrent evaluation and fails at the given evaluation
+class ThreadSafeDTLZ2 : public DTLZ2{
+public:
+	ThreadSafeDTLZ2(std::size_t numberOfVariables, std::size_t failingEvaluation = 0)
+	:DTLZ2(numberOfVariables), m_failingEvaluation(failingEvaluation){
+		m_features |= IS_THREAD_SAFE;
+	}
+
+	ResultType eval( const SearchPointType & x ) const {
+		ResultType value;
+		bool fail = false;
+		SHARK_CRITICAL_REGION{
+			value = DTLZ2::eval(x);
+			fail = evaluationCounter() == m_failingEvaluation;
+		}
+		if(fail)
+			throw SHARKEXCEPTION("[ThreadSafeDTLZ2::eval] evaluation failed");
+		return value;
+	}
+private:
+	std::size_t m_failingEvaluation;
+};
+}
+
+BOOST_AUTO_TEST_CASE( MOCMA_Batch_Evaluation ) {
+	DTLZ2 function(5);
+	ThreadSafeDTLZ2 threadSafeFunction(5);
+	BOOST_REQUIRE(!function.isThreadSafe());
+	BOOST_REQUIRE(threadSafeFunction.isThreadSafe());
+
+	//the offspring are sampled before the evaluation, thus both runs draw the same random numbers
+	detail::MOCMA<> serial;
+	Rng::seed(42);
+	FastRng::seed(42);
+	serial.init(function);
+	detail::MOCMA<>::SolutionSetType serialSolution;
+	for(std::size_t i = 0; i != 50; ++i)
+		serialSolution = serial.step(function);
+
+	detail::MOCMA<> parallel;
+	Rng::seed(42);
+	FastRng::seed(42);
+	parallel.init(threadSafeFunction);
+	detail::MOCMA<>::SolutionSetType parallelSolution;
+	for(std::size_t i = 0; i != 50; ++i)
+		parallelSolution = parallel.step(threadSafeFunction);
+
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), threadSafeFunction.evaluationCounter());
+	BOOST_REQUIRE_EQUAL(serialSolution.size(), parallelSolution.size());
+	for(std::size_t i = 0; i != serialSolution.size(); ++i){
+		BOOST_CHECK_SMALL(norm_inf(serialSolution[i].value - parallelSolution[i].value), 1.e-15);
+		BOOST_CHECK_SMALL(norm_inf(serialSolution[i].point - parallelSolution[i].point), 1.e-15);
+	}
+
+	//an exception of a single evaluation is passed on after the population is evaluated
+	ThreadSafeDTLZ2 failingFunction(5,3);
+	detail::MOCMA<> failing;
+	BOOST_CHECK_THROW(failing.init(failingFunction), Exception);
+}
+
 #ifdef NDEBUG
 BOOST_AUTO_TEST_CASE( MOCMA_Performance ) {
 
@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE ML_AdaptiveStepSize
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Algorithms/GradientDescent/Adam.h>
+#include <shark/Algorithms/GradientDescent/Adagrad.h>
+
+using namespace shark;
+
+//linear function, the derivative is the same everywhere and its components differ in scale
+struct LinearFunction : public AbstractObjectiveFunction<VectorSpace<double> ,double>
+{
+	typedef AbstractObjectiveFunction<VectorSpace<double> ,double> Base;
+
+	RealVector w;
+	LinearFunction():w(3)
+	{
+		w(0)=3;
+		w(1)=-0.5;
+		w(2)=1.e-3;
+		m_features|=Base::HAS_FIRST_DERIVATIVE;
+	}
+
+	std::string name() const
+	{ return "LinearFunction"; }
+
+	std::size_t numberOfVariables()const{
+		return 3;
+	}
+	virtual double eval(RealVector const& point)const
+	{
+		return inner_prod(w,point);
+	}
+	virtual double evalDerivative(RealVector const& point, FirstOrderDerivative& derivative)const
+	{
+		derivative = w;
+		return eval(point);
+	}
+};
+
+//with bias correction the averages equal the constant derivative in every step,
+//thus every component moves by the learning rate against the sign of its derivative
+BOOST_AUTO_TEST_CASE( Adam_Bias_Correction )
+{
+	LinearFunction function;
+	RealVector start(3,1.0);
+	double learningRate = 0.01;
+	Adam optimizer;
+	optimizer.setLearningRate(learningRate);
+	optimizer.setEpsilon(0.0);
+	optimizer.init(function,start);
+
+	for(std::size_t t = 1; t != 4; ++t){
+		optimizer.step(function);
+		RealVector const& point = optimizer.solution().point;
+		for(std::size_t i = 0; i != 3; ++i){
+			double sign = function.w(i) > 0? 1.0: -1.0;
+			BOOST_CHECK_CLOSE(point(i), start(i) - t * learningRate * sign, 1.e-10);
+		}
+		BOOST_CHECK_CLOSE(optimizer.solution().value, function.eval(point), 1.e-12);
+	}
+}
+
+//the t-th step of a component is learningRate*g/sqrt(t*g^2) = learningRate*sign(g)/sqrt(t)
+BOOST_AUTO_TEST_CASE( Adagrad_Step_Scaling )
+{
+	LinearFunction function;
+	RealVector start(3,1.0);
+	double learningRate = 0.1;
+	Adagrad optimizer;
+	optimizer.setLearningRate(learningRate);
+	optimizer.setEpsilon(0.0);
+	optimizer.init(function,start);
+
+	RealVector expected = start;
+	for(std::size_t t = 1; t != 4; ++t){
+		optimizer.step(function);
+		RealVector const& point = optimizer.solution().point;
+		for(std::size_t i = 0; i != 3; ++i){
+			double sign = function.w(i) > 0? 1.0: -1.0;
+			expected(i) -= learningRate * sign / std::sqrt(double(t));
+			BOOST_CHECK_CLOSE(point(i), expected(i), 1.e-10);
+		}
+		BOOST_CHECK_CLOSE(optimizer.solution().value, function.eval(point), 1.e-12);
+	}
+}
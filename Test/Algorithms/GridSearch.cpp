@@ -3,6 +3,7 @@
 #include <boost/test/floating_point_comparison.hpp>
 
 #include <shark/Algorithms/DirectSearch/GridSearch.h>
+#include <shark/Algorithms/DirectSearch/SuccessiveHalving.h>
 
 using namespace shark;
 
@@ -205,3 +206,283 @@ BOOST_AUTO_TEST_CASE( PointSearch_random )
 	std::cout<<"PointSearch_random done. Error:"<<error<<std::endl;
 	BOOST_CHECK_SMALL(error,1.e-5);
 }
+
+//counts the evaluations, the counter is only changed under a lock
+struct CountingFunction : public TestFunction
+{
+	CountingFunction(bool threadSafe){
+		if(threadSafe)
+			m_features|=Base::IS_THREAD_SAFE;
+	}
+	virtual double eval(RealVector const& pattern)const
+	{
+		SHARK_CRITICAL_REGION{
+			++m_evaluationCounter;
+		}
+		return TestFunction::eval(pattern);
+	}
+};
+
+BOOST_AUTO_TEST_CASE( GridSearch_Cache )
+{
+	CountingFunction function(false);
+	EvaluationCache cache;
+	GridSearch optimizer;
+	optimizer.configure(2,-1,1,5);
+	optimizer.setCache(&cache);
+	optimizer.init(function);
+	optimizer.step(function);
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), 25u);
+	BOOST_CHECK_EQUAL(cache.size(), 25u);
+
+	//all points are known, nothing is evaluated again
+	optimizer.step(function);
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), 25u);
+	BOOST_CHECK_SMALL(optimizer.solution().value,1.e-15);
+
+	//a point search on a subset of the grid only evaluates the new points
+	std::vector<RealVector> points(2,RealVector(2,0.0));
+	points[1](0)=0.25;
+	PointSearch pointSearch;
+	pointSearch.configure(points);
+	pointSearch.setCache(&cache);
+	pointSearch.init(function);
+	pointSearch.step(function);
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), 26u);
+	BOOST_CHECK_EQUAL(cache.size(), 26u);
+}
+
+BOOST_AUTO_TEST_CASE( GridSearch_Checkpoint_Resume )
+{
+	std::string file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+	{
+		CountingFunction function(false);
+		EvaluationCache cache;
+		cache.setCheckpointFile(file);
+		GridSearch optimizer;
+		optimizer.configure(2,-1,1,5);
+		optimizer.setCache(&cache);
+		optimizer.init(function);
+		optimizer.step(function);
+		BOOST_CHECK_EQUAL(function.evaluationCounter(), 25u);
+	}
+	//a new search resumes from the checkpoint
+	CountingFunction function(false);
+	EvaluationCache cache;
+	cache.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(cache.size(), 25u);
+	GridSearch optimizer;
+	optimizer.configure(2,-1,1,5);
+	optimizer.setCache(&cache);
+	optimizer.init(function);
+	optimizer.step(function);
+	BOOST_CHECK_EQUAL(function.evaluationCounter(), 0u);
+	BOOST_CHECK_SMALL(optimizer.solution().value,1.e-15);
+	cache.setCheckpointFile("");
+
+	//every insertion appended one line, a line cut off by a crash is ignored
+	{
+		std::ifstream stream(file.c_str());
+		std::string line;
+		std::size_t lines = 0;
+		while(std::getline(stream, line)) ++lines;
+		BOOST_CHECK_EQUAL(lines, 25u);
+		std::ofstream append(file.c_str(), std::ios::app);
+		append << "2 0.5";
+	}
+	EvaluationCache truncated;
+	truncated.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(truncated.size(), 25u);
+	double value = 0;
+	RealVector point(2);
+	point(0) = 0.5;
+	point(1) = -1;
+	BOOST_REQUIRE(truncated.lookup(point, value));
+	BOOST_CHECK_EQUAL(value, function.eval(point));
+	//new records start on a new line
+	point(0) = 0.25;
+	truncated.insert(point, 7.0);
+	truncated.setCheckpointFile("");
+	truncated.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(truncated.size(), 26u);
+
+	//compacting the file keeps all values
+	truncated.saveCheckpoint();
+	truncated.setCheckpointFile("");
+	EvaluationCache compacted;
+	compacted.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(compacted.size(), 26u);
+	compacted.setCheckpointFile("");
+	boost::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE( GridSearch_Checkpoint_Truncated_Value )
+{
+	std::string file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+	RealVector point(2);
+	point(0) = 0.5;
+	point(1) = 1.0;
+	{
+		std::ofstream stream(file.c_str());
+		stream << "2 -0.5 1 0.25\n";
+		//the record of point was cut off within its value 0.1234
+		stream << "2 0.5 1.0 0.12";
+	}
+	EvaluationCache cache;
+	cache.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(cache.size(), 1u);
+	double value = 0;
+	BOOST_CHECK(!cache.lookup(point, value));
+
+	//the cut off line is not completed by the next record
+	cache.insert(point, 0.1234);
+	cache.setCheckpointFile("");
+	EvaluationCache resumed;
+	resumed.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(resumed.size(), 2u);
+	BOOST_REQUIRE(resumed.lookup(point, value));
+	BOOST_CHECK_EQUAL(value, 0.1234);
+	resumed.setCheckpointFile("");
+	boost::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE( GridSearch_Checkpoint_Not_Finite )
+{
+	std::string file = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+	double values[4] = {
+		std::numeric_limits<double>::quiet_NaN(),
+		std::numeric_limits<double>::infinity(),
+		-std::numeric_limits<double>::infinity(),
+		-1.e-300
+	};
+	{
+		EvaluationCache cache;
+		cache.setCheckpointFile(file);
+		for(std::size_t i = 0; i != 4; ++i){
+			RealVector point(1, double(i));
+			cache.insert(point, values[i]);
+		}
+		RealVector infinitePoint(1, std::numeric_limits<double>::infinity());
+		cache.insert(infinitePoint, 1.0);
+		cache.setCheckpointFile("");
+	}
+	//diverged evaluations are restored and not evaluated again
+	EvaluationCache cache;
+	cache.setCheckpointFile(file);
+	BOOST_CHECK_EQUAL(cache.size(), 5u);
+	for(std::size_t i = 0; i != 4; ++i){
+		double value = 0;
+		BOOST_REQUIRE(cache.lookup(RealVector(1, double(i)), value));
+		if(i == 0)
+			BOOST_CHECK(value != value);
+		else
+			BOOST_CHECK_EQUAL(value, values[i]);
+	}
+	double value = 0;
+	BOOST_CHECK(cache.lookup(RealVector(1, std::numeric_limits<double>::infinity()), value));
+	BOOST_CHECK_EQUAL(value, 1.0);
+	cache.setCheckpointFile("");
+	boost::filesystem::remove(file);
+}
+
+//fails on the points with a positive first coordinate
+struct FailingFunction : public TestFunction
+{
+	FailingFunction(){
+		m_features|=Base::IS_THREAD_SAFE;
+	}
+	virtual double eval(RealVector const& pattern)const
+	{
+		if(pattern(0) > 0)
+			throw SHARKEXCEPTION("evaluation failed");
+		return TestFunction::eval(pattern);
+	}
+};
+
+BOOST_AUTO_TEST_CASE( GridSearch_Parallel_Exception )
+{
+	//the exception of a parallel evaluation reaches the caller
+	FailingFunction function;
+	EvaluationCache cache;
+	GridSearch optimizer;
+	optimizer.configure(2,-1,1,5);
+	optimizer.setCache(&cache);
+	optimizer.init(function);
+	BOOST_CHECK_THROW(optimizer.step(function), Exception);
+	//the other points were evaluated and cached
+	BOOST_CHECK_EQUAL(cache.size(), 15u);
+}
+
+BOOST_AUTO_TEST_CASE( GridSearch_Parallel_Evaluation )
+{
+	CountingFunction serialFunction(false);
+	CountingFunction parallelFunction(true);
+	NestedGridSearch serial;
+	NestedGridSearch parallel;
+	serial.configure(2,-1,1);
+	parallel.configure(2,-1,1);
+	serial.init(serialFunction);
+	parallel.init(parallelFunction);
+	for(size_t iteration=0;iteration<10;++iteration)
+	{
+		serial.step(serialFunction);
+		parallel.step(parallelFunction);
+		BOOST_CHECK_EQUAL(serial.solution().value, parallel.solution().value);
+		BOOST_CHECK_EQUAL(serial.solution().point(0), parallel.solution().point(0));
+		BOOST_CHECK_EQUAL(serial.solution().point(1), parallel.solution().point(1));
+	}
+	BOOST_CHECK_EQUAL(serialFunction.evaluationCounter(), parallelFunction.evaluationCounter());
+}
+
+BOOST_AUTO_TEST_CASE( SuccessiveHalving_Budgets )
+{
+	std::vector<RealVector> points(27,RealVector(2));
+	for(size_t i=0;i!=27;++i)
+	{
+		points[i](0)=(i%9)*0.25-1;
+		points[i](1)=(i/9)*0.5-0.5;
+	}
+	points[13](0)=0.0;
+	points[13](1)=0.0;
+
+	CountingFunction cheap(true);
+	CountingFunction medium(true);
+	CountingFunction full(true);
+	SuccessiveHalving optimizer;
+	optimizer.configure(points);
+	optimizer.addBudget(&cheap);
+	optimizer.addBudget(&medium);
+	optimizer.init(full);
+	optimizer.step(full);
+
+	//every budget only evaluates the best third of the previous one
+	BOOST_CHECK_EQUAL(cheap.evaluationCounter(), 27u);
+	BOOST_CHECK_EQUAL(medium.evaluationCounter(), 9u);
+	BOOST_CHECK_EQUAL(full.evaluationCounter(), 3u);
+	BOOST_CHECK_SMALL(optimizer.solution().value,1.e-15);
+	BOOST_CHECK_SMALL(optimizer.solution().point(0),1.e-15);
+	BOOST_CHECK_SMALL(optimizer.solution().point(1),1.e-15);
+}
+
+BOOST_AUTO_TEST_CASE( Hyperband_Brackets )
+{
+	CountingFunction cheap(false);
+	CountingFunction medium(false);
+	CountingFunction full(true);
+	Hyperband optimizer;
+	optimizer.configure(2,-0.1,0.1);
+	optimizer.addBudget(&cheap);
+	optimizer.addBudget(&medium);
+	BOOST_CHECK_EQUAL(optimizer.bracketSize(0), 9u);
+	BOOST_CHECK_EQUAL(optimizer.bracketSize(1), 5u);
+	BOOST_CHECK_EQUAL(optimizer.bracketSize(2), 3u);
+	optimizer.init(full);
+	optimizer.step(full);
+
+	//brackets of 9, 5 and 3 candidates ending with 1, 1 and 3 full evaluations
+	BOOST_CHECK_EQUAL(cheap.evaluationCounter(), 9u);
+	BOOST_CHECK_EQUAL(medium.evaluationCounter(), 3u + 5u);
+	BOOST_CHECK_EQUAL(full.evaluationCounter(), 5u);
+	BOOST_CHECK_SMALL(optimizer.solution().value,0.02);
+	BOOST_CHECK_CLOSE(optimizer.solution().value, full.eval(optimizer.solution().point), 1.e-10);
+}
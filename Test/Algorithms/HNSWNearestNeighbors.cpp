@@ -0,0 +1,183 @@
+#define BOOST_TEST_MODULE Algorithms_HNSWNearestNeighbors
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Algorithms/NearestNeighbors/HNSWNearestNeighbors.h>
+#include <shark/Algorithms/NearestNeighbors/SimpleNearestNeighbors.h>
+#include <shark/Models/Kernels/LinearKernel.h>
+
+#include <sstream>
+#include <algorithm>
+#include <boost/archive/polymorphic_text_iarchive.hpp>
+#include <boost/archive/polymorphic_text_oarchive.hpp>
+
+using namespace shark;
+
+namespace{
+//the label of every point is its index
+LabeledData<RealVector, unsigned int> createDataset(std::size_t numPoints, std::size_t dimensions){
+	std::vector<RealVector> points(numPoints,RealVector(dimensions));
+	std::vector<unsigned int> labels(numPoints);
+	for(std::size_t i = 0; i != numPoints; ++i){
+		for(std::size_t j = 0; j != dimensions; ++j){
+			points[i](j) = Rng::gauss();
+		}
+		labels[i] = i;
+	}
+	return createLabeledDataFromRange(points,labels,100);
+}
+
+RealMatrix createQueries(std::size_t numQueries, std::size_t dimensions){
+	RealMatrix queries(numQueries,dimensions);
+	for(std::size_t i = 0; i != numQueries; ++i){
+		for(std::size_t j = 0; j != dimensions; ++j){
+			queries(i,j) = Rng::gauss();
+		}
+	}
+	return queries;
+}
+
+//fraction of the exact neighbors which are found
+template<class Pair>
+double recall(std::vector<Pair> const& result, std::vector<Pair> const& exact, std::size_t k){
+	std::size_t found = 0;
+	for(std::size_t q = 0; q != exact.size()/k; ++q){
+		for(std::size_t i = 0; i != k; ++i){
+			for(std::size_t j = 0; j != k; ++j){
+				if(result[q*k+i].value == exact[q*k+j].value){
+					++found;
+					break;
+				}
+			}
+		}
+	}
+	return double(found)/exact.size();
+}
+}
+
+BOOST_AUTO_TEST_CASE( HNSW_Recall ){
+	std::size_t const k = 10;
+	LabeledData<RealVector, unsigned int> dataset = createDataset(3000,32);
+	RealMatrix queries = createQueries(100,32);
+
+	LinearKernel<> kernel;
+	SimpleNearestNeighbors<RealVector,unsigned int> simple(dataset,&kernel);
+	std::vector<KeyValuePair<double,unsigned int> > exact = simple.getNeighbors(queries,k);
+
+	HNSWNearestNeighbors<RealVector,unsigned int> hnsw(dataset,16,100);
+	hnsw.setEfSearch(10);
+	double lowRecall = recall(hnsw.getNeighbors(queries,k),exact,k);
+	hnsw.setEfSearch(200);
+	std::vector<KeyValuePair<double,unsigned int> > result = hnsw.getNeighbors(queries,k);
+	double highRecall = recall(result,exact,k);
+	BOOST_CHECK_GE(highRecall, 0.95);
+	BOOST_CHECK_GE(highRecall, lowRecall);
+
+	//the neighbors are sorted and the distances are squared euclidean distances
+	for(std::size_t q = 0; q != queries.size1(); ++q){
+		for(std::size_t i = 0; i != k; ++i){
+			KeyValuePair<double,unsigned int> const& neighbor = result[q*k+i];
+			double distance = distanceSqr(row(queries,q),dataset.element(neighbor.value).input);
+			BOOST_CHECK_CLOSE(neighbor.key, distance, 1.e-10);
+			if(i != 0)
+				BOOST_CHECK_LE(result[q*k+i-1].key, neighbor.key);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( HNSW_Finds_Dataset_Points ){
+	LabeledData<RealVector, unsigned int> dataset = createDataset(1000,8);
+	HNSWNearestNeighbors<RealVector,unsigned int> hnsw(dataset,8,50);
+	//every point of the dataset is its own nearest neighbor
+	std::size_t found = 0;
+	for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+		std::vector<KeyValuePair<double,unsigned int> > result = hnsw.getNeighbors(dataset.batch(b).input,1);
+		for(std::size_t i = 0; i != result.size(); ++i){
+			if(result[i].value == dataset.batch(b).label(i))
+				++found;
+		}
+	}
+	BOOST_CHECK_GE(found, 990u);
+}
+
+BOOST_AUTO_TEST_CASE( HNSW_Serialization ){
+	std::size_t const k = 5;
+	LabeledData<RealVector, unsigned int> dataset = createDataset(500,10);
+	RealMatrix queries = createQueries(20,10);
+	HNSWNearestNeighbors<RealVector,unsigned int> hnsw(dataset,8,50);
+	std::vector<KeyValuePair<double,unsigned int> > result = hnsw.getNeighbors(queries,k);
+
+	std::ostringstream outputStream;
+	{
+		boost::archive::polymorphic_text_oarchive oa(outputStream);
+		oa << hnsw;
+	}
+	HNSWNearestNeighbors<RealVector,unsigned int> deserialized;
+	std::istringstream inputStream(outputStream.str());
+	boost::archive::polymorphic_text_iarchive ia(inputStream);
+	ia >> deserialized;
+
+	BOOST_CHECK_EQUAL(deserialized.efSearch(), hnsw.efSearch());
+	BOOST_REQUIRE_EQUAL(deserialized.dataset().numberOfElements(), 500u);
+	std::vector<KeyValuePair<double,unsigned int> > deserializedResult = deserialized.getNeighbors(queries,k);
+	for(std::size_t i = 0; i != result.size(); ++i){
+		BOOST_CHECK_EQUAL(deserializedResult[i].value, result[i].value);
+		BOOST_CHECK_CLOSE(deserializedResult[i].key, result[i].key, 1.e-10);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( HNSW_All_Points ){
+	//asking for all points returns every point exactly once, also when the search
+	//in the sparse graph of the clusters does not reach all nodes
+	std::size_t const numPoints = 200;
+	std::vector<RealVector> points(numPoints,RealVector(2));
+	std::vector<unsigned int> labels(numPoints);
+	for(std::size_t i = 0; i != numPoints; ++i){
+		points[i](0) = (i % 10)*100.0 + Rng::gauss();
+		points[i](1) = Rng::gauss();
+		labels[i] = i;
+	}
+	LabeledData<RealVector, unsigned int> dataset = createLabeledDataFromRange(points,labels,10);
+	RealMatrix queries = createQueries(10,2);
+	HNSWNearestNeighbors<RealVector,unsigned int> hnsw(dataset,2,4);
+	hnsw.setEfSearch(1);
+	std::vector<KeyValuePair<double,unsigned int> > result = hnsw.getNeighbors(queries,numPoints);
+	BOOST_REQUIRE_EQUAL(result.size(), queries.size1()*numPoints);
+	for(std::size_t q = 0; q != queries.size1(); ++q){
+		std::vector<unsigned int> found;
+		for(std::size_t i = 0; i != numPoints; ++i){
+			KeyValuePair<double,unsigned int> const& neighbor = result[q*numPoints+i];
+			BOOST_CHECK_CLOSE(neighbor.key, distanceSqr(row(queries,q),points[neighbor.value]), 1.e-10);
+			if(i != 0)
+				BOOST_CHECK_LE(result[q*numPoints+i-1].key, neighbor.key);
+			found.push_back(neighbor.value);
+		}
+		std::sort(found.begin(),found.end());
+		for(std::size_t i = 0; i != numPoints; ++i)
+			BOOST_CHECK_EQUAL(found[i], i);
+	}
+}
+
+#ifdef SHARK_USE_OPENMP
+BOOST_AUTO_TEST_CASE( HNSW_Thread_Count ){
+	//the graph and thus the neighbors do not depend on the number of threads
+	std::size_t const k = 5;
+	LabeledData<RealVector, unsigned int> dataset = createDataset(1000,8);
+	RealMatrix queries = createQueries(20,8);
+	int maxThreads = omp_get_max_threads();
+	std::vector<KeyValuePair<double,unsigned int> > results[2];
+	int threads[2] = {1,3};
+	for(std::size_t t = 0; t != 2; ++t){
+		omp_set_num_threads(threads[t]);
+		Rng::seed(42);
+		HNSWNearestNeighbors<RealVector,unsigned int> hnsw(dataset,8,50);
+		results[t] = hnsw.getNeighbors(queries,k);
+	}
+	omp_set_num_threads(maxThreads);
+	BOOST_REQUIRE_EQUAL(results[0].size(), results[1].size());
+	for(std::size_t i = 0; i != results[0].size(); ++i){
+		BOOST_CHECK_EQUAL(results[0][i].value, results[1][i].value);
+		BOOST_CHECK_EQUAL(results[0][i].key, results[1][i].key);
+	}
+}
+#endif
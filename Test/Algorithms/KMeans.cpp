@@ -38,6 +38,7 @@
 #include <algorithm>
 
 #include <shark/Algorithms/KMeans.h>
+#include <shark/Algorithms/Trainers/MiniBatchKMeans.h>
 #include <shark/Models/Clustering/HardClusteringModel.h>
 #include <shark/Models/Kernels/LinearKernel.h>
 #include <shark/Models/Converter.h>
@@ -234,3 +235,129 @@ BOOST_AUTO_TEST_CASE(Kernel_KMeans_multiple_gauss)
 		}
 	}
 }
+
+// the bounded variants must compute the same clustering as Lloyd's algorithm
+BOOST_AUTO_TEST_CASE(KMeans_bounded_variants)
+{
+	const unsigned int numPoints = 2000;
+	const unsigned int numMeans = 30;
+	const unsigned int numDimensions = 4;
+	std::vector<RealVector> means(numMeans,RealVector(numDimensions));
+	for (unsigned int i=0; i<numMeans; i++){
+		for (unsigned int j=0; j <numDimensions; j++){
+			means[i](j) = Rng::uni(0,10);
+		}
+	}
+	std::vector<RealVector> data(numPoints);
+	for (std::size_t i=0; i<numPoints; i++)
+	{
+		data[i]=means[i%numMeans];
+		for (unsigned int j=0; j <numDimensions; j++){
+			data[i](j) += Rng::gauss(0,1);
+		}
+	}
+	Data<RealVector> dataset = createDataFromRange(data,100);
+	std::vector<RealVector> start(data.begin(),data.begin()+numMeans);
+
+	KMeansAlgorithm algorithms[] = {KMeansHamerly, KMeansElkan, KMeansAuto};
+	Centroids lloydCentroids(createDataFromRange(start));
+	KMeansStatistics lloydStatistics;
+	std::size_t lloydIterations = kMeans(dataset, numMeans, lloydCentroids, 0, KMeansLloyd, &lloydStatistics);
+	BOOST_CHECK_EQUAL(lloydStatistics.iterations, lloydIterations);
+	BOOST_CHECK_EQUAL(lloydStatistics.distanceComputations, lloydStatistics.lloydDistanceComputations);
+	for(std::size_t a = 0; a != 3; ++a){
+		Centroids centroids(createDataFromRange(start));
+		KMeansStatistics statistics;
+		std::size_t iterations = kMeans(dataset, numMeans, centroids, 0, algorithms[a], &statistics);
+		BOOST_CHECK_EQUAL(iterations, lloydIterations);
+		BOOST_CHECK_EQUAL(statistics.lloydDistanceComputations, lloydStatistics.lloydDistanceComputations);
+		BOOST_CHECK(statistics.savedDistanceFraction() > 0.5);
+		BOOST_CHECK(statistics.savedDistanceFraction() < 1.0);
+		for (unsigned int i=0; i<numMeans; i++){
+			double distance = distanceSqr(lloydCentroids.centroids().element(i),centroids.centroids().element(i));
+			BOOST_CHECK_SMALL(distance, 1.e-10);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(MiniBatchKMeans_gauss)
+{
+	const unsigned int numPoints = 3000;
+	const unsigned int numMeans = 3;
+	const unsigned int numDimensions = 2;
+	std::vector<RealVector> means(numMeans,RealVector(numDimensions,0.0));
+	means[1](0) = 10;
+	means[2](1) = 10;
+	std::vector<RealVector> data(numPoints);
+	for (std::size_t i=0; i<numPoints; i++)
+	{
+		data[i]=means[i%numMeans];
+		for (unsigned int j=0; j <numDimensions; j++){
+			data[i](j) += Rng::gauss(0,1);
+		}
+	}
+	Data<RealVector> dataset = createDataFromRange(data,50);
+
+	//start from one point of every cluster
+	std::vector<RealVector> start(data.begin(),data.begin()+numMeans);
+	Centroids centroids(createDataFromRange(start));
+	MiniBatchKMeans trainer(numMeans,5);
+	trainer.train(centroids,dataset);
+	BOOST_REQUIRE_EQUAL(centroids.numberOfClusters(), numMeans);
+	for (unsigned int i=0; i<numMeans; i++){
+		BOOST_CHECK_SMALL(distance(centroids.centroids().element(i),means[i]), 0.2);
+	}
+	std::size_t seen = 0;
+	for (unsigned int i=0; i<numMeans; i++)
+		seen += trainer.clusterCounts()[i];
+	BOOST_CHECK_EQUAL(seen, 5*numPoints);
+
+	//streaming the batches one by one gives the running means of the clusters
+	Centroids streamed(createDataFromRange(start));
+	trainer.resetCounts();
+	for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+		trainer.update(streamed,dataset.batch(b));
+	}
+	for (unsigned int i=0; i<numMeans; i++){
+		BOOST_CHECK_SMALL(distance(streamed.centroids().element(i),means[i]), 0.2);
+		BOOST_CHECK_EQUAL(trainer.clusterCounts()[i], numPoints/numMeans);
+	}
+}
+
+// with well separated clusters, both seedings choose one centroid in every cluster
+BOOST_AUTO_TEST_CASE(KMeans_seeding)
+{
+	const unsigned int numPoints = 5000;
+	const unsigned int numMeans = 20;
+	const unsigned int numDimensions = 3;
+	std::vector<RealVector> means(numMeans,RealVector(numDimensions));
+	for (unsigned int i=0; i<numMeans; i++){
+		for (unsigned int j=0; j <numDimensions; j++){
+			means[i](j) = 100.0*(j == i%numDimensions)*(i+1);
+		}
+	}
+	std::vector<RealVector> data(numPoints);
+	for (std::size_t i=0; i<numPoints; i++)
+	{
+		data[i]=means[i%numMeans];
+		for (unsigned int j=0; j <numDimensions; j++){
+			data[i](j) += Rng::uni(-0.1,0.1);
+		}
+	}
+	Data<RealVector> dataset = createDataFromRange(data,128);
+
+	Centroids::InitializationMethod methods[] = {Centroids::KMeansPlusPlus, Centroids::KMeansParallel};
+	for(std::size_t m = 0; m != 2; ++m){
+		Centroids centroids;
+		centroids.initFromData(dataset, numMeans, methods[m]);
+		BOOST_REQUIRE_EQUAL(centroids.numberOfClusters(), numMeans);
+		for (unsigned int i=0; i<numMeans; i++){
+			double closest = std::numeric_limits<double>::max();
+			for (unsigned int c=0; c<numMeans; c++)
+				closest = std::min(closest, distance(centroids.centroids().element(c),means[i]));
+			BOOST_CHECK_SMALL(closest, 1.0);
+		}
+		//Lloyd only needs to move the centroids to the means
+		BOOST_CHECK_LE(kMeans(dataset, numMeans, centroids), 3u);
+	}
+}
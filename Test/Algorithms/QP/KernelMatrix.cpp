@@ -193,6 +193,86 @@ BOOST_AUTO_TEST_CASE( QP_CachedMatrix_Flipping ) {
 	}
 	
 }
+BOOST_AUTO_TEST_CASE( QP_CachedMatrix_Statistics ) {
+	std::size_t numRowsToStore = 10;
+	std::size_t cacheSize = numRowsToStore*size;
+	
+	KernelMatrix<RealVector,double> km(kernel,data.inputs());
+	CachedMatrix<KernelMatrix<RealVector,double> > cache(&km,cacheSize);
+	
+	//creating and extending rows are misses
+	cache.row(3,0,size/2);
+	cache.row(3,0,size);
+	cache.row(7,0,size);
+	cache.row(1,0,size);
+	BOOST_CHECK_EQUAL(cache.cacheMisses(), 4u);
+	BOOST_CHECK_EQUAL(cache.cacheHits(), 0u);
+	
+	//cached rows are hits
+	cache.row(3,0,size);
+	cache.row(7,0,size/2);
+	cache.row(1,0,size);
+	BOOST_CHECK_EQUAL(cache.cacheHits(), 3u);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 0u);
+	
+	//filling the cache does not evict rows, one more row evicts the oldest one
+	cache.clear();
+	for(std::size_t i = 0; i != numRowsToStore; ++i)
+		cache.row(i,0,size);
+	BOOST_CHECK_EQUAL(cache.getCacheSize(), cacheSize);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 0u);
+	cache.row(numRowsToStore,0,size);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 1u);
+	BOOST_CHECK(!cache.isCached(0));
+	
+	cache.resetCacheStatistics();
+	BOOST_CHECK_EQUAL(cache.cacheHits(), 0u);
+	BOOST_CHECK_EQUAL(cache.cacheMisses(), 0u);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 0u);
+}
 
+BOOST_AUTO_TEST_CASE( QP_CachedMatrix_Prefetch ) {
+	std::size_t numRowsToStore = 10;
+	std::size_t cacheSize = numRowsToStore*size;
+	
+	KernelMatrix<RealVector,double> km(kernel,data.inputs());
+	CachedMatrix<KernelMatrix<RealVector,double> > cache(&km,cacheSize);
+	
+	//partially cached rows are extended, only the missing entries are computed
+	cache.row(3,0,size/2);
+	km.resetAccessCount();
+	std::vector<std::size_t> rows;
+	rows.push_back(3);
+	rows.push_back(7);
+	rows.push_back(1);
+	rows.push_back(7);
+	cache.prefetchRows(rows,size);
+	BOOST_CHECK_EQUAL(km.getAccessCount(), 2*size+size/2);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 0u);
+	
+	//the prefetched rows are hits
+	cache.resetCacheStatistics();
+	for(std::size_t r = 0; r != 3; ++r){
+		BOOST_REQUIRE_EQUAL(cache.getCacheRowSize(rows[r]), size);
+		double* line = cache.row(rows[r],0,size);
+		for(std::size_t i = 0; i != size; ++i){
+			BOOST_CHECK_CLOSE(line[i],kernelMatrix(rows[r],i), 1.e-10);
+		}
+	}
+	BOOST_CHECK_EQUAL(cache.cacheHits(), 3u);
+	BOOST_CHECK_EQUAL(cache.cacheMisses(), 0u);
+	BOOST_CHECK_EQUAL(km.getAccessCount(), 2*size+size/2);
+	
+	//only as many rows are prefetched as fit into the cache
+	cache.clear();
+	rows.clear();
+	for(std::size_t i = 0; i != 2*numRowsToStore; ++i)
+		rows.push_back(i);
+	cache.prefetchRows(rows,size);
+	for(std::size_t i = 0; i != rows.size(); ++i)
+		BOOST_CHECK_EQUAL(cache.isCached(i), i < numRowsToStore);
+	BOOST_CHECK_EQUAL(cache.getCacheSize(), cacheSize);
+	BOOST_CHECK_EQUAL(cache.cacheEvictions(), 0u);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -139,3 +139,28 @@ BOOST_AUTO_TEST_CASE( QP_LRUCache_DifferentLength_Access_fliped ) {
 	simulateCache(maxIndex, cacheSize,accessIndices,accessSizes,flips);
 }
 
+BOOST_AUTO_TEST_CASE( QP_LRUCache_Statistics ) {
+	LRUCache<double> cache(10,6);
+	cache.getCacheLine(0,2);//miss
+	cache.getCacheLine(1,2);//miss
+	cache.getCacheLine(0,1);//hit
+	cache.getCacheLine(1,3);//miss, extended
+	cache.getCacheLine(2,2);//miss, evicts line 0
+	BOOST_CHECK_EQUAL(cache.hits(), 1u);
+	BOOST_CHECK_EQUAL(cache.misses(), 4u);
+	BOOST_CHECK_EQUAL(cache.evictions(), 1u);
+	
+	std::vector<std::size_t> lines;
+	cache.cachedLineIndices(lines);
+	BOOST_REQUIRE_EQUAL(lines.size(), 2u);
+	BOOST_CHECK_EQUAL(lines[0], 2u);
+	BOOST_CHECK_EQUAL(lines[1], 1u);
+	
+	//clearing the cache is not counted as eviction
+	cache.clear();
+	BOOST_CHECK_EQUAL(cache.evictions(), 1u);
+	cache.resetStatistics();
+	BOOST_CHECK_EQUAL(cache.hits(), 0u);
+	BOOST_CHECK_EQUAL(cache.misses(), 0u);
+	BOOST_CHECK_EQUAL(cache.evictions(), 0u);
+}
@@ -244,3 +244,30 @@ BOOST_AUTO_TEST_CASE( CSVM_TRAINER_ITERATIVE_BIAS_TEST )
 	//~ std::cout<<svmTest.alpha()<<std::endl;
 	//~ std::cout<<svmTruth.alpha()<<std::endl;
 }
+
+//the parallel loops of the solver must give exactly the solution of the sequential loops
+BOOST_AUTO_TEST_CASE( CSVM_TRAINER_PARALLEL_TEST )
+{
+	CircleInSquare problem(2);
+	ClassificationDataset dataset = problem.generateDataset(300);
+	GaussianRbfKernel<> kernel(0.5);
+	CSvmTrainer<RealVector> trainer(&kernel, 10);
+	trainer.sparsify() = false;
+	trainer.shrinking() = true;
+	trainer.stoppingCondition().minAccuracy = 1e-6;
+
+	std::size_t threshold = qpParallelThreshold();
+	KernelExpansion<RealVector> svmSerial(true);
+	trainer.train(svmSerial, dataset);
+	//every loop over the variables runs in parallel
+	setQpParallelThreshold(1);
+	KernelExpansion<RealVector> svmParallel(true);
+	trainer.train(svmParallel, dataset);
+	setQpParallelThreshold(threshold);
+
+	RealVector serial = svmSerial.parameterVector();
+	RealVector parallel = svmParallel.parameterVector();
+	BOOST_REQUIRE_EQUAL(serial.size(), parallel.size());
+	for(std::size_t i = 0; i != serial.size(); ++i)
+		BOOST_CHECK_EQUAL(serial(i), parallel(i));
+}
@@ -265,3 +265,46 @@ BOOST_AUTO_TEST_CASE( CSVM_TRAINER_ITERATIVE_BIAS_TEST )
 	std::cout<<"WW with bias: "<<loss.eval(dataset.labels(),svmTest2(dataset.inputs()))<<" "<<svmTest2.offset()<<std::endl;
 }
 
+
+//the parallel loops of the decomposition solver must give exactly the solution of the sequential loops
+BOOST_AUTO_TEST_CASE( MCSVM_TRAINER_PARALLEL_TEST )
+{
+	//three overlapping classes, so that some variables are free and others at the bounds
+	std::size_t const ell = 150;
+	std::vector<RealVector> input(ell, RealVector(2));
+	std::vector<unsigned int> target(ell);
+	for (std::size_t i=0; i<ell; i++)
+	{
+		target[i] = i % 3;
+		input[i](0) = Rng::gauss() + (target[i] == 1 ? 2.0 : 0.0);
+		input[i](1) = Rng::gauss() + (target[i] == 2 ? 2.0 : 0.0);
+	}
+	ClassificationDataset dataset = createLabeledDataFromRange(input, target);
+	GaussianRbfKernel<> kernel(0.5);
+
+	AbstractSvmTrainer<RealVector, unsigned int>* trainer[2];
+	trainer[0] = new McSvmWWTrainer<RealVector>(&kernel, 1.0);
+	trainer[1] = new McSvmCSTrainer<RealVector>(&kernel, 1.0);
+	std::size_t threshold = qpParallelThreshold();
+	for (std::size_t t=0; t<2; t++)
+	{
+		trainer[t]->sparsify() = false;
+		trainer[t]->shrinking() = true;
+		trainer[t]->stoppingCondition().minAccuracy = 1e-6;
+
+		KernelExpansion<RealVector> svmSerial(false, 3);
+		trainer[t]->train(svmSerial, dataset);
+		//every loop over the variables runs in parallel
+		setQpParallelThreshold(1);
+		KernelExpansion<RealVector> svmParallel(false, 3);
+		trainer[t]->train(svmParallel, dataset);
+		setQpParallelThreshold(threshold);
+
+		RealVector serial = svmSerial.parameterVector();
+		RealVector parallel = svmParallel.parameterVector();
+		BOOST_REQUIRE_EQUAL(serial.size(), parallel.size());
+		for (std::size_t i=0; i<serial.size(); i++)
+			BOOST_CHECK_EQUAL(serial(i), parallel(i));
+		delete trainer[t];
+	}
+}
@@ -209,3 +209,49 @@ BOOST_AUTO_TEST_CASE(IterativeNearestNeighborQueries)
 ////	testTree(lctree,"LCTree",data,test,index,time_reference);
 ////	testTree(khctree,"KHCTree",data,test,index,time_reference);
 //}
+
+//compare the neighbors found by the tree with a brute force search
+template<class Tree>
+void testTreeNeighbors(Tree const& tree, LabeledData<RealVector,unsigned int> const& dataset, RealMatrix const& queries, std::size_t k){
+	TreeNearestNeighbors<RealVector,unsigned int> algorithm(dataset, &tree);
+	std::vector<KeyValuePair<double,unsigned int> > result = algorithm.getNeighbors(queries,k);
+	BOOST_REQUIRE_EQUAL(result.size(), queries.size1()*k);
+	for (std::size_t q = 0; q != queries.size1(); q++){
+		std::vector<std::pair<double,unsigned int> > exact(dataset.numberOfElements());
+		for (std::size_t i = 0; i != exact.size(); i++)
+			exact[i] = std::make_pair(distance(row(queries,q), dataset.element(i).input), dataset.element(i).label);
+		std::sort(exact.begin(),exact.end());
+		for (std::size_t i = 0; i != k; i++){
+			BOOST_CHECK_EQUAL(result[q*k+i].value, exact[i].second);
+			BOOST_CHECK_SMALL(result[q*k+i].key - exact[i].first, 1.e-10);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(TreeNearestNeighbors_Batch_Queries)
+{
+	std::size_t const dimensions = 3;
+	std::vector<RealVector> points(2000,RealVector(dimensions));
+	std::vector<unsigned int> labels(points.size());
+	for (std::size_t i = 0; i != points.size(); i++){
+		for (std::size_t j = 0; j != dimensions; j++)
+			points[i][j] = Rng::gauss();
+		labels[i] = i;
+	}
+	LabeledData<RealVector,unsigned int> dataset = createLabeledDataFromRange(points,labels,100);
+	RealMatrix queries(300,dimensions);
+	for (std::size_t q = 0; q != queries.size1(); q++){
+		for (std::size_t j = 0; j != dimensions; j++)
+			queries(q,j) = 1.5*Rng::gauss();
+	}
+
+	KDTree<RealVector> kdtree(dataset.inputs());
+	testTreeNeighbors(kdtree, dataset, queries, 10);
+	testTreeNeighbors(kdtree, dataset, queries, 1);
+	LCTree<RealVector> lctree(dataset.inputs());
+	testTreeNeighbors(lctree, dataset, queries, 10);
+	//kernel trees are searched point by point
+	LinearKernel<RealVector> kernel;
+	KHCTree<DataView<Data<RealVector> > > khctree(DataView<Data<RealVector> >(dataset.inputs()), &kernel);
+	testTreeNeighbors(khctree, dataset, queries, 10);
+}
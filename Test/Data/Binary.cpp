@@ -0,0 +1,196 @@
+#define BOOST_TEST_MODULE Data_Binary
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Data/Binary.h>
+#include <shark/Rng/GlobalRng.h>
+#include <cstdio>
+#include <fstream>
+#include <boost/cstdint.hpp>
+
+using namespace shark;
+
+namespace{
+std::string const filename = "test_binary_dataset.bin";
+
+LabeledData<RealVector, unsigned int> createDenseDataset(std::size_t size, std::size_t dim){
+	std::vector<RealVector> inputs(size, RealVector(dim));
+	std::vector<unsigned int> labels(size);
+	for(std::size_t i = 0; i != size; ++i){
+		for(std::size_t j = 0; j != dim; ++j)
+			inputs[i](j) = Rng::gauss();
+		labels[i] = Rng::discrete(0,4);
+	}
+	return createLabeledDataFromRange(inputs, labels, 25);
+}
+
+void checkBatchEqual(RealMatrix const& batch, RealMatrix const& imported){
+	BOOST_REQUIRE_EQUAL(batch.size1(), imported.size1());
+	BOOST_REQUIRE_EQUAL(batch.size2(), imported.size2());
+	for(std::size_t i = 0; i != batch.size1(); ++i){
+		for(std::size_t j = 0; j != batch.size2(); ++j)
+			BOOST_CHECK_EQUAL(batch(i,j), imported(i,j));
+	}
+}
+void checkBatchEqual(UIntVector const& batch, UIntVector const& imported){
+	BOOST_REQUIRE_EQUAL(batch.size(), imported.size());
+	for(std::size_t i = 0; i != batch.size(); ++i)
+		BOOST_CHECK_EQUAL(batch(i), imported(i));
+}
+
+template<class T>
+void checkBatchesEqual(Data<T> const& data, Data<T> const& imported){
+	BOOST_REQUIRE_EQUAL(data.numberOfBatches(), imported.numberOfBatches());
+	for(std::size_t b = 0; b != data.numberOfBatches(); ++b)
+		checkBatchEqual(data.batch(b), imported.batch(b));
+}
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Dense ){
+	LabeledData<RealVector, unsigned int> dataset = createDenseDataset(110, 7);
+
+	export_binary(dataset.inputs(), filename);
+	Data<RealVector> inputs;
+	import_binary(inputs, filename);
+	checkBatchesEqual(dataset.inputs(), inputs);
+
+	export_binary(dataset, filename);
+	LabeledData<RealVector, unsigned int> imported;
+	import_binary(imported, filename);
+	checkBatchesEqual(dataset.inputs(), imported.inputs());
+	checkBatchesEqual(dataset.labels(), imported.labels());
+	std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Regression ){
+	std::vector<RealVector> inputs(40, RealVector(3));
+	std::vector<RealVector> labels(40, RealVector(2));
+	for(std::size_t i = 0; i != 40; ++i){
+		for(std::size_t j = 0; j != 3; ++j) inputs[i](j) = Rng::uni(-1,1);
+		for(std::size_t j = 0; j != 2; ++j) labels[i](j) = Rng::uni(-1,1);
+	}
+	LabeledData<RealVector, RealVector> dataset = createLabeledDataFromRange(inputs, labels, 16);
+
+	export_binary(dataset, filename);
+	LabeledData<RealVector, RealVector> imported;
+	import_binary(imported, filename);
+	checkBatchesEqual(dataset.inputs(), imported.inputs());
+	checkBatchesEqual(dataset.labels(), imported.labels());
+	std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Sparse ){
+	std::size_t const size = 70;
+	std::size_t const dim = 50;
+	std::vector<CompressedRealVector> inputs(size, CompressedRealVector(dim));
+	std::vector<unsigned int> labels(size);
+	for(std::size_t i = 0; i != size; ++i){
+		//some points are empty to check rows without entries
+		if(i % 7 != 0){
+			for(std::size_t j = 0; j != dim; ++j){
+				if(Rng::coinToss(0.2))
+					inputs[i](j) = Rng::gauss();
+			}
+		}
+		labels[i] = i % 2;
+	}
+	LabeledData<CompressedRealVector, unsigned int> dataset = createLabeledDataFromRange(inputs, labels, 16);
+
+	export_binary(dataset, filename);
+	LabeledData<CompressedRealVector, unsigned int> imported;
+	import_binary(imported, filename);
+	BOOST_REQUIRE_EQUAL(imported.numberOfBatches(), dataset.numberOfBatches());
+	BOOST_REQUIRE_EQUAL(imported.numberOfElements(), size);
+	for(std::size_t i = 0; i != size; ++i){
+		CompressedRealVector const& x = imported.element(i).input;
+		BOOST_REQUIRE_EQUAL(x.size(), dim);
+		for(std::size_t j = 0; j != dim; ++j)
+			BOOST_CHECK_EQUAL(x(j), inputs[i](j));
+		BOOST_CHECK_EQUAL(imported.element(i).label, labels[i]);
+	}
+	checkBatchesEqual(dataset.labels(), imported.labels());
+	std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Invalid_Files ){
+	LabeledData<RealVector, unsigned int> dataset = createDenseDataset(30, 4);
+	export_binary(dataset, filename);
+
+	//wrong type of dataset
+	Data<RealVector> inputs;
+	BOOST_CHECK_THROW(import_binary(inputs, filename), Exception);
+	LabeledData<CompressedRealVector, unsigned int> sparse;
+	BOOST_CHECK_THROW(import_binary(sparse, filename), Exception);
+
+	//not a binary dataset
+	{
+		std::ofstream out(filename.c_str());
+		out<<"1,2,3\n4,5,6\n";
+	}
+	BOOST_CHECK_THROW(import_binary(inputs, filename), Exception);
+	std::remove(filename.c_str());
+
+	//missing file
+	BOOST_CHECK_THROW(import_binary(inputs, filename), Exception);
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Random_Access ){
+	LabeledData<RealVector, unsigned int> dataset = createDenseDataset(110, 7);
+	export_binary(dataset, filename);
+
+	BinaryDataFile<RealVector> inputs(filename, 0);
+	BinaryDataFile<unsigned int> labels(filename, 1);
+	BOOST_REQUIRE_EQUAL(inputs.numberOfBatches(), dataset.numberOfBatches());
+	BOOST_REQUIRE_EQUAL(labels.numberOfBatches(), dataset.numberOfBatches());
+	BOOST_CHECK_EQUAL(inputs.numberOfElements(), 110u);
+	for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+		BOOST_CHECK_EQUAL(inputs.batchSize(b), shark::size(dataset.inputs().batch(b)));
+		BOOST_CHECK_EQUAL(labels.batchSize(b), shark::size(dataset.labels().batch(b)));
+	}
+
+	//single batches
+	checkBatchEqual(dataset.inputs().batch(2), inputs.batch(2));
+	UIntVector labelBatch;
+	labels.readBatch(3, labelBatch);
+	checkBatchEqual(dataset.labels().batch(3), labelBatch);
+
+	//a subset of the batches
+	std::vector<std::size_t> batches;
+	batches.push_back(3);
+	batches.push_back(0);
+	Data<RealVector> subset = inputs.data(batches);
+	BOOST_REQUIRE_EQUAL(subset.numberOfBatches(), 2u);
+	checkBatchEqual(dataset.inputs().batch(3), subset.batch(0));
+	checkBatchEqual(dataset.inputs().batch(0), subset.batch(1));
+	checkBatchesEqual(dataset.labels(), labels.data());
+
+	//the file stays mapped while a copy exists
+	BinaryDataFile<RealVector> copy = inputs;
+	checkBatchEqual(dataset.inputs().batch(1), copy.batch(1));
+
+	//missing section and wrong type
+	BOOST_CHECK_THROW(BinaryDataFile<RealVector>(filename, 2), Exception);
+	BOOST_CHECK_THROW(BinaryDataFile<CompressedRealVector>(filename, 0), Exception);
+	BOOST_CHECK_THROW(BinaryDataFile<RealVector>(filename, 1), Exception);
+	std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( Data_Binary_Corrupted_Sizes ){
+	LabeledData<RealVector, unsigned int> dataset = createDenseDataset(30, 4);
+	export_binary(dataset.inputs(), filename);
+
+	//sizes of the first batch whose size in bytes overflows to 0,
+	//the table follows the file header and the section header of 24 bytes each
+	boost::uint64_t rows = boost::uint64_t(1) << 59;
+	boost::uint64_t nonZeros = boost::uint64_t(1) << 61;
+	{
+		std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(48);
+		file.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+		file.write(reinterpret_cast<char const*>(&nonZeros), sizeof(nonZeros));
+	}
+	Data<RealVector> inputs;
+	BOOST_CHECK_THROW(import_binary(inputs, filename), Exception);
+	BOOST_CHECK_THROW(BinaryDataFile<RealVector> file(filename), Exception);
+	std::remove(filename.c_str());
+}
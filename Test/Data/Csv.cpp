@@ -3,9 +3,12 @@
 #include <boost/test/floating_point_comparison.hpp>
 
 #include <shark/Data/Csv.h>
+#include <shark/Data/Impl/TextParsing.h>
 #include <shark/LinAlg/Base.h>
 
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <sstream>
+#include <cstdio>
 
 using namespace shark;
 
@@ -187,4 +190,120 @@ BOOST_AUTO_TEST_CASE( Data_Csv_Separator_Last_Column )
 	std::cout << test_ds<<std::endl;
 	
 	checkDataEquality(test_values_2,labels_2,test_ds);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE( Data_Csv_Chunks_End_At_Lines )
+{
+	std::stringstream stream(test_separator);
+	detail::LineChunkReader reader(stream,7);
+	std::string chunk;
+	std::string contents;
+	while(reader.read(chunk)){
+		BOOST_REQUIRE(!chunk.empty());
+		BOOST_CHECK(chunk[chunk.size()-1] == '\n' || chunk[chunk.size()-1] == '\r');
+		contents += chunk;
+	}
+	BOOST_CHECK_EQUAL(contents, std::string(test_separator));
+}
+
+BOOST_AUTO_TEST_CASE( Data_Csv_Import_Large_File )
+{
+	//large enough to be parsed in several parts
+	std::size_t const rows = 20000;
+	std::size_t const dimensions = 5;
+	{
+		std::ofstream file("Data_Csv_Import_Large_File.csv");
+		file.precision(17);
+		for(std::size_t i = 0; i != rows; ++i){
+			for(std::size_t j = 0; j != dimensions; ++j)
+				file << (i*0.25 - j*1.e-3) <<',';
+			file << i%3 << "\n";
+		}
+	}
+	LabeledData<RealVector, unsigned int> test_ds;
+	import_csv(test_ds, "Data_Csv_Import_Large_File.csv", LAST_COLUMN, ',','#',128);
+	std::remove("Data_Csv_Import_Large_File.csv");
+	
+	BOOST_REQUIRE_EQUAL(test_ds.numberOfElements(), rows);
+	BOOST_REQUIRE_EQUAL(inputDimension(test_ds), dimensions);
+	BOOST_CHECK_EQUAL(test_ds.numberOfBatches(), (rows+127)/128);
+	for(std::size_t i = 0; i != rows; ++i){
+		for(std::size_t j = 0; j != dimensions; ++j)
+			BOOST_CHECK_EQUAL(test_ds.element(i).input(j), i*0.25 - j*1.e-3);
+		BOOST_CHECK_EQUAL(test_ds.element(i).label, i%3);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Data_Csv_Regression_Label_Position )
+{
+	const char test_regression[] = "1,2,3,4\n5,6,7,8\n";
+	LabeledData<RealVector, RealVector> first;
+	csvStringToData(first, test_regression, FIRST_COLUMN, 1);
+	BOOST_REQUIRE_EQUAL(first.numberOfElements(), 2u);
+	BOOST_REQUIRE_EQUAL(inputDimension(first), 3u);
+	BOOST_REQUIRE_EQUAL(labelDimension(first), 1u);
+	for(std::size_t i = 0; i != 2; ++i){
+		BOOST_CHECK_EQUAL(first.element(i).label(0), 4*i+1.0);
+		for(std::size_t j = 0; j != 3; ++j)
+			BOOST_CHECK_EQUAL(first.element(i).input(j), 4*i+j+2.0);
+	}
+
+	LabeledData<RealVector, RealVector> last;
+	csvStringToData(last, test_regression, LAST_COLUMN, 2);
+	BOOST_REQUIRE_EQUAL(last.numberOfElements(), 2u);
+	BOOST_REQUIRE_EQUAL(inputDimension(last), 2u);
+	BOOST_REQUIRE_EQUAL(labelDimension(last), 2u);
+	for(std::size_t i = 0; i != 2; ++i){
+		for(std::size_t j = 0; j != 2; ++j){
+			BOOST_CHECK_EQUAL(last.element(i).input(j), 4*i+j+1.0);
+			BOOST_CHECK_EQUAL(last.element(i).label(j), 4*i+j+3.0);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Data_Csv_Import_Unlabeled_File )
+{
+	std::size_t const rows = 1000;
+	{
+		std::ofstream file("Data_Csv_Import_Unlabeled_File.csv");
+		for(std::size_t i = 0; i != rows; ++i)
+			file << i << ',' << 0.5*i << "\n";
+	}
+	Data<RealVector> vectors;
+	import_csv<RealVector>(vectors, "Data_Csv_Import_Unlabeled_File.csv", ',', '#', 300);
+	BOOST_REQUIRE_EQUAL(vectors.numberOfElements(), rows);
+	BOOST_REQUIRE_EQUAL(vectors.numberOfBatches(), 4u);
+	//all batches but the last are full
+	for(std::size_t b = 0; b != 3; ++b)
+		BOOST_CHECK_EQUAL(vectors.batch(b).size1(), 300u);
+	BOOST_CHECK_EQUAL(vectors.batch(3).size1(), 100u);
+	for(std::size_t i = 0; i != rows; ++i){
+		BOOST_REQUIRE_EQUAL(vectors.element(i).size(), 2u);
+		BOOST_CHECK_EQUAL(vectors.element(i)(0), double(i));
+		BOOST_CHECK_EQUAL(vectors.element(i)(1), 0.5*i);
+	}
+
+	//batch size 0 puts all elements into a single batch
+	Data<RealVector> single;
+	import_csv(single, "Data_Csv_Import_Unlabeled_File.csv", ',', '#', 0);
+	BOOST_REQUIRE_EQUAL(single.numberOfBatches(), 1u);
+	BOOST_CHECK_EQUAL(single.batch(0).size1(), rows);
+	BOOST_CHECK_EQUAL(single.element(rows-1)(1), 0.5*(rows-1));
+
+	//two values per row can not be read as a single value
+	Data<unsigned int> values;
+	BOOST_CHECK_THROW(import_csv(values, "Data_Csv_Import_Unlabeled_File.csv"), Exception);
+	std::remove("Data_Csv_Import_Unlabeled_File.csv");
+
+	{
+		std::ofstream file("Data_Csv_Import_Unlabeled_File.csv");
+		for(std::size_t i = 0; i != rows; ++i)
+			file << i << "\n";
+	}
+	import_csv(values, "Data_Csv_Import_Unlabeled_File.csv");
+	std::remove("Data_Csv_Import_Unlabeled_File.csv");
+	BOOST_REQUIRE_EQUAL(values.numberOfElements(), rows);
+	for(std::size_t i = 0; i != rows; ++i)
+		BOOST_CHECK_EQUAL(values.element(i), i);
+
+	BOOST_CHECK_THROW(import_csv(values, "Data_Csv_Import_Unlabeled_File.csv"), Exception);
+}
@@ -7,6 +7,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <cstdio>
 
 using namespace shark;
 
@@ -129,3 +131,64 @@ BOOST_AUTO_TEST_CASE( Set_Libsvm )
     //~ import_libsvm( import_of_export_2, "test_output/check2.libsvm" );
 
 }
+
+BOOST_AUTO_TEST_CASE( Set_Libsvm_Highest_Index )
+{
+	std::stringstream ss(test_classification), sss(test_classification);
+	LabeledData<RealVector,unsigned int> dense;
+	LabeledData<CompressedRealVector,unsigned int> sparse;
+	import_libsvm(dense, ss, 15);
+	import_libsvm(sparse, sss, 15);
+	BOOST_REQUIRE_EQUAL(dense.numberOfElements(), NumLines);
+	BOOST_REQUIRE_EQUAL(sparse.numberOfElements(), NumLines);
+	for(std::size_t i = 0; i != NumLines; ++i){
+		BOOST_REQUIRE_EQUAL(dense.element(i).input.size(), 15u);
+		BOOST_REQUIRE_EQUAL(sparse.element(i).input.size(), 15u);
+		for(std::size_t j = 0; j != 15; ++j){
+			double value = j < VectorSize? test_classification_values[i][j] : 0.0;
+			BOOST_CHECK_EQUAL(dense.element(i).input(j), value);
+			BOOST_CHECK_EQUAL(sparse.element(i).input(j), value);
+		}
+	}
+
+	//the highest index of the file is 11
+	std::stringstream smaller(test_classification);
+	BOOST_CHECK_THROW(import_libsvm(dense, smaller, 10), Exception);
+}
+
+BOOST_AUTO_TEST_CASE( Set_Libsvm_Import_File )
+{
+	//more lines than fit into a single batch
+	std::size_t const lines = 1000;
+	{
+		std::ofstream file("Set_Libsvm_Import_File.libsvm");
+		for(std::size_t i = 0; i != lines; ++i)
+			file << (i%3+1) << " " << (i%7+1) << ":" << 0.5*i << " 8:" << i << "\n";
+	}
+	LabeledData<RealVector,unsigned int> dense;
+	LabeledData<CompressedRealVector,unsigned int> sparse;
+	import_libsvm(dense, "Set_Libsvm_Import_File.libsvm");
+	import_libsvm(sparse, "Set_Libsvm_Import_File.libsvm");
+	std::remove("Set_Libsvm_Import_File.libsvm");
+
+	std::size_t batchSize = LabeledData<RealVector,unsigned int>::DefaultBatchSize;
+	BOOST_REQUIRE_EQUAL(dense.numberOfElements(), lines);
+	BOOST_REQUIRE_EQUAL(sparse.numberOfElements(), lines);
+	BOOST_REQUIRE_EQUAL(dense.numberOfBatches(), (lines+batchSize-1)/batchSize);
+	for(std::size_t b = 0; b+1 < dense.numberOfBatches(); ++b)
+		BOOST_CHECK_EQUAL(dense.batch(b).input.size1(), batchSize);
+	for(std::size_t i = 0; i != lines; ++i){
+		BOOST_REQUIRE_EQUAL(dense.element(i).input.size(), 8u);
+		BOOST_CHECK_EQUAL(dense.element(i).label, i%3);
+		BOOST_CHECK_EQUAL(sparse.element(i).label, i%3);
+		for(std::size_t j = 0; j != 7; ++j){
+			double value = (j == i%7)? 0.5*i : 0.0;
+			BOOST_CHECK_EQUAL(dense.element(i).input(j), value);
+			BOOST_CHECK_EQUAL(sparse.element(i).input(j), value);
+		}
+		BOOST_CHECK_EQUAL(dense.element(i).input(7), double(i));
+		BOOST_CHECK_EQUAL(sparse.element(i).input(7), double(i));
+	}
+
+	BOOST_CHECK_THROW(import_libsvm(dense, "Set_Libsvm_Import_File.libsvm"), Exception);
+}
@@ -0,0 +1,250 @@
+//===========================================================================
+/*!
+ *  \brief Benchmark of the level 2 and 3 BLAS operations.
+ *
+ *  Times the default kernels, which are used when Shark is compiled without an external BLAS,
+ *  the configured external BLAS (ATLAS or GotoBLAS) if there is one, and the plain uBLAS
+ *  implementations on the same problems. The results are checked against uBLAS and the program
+ *  returns a nonzero value if they differ. This is not a unit test and is not run by CTest.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#include <shark/LinAlg/Base.h>
+#include <shark/LinAlg/solveTriangular.h>
+#include <shark/LinAlg/BLAS/Impl/numeric_bindings/default/triangularKernel.h>
+#include <shark/Core/Timer.h>
+#include <shark/Rng/GlobalRng.h>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace shark;
+using namespace shark::blas::bindings::detail;
+
+namespace{
+//name of the external BLAS the bindings use, 0 if they use the default kernels
+#if defined(SHARK_USE_ATLAS)
+const char* externalBlas = "ATLAS";
+#elif defined(SHARK_USE_GOTOBLAS)
+const char* externalBlas = "GotoBLAS";
+#else
+const char* externalBlas = 0;
+#endif
+
+bool success = true;
+
+template<class Matrix>
+void fillRandom(Matrix& m){
+	for(std::size_t i = 0; i != m.size1(); ++i){
+		for(std::size_t j = 0; j != m.size2(); ++j){
+			m(i,j) = Rng::uni(-1,1);
+		}
+	}
+}
+RealVector createRandomVector(std::size_t n){
+	RealVector v(n);
+	for(std::size_t i = 0; i != n; ++i){
+		v(i) = Rng::uni(-1,1);
+	}
+	return v;
+}
+//well conditioned lower triangular matrix
+RealMatrix createLowerTriangular(std::size_t n){
+	RealMatrix A(n,n,0.0);
+	for(std::size_t i = 0; i != n; ++i){
+		for(std::size_t j = 0; j < i; ++j){
+			A(i,j) = Rng::uni(-1,1)/n;
+		}
+		A(i,i) = Rng::uni(1,2);
+	}
+	return A;
+}
+
+void printTime(std::string const& operation, std::string const& implementation, double flops, double time){
+	std::cout<<std::setw(12)<<operation<<std::setw(10)<<implementation
+		<<std::setw(12)<<time<<"s"<<std::setw(10)<<flops/time*1.e-9<<" GFlop/s"<<std::endl;
+}
+void checkResult(std::string const& operation, std::string const& implementation, double error){
+	if(!(error < 1.e-10)){
+		std::cout<<"error: "<<operation<<" "<<implementation<<" differs from uBLAS by "<<error<<std::endl;
+		success = false;
+	}
+}
+
+void benchmarkGemm(std::size_t n){
+	RealMatrix A(n,n);
+	RealMatrix B(n,n);
+	fillRandom(A);
+	fillRandom(B);
+	double flops = 2.0*n*n*n;
+
+	RealMatrix reference(n,n,0.0);
+	double start = Timer::now();
+	axpy_prod(A,B,reference);
+	printTime("gemm","uBLAS",flops,Timer::now()-start);
+
+	RealMatrix C(n,n,0.0);
+	start = Timer::now();
+	gemmBlocked<double>(n,n,n,1.0,&A(0,0),n,1,&B(0,0),n,1,&C(0,0),n,1);
+	printTime("gemm","default",flops,Timer::now()-start);
+	checkResult("gemm","default",norm_inf(C-reference)/n);
+
+	if(externalBlas){
+		C.clear();
+		start = Timer::now();
+		fast_prod(A,B,C);
+		printTime("gemm",externalBlas,flops,Timer::now()-start);
+		checkResult("gemm",externalBlas,norm_inf(C-reference)/n);
+	}
+}
+
+void benchmarkSyrk(std::size_t n, std::size_t k){
+	RealMatrix A(n,k);
+	fillRandom(A);
+	double flops = 1.0*n*n*k;
+
+	RealMatrix reference(n,n,0.0);
+	double start = Timer::now();
+	axpy_prod(A,trans(A),reference);
+	printTime("syrk","uBLAS",flops,Timer::now()-start);
+
+	//the kernel only computes the upper triangle
+	RealMatrix C(n,n,0.0);
+	start = Timer::now();
+	syrkBlocked<double>(n,k,1.0,&A(0,0),k,1,&C(0,0),n,1);
+	printTime("syrk","default",flops,Timer::now()-start);
+	for(std::size_t i = 0; i != n; ++i){
+		for(std::size_t j = 0; j < i; ++j){
+			C(i,j) = C(j,i);
+		}
+	}
+	checkResult("syrk","default",norm_inf(C-reference)/k);
+
+	if(externalBlas){
+		start = Timer::now();
+		symmRankKUpdate(A,C);
+		printTime("syrk",externalBlas,flops,Timer::now()-start);
+		checkResult("syrk",externalBlas,norm_inf(C-reference)/k);
+	}
+}
+
+template<class Orientation>
+void benchmarkGemv(std::string const& name, std::size_t n, std::size_t iterations){
+	blas::matrix<double,Orientation> A(n,n);
+	fillRandom(A);
+	RealVector x = createRandomVector(n);
+	double flops = 2.0*n*n*iterations;
+	//strides of the storage of A
+	std::ptrdiff_t stride1 = &A(1,0)-&A(0,0);
+	std::ptrdiff_t stride2 = &A(0,1)-&A(0,0);
+
+	RealVector reference(n);
+	double start = Timer::now();
+	for(std::size_t i = 0; i != iterations; ++i){
+		axpy_prod(A,x,reference);
+	}
+	printTime(name,"uBLAS",flops,Timer::now()-start);
+
+	RealVector y(n);
+	start = Timer::now();
+	for(std::size_t i = 0; i != iterations; ++i){
+		y.clear();
+		gemvStrided<double>(n,n,1.0,&A(0,0),stride1,stride2,&x(0),1,&y(0),1);
+	}
+	printTime(name,"default",flops,Timer::now()-start);
+	checkResult(name,"default",norm_inf(y-reference));
+
+	if(externalBlas){
+		start = Timer::now();
+		for(std::size_t i = 0; i != iterations; ++i){
+			fast_prod(A,x,y);
+		}
+		printTime(name,externalBlas,flops,Timer::now()-start);
+		checkResult(name,externalBlas,norm_inf(y-reference));
+	}
+}
+
+void benchmarkTrsv(std::size_t n, std::size_t iterations){
+	RealMatrix A = createLowerTriangular(n);
+	RealVector b = createRandomVector(n);
+	double flops = 1.0*n*n*iterations;
+
+	RealVector reference;
+	double start = Timer::now();
+	for(std::size_t i = 0; i != iterations; ++i){
+		reference = b;
+		blas::inplace_solve(A,reference,blas::lower_tag());
+	}
+	printTime("trsv","uBLAS",flops,Timer::now()-start);
+
+	RealVector x;
+	start = Timer::now();
+	for(std::size_t i = 0; i != iterations; ++i){
+		x = b;
+		trsvBlocked<double>(n,false,false,&A(0,0),n,1,&x(0),1);
+	}
+	printTime("trsv","default",flops,Timer::now()-start);
+	checkResult("trsv","default",norm_inf(x-reference));
+
+	if(externalBlas){
+		start = Timer::now();
+		for(std::size_t i = 0; i != iterations; ++i){
+			x = b;
+			blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Lower>(A,x);
+		}
+		printTime("trsv",externalBlas,flops,Timer::now()-start);
+		checkResult("trsv",externalBlas,norm_inf(x-reference));
+	}
+}
+
+void benchmarkTrsm(std::size_t n, std::size_t m){
+	RealMatrix A = createLowerTriangular(n);
+	RealMatrix B(n,m);
+	fillRandom(B);
+	double flops = 1.0*n*n*m;
+
+	RealMatrix reference = B;
+	double start = Timer::now();
+	blas::inplace_solve(A,reference,blas::lower_tag());
+	printTime("trsm","uBLAS",flops,Timer::now()-start);
+
+	RealMatrix X = B;
+	start = Timer::now();
+	trsmBlocked<double>(n,m,false,false,&A(0,0),n,1,&X(0,0),m,1);
+	printTime("trsm","default",flops,Timer::now()-start);
+	checkResult("trsm","default",norm_inf(X-reference));
+
+	if(externalBlas){
+		X = B;
+		start = Timer::now();
+		blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Lower>(A,X);
+		printTime("trsm",externalBlas,flops,Timer::now()-start);
+		checkResult("trsm",externalBlas,norm_inf(X-reference));
+	}
+}
+}
+
+int main(){
+	std::cout<<"external BLAS: "<<(externalBlas? externalBlas : "none")<<std::endl;
+	benchmarkGemm(500);
+	benchmarkSyrk(500,300);
+	benchmarkGemv<blas::row_major>("gemv row",1000,100);
+	benchmarkGemv<blas::column_major>("gemv column",1000,100);
+	benchmarkTrsv(1000,100);
+	benchmarkTrsm(500,300);
+	return success? 0 : 1;
+}
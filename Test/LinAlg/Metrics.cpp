@@ -275,3 +275,53 @@ BOOST_AUTO_TEST_CASE( LinAlg_Norm_distanceSqr_Matrix_Matrix){
 }
 
 
+
+BOOST_AUTO_TEST_CASE( LinAlg_Norm_distanceSqr_Matrix_Matrix_Sparse_Dense){
+	std::size_t const dim = 50;
+	CompressedRealMatrix sparse(40,dim);
+	RealMatrix dense(30,dim);
+	for(std::size_t i = 0; i != 40; ++i){
+		//leave some rows empty
+		if(i % 5 == 0) continue;
+		for(std::size_t j = 0; j != dim; ++j){
+			if(Rng::coinToss(0.1))
+				sparse(i,j) = Rng::uni(-1,1);
+		}
+	}
+	for(std::size_t i = 0; i != 30; ++i){
+		for(std::size_t j = 0; j != dim; ++j){
+			dense(i,j) = Rng::uni(-1,1);
+		}
+	}
+	RealMatrix result1 = distanceSqr(sparse,dense);
+	RealMatrix result2 = distanceSqr(dense,sparse);
+	BOOST_REQUIRE_EQUAL(result1.size1(), 40);
+	BOOST_REQUIRE_EQUAL(result1.size2(), 30);
+	BOOST_REQUIRE_EQUAL(result2.size1(), 30);
+	BOOST_REQUIRE_EQUAL(result2.size2(), 40);
+	for(std::size_t i = 0; i != 40; ++i){
+		RealVector x = row(sparse,i);
+		for(std::size_t j = 0; j != 30; ++j){
+			double d = distanceSqr(x,row(dense,j));
+			BOOST_CHECK_CLOSE(result1(i,j),d,1.e-10);
+			BOOST_CHECK_CLOSE(result2(j,i),d,1.e-10);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( LinAlg_Norm_distanceSqr_Matrix_Matrix_Nonnegative){
+	//equal points with a large norm: a^2 -2ab + b^2 must not become negative
+	RealMatrix mat(20,10);
+	for(std::size_t j = 0; j != 10; ++j){
+		double value = 1.e4*Rng::uni(-1,1);
+		for(std::size_t i = 0; i != 20; ++i){
+			mat(i,j) = value + Rng::uni(-1.e-6,1.e-6);
+		}
+	}
+	RealMatrix result = distanceSqr(mat,mat);
+	for(std::size_t i = 0; i != 20; ++i){
+		for(std::size_t j = 0; j != 20; ++j){
+			BOOST_CHECK(result(i,j) >= 0);
+		}
+	}
+}
@@ -95,6 +95,58 @@ BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_matrix_nonsquare ){
 	BOOST_CHECK_SMALL(error,1.e-10);
 	
 }
+//sizes which are not multiples of the block sizes and large enough to use several blocks
+BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_matrix_blocked ){
+	std::size_t m = 263, k = 301, n = 137;
+	RealMatrix A(m,k);
+	RealMatrix B(k,n);
+	for(std::size_t i = 0; i != m; ++i)
+		for(std::size_t j = 0; j != k; ++j)
+			A(i,j) = Rng::uni(-1,1);
+	for(std::size_t i = 0; i != k; ++i)
+		for(std::size_t j = 0; j != n; ++j)
+			B(i,j) = Rng::uni(-1,1);
+	RealMatrix ATrans = trans(A);
+	RealMatrix BTrans = trans(B);
+
+	RealMatrix C(m,n);
+	axpy_prod(A,B,C,true);
+
+	RealMatrix testC(m,n,1.0);
+	fast_prod(A,B,testC,true,2.0);
+	BOOST_CHECK_SMALL(norm_inf(2*C+RealMatrix(m,n,1.0)-testC),1.e-10);
+
+	testC.clear();
+	fast_prod(trans(ATrans),trans(BTrans),testC);
+	BOOST_CHECK_SMALL(norm_inf(C-testC),1.e-10);
+
+	//sub matrices with a leading dimension larger than their size
+	RealMatrix bigC(m+3,n+5,0.0);
+	fast_prod(subrange(A,1,m,2,k),subrange(B,2,k,0,n-1),subrange(bigC,1,m,3,n+2));
+	RealMatrix subC(m-1,n-1);
+	axpy_prod(subrange(A,1,m,2,k),subrange(B,2,k,0,n-1),subC,true);
+	BOOST_CHECK_SMALL(norm_inf(subC-subrange(bigC,1,m,3,n+2)),1.e-10);
+	BOOST_CHECK_SMALL(norm_inf(subrange(bigC,0,1,0,n+5)),1.e-15);
+}
+//several column blocks of the blocked syrk
+BOOST_AUTO_TEST_CASE( LinAlg_symmRankKUpdate_blocked ){
+	std::size_t n = 301, k = 157;
+	RealMatrix A(n,k);
+	for(std::size_t i = 0; i != n; ++i)
+		for(std::size_t j = 0; j != k; ++j)
+			A(i,j) = Rng::uni(-1,1);
+	RealMatrix reference(n,n);
+	axpy_prod(A,trans(A),reference,true);
+
+	RealMatrix C(n,n,1.0);
+	symmRankKUpdate(A,C,true,2.0);
+	BOOST_CHECK_SMALL(norm_inf(2*reference+RealMatrix(n,n,1.0)-C),1.e-10);
+
+	C.clear();
+	symmRankKUpdate(A,C);
+	BOOST_CHECK_SMALL(norm_inf(reference-C),1.e-10);
+}
+
 BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_matrix_sparse ){
 	CompressedRealMatrix A(10,10);
 	CompressedRealMatrix B(10,10);
@@ -182,6 +234,40 @@ BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_vector ){
 	BOOST_CHECK_SMALL(error,1.e-10);
 	
 }
+//sizes which are not multiples of the four rows or columns processed at once
+BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_vector_blocked ){
+	std::size_t m = 203, n = 157;
+	blas::matrix<double,blas::row_major> rowA(m,n);
+	blas::matrix<double,blas::column_major> columnA(m,n);
+	for(std::size_t i = 0; i != m; ++i)
+		for(std::size_t j = 0; j != n; ++j)
+			rowA(i,j) = Rng::uni(-1,1);
+	noalias(columnA) = rowA;
+	RealVector x(n);
+	for(std::size_t j = 0; j != n; ++j)
+		x(j) = Rng::uni(-1,1);
+	RealVector reference(m);
+	axpy_prod(rowA,x,reference);
+
+	RealVector y(m);
+	fast_prod(rowA,x,y);
+	BOOST_CHECK_SMALL(norm_inf(y-reference),1.e-12);
+	y.clear();
+	fast_prod(columnA,x,y);
+	BOOST_CHECK_SMALL(norm_inf(y-reference),1.e-12);
+
+	//transposed and with a result which is not contiguous
+	RealVector z(m);
+	for(std::size_t i = 0; i != m; ++i)
+		z(i) = Rng::uni(-1,1);
+	RealVector transReference(n);
+	axpy_prod(trans(rowA),z,transReference);
+	RealMatrix result(n,2,0.0);
+	fast_prod(trans(columnA),z,column(result,1));
+	BOOST_CHECK_SMALL(norm_inf(column(result,1)-transReference),1.e-12);
+	BOOST_CHECK_SMALL(norm_inf(column(result,0)),1.e-15);
+}
+
 BOOST_AUTO_TEST_CASE( LinAlg_fast_prod_matrix_vector_non_square ){
 	RealMatrix A(5,10);
 	RealVector b(10);
@@ -281,6 +281,74 @@ BOOST_AUTO_TEST_CASE( LinAlg_Solve_TriangularInPlace_Calls_Vector ){
 	}
 }
 
+//well conditioned lower triangular matrix
+RealMatrix createRandomLowerTriangular(std::size_t n){
+	RealMatrix A(n,n,0.0);
+	for(std::size_t i = 0; i != n; ++i){
+		for(std::size_t j = 0; j < i; ++j){
+			A(i,j) = Rng::uni(-1,1)/n;
+		}
+		A(i,i) = Rng::uni(1,2);
+	}
+	return A;
+}
+
+//systems which are large enough to be solved in several blocks
+BOOST_AUTO_TEST_CASE( LinAlg_Solve_TriangularInPlace_Blocked_Vector ){
+	std::size_t n = 157;
+	RealMatrix A = createRandomLowerTriangular(n);
+	RealMatrix U = trans(A);
+	RealMatrix unitA = A;
+	for(std::size_t i = 0; i != n; ++i) unitA(i,i) = 1.0;
+	RealVector b(n);
+	for(std::size_t i = 0; i != n; ++i){
+		b(i) = Rng::uni(-1,1);
+	}
+
+	RealVector x = b;
+	blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Lower>(A,x);
+	BOOST_CHECK_SMALL(norm_inf(prod(A,x)-b),1.e-10);
+	x = b;
+	blas::solveTriangularSystemInPlace<blas::SolveXAB,blas::Lower>(A,x);
+	BOOST_CHECK_SMALL(norm_inf(prod(x,A)-b),1.e-10);
+	x = b;
+	blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Upper>(U,x);
+	BOOST_CHECK_SMALL(norm_inf(prod(U,x)-b),1.e-10);
+	x = b;
+	blas::solveTriangularSystemInPlace<blas::SolveXAB,blas::Upper>(U,x);
+	BOOST_CHECK_SMALL(norm_inf(prod(x,U)-b),1.e-10);
+	x = b;
+	blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::UnitLower>(A,x);
+	BOOST_CHECK_SMALL(norm_inf(prod(unitA,x)-b),1.e-10);
+}
+
+BOOST_AUTO_TEST_CASE( LinAlg_Solve_TriangularInPlace_Blocked_Matrix ){
+	std::size_t n = 157;
+	std::size_t m = 71;
+	RealMatrix A = createRandomLowerTriangular(n);
+	RealMatrix U = trans(A);
+	RealMatrix B(n,m);
+	for(std::size_t i = 0; i != n; ++i){
+		for(std::size_t j = 0; j != m; ++j){
+			B(i,j) = Rng::uni(-1,1);
+		}
+	}
+	RealMatrix transB = trans(B);
+
+	RealMatrix X = B;
+	blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Lower>(A,X);
+	BOOST_CHECK_SMALL(norm_inf(prod(A,X)-B),1.e-10);
+	X = B;
+	blas::solveTriangularSystemInPlace<blas::SolveAXB,blas::Upper>(U,X);
+	BOOST_CHECK_SMALL(norm_inf(prod(U,X)-B),1.e-10);
+	X = transB;
+	blas::solveTriangularSystemInPlace<blas::SolveXAB,blas::Lower>(A,X);
+	BOOST_CHECK_SMALL(norm_inf(prod(X,A)-transB),1.e-10);
+	X = transB;
+	blas::solveTriangularSystemInPlace<blas::SolveXAB,blas::Upper>(U,X);
+	BOOST_CHECK_SMALL(norm_inf(prod(X,U)-transB),1.e-10);
+}
+
 //for the remaining functions, we can use random systems and check, whether they are okay
 
 RealMatrix createRandomInvertibleMatrix(std::size_t Dimensions,double lambdaMin, double lambdaMax){
@@ -96,3 +96,46 @@ BOOST_AUTO_TEST_CASE( CART_Classifier ) {
 	BOOST_CHECK(error == 0.0);
 
 }
+
+BOOST_AUTO_TEST_CASE( CART_Regression ) {
+	//a step function with three levels is reproduced exactly by a tree
+	std::vector<RealVector> input(30, RealVector(2));
+	std::vector<RealVector> target(30, RealVector(1));
+	for(std::size_t i = 0; i != 30; ++i){
+		input[i](0) = i;
+		input[i](1) = (i*7)%30;
+		target[i](0) = (i < 10)? -1.0 : (i < 20)? 2.0: 5.0;
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(input, target);
+
+	CARTTrainer trainer;
+	CARTClassifier<RealVector> model;
+	trainer.train(model, dataset);
+
+	Data<RealVector> prediction = model(dataset.inputs());
+	for(std::size_t i = 0; i != 30; ++i){
+		BOOST_CHECK_SMALL(prediction.element(i)(0) - target[i](0), 1.e-10);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( CART_Regression_Histogram ) {
+	//with at least as many bins as distinct values the histogram search is exact
+	std::vector<RealVector> input(30, RealVector(2));
+	std::vector<RealVector> target(30, RealVector(1));
+	for(std::size_t i = 0; i != 30; ++i){
+		input[i](0) = i;
+		input[i](1) = (i*7)%30;
+		target[i](0) = (i < 10)? -1.0 : (i < 20)? 2.0: 5.0;
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(input, target);
+
+	CARTTrainer trainer;
+	trainer.setHistogramBins(32);
+	CARTClassifier<RealVector> model;
+	trainer.train(model, dataset);
+
+	Data<RealVector> prediction = model(dataset.inputs());
+	for(std::size_t i = 0; i != 30; ++i){
+		BOOST_CHECK_SMALL(prediction.element(i)(0) - target[i](0), 1.e-10);
+	}
+}
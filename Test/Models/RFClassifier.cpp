@@ -42,6 +42,10 @@
 #include <shark/Algorithms/Trainers/RFTrainer.h>
 #include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
 
+#include <boost/archive/polymorphic_text_iarchive.hpp>
+#include <boost/archive/polymorphic_text_oarchive.hpp>
+#include <sstream>
+
 using namespace shark;
 
 BOOST_AUTO_TEST_CASE( RF_Classifier ) {
@@ -96,3 +100,263 @@ BOOST_AUTO_TEST_CASE( RF_Classifier ) {
 	BOOST_CHECK(error == 0.0);
 
 }
+
+BOOST_AUTO_TEST_CASE( RF_Classifier_Reproducible ) {
+	//Test data
+	std::vector<RealVector> input(20, RealVector(2));
+	std::vector<unsigned int> target(20);
+	for(std::size_t i = 0; i != 20; ++i){
+		input[i](0) = Rng::uni(-1,1);
+		input[i](1) = Rng::uni(-1,1);
+		target[i] = input[i](0)+input[i](1) > 0;
+	}
+	ClassificationDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setNTrees(20);
+	RFClassifier model1, model2;
+
+	//the same seed must lead to the same forest, regardless of the number of threads used
+#ifdef SHARK_USE_OPENMP
+	int maxThreads = omp_get_max_threads();
+	omp_set_num_threads(1);
+#endif
+	Rng::seed(42);
+	trainer.train(model1, dataset);
+#ifdef SHARK_USE_OPENMP
+	omp_set_num_threads(4);
+#endif
+	Rng::seed(42);
+	trainer.train(model2, dataset);
+#ifdef SHARK_USE_OPENMP
+	omp_set_num_threads(maxThreads);
+#endif
+
+	std::ostringstream forest1, forest2;
+	{
+		boost::archive::polymorphic_text_oarchive oa1(forest1);
+		oa1 << model1;
+		boost::archive::polymorphic_text_oarchive oa2(forest2);
+		oa2 << model2;
+	}
+	BOOST_CHECK(forest1.str() == forest2.str());
+
+	Data<RealVector> prediction1 = model1(dataset.inputs());
+	Data<RealVector> prediction2 = model2(dataset.inputs());
+	for(std::size_t i = 0; i != 20; ++i){
+		for(std::size_t j = 0; j != 2; ++j){
+			BOOST_CHECK_EQUAL(prediction1.element(i)(j), prediction2.element(i)(j));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( RF_Regression ) {
+	//a forest approximates a linear function on the training data
+	std::vector<RealVector> input(100, RealVector(2));
+	std::vector<RealVector> target(100, RealVector(1));
+	for(std::size_t i = 0; i != 100; ++i){
+		input[i](0) = Rng::uni(-1,1);
+		input[i](1) = Rng::uni(-1,1);
+		target[i](0) = 2*input[i](0);
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setMTry(2);
+	trainer.setNodeSize(2);
+	RFClassifier model;
+	trainer.train(model, dataset);
+
+	Data<RealVector> prediction = model(dataset.inputs());
+	double error = 0;
+	for(std::size_t i = 0; i != 100; ++i){
+		error += sqr(prediction.element(i)(0) - target[i](0));
+	}
+	BOOST_CHECK_SMALL(error/100, 0.05);
+}
+
+BOOST_AUTO_TEST_CASE( RF_Histogram ) {
+	//trees grown on quantized attributes still separate a simple problem
+	std::vector<RealVector> input(200, RealVector(3));
+	std::vector<unsigned int> classTarget(200);
+	std::vector<RealVector> regressionTarget(200, RealVector(1));
+	for(std::size_t i = 0; i != 200; ++i){
+		for(std::size_t j = 0; j != 3; ++j)
+			input[i](j) = Rng::uni(-1,1);
+		classTarget[i] = input[i](0) > 0.25;
+		regressionTarget[i](0) = input[i](0) > 0.25 ? 1.0 : -1.0;
+	}
+
+	RFTrainer trainer;
+	trainer.setNTrees(20);
+	trainer.setHistogramBins(32);
+
+	ClassificationDataset classification = createLabeledDataFromRange(input, classTarget);
+	RFClassifier classifier;
+	trainer.train(classifier, classification);
+	ZeroOneLoss<unsigned int, RealVector> loss;
+	BOOST_CHECK_SMALL(loss.eval(classification.labels(), classifier(classification.inputs())), 0.05);
+
+	RegressionDataset regression = createLabeledDataFromRange(input, regressionTarget);
+	RFClassifier regressor;
+	trainer.train(regressor, regression);
+	Data<RealVector> prediction = regressor(regression.inputs());
+	double error = 0;
+	for(std::size_t i = 0; i != 200; ++i){
+		error += sqr(prediction.element(i)(0) - regressionTarget[i](0));
+	}
+	BOOST_CHECK_SMALL(error/200, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE( RF_Serialization ) {
+	std::vector<RealVector> input(50, RealVector(3));
+	std::vector<unsigned int> target(50);
+	for(std::size_t i = 0; i != 50; ++i){
+		for(std::size_t j = 0; j != 3; ++j)
+			input[i](j) = Rng::uni(-1,1);
+		target[i] = (input[i](0) > 0) + (input[i](1) > 0);
+	}
+	ClassificationDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setNTrees(10);
+	RFClassifier model;
+	trainer.train(model, dataset);
+
+	//the compiled forest of the loaded model must give the same predictions
+	std::ostringstream outputStream;
+	{
+		boost::archive::polymorphic_text_oarchive oa(outputStream);
+		oa << model;
+	}
+	RFClassifier loaded;
+	std::istringstream inputStream(outputStream.str());
+	boost::archive::polymorphic_text_iarchive ia(inputStream);
+	ia >> loaded;
+
+	Data<RealVector> prediction = model(dataset.inputs());
+	Data<RealVector> loadedPrediction = loaded(dataset.inputs());
+	for(std::size_t i = 0; i != 50; ++i){
+		RealVector p = prediction.element(i);
+		BOOST_REQUIRE_EQUAL(p.size(), 3u);
+		BOOST_CHECK_SMALL(norm_inf(p - loadedPrediction.element(i)), 1.e-12);
+		BOOST_CHECK_SMALL(sum(p) - 1.0, 1.e-12);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( RF_OOB_Error_And_Importance ) {
+	//only the first attribute carries information about the label
+	std::vector<RealVector> input(300, RealVector(3));
+	std::vector<unsigned int> target(300);
+	for(std::size_t i = 0; i != 300; ++i){
+		for(std::size_t j = 0; j != 3; ++j)
+			input[i](j) = Rng::uni(-1,1);
+		target[i] = input[i](0) > 0;
+	}
+	ClassificationDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setNTrees(30);
+	trainer.setMTry(3);
+	trainer.setComputeFeatureImportances(true);
+	RFClassifier model;
+	trainer.train(model, dataset);
+
+	BOOST_CHECK_SMALL(model.OOBerror(), 0.1);
+	RealVector const& importances = model.featureImportances();
+	BOOST_REQUIRE_EQUAL(importances.size(), 3u);
+	BOOST_CHECK_GT(importances(0), 0.2);
+	BOOST_CHECK_GT(importances(0), 10*std::abs(importances(1)));
+	BOOST_CHECK_GT(importances(0), 10*std::abs(importances(2)));
+}
+
+#ifdef SHARK_USE_OPENMP
+BOOST_AUTO_TEST_CASE( RF_OOB_Thread_Count ) {
+	//the out-of-bag statistics are summed in the order of the trees, independent of the threads
+	std::vector<RealVector> input(100, RealVector(3));
+	std::vector<RealVector> target(100, RealVector(1));
+	for(std::size_t i = 0; i != 100; ++i){
+		for(std::size_t j = 0; j != 3; ++j)
+			input[i](j) = Rng::uni(-1,1);
+		target[i](0) = input[i](0) + 0.1*Rng::gauss();
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setNTrees(40);
+	trainer.setComputeFeatureImportances(true);
+	int maxThreads = omp_get_max_threads();
+	RFClassifier models[2];
+	int threads[2] = {1,4};
+	for(std::size_t t = 0; t != 2; ++t){
+		omp_set_num_threads(threads[t]);
+		Rng::seed(42);
+		trainer.train(models[t], dataset);
+	}
+	omp_set_num_threads(maxThreads);
+
+	BOOST_CHECK_EQUAL(models[0].OOBerror(), models[1].OOBerror());
+	BOOST_REQUIRE_EQUAL(models[0].featureImportances().size(), 3u);
+	BOOST_REQUIRE_EQUAL(models[1].featureImportances().size(), 3u);
+	for(std::size_t j = 0; j != 3; ++j)
+		BOOST_CHECK_EQUAL(models[0].featureImportances()(j), models[1].featureImportances()(j));
+}
+#endif
+
+BOOST_AUTO_TEST_CASE( RF_Bootstrap ) {
+	//trees grown on bootstrap samples with replacement, with exact and histogram split search
+	std::vector<RealVector> input(200, RealVector(2));
+	std::vector<unsigned int> classTarget(200);
+	std::vector<RealVector> regressionTarget(200, RealVector(1));
+	for(std::size_t i = 0; i != 200; ++i){
+		input[i](0) = Rng::uni(-1,1);
+		input[i](1) = Rng::uni(-1,1);
+		classTarget[i] = input[i](0) + input[i](1) > 0;
+		regressionTarget[i](0) = 2*input[i](0);
+	}
+	ClassificationDataset classification = createLabeledDataFromRange(input, classTarget);
+	RegressionDataset regression = createLabeledDataFromRange(input, regressionTarget);
+
+	for(std::size_t bins = 0; bins <= 64; bins += 64){
+		RFTrainer trainer;
+		trainer.setNTrees(30);
+		trainer.setSampleWithReplacement(true);
+		trainer.setHistogramBins(bins);
+
+		RFClassifier classifier;
+		trainer.train(classifier, classification);
+		ZeroOneLoss<unsigned int, RealVector> loss;
+		BOOST_CHECK_SMALL(loss.eval(classification.labels(), classifier(classification.inputs())), 0.05);
+		BOOST_CHECK_SMALL(classifier.OOBerror(), 0.2);
+
+		RFClassifier regressor;
+		trainer.train(regressor, regression);
+		BOOST_CHECK_SMALL(regressor.OOBerror(), 0.1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( RF_Tied_Values ) {
+	//the splits lie between different values of an attribute, every tree grown on all
+	//elements with single element leaves reproduces a function of the attribute exactly
+	std::vector<RealVector> input(100, RealVector(2));
+	std::vector<RealVector> target(100, RealVector(1));
+	for(std::size_t i = 0; i != 100; ++i){
+		input[i](0) = double(i % 7);
+		input[i](1) = Rng::uni(-1,1);
+		target[i](0) = sqr(input[i](0));
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(input, target);
+
+	RFTrainer trainer;
+	trainer.setNTrees(10);
+	trainer.setMTry(2);
+	trainer.setNodeSize(1);
+	trainer.setOOBratio(1.0);
+	RFClassifier model;
+	trainer.train(model, dataset);
+
+	Data<RealVector> prediction = model(dataset.inputs());
+	for(std::size_t i = 0; i != 100; ++i){
+		BOOST_CHECK_SMALL(prediction.element(i)(0) - target[i](0), 1.e-12);
+	}
+}
@@ -90,3 +90,139 @@ BOOST_AUTO_TEST_CASE( ObjectiveFunctions_CrossValidation )
 
 	BOOST_CHECK_LT(std::abs(cve - 5.0 / 3.0), 1e-12);
 }
+
+// Training the folds concurrently with copies of model and
+// trainer must give exactly the result of the sequential loop.
+BOOST_AUTO_TEST_CASE( ObjectiveFunctions_CrossValidation_Workers )
+{
+	std::vector<RealVector> data(50, RealVector(2));
+	std::vector<RealVector> target(50, RealVector(1));
+	for (std::size_t i=0; i<50; i++)
+	{
+		data[i](0) = Rng::gauss();
+		data[i](1) = Rng::gauss();
+		target[i](0) = 2.0 * data[i](0) - data[i](1) + 0.1 * Rng::gauss();
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(data, target, 10);
+	CVFolds<RegressionDataset> folds = createCVSameSize(dataset, 5);
+
+	LinearModel<> lin(2, 1, true);
+	LinearRegression trainer;
+	AbsoluteLoss<> loss;
+	CrossValidationError<LinearModel<> > cvError(folds, &trainer, &lin, &trainer, &loss);
+	BOOST_CHECK_EQUAL(cvError.numberOfWorkers(), 1u);
+
+	LinearModel<> lin1(2, 1, true);
+	LinearModel<> lin2(2, 1, true);
+	LinearRegression trainer1;
+	LinearRegression trainer2;
+	CrossValidationError<LinearModel<> > parallelError(folds, &trainer, &lin, &trainer, &loss);
+	parallelError.addWorker(&trainer1, &lin1, &trainer1);
+	parallelError.addWorker(&trainer2, &lin2, &trainer2);
+	BOOST_CHECK_EQUAL(parallelError.numberOfWorkers(), 3u);
+
+	for (std::size_t t=0; t<3; t++)
+	{
+		RealVector param(1);
+		param(0) = 0.5 * t;
+		double sequential = cvError.eval(param);
+		double concurrent = parallelError.eval(param);
+		BOOST_CHECK_EQUAL(sequential, concurrent);
+	}
+}
+
+// Concurrent evaluations of several points, e.g. the offspring of a CMA,
+// use one set of objects each and give the sequential results.
+BOOST_AUTO_TEST_CASE( ObjectiveFunctions_CrossValidation_Concurrent_Points )
+{
+	std::vector<RealVector> data(50, RealVector(2));
+	std::vector<RealVector> target(50, RealVector(1));
+	for (std::size_t i=0; i<50; i++)
+	{
+		data[i](0) = Rng::gauss();
+		data[i](1) = Rng::gauss();
+		target[i](0) = 2.0 * data[i](0) - data[i](1) + 0.1 * Rng::gauss();
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(data, target, 10);
+	CVFolds<RegressionDataset> folds = createCVSameSize(dataset, 5);
+
+#ifdef SHARK_USE_OPENMP
+	int maxThreads = omp_get_max_threads();
+	omp_set_num_threads(3);
+#endif
+	LinearModel<> lin(2, 1, true);
+	LinearRegression trainer;
+	AbsoluteLoss<> loss;
+	CrossValidationError<LinearModel<> > cvError(folds, &trainer, &lin, &trainer, &loss);
+
+	LinearModel<> lin1(2, 1, true);
+	LinearModel<> lin2(2, 1, true);
+	LinearRegression trainer1;
+	LinearRegression trainer2;
+	CrossValidationError<LinearModel<> > parallelError(folds, &trainer, &lin, &trainer, &loss);
+	parallelError.addWorker(&trainer1, &lin1, &trainer1);
+#ifdef SHARK_USE_OPENMP
+	//two sets of objects are not enough for three threads
+	BOOST_CHECK(!parallelError.isThreadSafe());
+#endif
+	parallelError.addWorker(&trainer2, &lin2, &trainer2);
+	BOOST_CHECK(parallelError.isThreadSafe());
+
+	std::size_t points = 12;
+	std::vector<double> concurrent(points);
+	SHARK_PARALLEL_FOR(int i = 0; i < (int)points; ++i)
+	{
+		RealVector param(1);
+		param(0) = 0.25 * i;
+		concurrent[i] = parallelError.eval(param);
+	}
+	for (std::size_t i=0; i<points; i++)
+	{
+		RealVector param(1);
+		param(0) = 0.25 * i;
+		BOOST_CHECK_EQUAL(cvError.eval(param), concurrent[i]);
+	}
+	BOOST_CHECK_EQUAL(parallelError.evaluationCounter(), points);
+#ifdef SHARK_USE_OPENMP
+	//the thread safety follows the number of threads
+	omp_set_num_threads(4);
+	BOOST_CHECK(!parallelError.isThreadSafe());
+	omp_set_num_threads(maxThreads);
+#endif
+}
+
+namespace{
+class FailingLinearRegression : public LinearRegression{
+public:
+	void train(LinearModel<>& model, LabeledData<RealVector, RealVector> const& dataset){
+		throw SHARKEXCEPTION("[FailingLinearRegression::train] training failed");
+	}
+};
+}
+
+// An exception of a worker is passed on to the caller of eval.
+BOOST_AUTO_TEST_CASE( ObjectiveFunctions_CrossValidation_Failing_Worker )
+{
+	std::vector<RealVector> data(50, RealVector(2));
+	std::vector<RealVector> target(50, RealVector(1));
+	for (std::size_t i=0; i<50; i++)
+	{
+		data[i](0) = Rng::gauss();
+		data[i](1) = Rng::gauss();
+		target[i](0) = 2.0 * data[i](0) - data[i](1) + 0.1 * Rng::gauss();
+	}
+	RegressionDataset dataset = createLabeledDataFromRange(data, target, 10);
+	CVFolds<RegressionDataset> folds = createCVSameSize(dataset, 5);
+
+	LinearModel<> lin(2, 1, true);
+	LinearRegression trainer;
+	AbsoluteLoss<> loss;
+	LinearModel<> lin1(2, 1, true);
+	FailingLinearRegression trainer1;
+	CrossValidationError<LinearModel<> > parallelError(folds, &trainer, &lin, &trainer, &loss);
+	parallelError.addWorker(&trainer1, &lin1, &trainer1);
+
+	RealVector param(1);
+	param(0) = 0.5;
+	BOOST_CHECK_THROW(parallelError.eval(param), Exception);
+}
@@ -219,4 +219,69 @@ BOOST_AUTO_TEST_CASE( ML_ErrorFunction_LinearRegression ){
 	}
 	
 	
-}
\ No newline at end of file
+}
+//the parallel implementation must compute the same error and derivative as the sequential one,
+//also when the batches differ in size and there are more batches than threads
+BOOST_AUTO_TEST_CASE( ML_ErrorFunction_Parallel_Uneven_Batches )
+{
+	std::size_t examples = 103;
+	std::vector<RealVector> input(examples,RealVector(3));
+	std::vector<RealVector> target(examples,RealVector(2));
+	for (std::size_t i=0;i!=examples;++i) {
+		for(std::size_t j = 0; j != 3; ++j)
+			input[i](j) = Rng::uni(-1,1);
+		for(std::size_t j = 0; j != 2; ++j)
+			target[i](j) = Rng::uni(-1,1);
+	}
+	LabeledData<RealVector,RealVector> dataset = createLabeledDataFromRange(input,target,7);
+
+	LinearModel<> model(3,2,true);
+	SquaredLoss<> loss;
+	RealVector point(model.numberOfParameters());
+	for(std::size_t i = 0; i != point.size(); ++i)
+		point(i) = Rng::gauss(0,1);
+
+	detail::LossBasedErrorFunctionImpl<RealVector,RealVector,RealVector> sequential(&model,&loss);
+	detail::ParallelLossBasedErrorFunctionImpl<RealVector,RealVector,RealVector> parallel(&model,&loss);
+	sequential.setDataset(dataset);
+	parallel.setDataset(dataset);
+
+	BOOST_CHECK_CLOSE(sequential.eval(point),parallel.eval(point),1.e-10);
+	//evaluate twice to check that the buffers are reset between calls
+	for(std::size_t trial = 0; trial != 2; ++trial){
+		RealVector sequentialDerivative;
+		RealVector parallelDerivative;
+		double sequentialError = sequential.evalDerivative(point,sequentialDerivative);
+		double parallelError = parallel.evalDerivative(point,parallelDerivative);
+		BOOST_CHECK_CLOSE(sequentialError,parallelError,1.e-10);
+		BOOST_REQUIRE_EQUAL(sequentialDerivative.size(),parallelDerivative.size());
+		BOOST_CHECK_SMALL(norm_inf(sequentialDerivative-parallelDerivative),1.e-12);
+	}
+
+#ifdef SHARK_USE_OPENMP
+	//the blocks depend on the number of threads, but not the dynamic schedule:
+	//repeated evaluations with the same number of threads are identical
+	int maxThreads = omp_get_max_threads();
+	for(int threads = 1; threads <= 8; threads *= 2){
+		omp_set_num_threads(threads);
+		RealVector sequentialDerivative;
+		double sequentialError = sequential.evalDerivative(point,sequentialDerivative);
+		RealVector firstDerivative;
+		double firstError = parallel.evalDerivative(point,firstDerivative);
+		for(std::size_t trial = 0; trial != 5; ++trial){
+			RealVector derivative;
+			double error = parallel.evalDerivative(point,derivative);
+			BOOST_CHECK_EQUAL(error,firstError);
+			BOOST_CHECK_EQUAL(norm_inf(derivative-firstDerivative),0.0);
+		}
+		BOOST_CHECK_CLOSE(sequentialError,firstError,1.e-10);
+		BOOST_CHECK_SMALL(norm_inf(sequentialDerivative-firstDerivative),1.e-12);
+	}
+	omp_set_num_threads(maxThreads);
+#endif
+
+	//an empty dataset is rejected instead of reading the buffer of a non-existing block
+	parallel.setDataset(LabeledData<RealVector,RealVector>());
+	RealVector derivative;
+	BOOST_CHECK_THROW(parallel.evalDerivative(point,derivative),Exception);
+}
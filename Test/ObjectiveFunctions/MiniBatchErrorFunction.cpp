@@ -0,0 +1,128 @@
+#include <shark/Algorithms/GradientDescent/Adam.h>
+#include <shark/ObjectiveFunctions/MiniBatchErrorFunction.h>
+#include <shark/ObjectiveFunctions/Loss/SquaredLoss.h>
+#include <shark/Models/LinearModel.h>
+#include <shark/Rng/GlobalRng.h>
+
+#define BOOST_TEST_MODULE ML_MiniBatchErrorFunction
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace shark;
+using namespace std;
+
+//every element is used exactly once per epoch, the labels identify the elements.
+//103 elements in batches of 10 end every epoch with a batch of 3 elements
+BOOST_AUTO_TEST_CASE( BatchPrefetcher_Epochs )
+{
+	std::size_t const elements = 103;
+	std::vector<RealVector> data(elements,RealVector(2));
+	std::vector<unsigned int> labels(elements);
+	for (size_t i=0; i!=elements; i++){
+		data[i](0) = Rng::uni(-1,1);
+		data[i](1) = Rng::uni(-1,1);
+		labels[i] = i;
+	}
+	ClassificationDataset dataset = createLabeledDataFromRange(data,labels);
+
+	BatchPrefetcher<ClassificationDataset> prefetcher(dataset,10,3);
+	for(size_t epoch = 0; epoch != 3; ++epoch){
+		std::vector<size_t> count(elements,0);
+		for(size_t batch = 0; batch != 11; ++batch){
+			ClassificationDataset next = prefetcher.next();
+			size_t batchSize = batch == 10 ? 3 : 10;
+			BOOST_REQUIRE_EQUAL(next.numberOfElements(),batchSize);
+			BOOST_CHECK_EQUAL(next.numberOfBatches(),3u);
+			for(size_t i = 0; i != batchSize; ++i){
+				unsigned int label = next.element(i).label;
+				BOOST_CHECK_EQUAL(next.element(i).input(0),data[label](0));
+				++count[label];
+			}
+		}
+		for(size_t i = 0; i != elements; ++i)
+			BOOST_CHECK_EQUAL(count[i],1u);
+	}
+}
+
+//without shuffling the batches follow the order of the dataset, including the last elements
+BOOST_AUTO_TEST_CASE( BatchPrefetcher_Ordered )
+{
+	std::size_t const elements = 23;
+	std::vector<RealVector> data(elements,RealVector(1,0.0));
+	std::vector<unsigned int> labels(elements);
+	for (size_t i=0; i!=elements; i++)
+		labels[i] = i;
+	ClassificationDataset dataset = createLabeledDataFromRange(data,labels);
+
+	BatchPrefetcher<ClassificationDataset> prefetcher(dataset,5,1,2,false);
+	for(size_t epoch = 0; epoch != 2; ++epoch){
+		unsigned int expected = 0;
+		for(size_t batch = 0; batch != 5; ++batch){
+			ClassificationDataset next = prefetcher.next();
+			BOOST_REQUIRE_EQUAL(next.numberOfElements(),batch == 4 ? 3u : 5u);
+			for(size_t i = 0; i != next.numberOfElements(); ++i,++expected)
+				BOOST_CHECK_EQUAL(next.element(i).label,expected);
+		}
+		BOOST_CHECK_EQUAL(expected,elements);
+	}
+}
+
+struct TestFunction
+{
+	RealVector weights;
+	TestFunction():weights(3){
+		weights(0)=1;
+		weights(1)=2;
+		weights(2)=-1;
+	}
+	double eval(RealVector const& pattern)const
+	{
+		return inner_prod(weights,pattern);
+	}
+};
+
+BOOST_AUTO_TEST_CASE( ML_MiniBatchErrorFunction )
+{
+	//create regression data from the testfunction
+	TestFunction function;
+	std::vector<RealVector> data;
+	std::vector<RealVector> target;
+	RealVector input(3);
+	RealVector output(1);
+
+	for (size_t i=0; i<1000; i++)
+	{
+		for(size_t j=0;j!=3;++j)
+		{
+			input(j)=Rng::uni(-1,1);
+		}
+		data.push_back(input);
+		output(0)=function.eval(input);
+		target.push_back(output);
+	}
+
+	RegressionDataset dataset = createLabeledDataFromRange(data,target);
+
+	RealVector point(3,0.0);
+	SquaredLoss<> loss;
+	LinearModel<> model(3);
+	MiniBatchErrorFunction<> mse(&model,&loss,50);
+	mse.setDataset(dataset);
+	BOOST_CHECK_EQUAL(mse.batchSize(),50u);
+
+	Adam optimizer;
+	optimizer.setLearningRate(0.05);
+	optimizer.init(mse, point);
+	//20 batches per epoch
+	for (size_t iteration=0; iteration<1000; ++iteration){
+		optimizer.step(mse);
+	}
+	RealVector best = optimizer.solution().point;
+	std::cout << "error:" << optimizer.solution().value << " parameter:" << best << std::endl;
+	BOOST_CHECK_SMALL(norm_inf(best-function.weights),1.e-3);
+	BOOST_CHECK(mse.epoch() >= 50u);
+
+	//a copy continues on its own shuffled epochs
+	MiniBatchErrorFunction<> copy(mse);
+	BOOST_CHECK_SMALL(copy.eval(best),1.e-5);
+}
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <vector>
+
+#include <shark/LinAlg/Base.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Rng/GlobalRng.h>
+#include <shark/Data/Dataset.h>
+#include <shark/Data/DataDistribution.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
+#include <shark/Algorithms/Trainers/McSvmCSTrainer.h>
+#include <shark/Algorithms/Trainers/McSvmWWTrainer.h>
+
+
+using namespace shark;
+
+
+// data generating distribution for a multi-category
+// classification problem with overlapping classes
+/// @cond EXAMPLE_SYMBOLS
+class Problem : public LabeledDataDistribution<RealVector, unsigned int>
+{
+public:
+	Problem(unsigned int classes, std::size_t dimensions)
+	: m_classes(classes), m_dimensions(dimensions){}
+
+	void draw(RealVector& input, unsigned int& label)const
+	{
+		label = Rng::discrete(0, m_classes - 1);
+		input.resize(m_dimensions);
+		for (std::size_t i=0; i<m_dimensions; i++)
+			input(i) = Rng::gauss();
+		input(label % m_dimensions) += 2.0;
+	}
+private:
+	unsigned int m_classes;
+	std::size_t m_dimensions;
+};
+/// @endcond
+
+// Compares the solve time of the all-in-one multi-class SVMs
+// of Weston and Watkins and of Crammer and Singer for
+// increasing numbers of threads. The decomposition solver
+// distributes the gradient updates, the shrinking checks and
+// the kernel row computations over the training examples.
+int main()
+{
+	// experiment settings
+	unsigned int classes = 10;
+	std::size_t dimensions = 10;
+	unsigned int ell = 5000;
+	double C = 1.0;
+	double gamma = 0.1;
+
+	Rng::seed(42);
+	Problem problem(classes, dimensions);
+	ClassificationDataset training = problem.generateDataset(ell);
+
+	GaussianRbfKernel<> kernel(gamma);
+	KernelExpansion<RealVector> svm;
+	svm.setStructure(false, classes);
+
+	AbstractSvmTrainer<RealVector, unsigned int>* trainer[2];
+	trainer[0] = new McSvmWWTrainer<RealVector>(&kernel, C);
+	trainer[1] = new McSvmCSTrainer<RealVector>(&kernel, C);
+
+#ifdef SHARK_USE_OPENMP
+	int maxThreads = omp_get_max_threads();
+#else
+	int maxThreads = 1;
+	std::printf("Shark was compiled without OpenMP, only the sequential solver is timed.\n");
+#endif
+
+	//powers of two below the maximum number of threads and the maximum itself
+	std::vector<int> threadCounts;
+	for (int threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	std::printf("SHARK multi-class SVM solver timing - %u examples, %u classes:\n", ell, classes);
+	for (std::size_t t = 0; t != threadCounts.size(); t++)
+	{
+		int threads = threadCounts[t];
+#ifdef SHARK_USE_OPENMP
+		omp_set_num_threads(threads);
+#endif
+		for (std::size_t i=0; i<2; i++)
+		{
+			trainer[i]->train(svm, training);
+			std::printf("%10s    threads=%3d    iterations=%10d    time=%9.4g seconds\n",
+					trainer[i]->name().c_str(),
+					threads,
+					(int)trainer[i]->solutionProperties().iterations,
+					trainer[i]->solutionProperties().seconds);
+		}
+	}
+
+	//clean up
+	for (std::size_t i=0; i<2; i++)
+		delete trainer[i];
+}
@@ -387,18 +387,15 @@ namespace shark {
 
 			std::vector< Individual > offspring( m_lambda );
 
-			shark::soo::PenalizingEvaluator evaluator;
 			for( unsigned int i = 0; i < offspring.size(); i++ ) {
 				MultiVariateNormalDistribution::ResultType sample = m_chromosome.m_mutationDistribution();
 				*(offspring[i]) = m_chromosome.m_mean + m_chromosome.m_sigma * sample.first;
-				boost::tuple< ObjectiveFunctionType::ResultType, ObjectiveFunctionType::ResultType > evalResult;
-				evalResult = evaluator( function, *offspring[i] );
-
-				offspring[i].fitness( shark::tag::UnpenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::UNPENALIZED_RESULT >( evalResult );
-				offspring[i].fitness( shark::tag::PenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::PENALIZED_RESULT >( evalResult );		    
-
 			}
 
+			// the offspring are evaluated as a batch, concurrently if the function is thread-safe
+			shark::soo::PenalizingEvaluator evaluator;
+			evaluator( function, offspring.begin(), offspring.end() );
+
 			// Selection
 			FitnessComparator comparator;
 			std::sort( offspring.begin(), offspring.end(), comparator );
@@ -0,0 +1,256 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Cache of objective function values for the grid and point searches
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_DIRECTSEARCH_EVALUATIONCACHE_H
+#define SHARK_ALGORITHMS_DIRECTSEARCH_EVALUATIONCACHE_H
+
+#include <shark/LinAlg/Base.h>
+#include <shark/Core/ISerializable.h>
+#include <shark/Core/Exception.h>
+
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/filesystem.hpp>
+
+#include <map>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+namespace shark {
+
+    //! \brief Stores the objective function values of already evaluated search points
+    //!
+    //! \par
+    //! GridSearch, NestedGridSearch and PointSearch look up every search point
+    //! in the cache before evaluating the objective function and insert the
+    //! newly computed values. Thus, overlapping searches and refinements of
+    //! a search do not evaluate the same point twice. Points are compared
+    //! exactly, which is the case for the grid points of identical grids.
+    //!
+    //! \par
+    //! The cache can be serialized like every other component. In addition,
+    //! a checkpoint file can be set. Its contents are loaded when the file
+    //! is set and every insertion appends one line with the point and its
+    //! value to the file, so that a search which was interrupted can be
+    //! resumed without evaluating the known points again. Appending keeps the
+    //! cost of an insertion independent of the size of the cache. Only lines
+    //! terminated by a line break are loaded, so a line which was only partially
+    //! written by a crash is ignored. Values which are not finite are written as
+    //! nan, inf and -inf and restored as well.
+    //! saveCheckpoint rewrites the file with one line per stored point.
+    //!
+    class EvaluationCache : public ISerializable
+    {
+    public:
+	//! Returns true and the value of the point if the point is stored in the cache.
+	bool lookup(RealVector const& point, double& value)const{
+	    MapType::const_iterator pos = m_values.find(key(point));
+	    if(pos == m_values.end())
+		return false;
+	    value = pos->second;
+	    return true;
+	}
+
+	//! Stores the value of a point and appends it to the checkpoint file, if one is set.
+	//! This method must not be called concurrently.
+	void insert(RealVector const& point, double value){
+	    std::vector<double> pointKey = key(point);
+	    m_values[pointKey] = value;
+	    if(m_checkpoint.is_open()){
+		writeRecord(m_checkpoint, pointKey, value);
+		m_checkpoint.flush();
+		if(!m_checkpoint)
+		    throw SHARKEXCEPTION("[EvaluationCache::insert] could not write to " + m_checkpointFile);
+	    }
+	}
+
+	//! Number of stored points.
+	std::size_t size()const{
+	    return m_values.size();
+	}
+
+	//! Removes all stored points. The checkpoint file is not changed.
+	void clear(){
+	    m_values.clear();
+	}
+
+	//! \brief Sets the checkpoint file and loads its contents, if it exists.
+	//!
+	//! The values of the file are added to the cache. An empty file name disables checkpointing.
+	void setCheckpointFile(std::string const& file){
+	    m_checkpoint.close();
+	    m_checkpoint.clear();
+	    m_checkpointFile = file;
+	    if(file.empty())
+		return;
+	    if(boost::filesystem::exists(file)){
+		std::ifstream stream(file.c_str());
+		if(!stream)
+		    throw SHARKEXCEPTION("[EvaluationCache::setCheckpointFile] could not open " + file);
+		std::string line;
+		//getline also returns a last line without line break, which may be cut off
+		while(std::getline(stream, line) && !stream.eof())
+		    readRecord(line);
+	    }
+	    openCheckpoint();
+	}
+
+	std::string const& checkpointFile()const{
+	    return m_checkpointFile;
+	}
+
+	//! \brief Rewrites the checkpoint file with the contents of the cache.
+	//!
+	//! This removes repeated insertions of the same point from the file and adds
+	//! points which were stored before the file was set. The file is written to a
+	//! temporary file first, which then replaces the old checkpoint.
+	void saveCheckpoint(){
+	    SHARK_CHECK(!m_checkpointFile.empty(), "[EvaluationCache::saveCheckpoint] no checkpoint file set");
+	    std::string temporary = m_checkpointFile + ".tmp";
+	    {
+		std::ofstream stream(temporary.c_str());
+		if(!stream)
+		    throw SHARKEXCEPTION("[EvaluationCache::saveCheckpoint] could not open " + temporary);
+		for(MapType::const_iterator pos = m_values.begin(); pos != m_values.end(); ++pos)
+		    writeRecord(stream, pos->first, pos->second);
+		if(!stream)
+		    throw SHARKEXCEPTION("[EvaluationCache::saveCheckpoint] could not write to " + temporary);
+	    }
+	    m_checkpoint.close();
+	    m_checkpoint.clear();
+	    boost::filesystem::rename(temporary, m_checkpointFile);
+	    openCheckpoint();
+	}
+
+	//from ISerializable
+	virtual void read( InArchive & archive )
+	{
+	    archive>>m_values;
+	}
+
+	virtual void write( OutArchive & archive ) const
+	{
+	    archive<<m_values;
+	}
+
+    private:
+	typedef std::map<std::vector<double>, double> MapType;
+
+	void openCheckpoint(){
+	    //a line cut off by a crash is removed, terminating it could turn it into a valid record
+	    boost::uintmax_t complete = 0;
+	    bool cutOff = false;
+	    {
+		std::ifstream stream(m_checkpointFile.c_str(), std::ios::binary);
+		std::string line;
+		while(std::getline(stream, line)){
+		    if(stream.eof()){
+			cutOff = true;
+			break;
+		    }
+		    complete += line.size() + 1;
+		}
+	    }
+	    if(cutOff)
+		boost::filesystem::resize_file(m_checkpointFile, complete);
+	    m_checkpoint.open(m_checkpointFile.c_str(), std::ios::out | std::ios::app);
+	    if(!m_checkpoint)
+		throw SHARKEXCEPTION("[EvaluationCache] could not open " + m_checkpointFile);
+	}
+
+	//! Writes a line "n x_1 ... x_n value", 17 digits restore the doubles exactly.
+	static void writeRecord(std::ostream& stream, std::vector<double> const& point, double value){
+	    stream.precision(std::numeric_limits<double>::digits10 + 2);
+	    stream << point.size();
+	    for(std::size_t i = 0; i != point.size(); ++i)
+		writeNumber(stream << ' ', point[i]);
+	    writeNumber(stream << ' ', value);
+	    stream << '\n';
+	}
+
+	//! Writes a number, values which are not finite are written as nan, inf or -inf.
+	static void writeNumber(std::ostream& stream, double x){
+	    if(x != x)
+		stream << "nan";
+	    else if(x == std::numeric_limits<double>::infinity())
+		stream << "inf";
+	    else if(x == -std::numeric_limits<double>::infinity())
+		stream << "-inf";
+	    else
+		stream << x;
+	}
+
+	//! Reads a number written by writeNumber, operator>> does not accept nan and inf.
+	static bool readNumber(std::istream& stream, double& x){
+	    std::string token;
+	    if(!(stream >> token))
+		return false;
+	    if(token == "nan")
+		x = std::numeric_limits<double>::quiet_NaN();
+	    else if(token == "inf")
+		x = std::numeric_limits<double>::infinity();
+	    else if(token == "-inf")
+		x = -std::numeric_limits<double>::infinity();
+	    else{
+		std::istringstream number(token);
+		if(!(number >> x) || number.peek() != std::istringstream::traits_type::eof())
+		    return false;
+	    }
+	    return true;
+	}
+
+	//! Parses a line written by writeRecord, malformed lines are skipped.
+	void readRecord(std::string const& line){
+	    std::istringstream stream(line);
+	    std::size_t dimensions;
+	    if(!(stream >> dimensions))
+		return;
+	    std::vector<double> point(dimensions);
+	    for(std::size_t i = 0; i != dimensions; ++i)
+		if(!readNumber(stream, point[i]))
+		    return;
+	    double value;
+	    if(!readNumber(stream, value))
+		return;
+	    m_values[point] = value;
+	}
+
+	static std::vector<double> key(RealVector const& point){
+	    return std::vector<double>(point.begin(), point.end());
+	}
+
+	//! values of the evaluated points
+	MapType m_values;
+
+	//! file the insertions are appended to, empty if not used
+	std::string m_checkpointFile;
+
+	//! stream appending to the checkpoint file
+	std::ofstream m_checkpoint;
+    };
+
+}
+#endif
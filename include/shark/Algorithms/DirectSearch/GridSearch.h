@@ -39,7 +39,9 @@
 
 
 #include <shark/Algorithms/AbstractSingleObjectiveOptimizer.h>
+#include <shark/Algorithms/DirectSearch/EvaluationCache.h>
 #include <shark/Core/SearchSpaces/VectorSpace.h>
+#include <shark/Core/OpenMP.h>
 #include <shark/Rng/GlobalRng.h>
 #include <boost/foreach.hpp>
 
@@ -48,6 +50,74 @@
 
 namespace shark {
 
+    namespace detail {
+	template<class Function>
+	void evaluateSearchPoint(Function const& f, RealVector const& point, double& value, EvaluationCache* cache){
+	    value = f.eval(point);
+	    if(cache != NULL){
+		//the insertion writes to the checkpoint file, exceptions must not leave the critical region
+		std::string error;
+		SHARK_CRITICAL_REGION{
+		    try{
+			cache->insert(point, value);
+		    }catch(std::exception const& e){
+			error = e.what();
+		    }
+		}
+		if(!error.empty())
+		    throw SHARKEXCEPTION(error);
+	    }
+	}
+
+	//! \brief Evaluates the objective function on all feasible points.
+	//!
+	//! Values stored in the cache are not computed again. If the function
+	//! declares that it is thread-safe, the remaining points are evaluated
+	//! in parallel. Infeasible points are marked in the feasible array.
+	//! An exception thrown by the function or the cache while evaluating in
+	//! parallel is rethrown after all points are processed.
+	template<class Function>
+	void evaluateSearchPoints(
+	    Function const& f, std::vector<RealVector> const& points,
+	    std::vector<double>& values, std::vector<char>& feasible,
+	    EvaluationCache* cache
+	){
+	    std::size_t numPoints = points.size();
+	    values.resize(numPoints);
+	    feasible.resize(numPoints);
+	    std::vector<std::size_t> pending;
+	    for (std::size_t i = 0; i != numPoints; i++)
+		{
+		    feasible[i] = f.isFeasible(points[i]);
+		    if (!feasible[i]) continue;
+		    if (cache != NULL && cache->lookup(points[i], values[i])) continue;
+		    pending.push_back(i);
+		}
+
+	    if (!f.isThreadSafe())
+		{
+		    for (std::size_t j = 0; j != pending.size(); j++)
+			evaluateSearchPoint(f, points[pending[j]], values[pending[j]], cache);
+		    return;
+		}
+	    //exceptions must not leave the parallel region
+	    std::vector<std::string> errors(pending.size());
+	    SHARK_PARALLEL_FOR_DYNAMIC(int j = 0; j < (int)pending.size(); j++)
+		{
+		    try{
+			evaluateSearchPoint(f, points[pending[j]], values[pending[j]], cache);
+		    }catch(std::exception const& e){
+			errors[j] = e.what();
+		    }
+		}
+	    for (std::size_t j = 0; j != pending.size(); j++)
+		{
+		    if (!errors[j].empty())
+			throw SHARKEXCEPTION(errors[j]);
+		}
+	}
+    }
+
     //!
     //! \brief Optimize by trying out a grid of configurations
     //!
@@ -64,11 +134,27 @@ namespace shark {
     //! A more sophisticated (less exhaustive) grid search variant is
     //! available with the NestedGridSearch class.
     //!
+    //! \par
+    //! The grid points are evaluated in parallel if the objective
+    //! function is thread-safe. Values of points which were evaluated
+    //! before can be taken from an EvaluationCache, see setCache.
+    //!
     class GridSearch : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
     {
     public:
 	GridSearch(){
 		m_configured=false;
+		mep_cache=NULL;
+	}
+
+	//! Sets the cache which stores the values of all evaluated grid points.
+	//! The cache is not owned by the search, NULL disables caching.
+	void setCache(EvaluationCache* cache){
+	    mep_cache = cache;
+	}
+
+	EvaluationCache* cache()const{
+	    return mep_cache;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -264,27 +350,14 @@ namespace shark {
 	    m_best.value = 1e100;
 	    RealVector point(dimensions);
 
-	    // loop through all grid points
+	    // enumerate all grid points
+	    std::vector<RealVector> points;
 	    while (true)
 		{
 		    // define the parameters
 		    for (size_t dimension = 0; dimension < dimensions; dimension++)
 			point(dimension) = m_nodeValues[dimension][index[dimension]];
-
-		    // evaluate the model
-		    if (objectiveFunction.isFeasible(point))
-			{
-			    double error = objectiveFunction.eval(point);
-			    
-#ifdef SHARK_CV_VERBOSE
-			    std::cout << point << "\t" << error << std::endl;
-#endif	    
-			    if (error < m_best.value)
-				{
-				    m_best.value = error;
-				    m_best.point = point;		// [TG] swap() solution is out, caused ugly memory bug, I changed this back
-				}
-			}
+		    points.push_back(point);
 
 		    // next index
 		    size_t dimension = 0;
@@ -296,6 +369,24 @@ namespace shark {
 			}
 		    if (dimension == dimensions) break;
 		}
+
+	    // evaluate the model
+	    std::vector<double> errors;
+	    std::vector<char> feasible;
+	    detail::evaluateSearchPoints(objectiveFunction, points, errors, feasible, mep_cache);
+
+	    for (size_t i = 0; i != points.size(); i++)
+		{
+		    if (!feasible[i]) continue;
+#ifdef SHARK_CV_VERBOSE
+		    std::cout << points[i] << "\t" << errors[i] << std::endl;
+#endif
+		    if (errors[i] < m_best.value)
+			{
+			    m_best.value = errors[i];
+			    m_best.point = points[i];
+			}
+		}
 	}
 
     protected:
@@ -304,6 +395,9 @@ namespace shark {
 	std::vector<std::vector<double> > m_nodeValues;
 
 	bool m_configured;
+
+	//! cache of evaluated points, may be NULL
+	EvaluationCache* mep_cache;
     };
 
 
@@ -348,6 +442,11 @@ namespace shark {
     //! the parameter range defined m_minimum and m_maximum.
     //! These invalid landscape values are not used.
     //!
+    //! \par
+    //! As for GridSearch, the grid points are evaluated in parallel
+    //! for thread-safe objective functions and an EvaluationCache
+    //! can be used to skip points which were evaluated before.
+    //!
     class NestedGridSearch : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
     {
     public:
@@ -355,6 +454,17 @@ namespace shark {
 	NestedGridSearch()
 	{
 		m_configured=false;
+		mep_cache=NULL;
+	}
+
+	//! Sets the cache which stores the values of all evaluated grid points.
+	//! The cache is not owned by the search, NULL disables caching.
+	void setCache(EvaluationCache* cache){
+	    mep_cache = cache;
+	}
+
+	EvaluationCache* cache()const{
+	    return mep_cache;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -464,7 +574,8 @@ namespace shark {
 
 	    RealVector point=m_best.point;
 
-	    // loop through the grid
+	    // loop through the grid and collect the points within the parameter range
+	    std::vector<RealVector> points;
 	    while (true)
 		{
 		    // compute the grid point,
@@ -480,19 +591,9 @@ namespace shark {
 				    break;
 				}
 			}
+		    if (compute)
+			points.push_back(point);
 
-		    // evaluate the grid point
-		    if (compute && objectiveFunction.isFeasible(point))
-			{
-			    double error = objectiveFunction.eval(point);
-
-			    // remember the best solution
-			    if (error < m_best.value)
-				{
-				    m_best.value = error;
-				    m_best.point=point;
-				}
-			}
 		    // move to the next grid point
 		    size_t d = 0;
 		    for (; d < dimensions; d++)
@@ -503,6 +604,22 @@ namespace shark {
 			}
 		    if (d == dimensions) break;
 		}
+
+	    // evaluate the grid points
+	    std::vector<double> errors;
+	    std::vector<char> feasible;
+	    detail::evaluateSearchPoints(objectiveFunction, points, errors, feasible, mep_cache);
+
+	    // remember the best solution
+	    for (size_t i = 0; i != points.size(); i++)
+		{
+		    if (feasible[i] && errors[i] < m_best.value)
+			{
+			    m_best.value = errors[i];
+			    m_best.point = points[i];
+			}
+		}
+
 	    // decrease the step sizes
 	    BOOST_FOREACH(double& step,m_stepsize)
 		step *= 0.5;
@@ -519,6 +636,9 @@ namespace shark {
 	std::vector<double> m_stepsize;
 
 	bool m_configured;
+
+	//! cache of evaluated points, may be NULL
+	EvaluationCache* mep_cache;
     };
 
 
@@ -538,12 +658,27 @@ namespace shark {
     //! They are uniformly distributed in [-1,1].
     //! parameters^2 points but minimum 20 are sampled in this case.
     //!
+    //! As for GridSearch, the points are evaluated in parallel for
+    //! thread-safe objective functions and an EvaluationCache can be
+    //! used to skip points which were evaluated before.
+    //!
     class PointSearch : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
     {
     public:
 	//! Constructor
 	PointSearch() {
 	    m_configured=false;
+	    mep_cache=NULL;
+	}
+
+	//! Sets the cache which stores the values of all evaluated points.
+	//! The cache is not owned by the search, NULL disables caching.
+	void setCache(EvaluationCache* cache){
+	    mep_cache = cache;
+	}
+
+	EvaluationCache* cache()const{
+	    return mep_cache;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -608,18 +743,18 @@ namespace shark {
 	    m_best.value = 1e100;
 	    size_t bestIndex=0;
 
+	    // evaluate the model
+	    std::vector<double> errors;
+	    std::vector<char> feasible;
+	    detail::evaluateSearchPoints(objectiveFunction, m_points, errors, feasible, mep_cache);
+
 	    // loop through all points
 	    for (size_t point = 0; point < numPoints; point++)
 		{
-		    // evaluate the model
-		    if (objectiveFunction.isFeasible(m_points[point]))
+		    if (feasible[point] && errors[point] < m_best.value)
 			{
-			    double error = objectiveFunction.eval(m_points[point]);
-			    if (error < m_best.value)
-				{
-				    m_best.value = error;
-				    bestIndex=point;
-				}
+			    m_best.value = errors[point];
+			    bestIndex=point;
 			}
 		}
 	    m_best.point=m_points[bestIndex];
@@ -631,6 +766,9 @@ namespace shark {
 
 	//! verbosity level
 	bool m_configured;
+
+	//! cache of evaluated points, may be NULL
+	EvaluationCache* mep_cache;
     };
 
 
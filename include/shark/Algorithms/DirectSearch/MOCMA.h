@@ -356,13 +356,12 @@ public:
 
 		std::size_t noObjectives = 0;
 
-		shark::moo::PenalizingEvaluator evaluator;
 		BOOST_FOREACH(mocma::Individual & ind, m_pop) {
 			f.proposeStartingPoint(*ind);
-			boost::tuple< typename ObjectiveFunction::ResultType, typename ObjectiveFunction::ResultType > 	result = evaluator(f, *ind);
-			ind.fitness(shark::tag::PenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::PENALIZED_RESULT >(result);
-			ind.fitness(shark::tag::UnpenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::UNPENALIZED_RESULT >(result);
-
+		}
+		shark::moo::PenalizingEvaluator evaluator;
+		evaluator(f, m_pop.begin(), m_pop.end());
+		BOOST_FOREACH(mocma::Individual & ind, m_pop) {
 			noObjectives = std::max(noObjectives, ind.fitness(shark::tag::PenalizedFitness()).size());
 		}
 
@@ -396,13 +395,12 @@ public:
 			*itOffspring = *itParents;
 			m_variator(*itOffspring);
 			itOffspring->age() = 0;
-			boost::tuple< typename Function::ResultType, typename Function::ResultType > 	result = m_evaluator(f, *(*itOffspring));
-			itOffspring->fitness(shark::tag::PenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::PENALIZED_RESULT >(result);
-			itOffspring->fitness(shark::tag::UnpenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::UNPENALIZED_RESULT >(result);
 
 			itParents->get<0>().mep_parent = NULL;
 			itOffspring->get<0>().mep_parent = &(itParents->get<0>());
 		}
+		// the offspring are evaluated as a batch, concurrently if the function is thread-safe
+		m_evaluator(f, m_pop.begin() + m_mu, m_pop.end());
 
 		m_fastNonDominatedSort(m_pop);
 
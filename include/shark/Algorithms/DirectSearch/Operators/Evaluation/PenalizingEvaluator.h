@@ -26,12 +26,18 @@
 #define SHARK_ALGORITHMS_DIRECT_SEARCH_OPERATORS_EVALUATION_PENALIZING_EVALUATOR_H
 
 #include <shark/LinAlg/Base.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Core/Exception.h>
+#include <shark/Algorithms/DirectSearch/EA.h>
 
 
 #include <boost/math/special_functions.hpp>
 
 #include <boost/tuple/tuple.hpp>
 
+#include <string>
+#include <vector>
+
 
 
 
@@ -109,6 +115,44 @@ namespace shark {
 				return( boost::make_tuple( fitness, penalizedFitness ) );
 			}
 
+			/**
+			* \brief Evaluates the supplied function on a range of individuals.
+			*
+			* The unpenalized and penalized fitness values are stored in the first component of the
+			* fitness vectors of the individuals. If the function declares that it is thread-safe,
+			* the individuals are evaluated concurrently, otherwise one after another.
+			* If the evaluation of an individual throws, the first error is rethrown
+			* after all individuals are processed.
+			*
+			* \tparam Function Abstracts the objective function type.
+			* \tparam IndividualIterator Random access iterator over the individuals.
+			* \param [in] f The function to be evaluated.
+			* \param [in] begin Iterator pointing to the first individual.
+			* \param [in] end Iterator pointing behind the last individual.
+			*/
+			template<typename Function, typename IndividualIterator>
+			void operator()( const Function & f, IndividualIterator begin, IndividualIterator end ) const {
+				int n = static_cast<int>( end - begin );
+				if( !f.isThreadSafe() ) {
+					for( int i = 0; i < n; i++ )
+						evaluateIndividual( f, begin[i] );
+					return;
+				}
+				//exceptions must not leave the parallel region, they are rethrown afterwards
+				std::vector<std::string> errors( n );
+				SHARK_PARALLEL_FOR( int i = 0; i < n; i++ ) {
+					try {
+						evaluateIndividual( f, begin[i] );
+					} catch( std::exception const& e ) {
+						errors[i] = e.what();
+					}
+				}
+				for( int i = 0; i < n; i++ ) {
+					if( !errors[i].empty() )
+						throw SHARKEXCEPTION( errors[i] );
+				}
+			}
+
 			/**
 			* \brief Stores/loads the evaluator's state.
 			* \tparam Archive The type of the archive.
@@ -122,6 +166,14 @@ namespace shark {
 
 			double m_penaltyFactor; ///< Penalty factor \f$\alpha\f$, default value: \f$10^{-6}\f$ .
 
+		private:
+			template<typename Function, typename Individual>
+			void evaluateIndividual( const Function & f, Individual & individual ) const {
+				boost::tuple< typename Function::ResultType, typename Function::ResultType > result = (*this)( f, *individual );
+				individual.fitness( shark::tag::UnpenalizedFitness() )[0] = boost::get< UNPENALIZED_RESULT >( result );
+				individual.fitness( shark::tag::PenalizedFitness() )[0] = boost::get< PENALIZED_RESULT >( result );
+			}
+
 		};
 	}
 
@@ -198,6 +250,44 @@ namespace shark {
 				return( boost::make_tuple( fitness, penalizedFitness ) );
 			}
 
+			/**
+			* \brief Evaluates the supplied function on a range of individuals.
+			*
+			* The unpenalized and penalized fitness values are stored in the fitness vectors of
+			* the individuals. If the function declares that it is thread-safe,
+			* the individuals are evaluated concurrently, otherwise one after another.
+			* If the evaluation of an individual throws, the first error is rethrown
+			* after all individuals are processed.
+			*
+			* \tparam Function Abstracts the objective function type.
+			* \tparam IndividualIterator Random access iterator over the individuals.
+			* \param [in] f The function to be evaluated.
+			* \param [in] begin Iterator pointing to the first individual.
+			* \param [in] end Iterator pointing behind the last individual.
+			*/
+			template<typename Function, typename IndividualIterator>
+			void operator()( const Function & f, IndividualIterator begin, IndividualIterator end ) const {
+				int n = static_cast<int>( end - begin );
+				if( !f.isThreadSafe() ) {
+					for( int i = 0; i < n; i++ )
+						evaluateIndividual( f, begin[i] );
+					return;
+				}
+				//exceptions must not leave the parallel region, they are rethrown afterwards
+				std::vector<std::string> errors( n );
+				SHARK_PARALLEL_FOR( int i = 0; i < n; i++ ) {
+					try {
+						evaluateIndividual( f, begin[i] );
+					} catch( std::exception const& e ) {
+						errors[i] = e.what();
+					}
+				}
+				for( int i = 0; i < n; i++ ) {
+					if( !errors[i].empty() )
+						throw SHARKEXCEPTION( errors[i] );
+				}
+			}
+
 			/**
 			* \brief Stores/loads the evaluator's state.
 			* \tparam Archive The type of the archive.
@@ -211,6 +301,14 @@ namespace shark {
 
 			double m_penaltyFactor; ///< Penalty factor \f$\alpha\f$, default value: \f$10^{-6}\f$ .
 
+		private:
+			template<typename Function, typename Individual>
+			void evaluateIndividual( const Function & f, Individual & individual ) const {
+				boost::tuple< typename Function::ResultType, typename Function::ResultType > result = (*this)( f, *individual );
+				individual.fitness( shark::tag::UnpenalizedFitness() ) = boost::get< UNPENALIZED_RESULT >( result );
+				individual.fitness( shark::tag::PenalizedFitness() ) = boost::get< PENALIZED_RESULT >( result );
+			}
+
 		};
 
 	}
@@ -368,13 +368,12 @@ struct SteadyStateMOCMA {
 
 		std::size_t noObjectives = 0;
 
-		shark::moo::PenalizingEvaluator evaluator;
 		BOOST_FOREACH(steady_state_mocma::Individual & ind, m_pop) {
 			f.proposeStartingPoint(*ind);
-			boost::tuple< typename ObjectiveFunction::ResultType, typename ObjectiveFunction::ResultType > 	result = evaluator(f, *ind);
-			ind.fitness(shark::tag::PenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::PENALIZED_RESULT >(result);
-			ind.fitness(shark::tag::UnpenalizedFitness()) = boost::get< shark::moo::PenalizingEvaluator::UNPENALIZED_RESULT >(result);
-
+		}
+		shark::moo::PenalizingEvaluator evaluator;
+		evaluator(f, m_pop.begin(), m_pop.end());
+		BOOST_FOREACH(steady_state_mocma::Individual & ind, m_pop) {
 			noObjectives = std::max(noObjectives, ind.fitness(shark::tag::PenalizedFitness()).size());
 		}
 
@@ -0,0 +1,358 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Successive halving and Hyperband for multi-fidelity hyperparameter search
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_DIRECTSEARCH_SUCCESSIVEHALVING_H
+#define SHARK_ALGORITHMS_DIRECTSEARCH_SUCCESSIVEHALVING_H
+
+#include <shark/Algorithms/DirectSearch/GridSearch.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace shark {
+
+    namespace detail {
+	//! \brief Runs successive halving on the given candidates.
+	//!
+	//! The candidates are evaluated on the budgets starting with firstBudget. After each
+	//! budget only the best 1/eta of the candidates are kept, at least one. The candidates
+	//! of every budget are evaluated with evaluateSearchPoints, i.e., in parallel for
+	//! thread-safe functions. Returns the best candidate on the last budget.
+	template<class Function>
+	SingleObjectiveResultSet<RealVector> successiveHalving(
+	    std::vector<Function const*> const& budgets, std::size_t firstBudget,
+	    std::vector<RealVector> candidates, double eta
+	){
+	    SingleObjectiveResultSet<RealVector> best;
+	    best.value = 1e100;
+	    std::vector<double> errors;
+	    std::vector<char> feasible;
+	    for (std::size_t budget = firstBudget; budget != budgets.size() && !candidates.empty(); budget++)
+		{
+		    evaluateSearchPoints(*budgets[budget], candidates, errors, feasible, (EvaluationCache*)NULL);
+
+		    // rank the feasible candidates, ties keep the order of the candidates
+		    std::vector<std::pair<double, std::size_t> > ranking;
+		    for (std::size_t i = 0; i != candidates.size(); i++)
+			if (feasible[i]) ranking.push_back(std::make_pair(errors[i], i));
+		    std::stable_sort(ranking.begin(), ranking.end());
+		    if (ranking.empty())
+			break;
+
+		    if (budget + 1 == budgets.size())
+			{
+			    best.value = ranking[0].first;
+			    best.point = candidates[ranking[0].second];
+			    break;
+			}
+
+		    std::size_t promoted = std::max<std::size_t>(1, (std::size_t)(candidates.size() / eta));
+		    promoted = std::min(promoted, ranking.size());
+		    std::vector<RealVector> next(promoted);
+		    for (std::size_t i = 0; i != promoted; i++)
+			next[i] = candidates[ranking[i].second];
+		    swap(candidates, next);
+		}
+	    return best;
+	}
+    }
+
+    //!
+    //! \brief Multi-fidelity search by successive halving
+    //!
+    //! \par
+    //! Many of the candidates of a PointSearch are obviously bad, yet each of them
+    //! costs a full evaluation of the objective function, e.g., a full cross-validation.
+    //! Successive halving first evaluates all candidates on cheap approximations of the
+    //! objective function, so called budgets, and only promotes the best fraction 1/eta
+    //! of the candidates to the next, more expensive budget. The objective function
+    //! passed to step is the last and most expensive budget.
+    //!
+    //! \par
+    //! Budgets are objective functions over the same search space, for example a
+    //! CrossValidationError on a subset of the data created with rangeSubset or on fewer
+    //! folds, or a trainer with a reduced number of iterations. They are added with
+    //! addBudget in the order of increasing cost and are not owned by the optimizer.
+    //! The candidates of a budget are evaluated in parallel if the budget declares
+    //! that it is thread-safe.
+    //!
+    //! \par
+    //! If no candidates are configured, random points are sampled as in PointSearch.
+    //!
+    class SuccessiveHalving : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
+    {
+    public:
+	SuccessiveHalving() {
+	    m_configured=false;
+	    m_eta=3.0;
+	}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "SuccessiveHalving"; }
+
+	void configure(PropertyTree const&){}
+
+	//! Sets the candidate points.
+	void configure(std::vector<RealVector> const& points) {
+	    m_points=points;
+	    m_configured=true;
+	}
+
+	//! Samples random candidates in the range [min,max]^parameters.
+	void configure(size_t parameters, size_t samples, double min, double max) {
+	    RANGE_CHECK(min<=max);
+	    m_points.resize(samples);
+	    for(size_t sample=0;sample!=samples;++sample)
+		{
+		    m_points[sample].resize(parameters);
+		    for(size_t param=0;param!=parameters;++param)
+			m_points[sample](param)=Rng::uni(min,max);
+		}
+	    m_configured=true;
+	}
+
+	//! Adds a cheaper approximation of the objective function. Budgets are used in the order they are added.
+	void addBudget(ObjectiveFunctionType const* budget){
+	    m_budgets.push_back(budget);
+	}
+
+	//! Removes all budgets, afterwards only the objective function passed to step is used.
+	void clearBudgets(){
+	    m_budgets.clear();
+	}
+
+	std::size_t numberOfBudgets()const{
+	    return m_budgets.size();
+	}
+
+	//! Inverse of the fraction of candidates which is promoted to the next budget.
+	double reductionFactor()const{
+	    return m_eta;
+	}
+
+	void setReductionFactor(double eta){
+	    RANGE_CHECK(eta > 1.0);
+	    m_eta = eta;
+	}
+
+	//from ISerializable
+	virtual void read( InArchive & archive )
+	{
+	    archive>>m_points;
+	    archive>>m_configured;
+	    archive>>m_eta;
+	    archive>>m_best.point;
+	    archive>>m_best.value;
+	}
+
+	virtual void write( OutArchive & archive ) const
+	{
+	    archive<<m_points;
+	    archive<<m_configured;
+	    archive<<m_eta;
+	    archive<<m_best.point;
+	    archive<<m_best.value;
+	}
+
+	//! If the class wasn't configured before, this method samples random uniform distributed points in [-1,1]^n.
+	void init(const ObjectiveFunctionType & objectiveFunction, const SearchPointType& startingPoint) {
+	    (void) objectiveFunction;
+	    if(!m_configured)
+		{
+		    size_t parameters=startingPoint.size();
+		    size_t samples=std::max(sqr(parameters),(size_t)20);
+		    configure(parameters,samples,-1,1);
+		}
+	    m_best.point=startingPoint;
+	}
+	using AbstractSingleObjectiveOptimizer<VectorSpace<double> >::init;
+
+	//! Runs successive halving over all budgets. As for PointSearch,
+	//! calling step more than once does not improve the solution.
+	void step(const ObjectiveFunctionType& objectiveFunction) {
+	    std::vector<ObjectiveFunctionType const*> budgets = m_budgets;
+	    budgets.push_back(&objectiveFunction);
+	    SingleObjectiveResultSet<RealVector> best = detail::successiveHalving(budgets, 0, m_points, m_eta);
+	    m_best.value = best.value;
+	    if (!best.point.empty())
+		m_best.point = best.point;
+	}
+
+    protected:
+	//! candidate points
+	std::vector<RealVector> m_points;
+
+	//! cheaper approximations of the objective function
+	std::vector<ObjectiveFunctionType const*> m_budgets;
+
+	//! inverse of the fraction of promoted candidates
+	double m_eta;
+
+	bool m_configured;
+    };
+
+    //!
+    //! \brief Hyperband hyperparameter search
+    //!
+    //! \par
+    //! Successive halving needs to know in advance how many candidates to start with:
+    //! many candidates on a cheap budget find good regions but may discard candidates
+    //! whose cheap estimate is misleading. Hyperband hedges this by running several
+    //! brackets of successive halving, starting with many random candidates on the
+    //! cheapest budget and ending with few candidates evaluated on the full objective
+    //! function only. The best candidate on the objective function passed to step is
+    //! returned.
+    //!
+    //! \par
+    //! The budgets are set up as for SuccessiveHalving. Every call of step runs all
+    //! brackets with newly sampled candidates from the box [min,max]^n given to
+    //! configure and keeps the best solution found so far.
+    //!
+    class Hyperband : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
+    {
+    public:
+	Hyperband() {
+	    m_configured=false;
+	    m_eta=3.0;
+	    m_best.value=1e100;
+	}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "Hyperband"; }
+
+	void configure(PropertyTree const&){}
+
+	//! Sets the box [min,max] the candidates are sampled from.
+	void configure(std::vector<double> const& min, std::vector<double> const& max) {
+	    SIZE_CHECK(min.size() == max.size());
+	    for(std::size_t i = 0; i != min.size(); ++i)
+		RANGE_CHECK(min[i] <= max[i]);
+	    m_minimum=min;
+	    m_maximum=max;
+	    m_configured=true;
+	}
+
+	//! Samples the candidates from [min,max]^parameters.
+	void configure(size_t parameters, double min, double max) {
+	    configure(std::vector<double>(parameters,min),std::vector<double>(parameters,max));
+	}
+
+	//! Adds a cheaper approximation of the objective function. Budgets are used in the order they are added.
+	void addBudget(ObjectiveFunctionType const* budget){
+	    m_budgets.push_back(budget);
+	}
+
+	void clearBudgets(){
+	    m_budgets.clear();
+	}
+
+	std::size_t numberOfBudgets()const{
+	    return m_budgets.size();
+	}
+
+	double reductionFactor()const{
+	    return m_eta;
+	}
+
+	void setReductionFactor(double eta){
+	    RANGE_CHECK(eta > 1.0);
+	    m_eta = eta;
+	}
+
+	//! Number of candidates the bracket starting at the given budget samples.
+	std::size_t bracketSize(std::size_t firstBudget)const{
+	    std::size_t budgets = m_budgets.size() + 1;
+	    SIZE_CHECK(firstBudget < budgets);
+	    std::size_t rungs = budgets - firstBudget;
+	    return (std::size_t)std::ceil(double(budgets) / rungs * std::pow(m_eta, double(rungs - 1)));
+	}
+
+	//from ISerializable
+	virtual void read( InArchive & archive )
+	{
+	    archive>>m_minimum;
+	    archive>>m_maximum;
+	    archive>>m_configured;
+	    archive>>m_eta;
+	    archive>>m_best.point;
+	    archive>>m_best.value;
+	}
+
+	virtual void write( OutArchive & archive ) const
+	{
+	    archive<<m_minimum;
+	    archive<<m_maximum;
+	    archive<<m_configured;
+	    archive<<m_eta;
+	    archive<<m_best.point;
+	    archive<<m_best.value;
+	}
+
+	//! If the class wasn't configured before, the candidates are sampled from [-1,1]^n.
+	void init(const ObjectiveFunctionType & objectiveFunction, const SearchPointType& startingPoint) {
+	    (void) objectiveFunction;
+	    if(!m_configured)
+		configure(startingPoint.size(),-1,1);
+	    SIZE_CHECK(startingPoint.size() == m_minimum.size());
+	    m_best.point=startingPoint;
+	    m_best.value=1e100;
+	}
+	using AbstractSingleObjectiveOptimizer<VectorSpace<double> >::init;
+
+	//! Runs one bracket of successive halving for every budget, starting with the cheapest.
+	void step(const ObjectiveFunctionType& objectiveFunction) {
+	    std::vector<ObjectiveFunctionType const*> budgets = m_budgets;
+	    budgets.push_back(&objectiveFunction);
+	    for (std::size_t first = 0; first != budgets.size(); first++)
+		{
+		    std::vector<RealVector> candidates(bracketSize(first), RealVector(m_minimum.size()));
+		    for (std::size_t i = 0; i != candidates.size(); i++)
+			for (std::size_t j = 0; j != m_minimum.size(); j++)
+			    candidates[i](j) = Rng::uni(m_minimum[j], m_maximum[j]);
+
+		    SingleObjectiveResultSet<RealVector> best = detail::successiveHalving(budgets, first, candidates, m_eta);
+		    if (best.value < m_best.value)
+			m_best = best;
+		}
+	}
+
+    protected:
+	//! lower end of the sampling range
+	std::vector<double> m_minimum;
+
+	//! upper end of the sampling range
+	std::vector<double> m_maximum;
+
+	//! cheaper approximations of the objective function
+	std::vector<ObjectiveFunctionType const*> m_budgets;
+
+	//! inverse of the fraction of promoted candidates
+	double m_eta;
+
+	bool m_configured;
+    };
+
+}
+#endif
@@ -0,0 +1,119 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Adagrad, a stochastic gradient method with per-component step sizes
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#ifndef SHARK_ML_OPTIMIZER_ADAGRAD_H
+#define SHARK_ML_OPTIMIZER_ADAGRAD_H
+
+#include <shark/Algorithms/AbstractSingleObjectiveOptimizer.h>
+#include <shark/Core/SearchSpaces/VectorSpace.h>
+
+namespace shark{
+
+///@brief Adagrad, stochastic gradient descent with adaptive per-component learning rates.
+///
+///Every component of the search point is moved by the learning rate times its derivative,
+///divided by the root of the sum of all squared derivatives of that component seen so far.
+///Components with large or frequent derivatives thus take smaller steps than rarely
+///changing ones, which suits sparse inputs.
+///
+///The method is meant for noisy objective functions like the MiniBatchErrorFunction,
+///for which the value of the solution is the value on the last mini-batch.
+///
+///See Duchi, Hazan and Singer, Adaptive Subgradient Methods for Online Learning and
+///Stochastic Optimization, JMLR 2011.
+class Adagrad : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
+{
+public:
+	Adagrad() {
+		m_features |= REQUIRES_FIRST_DERIVATIVE;
+
+		m_learningRate = 0.1;
+		m_epsilon = 1.e-8;
+	}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "Adagrad"; }
+
+	void init(const ObjectiveFunctionType & objectiveFunction, const SearchPointType& startingPoint) {
+		checkFeatures(objectiveFunction);
+
+		m_squaredSum.resize(startingPoint.size());
+		m_squaredSum.clear();
+		m_best.point = startingPoint;
+		m_best.value = objectiveFunction.evalDerivative(m_best.point,m_derivative);
+	}
+	using AbstractSingleObjectiveOptimizer<VectorSpace<double> >::init;
+
+	void configure( const PropertyTree & node ) {
+		m_learningRate=node.get("learningRate",0.1);
+		m_epsilon=node.get("epsilon",1.e-8);
+	}
+
+	double learningRate() const {
+		return m_learningRate;
+	}
+	void setLearningRate(double learningRate) {
+		m_learningRate = learningRate;
+	}
+
+	///\brief Constant added to the root of the squared sum to avoid divisions by zero.
+	double epsilon() const {
+		return m_epsilon;
+	}
+	void setEpsilon(double epsilon) {
+		m_epsilon = epsilon;
+	}
+
+	/*!
+	 *  \brief accumulates the squared derivative and moves the point by the scaled derivative
+	 */
+	void step(const ObjectiveFunctionType& objectiveFunction) {
+		noalias(m_squaredSum) += sqr(m_derivative);
+		for(std::size_t i = 0; i != m_best.point.size(); ++i)
+			m_best.point(i) -= m_learningRate * m_derivative(i) / (std::sqrt(m_squaredSum(i)) + m_epsilon);
+		m_best.value = objectiveFunction.evalDerivative(m_best.point,m_derivative);
+	}
+
+	virtual void read( InArchive & archive )
+	{
+		archive>>m_squaredSum;
+		archive>>m_learningRate;
+		archive>>m_epsilon;
+	}
+
+	virtual void write( OutArchive & archive ) const
+	{
+		archive<<m_squaredSum;
+		archive<<m_learningRate;
+		archive<<m_epsilon;
+	}
+
+private:
+	RealVector m_squaredSum;
+	ObjectiveFunctionType::FirstOrderDerivative m_derivative;
+	double m_learningRate;
+	double m_epsilon;
+};
+
+}
+#endif
@@ -0,0 +1,164 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Adam, a stochastic gradient method with adaptive step sizes
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#ifndef SHARK_ML_OPTIMIZER_ADAM_H
+#define SHARK_ML_OPTIMIZER_ADAM_H
+
+#include <shark/Algorithms/AbstractSingleObjectiveOptimizer.h>
+#include <shark/Core/SearchSpaces/VectorSpace.h>
+
+namespace shark{
+
+///@brief Adam, stochastic gradient descent with adaptive moment estimation.
+///
+///Adam keeps exponentially decaying averages of the derivative and of its squared
+///components. Every component of the search point is moved by the averaged derivative
+///divided by the square root of the averaged squared derivative, thus the step size
+///of a component adapts to the scale and the noise of its derivative. Both averages are
+///corrected for their initialization with zero.
+///
+///The method is meant for noisy objective functions like the MiniBatchErrorFunction,
+///for which the value of the solution is the value on the last mini-batch.
+///
+///See Kingma and Ba, Adam: A Method for Stochastic Optimization, ICLR 2015.
+class Adam : public AbstractSingleObjectiveOptimizer<VectorSpace<double> >
+{
+public:
+	Adam() {
+		m_features |= REQUIRES_FIRST_DERIVATIVE;
+
+		m_learningRate = 0.001;
+		m_beta1 = 0.9;
+		m_beta2 = 0.999;
+		m_epsilon = 1.e-8;
+	}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "Adam"; }
+
+	void init(const ObjectiveFunctionType & objectiveFunction, const SearchPointType& startingPoint) {
+		checkFeatures(objectiveFunction);
+
+		m_firstMoment.resize(startingPoint.size());
+		m_firstMoment.clear();
+		m_secondMoment.resize(startingPoint.size());
+		m_secondMoment.clear();
+		m_beta1Power = 1.0;
+		m_beta2Power = 1.0;
+		m_best.point = startingPoint;
+		m_best.value = objectiveFunction.evalDerivative(m_best.point,m_derivative);
+	}
+	using AbstractSingleObjectiveOptimizer<VectorSpace<double> >::init;
+
+	void configure( const PropertyTree & node ) {
+		m_learningRate=node.get("learningRate",0.001);
+		m_beta1=node.get("beta1",0.9);
+		m_beta2=node.get("beta2",0.999);
+		m_epsilon=node.get("epsilon",1.e-8);
+	}
+
+	double learningRate() const {
+		return m_learningRate;
+	}
+	void setLearningRate(double learningRate) {
+		m_learningRate = learningRate;
+	}
+
+	///\brief Decay rate of the average of the derivative.
+	double beta1() const {
+		return m_beta1;
+	}
+	void setBeta1(double beta1) {
+		RANGE_CHECK(beta1 >= 0.0 && beta1 < 1.0);
+		m_beta1 = beta1;
+	}
+
+	///\brief Decay rate of the average of the squared derivative.
+	double beta2() const {
+		return m_beta2;
+	}
+	void setBeta2(double beta2) {
+		RANGE_CHECK(beta2 >= 0.0 && beta2 < 1.0);
+		m_beta2 = beta2;
+	}
+
+	///\brief Constant added to the root of the squared derivative to avoid divisions by zero.
+	double epsilon() const {
+		return m_epsilon;
+	}
+	void setEpsilon(double epsilon) {
+		m_epsilon = epsilon;
+	}
+
+	/*!
+	 *  \brief updates the moment estimates and moves the point by the corrected ratio of the moments
+	 */
+	void step(const ObjectiveFunctionType& objectiveFunction) {
+		m_beta1Power *= m_beta1;
+		m_beta2Power *= m_beta2;
+		noalias(m_firstMoment) = m_beta1 * m_firstMoment + (1.0 - m_beta1) * m_derivative;
+		noalias(m_secondMoment) = m_beta2 * m_secondMoment + (1.0 - m_beta2) * sqr(m_derivative);
+		double stepSize = m_learningRate * std::sqrt(1.0 - m_beta2Power) / (1.0 - m_beta1Power);
+		for(std::size_t i = 0; i != m_best.point.size(); ++i)
+			m_best.point(i) -= stepSize * m_firstMoment(i) / (std::sqrt(m_secondMoment(i)) + m_epsilon);
+		m_best.value = objectiveFunction.evalDerivative(m_best.point,m_derivative);
+	}
+
+	virtual void read( InArchive & archive )
+	{
+		archive>>m_firstMoment;
+		archive>>m_secondMoment;
+		archive>>m_beta1Power;
+		archive>>m_beta2Power;
+		archive>>m_learningRate;
+		archive>>m_beta1;
+		archive>>m_beta2;
+		archive>>m_epsilon;
+	}
+
+	virtual void write( OutArchive & archive ) const
+	{
+		archive<<m_firstMoment;
+		archive<<m_secondMoment;
+		archive<<m_beta1Power;
+		archive<<m_beta2Power;
+		archive<<m_learningRate;
+		archive<<m_beta1;
+		archive<<m_beta2;
+		archive<<m_epsilon;
+	}
+
+private:
+	RealVector m_firstMoment;
+	RealVector m_secondMoment;
+	ObjectiveFunctionType::FirstOrderDerivative m_derivative;
+	double m_beta1Power;///< beta1 to the power of the number of steps
+	double m_beta2Power;///< beta2 to the power of the number of steps
+	double m_learningRate;
+	double m_beta1;
+	double m_beta2;
+	double m_epsilon;
+};
+
+}
+#endif
@@ -47,6 +47,41 @@
 namespace shark{
 
 
+/// \brief Variants of the k-means algorithm for vector-valued data.
+///
+/// \par
+/// All variants compute the same sequence of clusterings as Lloyd's algorithm.
+/// The variants of Hamerly and Elkan keep bounds on the distances between the points
+/// and the centroids. Using the triangle inequality, the bounds allow to skip most
+/// distance computations for points which provably keep their cluster.
+/// Hamerly's algorithm stores one lower bound per point and works best for a small
+/// number of clusters, Elkan's algorithm stores one lower bound per point and cluster
+/// and skips more computations when there are many clusters.
+enum KMeansAlgorithm{
+	KMeansLloyd, ///< computes all distances in every iteration
+	KMeansHamerly, ///< one upper and one lower bound per point
+	KMeansElkan, ///< one upper bound and k lower bounds per point
+	KMeansAuto ///< Elkan's algorithm for many clusters if the bounds fit in memory, Hamerly's algorithm otherwise
+};
+
+/// \brief Statistics about a run of kMeans.
+struct KMeansStatistics{
+	KMeansStatistics():iterations(0),distanceComputations(0),lloydDistanceComputations(0){}
+
+	/// number of iterations
+	std::size_t iterations;
+	/// number of point-centroid distances that were computed
+	std::size_t distanceComputations;
+	/// number of point-centroid distances Lloyd's algorithm computes for the same iterations
+	std::size_t lloydDistanceComputations;
+
+	/// fraction of the distance computations of Lloyd's algorithm that was saved by the bounds
+	double savedDistanceFraction()const{
+		if(lloydDistanceComputations == 0) return 0.0;
+		return 1.0 - double(distanceComputations)/lloydDistanceComputations;
+	}
+};
+
 ///
 /// \brief The k-means clustering algorithm.
 ///
@@ -61,21 +96,30 @@ namespace shark{
 /// \par
 /// This implementation starts the search with the given centroids,
 /// in case the provided centroids object (third parameter) contains
-/// a set of k centroids. Otherwise the search starts from the first
-/// k data points.
+/// a set of k centroids. Otherwise the centroids are initialized
+/// by k-means++ seeding, see Centroids::initFromData.
 ///
 /// \par
 /// Note that the data set needs to include at least k data points
 /// for k-means to work. This is because the current implementation
 /// does not allow for empty clusters.
 ///
+/// \par
+/// By default, distance computations are avoided using the bounds of Hamerly or Elkan,
+/// see KMeansAlgorithm. The batches of the data set are processed in parallel.
+///
 /// \param data           vector-valued data to be clustered
 /// \param k              number of clusters
 /// \param centroids      centroids input/output
 /// \param maxIterations  maximum number of k-means iterations; 0: unlimited
+/// \param algorithm      variant of the algorithm
+/// \param statistics     if not 0, receives the number of iterations and distance computations
 /// \return               number of k-means iterations
 ///
-std::size_t kMeans(Data<RealVector> const& data, std::size_t k, Centroids& centroids, std::size_t maxIterations = 0);
+std::size_t kMeans(
+	Data<RealVector> const& data, std::size_t k, Centroids& centroids, std::size_t maxIterations = 0,
+	KMeansAlgorithm algorithm = KMeansAuto, KMeansStatistics* statistics = 0
+);
 
 template<class InputType>
 KernelExpansion<InputType> kMeans(Data<InputType> const& dataset, std::size_t k, AbstractKernelFunction<InputType>& kernel, std::size_t maxIterations = 0){
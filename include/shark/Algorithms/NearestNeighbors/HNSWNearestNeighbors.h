@@ -0,0 +1,468 @@
+//===========================================================================
+/*!
+*
+*  \brief Approximate nearest neighbors using a hierarchical navigable small world graph.
+*
+*
+*  <BR><HR>
+*  This file is part of Shark. This library is free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  GNU General Public License as published by the Free Software
+*  Foundation; either version 3, or (at your option) any later version.
+*
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this library; if not, see <http://www.gnu.org/licenses/>.
+*
+*/
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_NEARESTNEIGHBORS_HNSWNEARESTNEIGHBORS_H
+#define SHARK_ALGORITHMS_NEARESTNEIGHBORS_HNSWNEARESTNEIGHBORS_H
+
+#include <shark/Algorithms/NearestNeighbors/AbstractNearestNeighbors.h>
+#include <shark/Core/ISerializable.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Rng/GlobalRng.h>
+#include <shark/LinAlg/Base.h>
+
+#include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+namespace shark {
+
+
+///\brief Approximate nearest neighbors using a hierarchical navigable small world graph (HNSW).
+///
+///The points of the dataset are the nodes of a layered graph (Y. A. Malkov and D. A. Yashunin,
+///Efficient and robust approximate nearest neighbor search using Hierarchical Navigable Small World graphs, 2016).
+///Every node is assigned to a random number of layers, with exponentially fewer nodes in
+///every higher layer. In every layer, a node is linked to close nodes in the same layer.
+///A query descends greedily from the single node of the top layer to the bottom layer and
+///then runs a best-first search in the bottom layer which keeps the efSearch best candidates.
+///Unlike tree based searches, the number of visited nodes depends only weakly on the
+///dimensionality of the data and grows logarithmically with the number of points.
+///
+///The search is approximate: larger values of efSearch give a higher recall for the price of
+///a higher query time. efSearch can be changed at any time, while efConstruction and the maximum
+///number of links per node determine the quality of the graph and are fixed at construction.
+///
+///The graph is built in parallel: the neighbors of a block of new nodes are searched concurrently
+///in the existing graph, afterwards the block is linked into the graph. The nodes of the same block
+///are considered as neighbors of each other. The blocks have a fixed size, so the graph does not
+///depend on the number of threads.
+///Distances are squared euclidean distances as in SimpleNearestNeighbors with a linear kernel.
+///For fast random access, the index keeps a copy of the inputs in a single batch.
+template<class InputType, class LabelType>
+class HNSWNearestNeighbors:public AbstractNearestNeighbors<InputType,LabelType>, public ISerializable{
+private:
+	typedef AbstractNearestNeighbors<InputType,LabelType> base_type;
+public:
+	typedef LabeledData<InputType, LabelType> Dataset;
+	typedef typename base_type::DistancePair DistancePair;
+	typedef typename Batch<InputType>::type BatchInputType;
+
+	///\brief Creates an empty index, which can be read from an archive.
+	HNSWNearestNeighbors()
+	: m_maxLinks(16), m_efConstruction(200), m_efSearch(50), m_entryPoint(0), m_maxLevel(0){}
+
+	///\brief Builds the graph of the dataset.
+	///
+	///\param dataset         the points and labels to search
+	///\param maxLinks        number of links of a node in the higher layers, nodes in the bottom layer have twice as many
+	///\param efConstruction  number of candidates kept by the search for the neighbors of a new node
+	HNSWNearestNeighbors(Dataset const& dataset, std::size_t maxLinks = 16, std::size_t efConstruction = 200)
+	: m_maxLinks(maxLinks), m_efConstruction(efConstruction), m_efSearch(50), m_entryPoint(0), m_maxLevel(0){
+		SHARK_CHECK(maxLinks >= 2, "[HNSWNearestNeighbors] nodes need at least two links");
+		setDataset(dataset);
+		buildGraph();
+	}
+
+	///\brief Number of candidates kept by the search of a query.
+	std::size_t efSearch()const{
+		return m_efSearch;
+	}
+	///\brief Sets the number of candidates kept by the search of a query, at least k candidates are used.
+	void setEfSearch(std::size_t ef){
+		m_efSearch = ef;
+	}
+
+	std::size_t maxLinks()const{
+		return m_maxLinks;
+	}
+	std::size_t efConstruction()const{
+		return m_efConstruction;
+	}
+
+	///\brief returns the k nearest neighbors of the points
+	///
+	///The points are processed in parallel. If the search in the graph reaches fewer than k
+	///nodes, the neighbors of the point are found by comparing it to all nodes.
+	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k)const{
+		std::size_t numPatterns = shark::size(patterns);
+		SIZE_CHECK(k <= m_labels.size());
+		std::vector<DistancePair> results(k*numPatterns);
+		SHARK_PARALLEL_FOR(int p = 0; p < (int)numPatterns; ++p){
+			InputType point = get(patterns,p);
+			boost::shared_ptr<VisitedSet> visited = acquireVisitedSet();
+			std::vector<Candidate> neighbors = search(point, std::max(k,m_efSearch), *visited);
+			releaseVisitedSet(visited);
+			if(neighbors.size() < k)
+				neighbors = exhaustiveSearch(point, k);
+			for(std::size_t i = 0; i != k; ++i){
+				results[i+p*k].key = neighbors[i].first;
+				results[i+p*k].value = m_labels[neighbors[i].second];
+			}
+		}
+		return results;
+	}
+
+	LabeledData<InputType,LabelType>const& dataset()const {
+		return m_dataset;
+	}
+
+	/// from ISerializable
+	void read(InArchive& archive){
+		archive & m_maxLinks;
+		archive & m_efConstruction;
+		archive & m_efSearch;
+		archive & m_entryPoint;
+		archive & m_maxLevel;
+		archive & m_links;
+		Dataset dataset;
+		archive & dataset;
+		setDataset(dataset);
+	}
+
+	/// from ISerializable
+	void write(OutArchive& archive) const{
+		archive & m_maxLinks;
+		archive & m_efConstruction;
+		archive & m_efSearch;
+		archive & m_entryPoint;
+		archive & m_maxLevel;
+		archive & m_links;
+		archive & m_dataset;
+	}
+
+private:
+	///\brief squared distance to a node and the index of the node
+	typedef std::pair<double, unsigned int> Candidate;
+	typedef std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > ClosestFirstQueue;
+	typedef std::priority_queue<Candidate> FarthestFirstQueue;
+	typedef typename boost::is_same<InputType,RealVector>::type IsDense;
+
+	///\brief Marks visited nodes. Marks are invalidated by increasing the generation.
+	class VisitedSet{
+	public:
+		VisitedSet(std::size_t size):m_marks(size,0),m_generation(0){}
+		void clear(){
+			if(++m_generation == 0){
+				std::fill(m_marks.begin(),m_marks.end(),0);
+				m_generation = 1;
+			}
+		}
+		///\brief marks the node and returns true if it was not visited before
+		bool visit(unsigned int node){
+			if(m_marks[node] == m_generation) return false;
+			m_marks[node] = m_generation;
+			return true;
+		}
+	private:
+		std::vector<unsigned int> m_marks;
+		unsigned int m_generation;
+	};
+
+	void setDataset(Dataset const& dataset){
+		m_dataset = dataset;
+		m_points = createBatch<InputType>(dataset.inputs().elements());
+		m_labels.assign(dataset.labels().elements().begin(),dataset.labels().elements().end());
+		m_visitedPool.clear();
+	}
+
+	///\brief Maximum number of links of a node in a layer.
+	std::size_t maxLinks(std::size_t level)const{
+		return level == 0? 2*m_maxLinks : m_maxLinks;
+	}
+
+	static double denseDistanceSqr(double const* x, double const* y, std::size_t size){
+		double sum0 = 0, sum1 = 0;
+		std::size_t i = 0;
+		for(; i+2 <= size; i += 2){
+			double diff0 = x[i]-y[i];
+			double diff1 = x[i+1]-y[i+1];
+			sum0 += diff0*diff0;
+			sum1 += diff1*diff1;
+		}
+		if(i != size)
+			sum0 += (x[i]-y[i])*(x[i]-y[i]);
+		return sum0+sum1;
+	}
+
+	double distanceToNode(InputType const& point, unsigned int node)const{
+		return distanceToNode(point,node,IsDense());
+	}
+	double distanceToNode(InputType const& point, unsigned int node, boost::true_type)const{
+		if(point.size() == 0) return 0;
+		return denseDistanceSqr(&point(0), &m_points(node,0), point.size());
+	}
+	double distanceToNode(InputType const& point, unsigned int node, boost::false_type)const{
+		return distanceSqr(point, row(m_points,node));
+	}
+
+	double nodeDistance(unsigned int node1, unsigned int node2)const{
+		return nodeDistance(node1,node2,IsDense());
+	}
+	double nodeDistance(unsigned int node1, unsigned int node2, boost::true_type)const{
+		if(m_points.size2() == 0) return 0;
+		return denseDistanceSqr(&m_points(node1,0), &m_points(node2,0), m_points.size2());
+	}
+	double nodeDistance(unsigned int node1, unsigned int node2, boost::false_type)const{
+		return distanceSqr(row(m_points,node1), row(m_points,node2));
+	}
+
+	boost::shared_ptr<VisitedSet> acquireVisitedSet()const{
+		boost::shared_ptr<VisitedSet> visited;
+		SHARK_CRITICAL_REGION{
+			if(!m_visitedPool.empty()){
+				visited = m_visitedPool.back();
+				m_visitedPool.pop_back();
+			}
+		}
+		if(!visited)
+			visited.reset(new VisitedSet(m_labels.size()));
+		return visited;
+	}
+	void releaseVisitedSet(boost::shared_ptr<VisitedSet> const& visited)const{
+		SHARK_CRITICAL_REGION{
+			m_visitedPool.push_back(visited);
+		}
+	}
+
+	///\brief Moves to the closest neighbor in the layer until no neighbor is closer to the point.
+	Candidate greedySearch(InputType const& point, Candidate current, std::size_t level)const{
+		bool changed = true;
+		while(changed){
+			changed = false;
+			std::vector<unsigned int> const& links = m_links[current.second][level];
+			for(std::size_t i = 0; i != links.size(); ++i){
+				double distance = distanceToNode(point,links[i]);
+				if(distance < current.first){
+					current = Candidate(distance,links[i]);
+					changed = true;
+				}
+			}
+		}
+		return current;
+	}
+
+	///\brief Best-first search in a layer which keeps the ef closest nodes found, returned in ascending order.
+	std::vector<Candidate> searchLayer(
+		InputType const& point, std::vector<Candidate> const& entryPoints,
+		std::size_t ef, std::size_t level, VisitedSet& visited
+	)const{
+		visited.clear();
+		ClosestFirstQueue candidates;
+		FarthestFirstQueue results;
+		for(std::size_t i = 0; i != entryPoints.size(); ++i){
+			visited.visit(entryPoints[i].second);
+			candidates.push(entryPoints[i]);
+			results.push(entryPoints[i]);
+		}
+		while(results.size() > ef) results.pop();
+		while(!candidates.empty()){
+			Candidate current = candidates.top();
+			if(current.first > results.top().first && results.size() >= ef)
+				break;
+			candidates.pop();
+			std::vector<unsigned int> const& links = m_links[current.second][level];
+			for(std::size_t i = 0; i != links.size(); ++i){
+				unsigned int node = links[i];
+				if(!visited.visit(node)) continue;
+				double distance = distanceToNode(point,node);
+				if(results.size() < ef || distance < results.top().first){
+					candidates.push(Candidate(distance,node));
+					results.push(Candidate(distance,node));
+					if(results.size() > ef)
+						results.pop();
+				}
+			}
+		}
+		std::vector<Candidate> closest(results.size());
+		for(std::size_t i = closest.size(); i != 0; --i){
+			closest[i-1] = results.top();
+			results.pop();
+		}
+		return closest;
+	}
+
+	///\brief Searches the ef closest nodes of a point in the bottom layer.
+	std::vector<Candidate> search(InputType const& point, std::size_t ef, VisitedSet& visited)const{
+		Candidate current(distanceToNode(point,m_entryPoint),m_entryPoint);
+		for(std::size_t level = m_maxLevel; level != 0; --level)
+			current = greedySearch(point,current,level);
+		return searchLayer(point,std::vector<Candidate>(1,current),ef,0,visited);
+	}
+
+	///\brief Returns the k closest nodes of a point in ascending order by comparing it to all nodes.
+	std::vector<Candidate> exhaustiveSearch(InputType const& point, std::size_t k)const{
+		std::vector<Candidate> candidates(m_labels.size());
+		for(std::size_t node = 0; node != candidates.size(); ++node)
+			candidates[node] = Candidate(distanceToNode(point,(unsigned int)node),(unsigned int)node);
+		std::partial_sort(candidates.begin(),candidates.begin()+k,candidates.end());
+		candidates.resize(k);
+		return candidates;
+	}
+
+	///\brief Chooses at most maxNeighbors of the candidates, sorted by distance, as neighbors of a new node.
+	///
+	///A candidate is skipped if it is closer to an already chosen neighbor than to the new node.
+	///This keeps links in all directions and connects clusters, see the HNSW paper.
+	std::vector<Candidate> selectNeighbors(std::vector<Candidate> const& candidates, std::size_t maxNeighbors)const{
+		std::vector<Candidate> selected;
+		for(std::size_t i = 0; i != candidates.size() && selected.size() != maxNeighbors; ++i){
+			bool keep = true;
+			for(std::size_t j = 0; j != selected.size() && keep; ++j){
+				keep = nodeDistance(candidates[i].second,selected[j].second) >= candidates[i].first;
+			}
+			if(keep)
+				selected.push_back(candidates[i]);
+		}
+		return selected;
+	}
+
+	///\brief Adds a link to a node in a layer. If the node has too many links, the farthest link is dropped.
+	void addLink(
+		unsigned int node, Candidate const& link, std::size_t level,
+		std::vector<std::vector<std::vector<double> > >& linkDistances
+	){
+		std::vector<unsigned int>& links = m_links[node][level];
+		std::vector<double>& distances = linkDistances[node][level];
+		if(links.size() < maxLinks(level)){
+			links.push_back(link.second);
+			distances.push_back(link.first);
+			return;
+		}
+		std::size_t farthest = std::max_element(distances.begin(),distances.end())-distances.begin();
+		if(link.first < distances[farthest]){
+			links[farthest] = link.second;
+			distances[farthest] = link.first;
+		}
+	}
+
+	void buildGraph(){
+		std::size_t n = m_labels.size();
+		m_links.assign(n,std::vector<std::vector<unsigned int> >());
+		if(n == 0) return;
+		//distances of the links, needed to drop the farthest link of a node
+		std::vector<std::vector<std::vector<double> > > linkDistances(n);
+
+		//draw the layers of the nodes, the probability of a node to reach the next layer is 1/maxLinks
+		double levelFactor = 1.0/std::log(double(m_maxLinks));
+		std::vector<std::size_t> levels(n);
+		for(std::size_t i = 0; i != n; ++i){
+			levels[i] = std::min<std::size_t>(std::size_t(-std::log(1.0-Rng::uni(0,1))*levelFactor),31);
+			m_links[i].resize(levels[i]+1);
+			linkDistances[i].resize(levels[i]+1);
+		}
+		m_entryPoint = 0;
+		m_maxLevel = levels[0];
+
+		std::size_t numThreads = SHARK_NUM_THREADS;
+		std::vector<boost::shared_ptr<VisitedSet> > visitedSets(numThreads);
+		for(std::size_t t = 0; t != numThreads; ++t)
+			visitedSets[t].reset(new VisitedSet(n));
+		//the block size does not depend on the number of threads, so that the graph does not either
+		std::size_t const maxBlockSize = 64;
+		std::size_t inserted = 1;
+		while(inserted != n){
+			//the first blocks are small, so that the nodes of a block have a graph to search in
+			std::size_t blockSize = std::min(std::min(n-inserted, inserted),maxBlockSize);
+			//selected[j][l] are the neighbors of the j-th new node in layer l
+			std::vector<std::vector<std::vector<Candidate> > > selected(blockSize);
+			SHARK_PARALLEL_FOR_DYNAMIC(int j = 0; j < (int)blockSize; ++j){
+				selected[j] = findNeighbors(inserted, j, levels, *visitedSets[SHARK_THREAD_NUM]);
+			}
+			for(std::size_t j = 0; j != blockSize; ++j){
+				unsigned int node = (unsigned int)(inserted+j);
+				for(std::size_t level = 0; level != selected[j].size(); ++level){
+					std::vector<Candidate> const& neighbors = selected[j][level];
+					for(std::size_t i = 0; i != neighbors.size(); ++i){
+						m_links[node][level].push_back(neighbors[i].second);
+						linkDistances[node][level].push_back(neighbors[i].first);
+						addLink(neighbors[i].second, Candidate(neighbors[i].first,node), level, linkDistances);
+					}
+				}
+				if(levels[node] > m_maxLevel){
+					m_maxLevel = levels[node];
+					m_entryPoint = node;
+				}
+			}
+			inserted += blockSize;
+		}
+	}
+
+	///\brief Finds the neighbors of the j-th node of the block starting at blockStart in all its layers.
+	std::vector<std::vector<Candidate> > findNeighbors(
+		std::size_t blockStart, std::size_t j,
+		std::vector<std::size_t> const& levels, VisitedSet& visited
+	)const{
+		unsigned int node = (unsigned int)(blockStart+j);
+		InputType point = row(m_points,node);
+		std::size_t nodeLevel = levels[node];
+		std::vector<std::vector<Candidate> > neighbors(nodeLevel+1);
+
+		Candidate current(distanceToNode(point,m_entryPoint),m_entryPoint);
+		for(std::size_t level = m_maxLevel; level > nodeLevel; --level)
+			current = greedySearch(point,current,level);
+		std::vector<Candidate> entryPoints(1,current);
+		for(std::size_t level = nodeLevel+1; level != 0; --level){
+			std::vector<Candidate> candidates;
+			if(level-1 <= m_maxLevel){
+				candidates = searchLayer(point,entryPoints,m_efConstruction,level-1,visited);
+				entryPoints = candidates;
+			}
+			//the previous nodes of the block are not yet in the graph
+			for(std::size_t i = 0; i != j; ++i){
+				if(levels[blockStart+i] >= level-1){
+					unsigned int other = (unsigned int)(blockStart+i);
+					candidates.push_back(Candidate(distanceToNode(point,other),other));
+				}
+			}
+			std::sort(candidates.begin(),candidates.end());
+			neighbors[level-1] = selectNeighbors(candidates,m_maxLinks);
+		}
+		return neighbors;
+	}
+
+	Dataset m_dataset;
+	///\brief the inputs of all nodes
+	BatchInputType m_points;
+	///\brief the labels of all nodes
+	std::vector<LabelType> m_labels;
+
+	std::size_t m_maxLinks;
+	std::size_t m_efConstruction;
+	std::size_t m_efSearch;
+	///\brief m_links[node][level] are the neighbors of a node in a layer
+	std::vector<std::vector<std::vector<unsigned int> > > m_links;
+	unsigned int m_entryPoint;
+	std::size_t m_maxLevel;
+
+	///\brief visited sets reused by the queries
+	mutable std::vector<boost::shared_ptr<VisitedSet> > m_visitedPool;
+};
+
+
+}
+#endif
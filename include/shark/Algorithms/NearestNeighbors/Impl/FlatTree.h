@@ -0,0 +1,290 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Contiguous copy of a space-partitioning tree for batched nearest neighbor queries.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#ifndef SHARK_ALGORITHMS_NEARESTNEIGHBORS_IMPL_FLATTREE_H
+#define SHARK_ALGORITHMS_NEARESTNEIGHBORS_IMPL_FLATTREE_H
+
+#include <shark/Models/Trees/BinaryTree.h>
+#include <shark/Data/Dataset.h>
+#include <shark/LinAlg/Base.h>
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace shark{
+namespace detail{
+
+///\brief Space-partitioning tree stored in contiguous arrays.
+///
+///The nodes are stored in depth-first order, such that the left child of a node
+///directly follows it and only the index of the right child is stored. Every field of the
+///nodes is kept in its own array. Instead of the cells of the original tree, every node
+///stores the bounding box of its points, which gives a tighter lower bound on the
+///distance of a query to the points in the node. Sub-trees with at most leafSize points
+///are merged into a single leaf and the points are stored row-wise in the order of the
+///leaves, such that a leaf is a contiguous block of memory.
+///
+///Queries are processed in blocks which traverse the tree together: a node is visited
+///once for all queries of the block which can not exclude it. All memory needed by
+///a search is held by a QueryArena, which can be reused by subsequent searches.
+class FlatTree{
+public:
+	///\brief squared distance of a point and its index in the dataset
+	typedef std::pair<double, std::size_t> Neighbor;
+
+	///\brief Memory used by a search, can be reused between searches.
+	class QueryArena{
+	private:
+		friend class FlatTree;
+		///\brief query of the current block and its lower bound on the distance to the current node
+		typedef std::pair<std::size_t, double> ActiveQuery;
+
+		std::vector<Neighbor> m_neighbors;///< k candidates of every query of the block, organized as max-heaps
+		std::vector<std::size_t> m_found;///< number of candidates of every query
+		std::vector<double> m_worst;///< distance of the k-th candidate or infinity
+		std::vector<ActiveQuery> m_active;///< stack of the queries active in the visited nodes
+	};
+
+	///\brief Copies the structure of the tree and the points of the dataset.
+	///
+	///The tree must have been built for the inputs.
+	FlatTree(BinaryTree<RealVector> const& tree, Data<RealVector> const& inputs, std::size_t leafSize = 16)
+	: m_leafSize(leafSize){
+		SIZE_CHECK(tree.size() == inputs.numberOfElements());
+		m_dimension = dataDimension(inputs);
+		std::size_t size = tree.size();
+		m_points.resize(size, m_dimension);
+		m_indices.resize(size);
+		for(std::size_t i = 0; i != size; ++i){
+			m_indices[i] = tree.index(i);
+			noalias(row(m_points,i)) = inputs.element(m_indices[i]);
+		}
+		addNode(&tree,0);
+	}
+
+	std::size_t numberOfNodes()const{
+		return m_right.size();
+	}
+
+	///\brief Orders the queries such that queries in the same region of space follow each other.
+	///
+	///Every query descends to the leaf with the closest bounding box, the queries are sorted by this leaf.
+	void orderQueries(RealMatrix const& queries, std::vector<std::size_t>& order)const{
+		std::size_t numQueries = queries.size1();
+		std::vector<std::pair<std::size_t, std::size_t> > leaves(numQueries);
+		for(std::size_t q = 0; q != numQueries; ++q){
+			double const* query = rowPointer(queries,q);
+			std::size_t node = 0;
+			while(!isLeaf(node)){
+				std::size_t right = m_right[node];
+				node = boxDistanceSqr(node+1,query) <= boxDistanceSqr(right,query)? node+1: right;
+			}
+			leaves[q] = std::make_pair(node,q);
+		}
+		std::sort(leaves.begin(),leaves.end());
+		order.resize(numQueries);
+		for(std::size_t q = 0; q != numQueries; ++q)
+			order[q] = leaves[q].second;
+	}
+
+	///\brief Finds the k nearest neighbors of a block of queries.
+	///
+	///The neighbors of query queryIndices[i] are stored sorted by distance in
+	///results[queryIndices[i]*k],...,results[queryIndices[i]*k+k-1].
+	void search(
+		RealMatrix const& queries, std::size_t const* queryIndices, std::size_t numQueries,
+		std::size_t k, QueryArena& arena, Neighbor* results
+	)const{
+		SIZE_CHECK(k <= m_indices.size());
+		SIZE_CHECK(queries.size2() == m_dimension);
+		arena.m_neighbors.resize(numQueries*k);
+		arena.m_found.assign(numQueries,0);
+		arena.m_worst.assign(numQueries,std::numeric_limits<double>::infinity());
+		arena.m_active.clear();
+		for(std::size_t i = 0; i != numQueries; ++i){
+			double const* query = rowPointer(queries,queryIndices[i]);
+			arena.m_active.push_back(QueryArena::ActiveQuery(i,boxDistanceSqr(0,query)));
+		}
+		searchNode(0, 0, numQueries, queries, queryIndices, k, arena);
+
+		for(std::size_t i = 0; i != numQueries; ++i){
+			Neighbor* neighbors = &arena.m_neighbors[i*k];
+			std::sort_heap(neighbors, neighbors+k);
+			Neighbor* result = results + queryIndices[i]*k;
+			for(std::size_t j = 0; j != k; ++j){
+				result[j].first = neighbors[j].first;
+				result[j].second = m_indices[neighbors[j].second];
+			}
+		}
+	}
+
+private:
+	typedef QueryArena::ActiveQuery ActiveQuery;
+
+	bool isLeaf(std::size_t node)const{
+		//the root is never a right child, so 0 marks leaves
+		return m_right[node] == 0;
+	}
+
+	static double const* rowPointer(RealMatrix const& matrix, std::size_t i){
+		return matrix.size2() == 0? 0 : &matrix(i,0);
+	}
+
+	///\brief adds the node and its sub-tree and returns its index
+	///
+	///\param tree  node of the original tree
+	///\param begin position of the first point of the node in the tree order
+	std::size_t addNode(BinaryTree<RealVector> const* tree, std::size_t begin){
+		std::size_t node = m_right.size();
+		std::size_t end = begin + tree->size();
+		m_right.push_back(0);
+		m_begin.push_back(begin);
+		m_end.push_back(end);
+		m_lower.resize(m_lower.size()+m_dimension);
+		m_upper.resize(m_upper.size()+m_dimension);
+		if(tree->isLeaf() || tree->size() <= m_leafSize){
+			for(std::size_t d = 0; d != m_dimension; ++d){
+				m_lower[node*m_dimension+d] = m_points(begin,d);
+				m_upper[node*m_dimension+d] = m_points(begin,d);
+			}
+			for(std::size_t i = begin+1; i != end; ++i){
+				for(std::size_t d = 0; d != m_dimension; ++d){
+					m_lower[node*m_dimension+d] = std::min(m_lower[node*m_dimension+d],m_points(i,d));
+					m_upper[node*m_dimension+d] = std::max(m_upper[node*m_dimension+d],m_points(i,d));
+				}
+			}
+			return node;
+		}
+		std::size_t left = addNode(tree->left(), begin);
+		std::size_t right = addNode(tree->right(), begin + tree->left()->size());
+		m_right[node] = right;
+		for(std::size_t d = 0; d != m_dimension; ++d){
+			m_lower[node*m_dimension+d] = std::min(m_lower[left*m_dimension+d],m_lower[right*m_dimension+d]);
+			m_upper[node*m_dimension+d] = std::max(m_upper[left*m_dimension+d],m_upper[right*m_dimension+d]);
+		}
+		return node;
+	}
+
+	///\brief squared distance of the query to the bounding box of the node
+	double boxDistanceSqr(std::size_t node, double const* query)const{
+		double const* lower = &m_lower[node*m_dimension];
+		double const* upper = &m_upper[node*m_dimension];
+		double sum = 0;
+		for(std::size_t d = 0; d != m_dimension; ++d){
+			double diff = std::max(lower[d]-query[d], 0.0) + std::max(query[d]-upper[d], 0.0);
+			sum += diff*diff;
+		}
+		return sum;
+	}
+
+	double pointDistanceSqr(std::size_t point, double const* query)const{
+		double const* x = rowPointer(m_points,point);
+		double sum = 0;
+		for(std::size_t d = 0; d != m_dimension; ++d){
+			double diff = x[d]-query[d];
+			sum += diff*diff;
+		}
+		return sum;
+	}
+
+	///\brief Visits the node with the queries arena.m_active[activeBegin],...,arena.m_active[activeEnd-1]
+	///
+	///The lists of the queries which visit the children are pushed on top of the active stack
+	///and removed when the children are finished.
+	void searchNode(
+		std::size_t node, std::size_t activeBegin, std::size_t activeEnd,
+		RealMatrix const& queries, std::size_t const* queryIndices,
+		std::size_t k, QueryArena& arena
+	)const{
+		if(isLeaf(node)){
+			for(std::size_t a = activeBegin; a != activeEnd; ++a){
+				std::size_t i = arena.m_active[a].first;
+				double const* query = rowPointer(queries,queryIndices[i]);
+				Neighbor* neighbors = &arena.m_neighbors[i*k];
+				for(std::size_t p = m_begin[node]; p != m_end[node]; ++p){
+					double distance = pointDistanceSqr(p,query);
+					if(distance >= arena.m_worst[i]) continue;
+					if(arena.m_found[i] == k){
+						std::pop_heap(neighbors, neighbors+k);
+						neighbors[k-1] = Neighbor(distance,p);
+						std::push_heap(neighbors, neighbors+k);
+					}else{
+						neighbors[arena.m_found[i]] = Neighbor(distance,p);
+						++arena.m_found[i];
+						std::push_heap(neighbors, neighbors+arena.m_found[i]);
+					}
+					if(arena.m_found[i] == k)
+						arena.m_worst[i] = neighbors[0].first;
+				}
+			}
+			return;
+		}
+
+		//compute the bounds of both children, queries go first to the child which is closer to most of them
+		std::size_t children[2] = {node+1, m_right[node]};
+		std::size_t listStart = arena.m_active.size();
+		double sum[2] = {0,0};
+		for(std::size_t a = activeBegin; a != activeEnd; ++a){
+			std::size_t i = arena.m_active[a].first;
+			double const* query = rowPointer(queries,queryIndices[i]);
+			double leftBound = boxDistanceSqr(children[0],query);
+			double rightBound = boxDistanceSqr(children[1],query);
+			sum[0] += std::min(leftBound, arena.m_worst[i]);
+			sum[1] += std::min(rightBound, arena.m_worst[i]);
+			arena.m_active.push_back(ActiveQuery(i,leftBound));
+			arena.m_active.push_back(ActiveQuery(i,rightBound));
+		}
+		std::size_t first = sum[1] < sum[0]? 1 : 0;
+		std::size_t numActive = activeEnd - activeBegin;
+		for(std::size_t c = 0; c != 2; ++c){
+			std::size_t child = c == 0? first: 1-first;
+			//collect the queries which can not exclude the child,
+			//the bounds of the children are interleaved at the start of the list
+			std::size_t childBegin = arena.m_active.size();
+			for(std::size_t j = 0; j != numActive; ++j){
+				ActiveQuery query = arena.m_active[listStart+2*j+child];
+				if(query.second < arena.m_worst[query.first])
+					arena.m_active.push_back(query);
+			}
+			std::size_t childEnd = arena.m_active.size();
+			if(childBegin != childEnd)
+				searchNode(children[child], childBegin, childEnd, queries, queryIndices, k, arena);
+			arena.m_active.resize(childBegin);
+		}
+		arena.m_active.resize(listStart);
+	}
+
+	std::size_t m_leafSize;
+	std::size_t m_dimension;
+
+	RealMatrix m_points;///< points of the dataset in the order of the leaves
+	std::vector<std::size_t> m_indices;///< index in the dataset of every row of m_points
+
+	std::vector<std::size_t> m_right;///< index of the right child, 0 for leaves
+	std::vector<std::size_t> m_begin;///< first point of the node
+	std::vector<std::size_t> m_end;///< end of the points of the node
+	std::vector<double> m_lower;///< lower corners of the bounding boxes, m_dimension values per node
+	std::vector<double> m_upper;///< upper corners of the bounding boxes, m_dimension values per node
+};
+
+}}
+#endif
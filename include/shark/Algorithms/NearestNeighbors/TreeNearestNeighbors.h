@@ -29,8 +29,12 @@
 
 
 #include <boost/intrusive/rbtree.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits/is_same.hpp>
 #include <shark/Models/Trees/BinaryTree.h>
 #include <shark/Algorithms/NearestNeighbors/AbstractNearestNeighbors.h>
+#include <shark/Algorithms/NearestNeighbors/Impl/FlatTree.h>
+#include <shark/Core/OpenMP.h>
 #include <shark/Data/DataView.h>
 namespace shark {
 
@@ -397,6 +401,13 @@ private:
 ///\brief Nearest Neighbors implementation using binary trees
 ///
 /// Returns the labels and distances of the k nearest neighbors of a point.
+///
+/// For real valued vectors and trees using the euclidean metric, e.g. the KDTree and LCTree,
+/// the tree is copied into contiguous arrays with the bounding boxes of the points of every node.
+/// The queries of a batch are sorted by their position in the tree and processed in blocks, where
+/// all queries of a block traverse the tree together. Blocks are processed in parallel and
+/// reuse the memory of previous searches, so that a search does not allocate memory
+/// once the first batches are processed. Other trees are searched point by point with an IterativeNNQuery.
 template<class InputType, class LabelType>
 class TreeNearestNeighbors:public AbstractNearestNeighbors<InputType,LabelType>
 {
@@ -411,10 +422,58 @@ public:
 
 	TreeNearestNeighbors(Dataset const& dataset, Tree const* tree)
 	: m_dataset(dataset), m_inputs(dataset.inputs()), m_labels(dataset.labels()),mep_tree(tree)
-	{ }
+	{
+		if(tree->kernel() == NULL)
+			createFlatTree(IsDense());
+	}
 
-	///\brief returns the k nearest neighbors of the point
+	///\brief returns the k nearest neighbors of the points
 	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k)const{
+		return getNeighbors(patterns, k, IsDense());
+	}
+
+	LabeledData<InputType,LabelType>const& dataset()const {
+		return m_dataset;
+	}
+
+private:
+	typedef typename boost::is_same<InputType,RealVector>::type IsDense;
+	typedef detail::FlatTree::QueryArena QueryArena;
+
+	/// number of queries traversing the tree together
+	static std::size_t const queryBlockSize = 32;
+
+	void createFlatTree(boost::true_type){
+		mp_flatTree.reset(new detail::FlatTree(*mep_tree,m_dataset.inputs()));
+	}
+	void createFlatTree(boost::false_type){}
+
+	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k, boost::true_type)const{
+		if(!mp_flatTree)
+			return getNeighbors(patterns, k, boost::false_type());
+		std::size_t numPoints = shark::size(patterns);
+		if(k == 0)
+			return std::vector<DistancePair>();
+		std::vector<std::size_t> order;
+		mp_flatTree->orderQueries(patterns, order);
+		std::vector<detail::FlatTree::Neighbor> neighbors(k*numPoints);
+		std::size_t numBlocks = (numPoints+queryBlockSize-1)/queryBlockSize;
+		SHARK_PARALLEL_FOR(int block = 0; block < (int)numBlocks; ++block){
+			std::size_t start = block*queryBlockSize;
+			std::size_t end = std::min(start+queryBlockSize, numPoints);
+			boost::shared_ptr<QueryArena> arena = acquireArena();
+			mp_flatTree->search(patterns, &order[start], end-start, k, *arena, &neighbors[0]);
+			releaseArena(arena);
+		}
+		std::vector<DistancePair> results(k*numPoints);
+		for(std::size_t i = 0; i != results.size(); ++i){
+			results[i].key = std::sqrt(neighbors[i].first);
+			results[i].value = m_labels[neighbors[i].second];
+		}
+		return results;
+	}
+
+	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k, boost::false_type)const{
 		std::size_t numPoints = shark::size(patterns);
 		std::vector<DistancePair> results(k*numPoints);
 		for(std::size_t p = 0; p != numPoints; ++p){
@@ -429,16 +488,30 @@ public:
 		return results;
 	}
 
-	LabeledData<InputType,LabelType>const& dataset()const {
-		return m_dataset;
+	boost::shared_ptr<QueryArena> acquireArena()const{
+		boost::shared_ptr<QueryArena> arena;
+		SHARK_CRITICAL_REGION{
+			if(!m_arenaPool.empty()){
+				arena = m_arenaPool.back();
+				m_arenaPool.pop_back();
+			}
+		}
+		if(!arena)
+			arena.reset(new QueryArena());
+		return arena;
+	}
+	void releaseArena(boost::shared_ptr<QueryArena> const& arena)const{
+		SHARK_CRITICAL_REGION{
+			m_arenaPool.push_back(arena);
+		}
 	}
 
-private:
 	Dataset const& m_dataset;
 	DataView<Data<InputType> const> m_inputs;
 	DataView<Data<LabelType> const> m_labels;
 	Tree const* mep_tree;
-	
+	boost::shared_ptr<detail::FlatTree> mp_flatTree;
+	mutable std::vector<boost::shared_ptr<QueryArena> > m_arenaPool;
 };
 
 
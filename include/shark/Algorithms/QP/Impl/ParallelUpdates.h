@@ -0,0 +1,166 @@
+/*!
+ *  \brief Parallel gradient updates and working set reductions of the decomposition solvers
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_ALGORITHMS_QP_IMPL_PARALLELUPDATES_H
+#define SHARK_ALGORITHMS_QP_IMPL_PARALLELUPDATES_H
+
+#include <shark/LinAlg/Base.h>
+#include <shark/Core/OpenMP.h>
+#include <vector>
+#include <algorithm>
+
+namespace shark{
+
+namespace detail{
+inline std::size_t& qpParallelThresholdStorage(){
+	static std::size_t threshold = 20000;
+	return threshold;
+}
+}
+
+/// \brief Number of variables from which on the loops of the decomposition solvers over the variables are run in parallel.
+///
+/// A single pass over the gradient takes only a few microseconds for smaller problems,
+/// which is not enough to pay for starting the threads. The default of 20000 variables
+/// suits current desktop machines, the best value depends on the number of cores and
+/// the memory bandwidth. The solution does not depend on the threshold.
+inline std::size_t qpParallelThreshold(){
+	return detail::qpParallelThresholdStorage();
+}
+
+/// \brief Sets the number of variables from which on the loops of the decomposition solvers are run in parallel.
+///
+/// The threshold is shared by all solvers and must not be changed while a solver is running.
+inline void setQpParallelThreshold(std::size_t threshold){
+	detail::qpParallelThresholdStorage() = threshold;
+}
+
+namespace detail{
+
+/// \brief Number of blocks a loop over the given number of variables is split into.
+inline std::size_t qpNumberOfBlocks(std::size_t size){
+	if(size < qpParallelThreshold())
+		return 1;
+	return SHARK_NUM_THREADS;
+}
+
+/// \brief Start of the block b when a range of variables is split into the given number of blocks.
+inline std::size_t qpBlockStart(std::size_t begin, std::size_t end, std::size_t block, std::size_t blocks){
+	return begin + block*(end-begin)/blocks;
+}
+
+template<class QpFloatType>
+void subtractScaledRowBlock(double* gradient, double factor, QpFloatType const* q, std::size_t begin, std::size_t end){
+	for(std::size_t a = begin; a < end; a++)
+		gradient[a] -= factor * q[a];
+}
+
+/// \brief Computes gradient(a) -= factor * q[a] for all a in [begin,end).
+template<class QpFloatType>
+void subtractScaledRow(RealVector& gradient, double factor, QpFloatType const* q, std::size_t begin, std::size_t end){
+	if(begin >= end) return;
+	double* g = &gradient(0);
+	std::size_t blocks = qpNumberOfBlocks(end-begin);
+	if(blocks == 1){
+		subtractScaledRowBlock(g, factor, q, begin, end);
+		return;
+	}
+	SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b){
+		subtractScaledRowBlock(g, factor, q, qpBlockStart(begin,end,b,blocks), qpBlockStart(begin,end,b+1,blocks));
+	}
+}
+
+template<class QpFloatType>
+void updateGradientSMOBlock(double* gradient, double step, QpFloatType const* qi, QpFloatType const* qj, std::size_t begin, std::size_t end){
+	for(std::size_t a = begin; a < end; a++)
+		gradient[a] -= step * qi[a] - step * qj[a];
+}
+
+/// \brief Computes the change of the gradient of an SMO step, gradient(a) -= step * qi[a] - step * qj[a] for all a < end.
+template<class QpFloatType>
+void updateGradientSMO(RealVector& gradient, double step, QpFloatType const* qi, QpFloatType const* qj, std::size_t end){
+	if(end == 0) return;
+	double* g = &gradient(0);
+	std::size_t blocks = qpNumberOfBlocks(end);
+	if(blocks == 1){
+		updateGradientSMOBlock(g, step, qi, qj, 0, end);
+		return;
+	}
+	SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b){
+		updateGradientSMOBlock(g, step, qi, qj, qpBlockStart(0,end,b,blocks), qpBlockStart(0,end,b+1,blocks));
+	}
+}
+
+/// \brief Largest gradient of the variables which can be increased and smallest gradient of the variables which can be decreased.
+struct GradientExtremes{
+	double largestUp;
+	std::size_t up;///< index of the largest gradient of a variable which is not at the upper bound
+	double smallestDown;
+	std::size_t down;///< index of the smallest gradient of a variable which is not at the lower bound
+
+	GradientExtremes(std::size_t i, std::size_t j)
+	: largestUp(-1e100), up(i), smallestDown(1e100), down(j){}
+
+	/// \brief Merges the extremes of the following variables, ties are resolved in favour of the smaller index.
+	void merge(GradientExtremes const& other){
+		if(other.largestUp > largestUp){
+			largestUp = other.largestUp;
+			up = other.up;
+		}
+		if(other.smallestDown < smallestDown){
+			smallestDown = other.smallestDown;
+			down = other.down;
+		}
+	}
+};
+
+template<class Problem>
+void findGradientExtremesBlock(Problem const& problem, std::size_t begin, std::size_t end, GradientExtremes& extremes){
+	for (std::size_t a = begin; a < end; a++){
+		double ga = problem.gradient(a);
+		if (!problem.isUpperBound(a) && ga > extremes.largestUp){
+			extremes.largestUp = ga;
+			extremes.up = a;
+		}
+		if (!problem.isLowerBound(a) && ga < extremes.smallestDown){
+			extremes.smallestDown = ga;
+			extremes.down = a;
+		}
+	}
+}
+
+/// \brief Finds the gradient extremes of the active variables. The indices of extremes are kept if no variable can be moved.
+template<class Problem>
+void findGradientExtremes(Problem const& problem, GradientExtremes& extremes){
+	std::size_t active = problem.active();
+	std::size_t blocks = qpNumberOfBlocks(active);
+	if(blocks == 1){
+		findGradientExtremesBlock(problem, 0, active, extremes);
+		return;
+	}
+	std::vector<GradientExtremes> partial(blocks, extremes);
+	SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b){
+		findGradientExtremesBlock(problem, qpBlockStart(0,active,b,blocks), qpBlockStart(0,active,b+1,blocks), partial[b]);
+	}
+	for(std::size_t b = 0; b != blocks; ++b)
+		extremes.merge(partial[b]);
+}
+
+}}
+#endif
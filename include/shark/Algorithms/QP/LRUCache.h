@@ -42,6 +42,10 @@ namespace shark{
 /// cache lines need to be freed. This cache uss an Least-Rcently-Used strategy. The cache maintains
 /// a list. Everytime a cacheline is accessed, it moves to the front of the list. When a line is freed
 /// the end of the list is chosen.
+///
+/// The cache counts the requests of lines which could be answered from the cache (hits), the requests
+/// which needed to create or extend a line (misses) and the number of lines which were freed to make room
+/// for other lines (evictions).
 template<class T>
 class LRUCache{
 	/// cache data held for every example
@@ -56,7 +60,10 @@ public:
 	LRUCache(std::size_t lines, std::size_t cachesize = 0x4000000)
 	: m_cacheEntry(lines)
 	, m_cacheSize( 0 )
-	, m_maxSize( cachesize ){}
+	, m_maxSize( cachesize )
+	, m_hits( 0 )
+	, m_misses( 0 )
+	, m_evictions( 0 ){}
 	
 	~LRUCache(){
 		clear();
@@ -84,13 +91,19 @@ public:
 	T* getCacheLine(std::size_t i, std::size_t size){
 		CacheEntry& entry = m_cacheEntry[i];
 		//if the is cached, we push it to the front
-		if(!isCached(i))
+		if(!isCached(i)){
+			++m_misses;
 			cacheCreateRow(entry,size);
+		}
 		else{
-			if(entry.length >= size)
+			if(entry.length >= size){
+				++m_hits;
 				cacheRedeclareNewest(entry);
-			else
+			}
+			else{
+				++m_misses;
 				resizeLine(entry,size);
+			}
 		}
 		return entry.data;
 	}
@@ -184,9 +197,36 @@ public:
 		return m_maxSize;
 	}
 	
+	///\brief Appends the indices of all cached lines to the vector, starting with the most recently used line.
+	void cachedLineIndices(std::vector<std::size_t>& indices)const{
+		typedef typename boost::intrusive::list<CacheEntry>::const_iterator Iterator;
+		for(Iterator iter = m_lruList.begin(); iter != m_lruList.end(); ++iter)
+			indices.push_back(&(*iter)-&m_cacheEntry[0]);
+	}
+	
+	///\brief Number of requests of lines which were cached with sufficient length.
+	std::size_t hits()const{
+		return m_hits;
+	}
+	///\brief Number of requests of lines which had to be created or extended.
+	std::size_t misses()const{
+		return m_misses;
+	}
+	///\brief Number of lines which were freed to make room for other lines.
+	std::size_t evictions()const{
+		return m_evictions;
+	}
+	///\brief Sets the hit, miss and eviction counters to zero.
+	void resetStatistics(){
+		m_hits = 0;
+		m_misses = 0;
+		m_evictions = 0;
+	}
+	
 	///\brief empty cache
 	void clear(){
-		ensureFreeMemory(m_maxSize);
+		while(!m_lruList.empty())
+			cacheRemoveRow(m_lruList.back());
 	}
 private:
 	/// \brief Pushes a cached entry to the bginning of the lru-list
@@ -235,6 +275,7 @@ private:
 		SIZE_CHECK(size <= m_maxSize);
 		while(m_maxSize-m_cacheSize < size){
 			cacheRemoveRow(m_lruList.back());//remove the oldest row
+			++m_evictions;
 		}
 	}
 	
@@ -243,6 +284,10 @@ private:
 	
 	std::size_t m_cacheSize;//current size of cache in T
 	std::size_t m_maxSize;//maximum size of cache in T
+	
+	std::size_t m_hits;///< number of requests answered by the cache
+	std::size_t m_misses;///< number of requests which created or extended a line
+	std::size_t m_evictions;///< number of lines freed to make room for others
 
 	
 };
@@ -30,6 +30,7 @@
 
 #include <shark/Algorithms/QP/QuadraticProgram.h>
 #include <shark/Algorithms/QP/QpSparseArray.h>
+#include <shark/Algorithms/QP/Impl/ParallelUpdates.h>
 // #include <shark/Algorithms/LP/GLPK.h>
 #include <shark/Core/Timer.h>
 #include <shark/Data/Dataset.h>
@@ -40,37 +41,6 @@ namespace shark {
 
 #define ITERATIONS_BETWEEN_SHRINKING 1000
 
-//todo: O.K.: inline fucntions?!? 
-#define GRADIENT_UPDATE(r, from, to, mu, q) \
-{ \
-	std::size_t a, b, p; \
-	for (a=(from); a<(to); a++) \
-	{ \
-		double k = (q)[a]; \
-		tExample& ex = example[a]; \
-		typename QpSparseArray<QpFloatType>::Row const& row = M.row(classes * (r) + ex.y); \
-		QpFloatType def = row.defaultvalue; \
-		if (def == 0.0) \
-		{ \
-			for (b=0; b<row.size; b++) \
-			{ \
-				p = row.entry[b].index; \
-				gradient(ex.var[p]) -= (mu) * row.entry[b].value * k; \
-			} \
-		} \
-		else \
-		{ \
-			for (b=0; b<row.size; b++) \
-			{ \
-				p = row.entry[b].index; \
-				gradient(ex.var[p]) -= (mu) * (row.entry[b].value - def) * k; \
-			} \
-			double upd = (mu) * def * k; \
-			for (b=0; b<ex.active; b++) gradient(ex.avar[b]) -= upd; \
-		} \
-	} \
-}
-
 #define GAIN_SELECTION_BOX(qif) \
 	f = exa.var[pf]; \
 	if (f >= activeVar) continue; \
@@ -328,7 +298,7 @@ public:
 						e = iv;
 					}
 					unsigned int r = y*cardP+p;
-					GRADIENT_UPDATE(r, 0, activeEx, av, q);
+					updateGradient(r, av, q);
 				}
 			}
 		}
@@ -451,7 +421,7 @@ public:
 						else alpha(v) += mu;
 					}
 				}
-				GRADIENT_UPDATE(r, 0, activeEx, mu, q);
+				updateGradient(r, mu, q);
 			}
 			else
 			{
@@ -518,8 +488,7 @@ public:
 				}
 
 				// update the gradient
-				GRADIENT_UPDATE(rv, 0, activeEx, mu_v, qv);
-				GRADIENT_UPDATE(rw, 0, activeEx, mu_w, qw);
+				updateGradient(rv, mu_v, qv, rw, mu_w, qw);
 			}
 
 			checkCounter--;
@@ -673,7 +642,7 @@ solutionGradient(w) = gradient(v);
 						e = iv;
 					}
 					unsigned int r = y*cardP+p;
-					GRADIENT_UPDATE(r, 0, activeEx, av, q);
+					updateGradient(r, av, q);
 				}
 			}
 		}
@@ -812,8 +781,8 @@ solutionGradient(w) = gradient(v);
 				}
 
 				// update the gradient
-				GRADIENT_UPDATE(rv, 0, activeEx, mu_v, qv);
-// 				GRADIENT_UPDATE(rw, 0, activeEx, mu_w, qw);
+				updateGradient(rv, mu_v, qv);
+// 				updateGradient(rw, mu_w, qw);
 			}
 
 			checkCounter--;
@@ -1365,59 +1334,156 @@ printf(")\n");
 	{
 	}
 */
-	//! return the largest KKT violation
-	double checkKKT()
+	//! gradient update of the active examples in [begin, end) for a step of size mu
+	//! on a variable with kernel modifier rows r and kernel row q
+	void updateGradientBlock(unsigned int r, double mu, QpFloatType const* q, std::size_t begin, std::size_t end)
 	{
-		if (cardR == cardP)
+		// the kernel modifiers of r are stored contiguously for all classes
+		typename QpSparseArray<QpFloatType>::Row const* rows = &M.row(classes * r);
+		std::size_t a, b, p;
+		for (a=begin; a<end; a++)
 		{
-			double ret = 0.0;
-			std::size_t v;
-			for (v=0; v<activeVar; v++)
+			double k = q[a];
+			tExample& ex = example[a];
+			typename QpSparseArray<QpFloatType>::Row const& row = rows[ex.y];
+			QpFloatType def = row.defaultvalue;
+			if (def == 0.0)
 			{
-				double a = alpha(v);
-				double g = gradient(v);
-				if (a < C)
+				for (b=0; b<row.size; b++)
 				{
-					if (g > ret) ret = g;
+					p = row.entry[b].index;
+					gradient(ex.var[p]) -= mu * row.entry[b].value * k;
 				}
-				if (a > 0.0)
+			}
+			else
+			{
+				for (b=0; b<row.size; b++)
 				{
-					if (-g > ret) ret = -g;
+					p = row.entry[b].index;
+					gradient(ex.var[p]) -= mu * (row.entry[b].value - def) * k;
 				}
+				double upd = mu * def * k;
+				for (b=0; b<ex.active; b++) gradient(ex.avar[b]) -= upd;
 			}
-			return ret;
 		}
-		else
+	}
+
+	//! update the gradient of the active variables after a step of size mu
+	//! on a variable with kernel modifier rows r and kernel row q.
+	//! Each example only changes its own variables, thus the
+	//! examples are processed in parallel for large problems.
+	void updateGradient(unsigned int r, double mu, QpFloatType const* q)
+	{
+		std::size_t blocks = detail::qpNumberOfBlocks(activeVar);
+		if (blocks == 1)
 		{
-			double ret = 0.0;
-			std::size_t i, p, pc, v;
-			for (i=0; i<activeEx; i++)
+			updateGradientBlock(r, mu, q, 0, activeEx);
+			return;
+		}
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b)
+		{
+			updateGradientBlock(r, mu, q, detail::qpBlockStart(0, activeEx, b, blocks), detail::qpBlockStart(0, activeEx, b+1, blocks));
+		}
+	}
+
+	//! gradient update of a two-variable step; the examples are traversed only once
+	void updateGradient(unsigned int rv, double mu_v, QpFloatType const* qv, unsigned int rw, double mu_w, QpFloatType const* qw)
+	{
+		std::size_t blocks = detail::qpNumberOfBlocks(activeVar);
+		if (blocks == 1)
+		{
+			updateGradientBlock(rv, mu_v, qv, 0, activeEx);
+			updateGradientBlock(rw, mu_w, qw, 0, activeEx);
+			return;
+		}
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b)
+		{
+			std::size_t begin = detail::qpBlockStart(0, activeEx, b, blocks);
+			std::size_t end = detail::qpBlockStart(0, activeEx, b+1, blocks);
+			updateGradientBlock(rv, mu_v, qv, begin, end);
+			updateGradientBlock(rw, mu_w, qw, begin, end);
+		}
+	}
+
+	//! largest KKT violation of the variables in [begin, end) w.r.t. the box constraints
+	double kktViolationBox(std::size_t begin, std::size_t end)
+	{
+		double ret = 0.0;
+		for (std::size_t v=begin; v<end; v++)
+		{
+			double a = alpha(v);
+			double g = gradient(v);
+			if (a < C)
+			{
+				if (g > ret) ret = g;
+			}
+			if (a > 0.0)
 			{
-				tExample& ex = example[i];
-				pc = ex.active;
-				bool cangrow = (ex.varsum < C);
-				double up = -1e100;
-				double down = 1e100;
-				for (p=0; p<pc; p++)
+				if (-g > ret) ret = -g;
+			}
+		}
+		return ret;
+	}
+
+	//! largest KKT violation of the examples in [begin, end) w.r.t. the simplex constraints
+	double kktViolationSimplex(std::size_t begin, std::size_t end)
+	{
+		double ret = 0.0;
+		std::size_t i, p, pc, v;
+		for (i=begin; i<end; i++)
+		{
+			tExample& ex = example[i];
+			pc = ex.active;
+			bool cangrow = (ex.varsum < C);
+			double up = -1e100;
+			double down = 1e100;
+			for (p=0; p<pc; p++)
+			{
+				v = ex.avar[p];
+				SHARK_ASSERT(v < activeVar);
+				double a = alpha(v);
+				double g = gradient(v);
+				if (cangrow)
 				{
-					v = ex.avar[p];
-					SHARK_ASSERT(v < activeVar);
-					double a = alpha(v);
-					double g = gradient(v);
-					if (cangrow)
-					{
-						if (g > up) up = g;
-					}
-					if (a > 0.0)
-					{
-						if (g < down) down = g;
-					}
+					if (g > up) up = g;
+				}
+				if (a > 0.0)
+				{
+					if (g < down) down = g;
 				}
-				if (up - down > ret) ret = up - down;
-				if (up > ret) ret = up;
-				if (-down > ret) ret = -down;
 			}
-			return ret;
+			if (up - down > ret) ret = up - down;
+			if (up > ret) ret = up;
+			if (-down > ret) ret = -down;
+		}
+		return ret;
+	}
+
+	typedef double (QpMcDecomp::*BlockViolation)(std::size_t, std::size_t);
+
+	//! maximum of a KKT violation over the range [0, size), computed blockwise in parallel for large problems
+	double parallelViolation(BlockViolation violation, std::size_t size)
+	{
+		std::size_t blocks = detail::qpNumberOfBlocks(activeVar);
+		if (blocks == 1) return (this->*violation)(0, size);
+		std::vector<double> partial(blocks);
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b)
+		{
+			partial[b] = (this->*violation)(detail::qpBlockStart(0, size, b, blocks), detail::qpBlockStart(0, size, b+1, blocks));
+		}
+		return *std::max_element(partial.begin(), partial.end());
+	}
+
+	//! return the largest KKT violation
+	double checkKKT()
+	{
+		if (cardR == cardP)
+		{
+			return parallelViolation(&QpMcDecomp::kktViolationBox, activeVar);
+		}
+		else
+		{
+			return parallelViolation(&QpMcDecomp::kktViolationSimplex, activeEx);
 		}
 	}
 
@@ -1764,18 +1830,7 @@ printf(")\n");
 
 		if (! bUnshrinked)
 		{
-			double largest = 0.0;
-			for (a = 0; a < (int)activeVar; a++)
-			{
-				if (alpha(a) < C)
-				{
-					if (gradient(a) > largest) largest = gradient(a);
-				}
-				if (alpha(a) > 0.0)
-				{
-					if (-gradient(a) > largest) largest = -gradient(a);
-				}
-			}
+			double largest = parallelViolation(&QpMcDecomp::kktViolationBox, activeVar);
 			if (largest < 10.0 * epsilon)
 			{
 				// unshrink the problem at this accuracy level
@@ -1825,6 +1880,44 @@ printf(")\n");
 		}
 	}
 
+	//! update the inactive gradient components of the examples in [begin, end)
+	//! for a variable with value mu, kernel modifier rows r and kernel row q
+	void unshrinkGradientBlock(unsigned int r, double mu, QpFloatType const* q, std::size_t begin, std::size_t end)
+	{
+		typename QpSparseArray<QpFloatType>::Row const* rows = &M.row(classes * r);
+		std::size_t a, b, f;
+		for (a=begin; a<end; a++)
+		{
+			double k = q[a];
+			tExample& ex = example[a];
+			typename QpSparseArray<QpFloatType>::Row const& row = rows[ex.y];
+			QpFloatType def = row.defaultvalue;
+			if (def == 0.0)
+			{
+				for (b=0; b<row.size; b++)
+				{
+					f = ex.var[row.entry[b].index];
+					if (f >= activeVar) gradient(f) -= mu * row.entry[b].value * k;
+				}
+			}
+			else
+			{
+				for (b=0; b<row.size; b++)
+				{
+					f = ex.var[row.entry[b].index];
+					if (f >= activeVar) gradient(f) -= mu * (row.entry[b].value - def) * k;
+				}
+				double upd = mu * def * k;
+				for (b=ex.active; b<cardP; b++)
+				{
+					f = ex.avar[b];
+					SHARK_ASSERT(f >= activeVar);
+					gradient(f) -= upd;
+				}
+			}
+		}
+	}
+
 	//! Activate all variables
 	void unshrink(double epsilon, bool complete)
 	{
@@ -1839,6 +1932,9 @@ printf(")\n");
 // 		{
 // 			gradient(v) = linear(v);
 // 		}
+		std::vector<QpFloatType> q(examples);
+		std::size_t e = (std::size_t)(-1);   // invalid value
+		std::size_t blocks = detail::qpNumberOfBlocks(variables);
 		for (v=0; v<variables; v++)
 		{
 			mu = alpha(v);
@@ -1848,39 +1944,20 @@ printf(")\n");
 			unsigned int pv = variable[v].p;
 			unsigned int yv = example[iv].y;
 			unsigned int r = cardP * yv + pv;
-			std::vector<QpFloatType> q(examples);
-			kernelMatrix.row(iv, 0, examples, &q[0]);
+			if (iv != e)
+			{
+				kernelMatrix.row(iv, 0, examples, &q[0]);
+				e = iv;
+			}
 
-			std::size_t a, b, f;
-			for (a=0; a<examples; a++)
+			if (blocks == 1)
 			{
-				double k = (q)[a];
-				tExample& ex = example[a];
-				typename QpSparseArray<QpFloatType>::Row const& row = M.row(classes * r + ex.y);
-				QpFloatType def = row.defaultvalue;
-				if (def == 0.0)
-				{
-					for (b=0; b<row.size; b++)
-					{
-						f = ex.var[row.entry[b].index];
-						if (f >= activeVar) gradient(f) -= mu * row.entry[b].value * k;
-					}
-				}
-				else
-				{
-					for (b=0; b<row.size; b++)
-					{
-						f = ex.var[row.entry[b].index];
-						if (f >= activeVar) gradient(f) -= mu * (row.entry[b].value - def) * k;
-					}
-					double upd = (mu) * def * (k);
-					for (b=ex.active; b<cardP; b++)
-					{
-						f = ex.avar[b];
-						SHARK_ASSERT(f >= activeVar);
-						gradient(f) -= upd;
-					}
-				}
+				unshrinkGradientBlock(r, mu, &q[0], 0, examples);
+				continue;
+			}
+			SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b)
+			{
+				unshrinkGradientBlock(r, mu, &q[0], detail::qpBlockStart(0, examples, b, blocks), detail::qpBlockStart(0, examples, b+1, blocks));
 			}
 		}
 
@@ -2057,7 +2134,6 @@ printf(")\n");
 };
 
 
-#undef GRADIENT_UPDATE
 #undef GAIN_SELECTION_BOX
 #undef GAIN_SELECTION_TRIANGLE
 
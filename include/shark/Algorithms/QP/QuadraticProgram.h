@@ -55,6 +55,7 @@
 
 #include <boost/range/algorithm_ext/iota.hpp>
 #include <vector>
+#include <algorithm>
 #include <cmath>
 
 
@@ -68,6 +69,20 @@ namespace shark {
 #define XCHG_A(t, a, i, j) {t temp; temp = a[i]; a[i] = a[j]; a[j] = temp;}
 #define XCHG_V(t, a, i, j) {t temp; temp = a[i]; a[i] = a[j]; a[j] = temp;}
 
+namespace detail{
+///\brief Adds n to the kernel access counter of a matrix.
+///
+///The rows of a matrix may be computed by several threads at once, see CachedMatrix::prefetchRows.
+inline void addKernelAccesses(unsigned long long& counter, std::size_t n){
+	if(SHARK_IN_PARALLEL){
+		SHARK_CRITICAL_REGION{
+			counter += n;
+		}
+	}else{
+		counter += n;
+	}
+}
+}
 /// reason for the quadratic programming solver
 /// to stop the iterative optimization process
 enum QpStopType
@@ -205,7 +220,7 @@ public:
 	/// return a single matrix entry
 	QpFloatType entry(std::size_t i, std::size_t j) const
 	{
-		++m_accessCounter;
+		detail::addKernelAccesses(m_accessCounter,1);
 		return (QpFloatType)kernel.eval(*x[i], *x[j]);
 	}
 	
@@ -214,7 +229,7 @@ public:
 	///The entries start,...,end of the i-th row are computed and stored in storage.
 	///There must be enough room for this operation preallocated.
 	void row(std::size_t i, std::size_t start,std::size_t end, QpFloatType* storage) const{
-		m_accessCounter += end-start;
+		detail::addKernelAccesses(m_accessCounter,end-start);
 		
 		typename AbstractKernelFunction<InputType>::ConstInputReference xi = *x[i];
 		SHARK_PARALLEL_FOR(int j = start; j < (int) end; j++)
@@ -296,7 +311,7 @@ public:
 	/// return a single matrix entry
 	QpFloatType entry(std::size_t i, std::size_t j) const
 	{
-		++m_accessCounter;
+		detail::addKernelAccesses(m_accessCounter,1);
 		return (QpFloatType)kernel.eval(*x[i], *x[j]);
 	}
 	
@@ -306,10 +321,11 @@ public:
 	///There must be enough room for this operation preallocated.
 	void row(std::size_t k, std::size_t start,std::size_t end, QpFloatType* storage) const
 	{
-		m_accessCounter +=end-start;
+		detail::addKernelAccesses(m_accessCounter,end-start);
 		typename AbstractKernelFunction<InputType>::ConstInputReference xi = *x[k];
 
-		if(SHARK_NUM_THREADS > 1)//todo try to use batched more in multithread setup as well.
+		//rows computed concurrently by a prefetch use the batched evaluation
+		if(SHARK_NUM_THREADS > 1 && !SHARK_IN_PARALLEL)//todo try to use batched more in multithread setup as well.
 		{
 			SHARK_PARALLEL_FOR(int j = start; j < (int) end; j++){
 				storage[j-start] = QpFloatType(kernel.eval(xi, *x[j]));
@@ -397,7 +413,7 @@ public:
 	/// return a single matrix entry
 	QpFloatType entry(std::size_t i, std::size_t j) const
 	{
-		++m_accessCounter;
+		detail::addKernelAccesses(m_accessCounter,1);
 		return (QpFloatType)kernel.eval(x[i], x[j]);
 	}
 	
@@ -406,7 +422,7 @@ public:
 	///The entries start,...,end of the i-th row are computed and stored in storage.
 	///There must be enough room for this operation preallocated.
 	void row(std::size_t i, std::size_t start,std::size_t end, QpFloatType* storage) const{
-		m_accessCounter +=end-start;
+		detail::addKernelAccesses(m_accessCounter,end-start);
 		SHARK_PARALLEL_FOR(int j = start; j < (int) end; j++)
 		{
 			storage[j-start] = QpFloatType(kernel.eval(x[i], x[j]));
@@ -478,7 +494,7 @@ public:
 	/// return a single matrix entry
 	QpFloatType entry(std::size_t i, std::size_t j) const
 	{
-		++m_accessCounter;
+		detail::addKernelAccesses(m_accessCounter,1);
 		double distance = m_squaredNorms(i)-2*inner_prod(x[i], x[j])+m_squaredNorms(j);
 		return (QpFloatType)std::exp(- m_gamma * distance);
 	}
@@ -489,7 +505,7 @@ public:
 	///There must be enough room for this operation preallocated.
 	void row(std::size_t i, std::size_t start,std::size_t end, QpFloatType* storage) const
 	{
-		m_accessCounter +=end-start;
+		detail::addKernelAccesses(m_accessCounter,end-start);
 		SHARK_PARALLEL_FOR(int j = start; j < (int) end; j++)
 		{
 			double distance = m_squaredNorms(i)-2*inner_prod(x[i], x[j])+m_squaredNorms(j);
@@ -874,6 +890,12 @@ protected:
 /// have information on the fullness of the cache (although this functionality
 /// could easily be added).
 ///
+/// \par
+/// Rows which are known to be needed soon can be computed together with
+/// prefetchRows. The missing entries are computed by several threads and
+/// inserted into the cache one row at a time. The numbers of cache hits,
+/// misses and evictions are counted to help choosing the cache size.
+///
 template <class Matrix>
 class CachedMatrix
 {
@@ -926,6 +948,43 @@ public:
 		return line;
 	}
 
+	/// \brief Makes sure that the given rows are cached with at least the entries [0,end)
+	///
+	/// The missing entries of the rows are computed in parallel through the row method of the
+	/// base matrix, each thread inserts the rows it computed into the cache under a lock. Rows
+	/// are only prefetched as long as all of them fit into the cache together, so that they do
+	/// not evict each other.
+	/// \param rows indices of the rows
+	/// \param end  last column to be filled in +1
+	void prefetchRows(std::vector<std::size_t> const& rows, std::size_t end){
+		SIZE_CHECK(end <= size());
+		std::vector<std::size_t> fillRows;
+		std::vector<std::size_t> cachedLengths;
+		std::size_t memory = 0;
+		for(std::size_t r = 0; r != rows.size(); ++r){
+			std::size_t k = rows[r];
+			std::size_t cached = m_cache.lineLength(k);
+			if(cached >= end || std::find(fillRows.begin(),fillRows.end(),k) != fillRows.end()) continue;
+			memory += end;
+			if(memory > m_cache.maxSize()) break;
+			fillRows.push_back(k);
+			cachedLengths.push_back(cached);
+		}
+		SHARK_PARALLEL_FOR_DYNAMIC(int r = 0; r < (int)fillRows.size(); ++r){
+			std::size_t k = fillRows[r];
+			std::size_t cached = cachedLengths[r];
+			std::vector<QpFloatType> values(end-cached);
+			mep_baseMatrix->row(k,cached,end,&values[0]);
+			SHARK_CRITICAL_REGION{
+				//if the row was evicted by another thread in the meantime, row() computes it on demand
+				if(m_cache.lineLength(k) == cached){
+					QpFloatType* line = m_cache.getCacheLine(k,end);
+					std::copy(values.begin(),values.end(),line+cached);
+				}
+			}
+		}
+	}
+
 	/// return a single matrix entry
 	QpFloatType operator () (std::size_t i, std::size_t j) const{ 
 		return entry(i, j);
@@ -955,9 +1014,12 @@ public:
 		if (i > j)
 			std::swap(i,j);
 
-		// exchange all cache row entries
-		for (std::size_t  k = 0; k < size(); k++)
+		// exchange the entries of all cached rows
+		m_cachedLines.clear();
+		m_cache.cachedLineIndices(m_cachedLines);
+		for (std::size_t  l = 0; l != m_cachedLines.size(); l++)
 		{
+			std::size_t k = m_cachedLines[l];
 			std::size_t length = m_cache.lineLength(k);
 			if(length <= i) continue;
 			QpFloatType* line = m_cache.getLinePointer(k);//do not affect caching
@@ -988,6 +1050,22 @@ public:
 	
 	bool isCached(std::size_t k) const
 	{ return m_cache.isCached(k); }
+
+	/// number of requested rows which were found in the cache
+	std::size_t cacheHits() const
+	{ return m_cache.hits(); }
+
+	/// number of requested rows which had to be computed or extended
+	std::size_t cacheMisses() const
+	{ return m_cache.misses(); }
+
+	/// number of rows removed from the cache to make room for other rows
+	std::size_t cacheEvictions() const
+	{ return m_cache.evictions(); }
+
+	/// set the hit, miss and eviction counters to zero
+	void resetCacheStatistics()
+	{ m_cache.resetStatistics(); }
 	
 	///\brief Restrict the cached part of the matrix to the upper left nxn sub-matrix
 	void setMaxCachedIndex(std::size_t n){
@@ -1012,6 +1090,8 @@ protected:
 	Matrix* mep_baseMatrix; ///< matrix to be cached
 
 	LRUCache<QpFloatType> m_cache; ///< cache of the matrix lines
+
+	std::vector<std::size_t> m_cachedLines; ///< storage for the indices of the cached lines used by flipColumnsAndRows
 };
 
 
@@ -1126,6 +1206,9 @@ public:
 	}
 	/// for compatibility with CachedMatrix
 	void setMaxCachedIndex(std::size_t n){}
+
+	/// for compatibility with CachedMatrix, all rows are precomputed
+	void prefetchRows(std::vector<std::size_t> const&, std::size_t){}
 		
 	/// for compatibility with CachedMatrix
 	void clear()
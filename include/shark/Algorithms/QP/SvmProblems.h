@@ -33,6 +33,7 @@
 #define SHARK_ALGORITHMS_QP_SVMPROBLEMS_H
 
 #include <shark/Algorithms/QP/BoxConstrainedProblems.h>
+#include <shark/Algorithms/QP/Impl/ParallelUpdates.h>
 
 namespace shark{
  
@@ -42,6 +43,7 @@ namespace shark{
 struct MVPSelectionCriterion{
 	/// \brief Select the most violatig pair (MVP)
 	///
+	/// For large problems the variables are searched in parallel.
 	/// \return maximal KKT vioation
 	/// \param problem the svm problem to select the working set for
 	/// \param i  first working set component
@@ -49,33 +51,13 @@ struct MVPSelectionCriterion{
 	template<class Problem>
 	double operator()(Problem& problem, std::size_t& i, std::size_t& j)
 	{
-		double largestUp = -1e100;
-		double smallestDown = 1e100;
-
-		for (std::size_t a=0; a < problem.active(); a++)
-		{
-			double aa = problem.alpha(a);
-			double ga = problem.gradient(a);
-			if (!problem.isUpperBound(a))
-			{
-				if (ga > largestUp)
-				{
-					largestUp = ga;
-					i = a;
-				}
-			}
-			if (!problem.isLowerBound(a))
-			{
-				if (ga < smallestDown)
-				{
-					smallestDown = ga;
-					j = a;
-				}
-			}
-		}
+		detail::GradientExtremes extremes(i,j);
+		detail::findGradientExtremes(problem,extremes);
+		i = extremes.up;
+		j = extremes.down;
 
 		// MVP stopping condition
-		return largestUp - smallestDown;
+		return extremes.largestUp - extremes.smallestDown;
 	}
 	
 	void reset(){}
@@ -86,6 +68,7 @@ struct LibSVMSelectionCriterion{
 	
 	/// \brief Select a working set according to the second order algorithm of LIBSVM 2.8
 	///
+	/// For large problems the variables are searched in parallel.
 	/// \return maximal KKT vioation
 	/// \param problem the svm problem to select the working set for
 	/// \param i  first working set component
@@ -93,59 +76,74 @@ struct LibSVMSelectionCriterion{
 	template<class Problem>
 	double operator()(Problem& problem, std::size_t& i, std::size_t& j)
 	{
-		i = 0;
+		detail::GradientExtremes extremes(0,1);
+		detail::findGradientExtremes(problem,extremes);
+		i = extremes.up;
 		j = 1;
-
-		double smallestDown = 1e100;
-		double largestUp = -1e100;
-
-		for (std::size_t a=0; a < problem.active(); a++)
-		{
-			double ga = problem.gradient(a);
-			//if (aa < problem.boxMax(a))
-			if (!problem.isUpperBound(a))
-			{
-				if (ga > largestUp)
-				{
-					largestUp = ga;
-					i = a;
-				}
-			}
-		}
+		double largestUp = extremes.largestUp;
 		if (largestUp == -1e100) return 0.0;
 
 		// find the second index using second order information
 		typename Problem::QpFloatType* q = problem.quadratic().row(i, 0, problem.active());
-		double best = 0.0;
-		for (std::size_t a = 0; a < problem.active(); a++){
-			double ga = problem.gradient(a);
-			if (!problem.isLowerBound(a))
-			{
-				smallestDown=std::min(smallestDown,ga);
-				
-				double grad_diff = largestUp - ga;
-				if (grad_diff > 0.0)
-				{
-					double quad_coef = problem.diagonal(i) + problem.diagonal(a) - 2.0 * q[a];
-					if (quad_coef <= 1.e-12) quad_coef=1.e-12;
-					double obj_diff = (grad_diff * grad_diff) / quad_coef;
-
-					if (obj_diff > best)
-					{
-						best = obj_diff;
-						j = a;
-					}
-				}
+		SecondOrderStep step(j);
+		std::size_t active = problem.active();
+		std::size_t blocks = detail::qpNumberOfBlocks(active);
+		if(blocks == 1){
+			selectSecondVariable(problem, i, largestUp, q, 0, active, step);
+		}else{
+			std::vector<SecondOrderStep> partial(blocks,step);
+			SHARK_PARALLEL_FOR(int b = 0; b < (int)blocks; ++b){
+				selectSecondVariable(
+					problem, i, largestUp, q, 
+					detail::qpBlockStart(0,active,b,blocks), detail::qpBlockStart(0,active,b+1,blocks), 
+					partial[b]
+				);
+			}
+			//ties are resolved in favour of the smaller index
+			for(std::size_t b = 0; b != blocks; ++b){
+				if(partial[b].gain > step.gain)
+					step = partial[b];
 			}
 		}
+		j = step.index;
 
-		if (best == 0.0) return 0.0;		// numerical accuracy reached :(
+		if (step.gain == 0.0) return 0.0;		// numerical accuracy reached :(
 
 		// MVP stopping condition
-		return largestUp - smallestDown;
+		return largestUp - extremes.smallestDown;
 	}
 	
 	void reset(){}
+private:
+	struct SecondOrderStep{
+		double gain;
+		std::size_t index;
+		SecondOrderStep(std::size_t j):gain(0.0),index(j){}
+	};
+	
+	template<class Problem, class QpFloatType>
+	static void selectSecondVariable(
+		Problem const& problem, std::size_t i, double largestUp, QpFloatType const* q,
+		std::size_t begin, std::size_t end, SecondOrderStep& step
+	){
+		double di = problem.diagonal(i);
+		for (std::size_t a = begin; a < end; a++){
+			if (problem.isLowerBound(a)) continue;
+			double grad_diff = largestUp - problem.gradient(a);
+			if (grad_diff > 0.0)
+			{
+				double quad_coef = di + problem.diagonal(a) - 2.0 * q[a];
+				if (quad_coef <= 1.e-12) quad_coef=1.e-12;
+				double obj_diff = (grad_diff * grad_diff) / quad_coef;
+
+				if (obj_diff > step.gain)
+				{
+					step.gain = obj_diff;
+					step.index = a;
+				}
+			}
+		}
+	}
 };
 
 class HMGSelectionCriterion{
@@ -173,6 +171,11 @@ public:
 			return value;
 		}
 		//~ //old HMG
+		//both rows of the last working set are needed, missing ones are computed together
+		std::vector<std::size_t> rows(2);
+		rows[0] = last_i;
+		rows[1] = last_j;
+		problem.quadratic().prefetchRows(rows, problem.active());
 		MGStep besti = selectMGVariable(problem,last_i);
 		if(besti.violation == 0.0)
 			return 0;
@@ -306,8 +309,7 @@ public:
 			double v = alpha(i);
 			if (v != 0.0){
 				QpFloatType* q = quadratic().row(i, 0, dimensions());
-				for (std::size_t a=0; a < dimensions(); a++) 
-					m_gradient(a) -= q[a] * v;
+				detail::subtractScaledRow(m_gradient, v, q, 0, dimensions());
 			}
 			updateAlphaStatus(i);
 		}
@@ -518,8 +520,7 @@ protected:
 		//Update internal data structures (gradient and alpha status)
 		QpFloatType* qi = quadratic().row(i, 0, active());
 		QpFloatType* qj = quadratic().row(j, 0, active());
-		for (std::size_t a = 0; a < active(); a++) 
-			m_gradient(a) -= step * qi[a] - step * qj[a];
+		detail::updateGradientSMO(m_gradient, step, qi, qj, active());
 		
 		//update boundary status
 		updateAlphaStatus(i);
@@ -605,8 +606,7 @@ public:
 			if (isUpperBound(i) || isLowerBound(i)) continue;
 			
 			QpFloatType* q = quadratic().row(i, 0, dimensions());
-			for (std::size_t a = active(); a < dimensions(); a++) 
-				this->m_gradient(a) -= alpha(i) * q[a] ;
+			detail::subtractScaledRow(this->m_gradient, alpha(i), q, active(), dimensions());
 		}
 
 		this->m_active = dimensions();
@@ -685,9 +685,7 @@ private:
 		}
 
 		QpFloatType* q = quadratic().row(i, 0, dimensions());
-		for(std::size_t a = 0; a != dimensions(); ++a){
-			m_gradientEdge(a) -= diff*q[a];
-		}
+		detail::subtractScaledRow(m_gradientEdge, diff, q, 0, dimensions());
 	}
 	///\brief Shrink the variable from the Problem.
 	void shrinkVariable(std::size_t i){
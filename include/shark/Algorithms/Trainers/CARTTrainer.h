@@ -68,6 +68,7 @@ public:
 	CARTTrainer(){
 		//Set the node size to 1 as default
 		m_nodeSize = 1;
+		m_histogramBins = 0;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -80,6 +81,16 @@ public:
 	///Train regression
     void train(ModelType& model, RegressionDataset const& dataset);
 
+	/// \brief Grow the trees on histograms of quantized attributes.
+	///
+	/// Every attribute is quantized into at most bins bins, 2 <= bins <= 256, and only the bin
+	/// boundaries are considered as thresholds. 0 selects the exact search on the
+	/// sorted attribute tables, which is the default.
+	void setHistogramBins(std::size_t bins){
+		SHARK_CHECK(bins == 0 || (bins >= 2 && bins <= 256), "[CARTTrainer::setHistogramBins] the number of bins must be 0 or in [2,256]");
+		m_histogramBins = bins;
+	}
+
 protected:
 
     ///Types frequently used
@@ -93,6 +104,16 @@ protected:
     };
     typedef std::vector < TableEntry > AttributeTable;
     typedef std::vector < AttributeTable > AttributeTables;
+
+    ///\brief Scratch memory used to partition the attribute tables of a node in place.
+    ///
+    ///One buffer is created per tree, so that splitting a node does not allocate memory.
+    struct PartitionBuffer{
+    	///flags whether the element with a given id is moved to the left child
+    	std::vector<char> goesLeft;
+    	///temporary storage for the entries moved to the right child
+    	AttributeTable entries;
+    };
     
     typedef ModelType::SplitMatrixType SplitMatrixType;
     
@@ -106,13 +127,16 @@ protected:
     ///Controls the number of samples in the terminal nodes
     std::size_t m_nodeSize;
 
+    ///Number of bins of the quantized attributes, 0 for the exact split search
+    std::size_t m_histogramBins;
+
     ///Holds the maximum label. Used in allocating the histograms
     unsigned int m_maxLabel;
 
     //Classification functions
     ///Builds a single decision tree from a classification dataset
-    ///The method requires the attribute tables,
-    SplitMatrixType buildTree(AttributeTables const& tables, ClassificationDataset const& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId );
+    ///The method requires the attribute tables. The node consists of the elements in the range [begin,end) of the tables.
+    SplitMatrixType buildTree(AttributeTables& tables, std::size_t begin, std::size_t end, std::vector<unsigned int> const& labels, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId, PartitionBuffer& buffer);
 
     ///Calculates the Gini impurity of a node. The impurity is defined as
     ///1-sum_j p(j|t)^2
@@ -122,11 +146,10 @@ protected:
     RealVector hist(boost::unordered_map<std::size_t, std::size_t> countMatrix);
 
     ///Regression functions
-    SplitMatrixType buildTree(AttributeTables const& tables, RegressionDataset const& dataset, std::vector<RealVector> const& labels, std::size_t nodeId, std::size_t trainSize);
-    ///Calculates the total sum of squares
-    double totalSumOfSquares(std::vector<RealVector> const& labels, std::size_t start, std::size_t length, const RealVector& sumLabel);
-    ///Calculates the mean of a vector of labels
-    RealVector mean(std::vector<RealVector> const& labels);
+    ///Builds a single regression tree. The node consists of the elements in the range [begin,end) of the tables.
+    SplitMatrixType buildTree(AttributeTables& tables, std::size_t begin, std::size_t end, std::vector<RealVector> const& labels, std::size_t nodeId, std::size_t trainSize, PartitionBuffer& buffer);
+    ///Calculates the total sum of squares of n labels from the sum of their squared norms and their sum
+    double totalSumOfSquares(double sumOfSquares, const RealVector& sumLabel, std::size_t n);
 
     ///Pruning
     ///Prunes decision tree, represented by a split matrix
@@ -142,10 +165,11 @@ protected:
     ///Attribute table functions
     ///Create the attribute tables used by the SPRINT algorithm
     AttributeTables createAttributeTables(Data<RealVector> const& dataset);
-    ///Splits the attribute tables by a attribute index and value. Returns a left and a right attribute table in the variables LAttributeTables and RAttributeTables
-    void splitAttributeTables(AttributeTables const& tables, std::size_t index, std::size_t valIndex, AttributeTables& LAttributeTables, AttributeTables& RAttributeTables);
-    ///Crates count matrices from a classification dataset
-    boost::unordered_map<std::size_t, std::size_t> createCountMatrix(ClassificationDataset const& dataset);
+    ///Splits the range [begin,end) of the attribute tables in place at the position splitPoint of the table with the given index.
+    ///Afterwards [begin,splitPoint) holds the left and [splitPoint,end) the right child in every table. The tables stay sorted.
+    void splitAttributeTables(AttributeTables& tables, std::size_t begin, std::size_t end, std::size_t index, std::size_t splitPoint, PartitionBuffer& buffer);
+    ///Crates count matrices from the labels of a classification dataset
+    boost::unordered_map<std::size_t, std::size_t> createCountMatrix(std::vector<unsigned int> const& labels);
 
 
 };
@@ -0,0 +1,191 @@
+//===========================================================================
+/*!
+ *  \brief Histogram based growing of CART trees on quantized attributes.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_TRAINERS_IMPL_BINNEDTREEBUILDER_H
+#define SHARK_ALGORITHMS_TRAINERS_IMPL_BINNEDTREEBUILDER_H
+
+#include <shark/Models/Trees/CARTClassifier.h>
+#include <shark/Rng/GlobalRng.h>
+#include <vector>
+
+namespace shark{
+namespace detail{
+
+/// \brief The attributes of a data set quantized into at most 256 bins each.
+///
+/// The bins of an attribute are formed by consecutive ranges of its sorted values.
+/// If an attribute takes at most maxBins distinct values, every value gets its own bin,
+/// otherwise the bins are chosen to hold roughly the same number of elements.
+/// Elements with equal values always share a bin.
+/// The bin indices are stored as a column major matrix of bytes, which needs an
+/// eighth of the memory of the original data.
+class BinnedAttributes{
+public:
+	BinnedAttributes():m_numElements(0){}
+
+	BinnedAttributes(Data<RealVector> const& inputs, std::size_t maxBins){
+		create(inputs,maxBins);
+	}
+
+	/// \brief Quantizes the attributes of the inputs into at most maxBins <= 256 bins.
+	void create(Data<RealVector> const& inputs, std::size_t maxBins);
+
+	std::size_t numberOfElements()const{
+		return m_numElements;
+	}
+	std::size_t numberOfAttributes()const{
+		return m_thresholds.size();
+	}
+	std::size_t numberOfBins(std::size_t attribute)const{
+		return m_thresholds[attribute].size();
+	}
+
+	/// \brief Bin indices of all elements for an attribute.
+	unsigned char const* column(std::size_t attribute)const{
+		return &m_bins[attribute*m_numElements];
+	}
+
+	/// \brief Largest value of the attribute that is mapped to the bin.
+	///
+	/// All elements in the bins [0,bin] have a value <= threshold(attribute,bin).
+	double threshold(std::size_t attribute, std::size_t bin)const{
+		return m_thresholds[attribute][bin];
+	}
+private:
+	std::size_t m_numElements;
+	std::vector<unsigned char> m_bins;
+	std::vector<std::vector<double> > m_thresholds;
+};
+
+/// \brief Grows a single CART tree on binned attributes.
+///
+/// The split search does not iterate over the sorted elements of a node but over
+/// histograms of the label statistics, one per attribute with one entry per bin.
+/// A node is represented by a range of element indices, which is partitioned in place
+/// when the node is split.
+///
+/// In the classification case the statistic of an element is its class, the node impurity is measured
+/// by the Gini criterion. In the regression case the statistics are the count, the squared norm and the
+/// sum of the labels and the impurity is the total sum of squares. As in the exact trainers, the impurity
+/// of a split is the sum of the impurities of the children, weighted by their size.
+///
+/// When all attributes are searched at every node, only the histograms of the smaller child
+/// are computed from the data, the histograms of the larger child are obtained by subtracting
+/// them from the histograms of the parent.
+class BinnedTreeBuilder{
+public:
+	typedef CARTClassifier<RealVector>::SplitMatrixType SplitMatrixType;
+
+	/// \brief Builder for a classification tree.
+	BinnedTreeBuilder(BinnedAttributes const& attributes, std::vector<unsigned int> const& labels, std::size_t numberOfClasses);
+
+	/// \brief Builder for a regression tree.
+	BinnedTreeBuilder(BinnedAttributes const& attributes, std::vector<RealVector> const& labels);
+
+	/// \brief Nodes with at most nodeSize elements are not split.
+	void setNodeSize(std::size_t nodeSize){
+		m_nodeSize = nodeSize;
+	}
+
+	/// \brief Number of attributes drawn at random at every node. 0 means that all attributes are searched.
+	void setMTry(std::size_t mtry){
+		m_try = mtry;
+	}
+
+	/// \brief Weights the elements by how often they were drawn.
+	///
+	/// Every element given to buildTree counts multiplicities[i] times, which allows
+	/// bootstrap samples without copying elements. By default every element counts once.
+	void setMultiplicities(std::vector<unsigned int> const& multiplicities){
+		SIZE_CHECK(multiplicities.size() == m_attributes.numberOfElements());
+		mep_multiplicities = &multiplicities;
+	}
+
+	/// \brief Grows a tree from the elements with the given indices.
+	///
+	/// The nodes of the returned split matrix are numbered in the order they are stored.
+	/// The random number generator is used to draw the attributes searched at each node.
+	SplitMatrixType buildTree(std::vector<std::size_t> const& elements, Rng::rng_type& rng);
+
+private:
+	/// \brief Returns true if the histograms of all attributes are computed at every node.
+	bool searchesAllAttributes()const{
+		return m_try == 0 || m_try >= m_attributes.numberOfAttributes();
+	}
+
+	SplitMatrixType buildNode(std::size_t begin, std::size_t end, std::size_t nodeId, std::vector<double>& histograms, Rng::rng_type& rng);
+
+	/// \brief Adds the statistics of the elements in [begin,end) to the histograms of the given attributes.
+	void fillHistograms(std::vector<double>& histograms, std::size_t begin, std::size_t end, std::vector<std::size_t> const& attributes)const;
+
+	/// \brief Adds the statistic of a single element.
+	void addElement(double* statistics, std::size_t element)const{
+		double weight = mep_multiplicities? (*mep_multiplicities)[element] : 1.0;
+		if(m_regression){
+			RealVector const& label = (*mep_regressionLabels)[element];
+			double normSqr = 0;
+			for(std::size_t k = 0; k != m_labelDimension; ++k){
+				statistics[2+k] += weight*label(k);
+				normSqr += sqr(label(k));
+			}
+			statistics[0] += weight;
+			statistics[1] += weight*normSqr;
+		}
+		else{
+			statistics[(*mep_classLabels)[element]] += weight;
+		}
+	}
+
+	/// \brief Number of elements described by the statistics.
+	double count(double const* statistics)const;
+	/// \brief Impurity times number of elements.
+	double cost(double const* statistics)const;
+	/// \brief Fills label and error of a node.
+	void setNodeInfo(CARTClassifier<RealVector>::SplitInfo& info, double const* statistics)const;
+
+	BinnedAttributes const& m_attributes;
+	/// labels in the classification case
+	std::vector<unsigned int> const* mep_classLabels;
+	/// labels in the regression case
+	std::vector<RealVector> const* mep_regressionLabels;
+	/// number of times every element is counted, 0 if every element counts once
+	std::vector<unsigned int> const* mep_multiplicities;
+	bool m_regression;
+	std::size_t m_labelDimension;
+
+	/// number of statistics per bin: the number of classes or 2+labelDimension for count, squared norm and label sum
+	std::size_t m_stride;
+	/// start of the histogram of every attribute
+	std::vector<std::size_t> m_offsets;
+	/// size of the histograms of all attributes
+	std::size_t m_histogramSize;
+
+	std::size_t m_nodeSize;
+	std::size_t m_try;
+
+	/// element indices, the nodes are ranges of this vector
+	std::vector<std::size_t> m_elements;
+	/// histograms of the searched attributes when not all attributes are searched
+	std::vector<double> m_scratch;
+};
+
+}}
+#endif
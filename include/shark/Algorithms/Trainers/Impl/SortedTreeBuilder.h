@@ -0,0 +1,228 @@
+//===========================================================================
+/*!
+ *  \brief Level-wise growing of CART trees on attributes sorted once for all trees.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_TRAINERS_IMPL_SORTEDTREEBUILDER_H
+#define SHARK_ALGORITHMS_TRAINERS_IMPL_SORTEDTREEBUILDER_H
+
+#include <shark/Models/Trees/CARTClassifier.h>
+#include <shark/Rng/GlobalRng.h>
+#include <vector>
+
+namespace shark{
+namespace detail{
+
+/// \brief The attributes of a data set, every attribute sorted by its values.
+///
+/// Every attribute is stored as a table of values and element indices in ascending order
+/// of the values. The tables are created once and can be shared by all trees grown on
+/// subsets of the data set, no tree changes them. The values are also stored column wise
+/// in the order of the elements, so that the value of an element can be looked up directly.
+class SortedAttributes{
+public:
+	/// \brief Entry of an attribute table: the value of the attribute and the index of the element.
+	struct Entry{
+		double value;
+		std::size_t id;
+
+		bool operator<(Entry const& other)const{
+			return value < other.value;
+		}
+	};
+
+	SortedAttributes():m_numElements(0){}
+
+	SortedAttributes(Data<RealVector> const& inputs){
+		create(inputs);
+	}
+
+	/// \brief Sorts every attribute of the inputs.
+	void create(Data<RealVector> const& inputs);
+
+	std::size_t numberOfElements()const{
+		return m_numElements;
+	}
+	std::size_t numberOfAttributes()const{
+		return m_tables.size();
+	}
+
+	/// \brief Entries of all elements for an attribute, sorted by value.
+	std::vector<Entry> const& table(std::size_t attribute)const{
+		return m_tables[attribute];
+	}
+
+	/// \brief Value of the attribute of an element.
+	double value(std::size_t attribute, std::size_t element)const{
+		return m_values[attribute*m_numElements+element];
+	}
+private:
+	std::size_t m_numElements;
+	std::vector<std::vector<Entry> > m_tables;
+	std::vector<double> m_values;
+};
+
+/// \brief Grows a single CART tree with the exact split search on sorted attributes.
+///
+/// The tree is grown level by level as in SLIQ. Every element stores the node of the
+/// current level it belongs to. For every attribute searched by at least one node of the
+/// level, the sorted table of the attribute is scanned once and every element is added to
+/// the split search of its node, elements of other nodes and elements which are not used
+/// by the tree are skipped. Thus the tables are neither copied nor partitioned and the
+/// memory of a tree is linear in the number of elements and nodes. When the nodes of a
+/// level contain so few elements that sorting them is cheaper than scanning the tables,
+/// the elements of every node are sorted instead.
+///
+/// The statistics and impurities are the ones of the BinnedTreeBuilder, but every split
+/// between two different values of an attribute is considered. The threshold of a split
+/// is the largest value of the left child.
+class SortedTreeBuilder{
+public:
+	typedef CARTClassifier<RealVector>::SplitMatrixType SplitMatrixType;
+
+	/// \brief Builder for a classification tree.
+	SortedTreeBuilder(SortedAttributes const& attributes, std::vector<unsigned int> const& labels, std::size_t numberOfClasses);
+
+	/// \brief Builder for a regression tree.
+	SortedTreeBuilder(SortedAttributes const& attributes, std::vector<RealVector> const& labels);
+
+	/// \brief Nodes with at most nodeSize elements are not split.
+	void setNodeSize(std::size_t nodeSize){
+		m_nodeSize = nodeSize;
+	}
+
+	/// \brief Number of attributes drawn at random at every node. 0 means that all attributes are searched.
+	void setMTry(std::size_t mtry){
+		m_try = mtry;
+	}
+
+	/// \brief Weights the elements by how often they were drawn.
+	///
+	/// Every element given to buildTree counts multiplicities[i] times, which allows
+	/// bootstrap samples without copying elements. By default every element counts once.
+	void setMultiplicities(std::vector<unsigned int> const& multiplicities){
+		SIZE_CHECK(multiplicities.size() == m_attributes.numberOfElements());
+		mep_multiplicities = &multiplicities;
+	}
+
+	/// \brief Grows a tree from the elements with the given indices.
+	///
+	/// The nodes of the returned split matrix are numbered in the order they are stored.
+	/// The random number generator is used to draw the attributes searched at each node,
+	/// the nodes draw in the order of the levels.
+	SplitMatrixType buildTree(std::vector<std::size_t> const& elements, Rng::rng_type& rng);
+
+private:
+	/// \brief Node of the tree while it is grown.
+	struct Node{
+		CARTClassifier<RealVector>::SplitInfo info;
+		/// positions of the children in the list of nodes, 0 for a leaf
+		std::size_t left;
+		std::size_t right;
+	};
+
+	/// \brief State of the split search of a node of the current level.
+	struct SplitSearch{
+		/// whether a split was found
+		bool found;
+		/// cost of the best split
+		double cost;
+		/// attribute and threshold of the best split
+		std::size_t attribute;
+		double value;
+		/// whether an element of the node was visited in the order of the current attribute
+		bool started;
+		/// value of the last visited element
+		double lastValue;
+	};
+
+	/// \brief Searches the splits of the nodes by scanning the sorted table of every searched attribute once.
+	void scanTables(
+		std::vector<unsigned int> const& levelNode, std::vector<double> const& statistics,
+		std::vector<std::vector<std::size_t> >& attributeNodes, std::vector<SplitSearch>& searches
+	);
+
+	/// \brief Searches the splits of the nodes by sorting the elements of every node by the searched attributes.
+	///
+	/// This is faster than scanning the tables when the nodes of a level contain only few elements.
+	void sortNodes(
+		std::vector<std::size_t> const& elements, std::vector<unsigned int> const& levelNode,
+		std::vector<std::size_t> const& nodeSizes, std::vector<double> const& statistics,
+		std::vector<std::vector<std::size_t> >& attributeNodes, std::vector<SplitSearch>& searches
+	);
+
+	/// \brief Adds the next element of a node in the order of an attribute to the split search of the node.
+	void searchElement(
+		SplitSearch& search, double* left, double const* nodeStatistics,
+		std::size_t attribute, SortedAttributes::Entry const& entry
+	);
+
+	/// \brief Draws the attributes searched by a node, in ascending order.
+	void drawAttributes(std::vector<std::size_t>& attributes, Rng::rng_type& rng)const;
+
+	/// \brief Appends the subtree of a node to the split matrix in depth first order.
+	void storeSubtree(std::vector<Node> const& nodes, std::size_t node, SplitMatrixType& splitMatrix)const;
+
+	/// \brief Adds the statistic of a single element.
+	void addElement(double* statistics, std::size_t element)const{
+		double weight = mep_multiplicities? (*mep_multiplicities)[element] : 1.0;
+		if(m_regression){
+			RealVector const& label = (*mep_regressionLabels)[element];
+			double normSqr = 0;
+			for(std::size_t k = 0; k != m_labelDimension; ++k){
+				statistics[2+k] += weight*label(k);
+				normSqr += sqr(label(k));
+			}
+			statistics[0] += weight;
+			statistics[1] += weight*normSqr;
+		}
+		else{
+			statistics[(*mep_classLabels)[element]] += weight;
+		}
+	}
+
+	/// \brief Number of elements described by the statistics.
+	double count(double const* statistics)const;
+	/// \brief Impurity times number of elements.
+	double cost(double const* statistics)const;
+	/// \brief Fills label and error of a node.
+	void setNodeInfo(CARTClassifier<RealVector>::SplitInfo& info, double const* statistics)const;
+
+	SortedAttributes const& m_attributes;
+	/// labels in the classification case
+	std::vector<unsigned int> const* mep_classLabels;
+	/// labels in the regression case
+	std::vector<RealVector> const* mep_regressionLabels;
+	/// number of times every element is counted, 0 if every element counts once
+	std::vector<unsigned int> const* mep_multiplicities;
+	bool m_regression;
+	std::size_t m_labelDimension;
+
+	/// number of statistics per node: the number of classes or 2+labelDimension for count, squared norm and label sum
+	std::size_t m_stride;
+
+	std::size_t m_nodeSize;
+	std::size_t m_try;
+
+	/// statistics of the right child of a split
+	std::vector<double> m_right;
+};
+
+}}
+#endif
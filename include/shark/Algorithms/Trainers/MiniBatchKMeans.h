@@ -0,0 +1,113 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Mini-batch k-means for large and streamed datasets
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#ifndef SHARK_ALGORITHMS_TRAINERS_MINIBATCHKMEANS_H
+#define SHARK_ALGORITHMS_TRAINERS_MINIBATCHKMEANS_H
+
+#include <shark/Algorithms/Trainers/AbstractTrainer.h>
+#include <shark/Models/Clustering/Centroids.h>
+
+namespace shark{
+
+///
+/// \brief Mini-batch k-means clustering.
+///
+/// \par
+/// Instead of assigning all points to the centroids before the centroids are moved,
+/// mini-batch k-means moves the centroids after every batch of points
+/// (D. Sculley, Web-Scale K-Means Clustering, WWW 2010). The points of a batch are assigned
+/// to their closest centroid, then every centroid c is moved towards its points x by
+/// \f$ c \leftarrow (1-\eta_c) c + \eta_c x \f$ with the per-centroid learning rate
+/// \f$ \eta_c = 1/n_c \f$, where \f$ n_c \f$ is the number of points assigned to c so far.
+/// Thus every centroid is the running mean of the points it has seen.
+///
+/// \par
+/// train() passes over the batches of a dataset in random order for a number of epochs.
+/// Datasets which do not fit into memory can be streamed by calling update() with batches
+/// as they are read, e.g. from parts of the dataset stored with export_binary or from
+/// chunks of a csv file. The counts of the centroids are kept between calls of update(),
+/// resetCounts() starts a new run.
+///
+class MiniBatchKMeans : public AbstractUnsupervisedTrainer<Centroids>
+{
+public:
+	/// \brief Constructor.
+	///
+	/// \param numberOfClusters  number of centroids; 0 keeps the number of centroids of the model
+	/// \param epochs            number of passes over the dataset done by train
+	MiniBatchKMeans(std::size_t numberOfClusters = 0, std::size_t epochs = 10)
+	: m_numberOfClusters(numberOfClusters), m_epochs(epochs){}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "MiniBatchKMeans"; }
+
+	std::size_t numberOfClusters()const{
+		return m_numberOfClusters;
+	}
+	void setNumberOfClusters(std::size_t numberOfClusters){
+		m_numberOfClusters = numberOfClusters;
+	}
+
+	std::size_t epochs()const{
+		return m_epochs;
+	}
+	void setEpochs(std::size_t epochs){
+		m_epochs = epochs;
+	}
+
+	/// \brief Number of points assigned to every centroid since the last reset.
+	std::vector<std::size_t> const& clusterCounts()const{
+		return m_counts;
+	}
+	/// \brief Forgets the number of points seen by the centroids.
+	///
+	/// The next update treats the centroids of the model as initial guesses.
+	void resetCounts(){
+		m_counts.clear();
+	}
+
+	/// \brief Clusters the dataset by passing over its batches in random order.
+	///
+	/// If the model does not have the requested number of centroids, it is initialized
+	/// by k-means++ seeding, see Centroids::initFromData. The counts of the centroids are reset.
+	void train(Centroids& model, UnlabeledData<RealVector> const& inputs);
+
+	/// \brief Moves the centroids of the model towards a batch of points.
+	///
+	/// The model must already hold the centroids, e.g. from Centroids::initFromData
+	/// applied to the first batches of the stream.
+	void update(Centroids& model, RealMatrix const& batch);
+
+	/// from ISerializable
+	void read(InArchive& archive);
+
+	/// from ISerializable
+	void write(OutArchive& archive) const;
+
+private:
+	std::size_t m_numberOfClusters;
+	std::size_t m_epochs;
+	std::vector<std::size_t> m_counts;///< number of points assigned to each centroid
+};
+
+}
+#endif
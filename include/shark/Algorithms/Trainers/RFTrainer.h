@@ -28,8 +28,7 @@
 
 #include <shark/Algorithms/Trainers/AbstractTrainer.h>
 #include <shark/Models/Trees/RFClassifier.h>
-
-#include <boost/unordered_map.hpp>
+#include <shark/Rng/GlobalRng.h>
 
 namespace shark {
 /*!
@@ -38,8 +37,11 @@ namespace shark {
  * Random Forest is an ensemble learner, that builds multiple binary decision trees.
  * The trees are built using a variant of the CART methodology
  *
- * The algorithm used to generate each tree based on the SPRINT algorithm, as
- * shown by J. Shafer et al.
+ * The attributes are sorted once for the whole dataset. Each tree is grown level
+ * by level on these shared tables, as in the SLIQ algorithm by M. Mehta et al.:
+ * every element of the sample of a tree stores its node, and one scan of the
+ * sorted table of an attribute evaluates the splits of all nodes of a level
+ * searching that attribute. No tree copies or partitions the tables.
  *
  * Typically 100+ trees are built, and classification/regression is done by combining
  * the results generated by each tree. Typically the a majority vote is used in the
@@ -55,12 +57,19 @@ namespace shark {
  * After growing a maximum sized tree, the tree is added to the ensemble
  * without pruning.
  *
+ * The trees are independent of each other and are therefore grown in parallel
+ * when OpenMP is enabled. Every tree draws its random numbers from its own
+ * generator, which is seeded from the global Rng before training starts.
+ * Thus, for a fixed seed of the global Rng, the same forest is obtained
+ * regardless of the number of threads. The trees are added to the
+ * RFClassifier in the order of their index.
+ *
  * For detailed information about Random Forest, see Random Forest
  * by L. Breiman et al. 2001.
  *
- * For detailed information about the SPRINT algorithm, see
- * SPRINT: A Scalable Parallel Classifier for Data Mining
- * by J. Shafer et al.
+ * For detailed information about the SLIQ algorithm, see
+ * SLIQ: A Fast Scalable Classifier for Data Mining
+ * by M. Mehta et al.
  */
 class RFTrainer 
 : public AbstractTrainer<RFClassifier, unsigned int>
@@ -95,46 +104,93 @@ public:
 	/// out of bag sample. The default value is 0.66.
 	void setOOBratio(double ratio);
 
-protected:
-	/// attribute table
-	typedef std::vector < RealVector > AttributeTable;
-	/// collecting of attribute tables
-	typedef std::vector < AttributeTable > AttributeTables;
-
-	/// Create attribute tables from a data set, and in the process create a count matrix (cAbove).
-	/// A dataset with m features results in m attribute tables.
-	/// [attribute | class/value | row id ]
-	void createAttributeTables(Data<RealVector> const& dataset, AttributeTables& tables);
-
-	/// Create a count matrix as used in the classification case.
-	void createCountMatrix(const ClassificationDataset& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove);
-
-	// Split attribute tables into left and right parts.
-	void splitAttributeTables(const AttributeTables& tables, std::size_t index, std::size_t valIndex, AttributeTables& LAttributeTables, AttributeTables& RAttributeTables);
-
-	/// Build a decision tree for classification
-	RFClassifier::SplitMatrixType buildTree(const AttributeTables& tables, const ClassificationDataset& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId);
-
-	/// Builds a decision tree for regression
-	RFClassifier::SplitMatrixType buildTree(const AttributeTables& tables, const RegressionDataset& dataset, const std::vector<RealVector>& labels, std::size_t nodeId);
-
-	/// comparison function for sorting an attributeTable
-	static bool tableSort(const RealVector& inner1, const RealVector& inner2);
+	/// \brief Grow the trees on histograms of quantized attributes.
+	///
+	/// Every attribute is quantized once into at most bins bins, 2 <= bins <= 256, and the split
+	/// search only considers the bin boundaries as thresholds. This is much faster on large
+	/// datasets, but the thresholds are coarser. 0 selects the exact search on the sorted
+	/// attribute tables, which is the default.
+	void setHistogramBins(std::size_t bins);
+
+	/// \brief Controls whether the permutation importance of the attributes is estimated.
+	///
+	/// The out-of-bag error is always computed. The importances require one additional
+	/// evaluation of every tree on its out-of-bag elements per attribute used by the tree.
+	/// The default is false, the importances of the model are zero then.
+	void setComputeFeatureImportances(bool compute);
+
+	/// \brief Draw bootstrap samples with replacement for growing the trees.
+	///
+	/// Every tree is grown on numberOfElements draws with replacement and the OOB ratio is
+	/// not used. Elements drawn several times are weighted by their multiplicity, the data is never copied.
+	/// The default is false: every tree is grown on a subset of the data drawn without replacement.
+	void setSampleWithReplacement(bool replace);
 
-	/// Generate a histogram from the count matrix.
-	RealVector hist(boost::unordered_map<std::size_t, std::size_t> countMatrix);
-
-	/// Average label over a vector.
-	RealVector average(const std::vector<RealVector>& labels);
-
-	/// Calculate the Gini impurity of the countMatrix
-	double gini(boost::unordered_map<std::size_t, std::size_t>& countMatrix, std::size_t n);
-
-	/// Total Sum Of Squares
-	double totalSumOfSquares(std::vector<RealVector>& labels, std::size_t from, std::size_t to, const RealVector& sumLabel);
-
-	/// Generate random table indices.
-	void generateRandomTableIndicies(std::set<std::size_t>& tableIndicies);
+protected:
+	/// \brief Out-of-bag results of a single tree.
+	struct TreeOOBResults{
+		/// indices of the elements not used for growing the tree
+		std::vector<std::size_t> indices;
+		/// predictions of the tree for these elements
+		RealMatrix predictions;
+		/// increase of the out-of-bag error of the tree after permuting an attribute, empty if not computed
+		RealVector importances;
+	};
+
+	/// \brief Statistics of the out-of-bag elements, which are accumulated while the trees are grown.
+	///
+	/// The results of the trees are added in the order of the trees, so that the sums
+	/// do not depend on the number of threads or the scheduling.
+	struct OOBStatistics{
+		/// sum of the predictions of all trees for which an element is out of bag
+		RealMatrix predictions;
+		/// number of trees for which an element is out of bag
+		std::vector<std::size_t> hits;
+		/// sum over all trees of the increase of the out-of-bag error after permuting an attribute
+		RealVector importances;
+		/// results of finished trees which wait for a tree with a smaller index
+		std::vector<TreeOOBResults> pending;
+		std::vector<char> finished;
+		/// index of the next tree whose results are added
+		std::size_t nextTree;
+	};
+
+	/// Allocates the sums of the statistics for the given number of elements and labels.
+	void initOOBStatistics(OOBStatistics& statistics, std::size_t numElements, std::size_t labelDimension)const;
+
+	/// batch and position inside the batch of every element of a dataset
+	typedef std::vector<std::pair<std::size_t, std::size_t> > ElementPositions;
+
+	/// Find the position of every element in the batches of the inputs.
+	void createElementPositions(Data<RealVector> const& inputs, ElementPositions& positions);
+
+	/// \brief Evaluates a new tree on the elements not used for growing it.
+	///
+	/// This is called in parallel for different trees.
+	template<class Label>
+	void computeOOBResults(
+		RFClassifier::SplitMatrixType const& tree,
+		Data<RealVector> const& inputs, ElementPositions const& positions, std::vector<Label> const& labels,
+		std::vector<std::size_t> const& subsetIndices, Rng::rng_type& rng, TreeOOBResults& results
+	)const;
+
+	/// \brief Adds the results of the t-th tree and of all finished trees following it to the statistics.
+	///
+	/// If a tree with a smaller index is not finished, the results are kept until it is.
+	void addOOBResults(std::size_t t, TreeOOBResults& results, OOBStatistics& statistics)const;
+
+	/// Computes the out-of-bag error and the feature importances from the statistics and stores them in the model.
+	template<class Label>
+	void setOOBResults(RFClassifier& model, OOBStatistics const& statistics, std::vector<Label> const& labels)const;
+
+	/// \brief Draw the sample of the dataset used for growing a single tree.
+	///
+	/// The sample is not copied, it is described by the number of times every element was drawn.
+	/// The subset indices are the elements drawn at least once.
+	void generateSubsetIndices(std::vector<std::size_t>& subsetIndices, std::vector<unsigned int>& multiplicities, std::size_t numElements, Rng::rng_type& rng);
+
+	/// Draw one seed for every tree from the global Rng.
+	std::vector<Rng::rng_type::result_type> generateTreeSeeds()const;
 
 	/// Reset the training to its default parameters.
 	void setDefaults();
@@ -162,6 +218,15 @@ protected:
 	/// 0 < m_OOBratio < 1
 	double m_OOBratio;
 
+	/// number of bins of the quantized attributes, 0 for the exact split search
+	std::size_t m_histogramBins;
+
+	/// whether the permutation importances of the attributes are estimated
+	bool m_computeFeatureImportances;
+
+	/// whether the samples of the trees are drawn with replacement
+	bool m_sampleWithReplacement;
+
 	/// true if the trainer is used for regression, false otherwise.
 	bool m_regressionLearner;
 };
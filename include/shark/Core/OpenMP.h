@@ -40,6 +40,9 @@
 #define SHARK_PARALLEL_FOR __pragma(omp parallel for)\
 for
 
+#define SHARK_PARALLEL_FOR_DYNAMIC __pragma(omp parallel for schedule(dynamic))\
+for
+
 #define SHARK_CRITICAL_REGION __pragma(omp critical)
 
 #else
@@ -47,17 +50,24 @@ for
 _Pragma ( "omp parallel for" )\
 for
 
+#define SHARK_PARALLEL_FOR_DYNAMIC \
+_Pragma ( "omp parallel for schedule(dynamic)" )\
+for
+
 #define SHARK_CRITICAL_REGION _Pragma("omp critical")
 #endif
 
 #define SHARK_NUM_THREADS (std::size_t)(omp_in_parallel()?omp_get_num_threads():omp_get_max_threads())
 #define SHARK_THREAD_NUM (std::size_t)(omp_in_parallel()?omp_get_thread_num():0)
+#define SHARK_IN_PARALLEL (omp_in_parallel() != 0)
 
 #else
 #define SHARK_PARALLEL_FOR for
+#define SHARK_PARALLEL_FOR_DYNAMIC for
 #define SHARK_CRITICAL_REGION
 #define SHARK_NUM_THREADS (std::size_t)1
 #define SHARK_THREAD_NUM (std::size_t)0
+#define SHARK_IN_PARALLEL false
 #endif
 
 #endif
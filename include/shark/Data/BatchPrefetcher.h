@@ -0,0 +1,206 @@
+//===========================================================================
+/*!
+ *  \brief Background preparation of shuffled mini-batches
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_BATCHPREFETCHER_H
+#define SHARK_DATA_BATCHPREFETCHER_H
+
+#include <shark/Data/Dataset.h>
+#include <shark/Data/DataView.h>
+#include <shark/Rng/GlobalRng.h>
+#include <shark/Core/Exception.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <vector>
+#include <limits>
+
+namespace shark {
+
+///\brief Prepares the mini-batches of a dataset in a background thread.
+///
+///Stochastic gradient methods consume one small batch of randomly chosen elements
+///per step. Gathering the elements of a batch from a large dataset takes time which
+///can be spent while the optimizer works on the previous batch. The prefetcher runs
+///a thread which walks through a random permutation of the elements, copies the next
+///batchSize elements into a new dataset and keeps up to queueSize of them ready. If the
+///size of the dataset is not a multiple of batchSize, the last batch of an epoch holds the
+///remaining elements. Afterwards the elements are shuffled again and the next epoch starts,
+///thus every element is used exactly once per epoch.
+///
+///The batches are returned as datasets which are split into the given number of
+///smaller batches, so that the batches can be processed by several threads, for example
+///by the parallel ErrorFunction.
+///
+///The random numbers of the background thread are drawn from its own generator which
+///is seeded with the global Rng on construction. Thus the sequence of batches is
+///reproducible and does not interfere with the global Rng.
+template<class DatasetType>
+class BatchPrefetcher : private boost::noncopyable{
+public:
+	///\brief Starts preparing batches of the dataset.
+	///
+	///\param dataset the dataset the batches are drawn from, it must not be changed while the prefetcher exists
+	///\param batchSize number of elements of a batch, at most the size of the dataset
+	///\param subBatches number of batches every returned dataset is split into
+	///\param queueSize maximum number of batches which are prepared in advance
+	///\param shuffle whether the elements are shuffled every epoch or taken in the order of the dataset
+	BatchPrefetcher(
+		DatasetType const& dataset, std::size_t batchSize,
+		std::size_t subBatches = 1, std::size_t queueSize = 2, bool shuffle = true
+	)
+	: m_view(dataset)
+	, m_batchSize(std::min(batchSize, dataset.numberOfElements()))
+	, m_subBatches(subBatches)
+	, m_queueSize(queueSize)
+	, m_shuffle(shuffle)
+	, m_position(0)
+	, m_epoch(0)
+	, m_stop(false)
+	, m_failed(false){
+		SHARK_CHECK(m_batchSize > 0, "[BatchPrefetcher] batch size and dataset must not be empty");
+		SHARK_CHECK(subBatches > 0 && queueSize > 0, "[BatchPrefetcher] number of sub batches and queue size must be positive");
+		m_rng.seed((unsigned int)Rng::discrete(0, std::numeric_limits<int>::max()));
+		m_permutation.resize(m_view.size());
+		for(std::size_t i = 0; i != m_permutation.size(); ++i)
+			m_permutation[i] = i;
+		if(m_shuffle)
+			shufflePermutation();
+		m_thread = boost::thread(&BatchPrefetcher::run, this);
+	}
+
+	~BatchPrefetcher(){
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			m_stop = true;
+		}
+		m_changed.notify_all();
+		m_thread.join();
+	}
+
+	///\brief Returns the next batch, waits if it is not ready yet.
+	DatasetType next(){
+		boost::mutex::scoped_lock lock(m_mutex);
+		while(m_queue.empty() && !m_failed)
+			m_changed.wait(lock);
+		if(m_queue.empty())
+			throw SHARKEXCEPTION("[BatchPrefetcher::next] preparing a batch failed: " + m_error);
+		DatasetType batch = m_queue.front();
+		m_queue.pop_front();
+		lock.unlock();
+		m_changed.notify_all();
+		return batch;
+	}
+
+	///\brief Maximum number of elements of a batch, the last batch of an epoch may be smaller.
+	std::size_t batchSize()const{
+		return m_batchSize;
+	}
+
+	std::size_t subBatches()const{
+		return m_subBatches;
+	}
+
+	///\brief Number of epochs the background thread has completed, the batches in the queue may belong to an earlier one.
+	std::size_t epoch()const{
+		boost::mutex::scoped_lock lock(m_mutex);
+		return m_epoch;
+	}
+
+private:
+	typedef DataView<DatasetType const> ViewType;
+
+	void run(){
+		try{
+			for(;;){
+				DatasetType batch = createBatch();
+				boost::mutex::scoped_lock lock(m_mutex);
+				while(m_queue.size() >= m_queueSize && !m_stop)
+					m_changed.wait(lock);
+				if(m_stop)
+					return;
+				m_queue.push_back(batch);
+				lock.unlock();
+				m_changed.notify_all();
+			}
+		}
+		catch(std::exception const& e){
+			boost::mutex::scoped_lock lock(m_mutex);
+			m_failed = true;
+			m_error = e.what();
+		}
+		m_changed.notify_all();
+	}
+
+	DatasetType createBatch(){
+		if(m_position == m_permutation.size()){
+			if(m_shuffle)
+				shufflePermutation();
+			m_position = 0;
+			boost::mutex::scoped_lock lock(m_mutex);
+			++m_epoch;
+		}
+		//the last batch of an epoch is shorter if the batch size does not divide the dataset size
+		std::size_t end = std::min(m_position + m_batchSize, m_permutation.size());
+		std::vector<std::size_t> indices(
+			m_permutation.begin() + m_position,
+			m_permutation.begin() + end
+		);
+		m_position = end;
+		std::size_t subBatchSize = (indices.size() + m_subBatches - 1) / m_subBatches;
+		return toDataset(subset(m_view, indices), subBatchSize);
+	}
+
+	void shufflePermutation(){
+		DiscreteUniform<Rng::rng_type> uni(m_rng);
+		for(std::size_t i = m_permutation.size(); i > 1; --i)
+			std::swap(m_permutation[i-1], m_permutation[uni(0, i-1)]);
+	}
+
+	ViewType m_view;
+	std::size_t m_batchSize;
+	std::size_t m_subBatches;
+	std::size_t m_queueSize;
+	bool m_shuffle;
+
+	//state of the background thread
+	Rng::rng_type m_rng;
+	std::vector<std::size_t> m_permutation;
+	std::size_t m_position;
+
+	//shared state, guarded by m_mutex
+	mutable boost::mutex m_mutex;
+	boost::condition_variable m_changed;
+	std::deque<DatasetType> m_queue;
+	std::size_t m_epoch;
+	bool m_stop;
+	bool m_failed;
+	std::string m_error;
+
+	boost::thread m_thread;
+};
+
+}
+#endif
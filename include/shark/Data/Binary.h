@@ -0,0 +1,143 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Import and export of datasets in a native binary format
+ *
+ *  \par
+ *  The format stores every batch of a dataset as one contiguous block, so that
+ *  loading a dataset does not require any parsing. Files are memory mapped
+ *  when they are read and the batches are copied from the mapping in parallel.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_BINARY_H
+#define SHARK_DATA_BINARY_H
+
+#include <shark/Data/Dataset.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace shark {
+
+/**
+ * \ingroup shark_globals
+ *
+ * @{
+ */
+
+/// \brief Version of the binary dataset format written by export_binary.
+///
+/// \par
+/// A file starts with a header holding the magic string "SHARKDAT", the format version,
+/// a byte order mark and the number of sections. Every section stores a Data object,
+/// labeled data is stored as the section of the inputs followed by the section of the labels.
+/// A section consists of the type of the data, the number of batches, the dimension and a table
+/// with the number of rows, the number of nonzero elements and the file offset of every batch.
+/// The contents of a batch start at a multiple of 64 bytes:
+///  - dense vectors are stored as row major matrix of doubles
+///  - sparse vectors are stored in compressed row format: rows+1 row starts and
+///    the column indices as 64 bit integers followed by the nonzero values
+///  - unsigned int labels are stored as array of 32 bit integers.
+///
+/// Files are written in the byte order of the machine, reading a file with a different
+/// byte order or a newer version throws an exception.
+static const unsigned int BinaryFormatVersion = 1;
+
+/// \brief Export data to a binary file.
+void export_binary(Data<RealVector> const& data, std::string const& fn);
+/// \brief Export data to a binary file.
+void export_binary(Data<CompressedRealVector> const& data, std::string const& fn);
+/// \brief Export data to a binary file.
+void export_binary(Data<unsigned int> const& data, std::string const& fn);
+/// \brief Export labeled data to a binary file.
+void export_binary(LabeledData<RealVector, unsigned int> const& dataset, std::string const& fn);
+/// \brief Export labeled data to a binary file.
+void export_binary(LabeledData<CompressedRealVector, unsigned int> const& dataset, std::string const& fn);
+/// \brief Export labeled data to a binary file.
+void export_binary(LabeledData<RealVector, RealVector> const& dataset, std::string const& fn);
+
+/// \brief Import data from a binary file written by export_binary.
+///
+/// All batches are copied from the memory mapped file into the dataset in parallel. The batches
+/// are the same as in the exported dataset. Use BinaryDataFile to read only some of the batches.
+void import_binary(Data<RealVector>& data, std::string const& fn);
+/// \brief Import data from a binary file written by export_binary.
+void import_binary(Data<CompressedRealVector>& data, std::string const& fn);
+/// \brief Import data from a binary file written by export_binary.
+void import_binary(Data<unsigned int>& data, std::string const& fn);
+/// \brief Import labeled data from a binary file written by export_binary.
+void import_binary(LabeledData<RealVector, unsigned int>& dataset, std::string const& fn);
+/// \brief Import labeled data from a binary file written by export_binary.
+void import_binary(LabeledData<CompressedRealVector, unsigned int>& dataset, std::string const& fn);
+/// \brief Import labeled data from a binary file written by export_binary.
+void import_binary(LabeledData<RealVector, RealVector>& dataset, std::string const& fn);
+
+/** @}*/
+
+/// \brief Random access to the batches of a binary file without loading the whole file.
+///
+/// \par
+/// The file stays memory mapped as long as the object or one of its copies exists. Opening the
+/// file only reads the header and the batch table. A batch is copied out of the mapping when it is
+/// requested, so the operating system only reads the pages of the requested batches from disk.
+/// This allows to process datasets which do not fit into memory one batch at a time, or to load
+/// only a subset of the batches, e.g. the training part of a split.
+///
+/// \par
+/// A file written by export_binary for labeled data holds the inputs in section 0 and the labels
+/// in section 1. Reading batches is thread-safe, the mapping is never written.
+///
+/// The class is instantiated for RealVector, CompressedRealVector and unsigned int.
+template<class T>
+class BinaryDataFile{
+public:
+	typedef typename Batch<T>::type BatchType;
+
+	/// \brief Maps the file and reads the table of the given section.
+	///
+	/// Throws an exception if the file is not a binary dataset, the section does not exist
+	/// or does not hold data of type T.
+	BinaryDataFile(std::string const& fn, std::size_t section = 0);
+
+	std::size_t numberOfBatches()const;
+	/// \brief Number of elements of the whole section.
+	std::size_t numberOfElements()const;
+	/// \brief Number of elements of a batch, read from the table without copying the batch.
+	std::size_t batchSize(std::size_t b)const;
+
+	/// \brief Copies the b-th batch out of the file.
+	void readBatch(std::size_t b, BatchType& batch)const;
+	/// \brief Copies the b-th batch out of the file.
+	BatchType batch(std::size_t b)const{
+		BatchType result;
+		readBatch(b, result);
+		return result;
+	}
+
+	/// \brief Copies the batches with the given indices into a new dataset in parallel.
+	Data<T> data(std::vector<std::size_t> const& batches)const;
+	/// \brief Copies all batches into a new dataset in parallel.
+	Data<T> data()const;
+
+private:
+	struct Impl;
+	boost::shared_ptr<Impl const> mp_impl;
+};
+
+}
+#endif
@@ -307,8 +307,20 @@ void csvStringToData(
 );
 
 
+namespace detail{
+// readers of csv files for the element types supported by import_csv(Data<T>&,...)
+void import_csv(Data<RealVector>& data, std::string const& fn, char separator, char comment, std::size_t maximumBatchSize);
+void import_csv(Data<int>& data, std::string const& fn, char separator, char comment, std::size_t maximumBatchSize);
+void import_csv(Data<unsigned int>& data, std::string const& fn, char separator, char comment, std::size_t maximumBatchSize);
+void import_csv(Data<double>& data, std::string const& fn, char separator, char comment, std::size_t maximumBatchSize);
+}
+
 /// \brief Import a Dataset from a csv file
 ///
+/// The file is read in chunks of whole lines which are parsed in parallel and written
+/// straight into the batches, so the file itself is never held in memory completely.
+/// All batches but the last have maximumBatchSize elements.
+///
 /// \param  data       Container storing the loaded data
 /// \param  fn         The file to be read from
 /// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
@@ -322,15 +334,7 @@ void import_csv(
 	char comment = '#',
 	std::size_t maximumBatchSize = Data<T>::DefaultBatchSize
 ){
-	std::ifstream stream(fn.c_str());
-	stream.unsetf(std::ios::skipws);
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
-	//call the actual parser
-	csvStringToData(data,contents,separator,comment,maximumBatchSize);
+	detail::import_csv(data,fn,separator,comment,maximumBatchSize);
 }
 
 /// \brief Import a labeled Dataset from a csv file
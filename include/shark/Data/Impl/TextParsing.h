@@ -0,0 +1,250 @@
+/*!
+ *  \brief Tools for reading and parsing large text files in parallel.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_DATA_IMPL_TEXTPARSING_H
+#define SHARK_DATA_IMPL_TEXTPARSING_H
+
+#include <shark/Core/Exception.h>
+#include <shark/Core/OpenMP.h>
+#include <boost/cstdint.hpp>
+#include <istream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+#include <cmath>
+
+namespace shark{ namespace detail{
+
+/// \brief Returns true for the characters that end a line: '\n' and '\r'.
+inline bool isLineBreak(char c){
+	return c == '\n' || c == '\r';
+}
+
+/// \brief Returns true for spaces and tabs.
+inline bool isBlank(char c){
+	return c == ' ' || c == '\t';
+}
+
+inline void skipBlanks(char const*& pos, char const* end){
+	while(pos != end && isBlank(*pos)) ++pos;
+}
+
+/// \brief Returns the end of the line starting at pos, which is either a line break or end.
+inline char const* findLineEnd(char const* pos, char const* end){
+	while(pos != end && !isLineBreak(*pos)) ++pos;
+	return pos;
+}
+
+/// \brief Matches a lower case keyword at pos, ignoring the case of the input.
+inline bool matchKeyword(char const* pos, char const* end, char const* keyword){
+	for(; *keyword; ++keyword, ++pos){
+		if(pos == end || (*pos | 0x20) != *keyword) return false;
+	}
+	return true;
+}
+
+/// \brief Parses a floating point number starting at pos.
+///
+/// On success, value holds the number, pos points behind it and true is returned. Otherwise pos is unchanged.
+/// Numbers with at most 19 significant digits and a decimal exponent of at most 22 are converted
+/// exactly by a single multiplication or division with a power of ten, all other numbers are passed to strtod.
+/// This gives correctly rounded results and is several times faster than a stream or spirit based parser.
+/// nan, inf and infinity are accepted regardless of case.
+inline bool parseDouble(char const*& pos, char const* end, double& value){
+	static double const powersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	char const* p = pos;
+	bool negative = false;
+	if(p != end && (*p == '-' || *p == '+')){
+		negative = *p == '-';
+		++p;
+	}
+
+	boost::uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	bool truncated = false;
+	for(; p != end && *p >= '0' && *p <= '9'; ++p){
+		anyDigits = true;
+		if(significantDigits < 19){
+			mantissa = mantissa*10 + (*p - '0');
+			if(mantissa) ++significantDigits;
+		}else{
+			++exponent;
+			truncated = true;
+		}
+	}
+	if(p != end && *p == '.'){
+		++p;
+		for(; p != end && *p >= '0' && *p <= '9'; ++p){
+			anyDigits = true;
+			if(significantDigits < 19){
+				mantissa = mantissa*10 + (*p - '0');
+				if(mantissa) ++significantDigits;
+				--exponent;
+			}else{
+				truncated = true;
+			}
+		}
+	}
+	if(!anyDigits){
+		double special;
+		if(matchKeyword(p, end, "nan")){
+			special = std::numeric_limits<double>::quiet_NaN();
+			p += 3;
+		}else if(matchKeyword(p, end, "infinity")){
+			special = std::numeric_limits<double>::infinity();
+			p += 8;
+		}else if(matchKeyword(p, end, "inf")){
+			special = std::numeric_limits<double>::infinity();
+			p += 3;
+		}else
+			return false;
+		value = negative? -special: special;
+		pos = p;
+		return true;
+	}
+	if(p != end && (*p == 'e' || *p == 'E')){
+		char const* exponentStart = p;
+		++p;
+		bool negativeExponent = false;
+		if(p != end && (*p == '-' || *p == '+')){
+			negativeExponent = *p == '-';
+			++p;
+		}
+		if(p == end || *p < '0' || *p > '9'){
+			p = exponentStart;//not an exponent, e.g. "1e" is the number 1 followed by 'e'
+		}else{
+			int explicitExponent = 0;
+			for(; p != end && *p >= '0' && *p <= '9'; ++p){
+				if(explicitExponent < 100000)
+					explicitExponent = explicitExponent*10 + (*p - '0');
+			}
+			exponent += negativeExponent? -explicitExponent : explicitExponent;
+		}
+	}
+
+	if(!truncated && mantissa <= (boost::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22){
+		double result = double(mantissa);
+		result = exponent < 0? result / powersOf10[-exponent] : result * powersOf10[exponent];
+		value = negative? -result: result;
+	}else{
+		std::string number(pos, p);
+		value = std::strtod(number.c_str(), 0);
+	}
+	pos = p;
+	return true;
+}
+
+/// \brief Converts a parsed number to an integer label and throws if it is not integral.
+///
+/// Labels are usually written as integers, but 2.000 or 1. are accepted as well.
+inline int integerLabel(double value){
+	if(!(value == std::floor(value)) || std::abs(value) > std::numeric_limits<int>::max())
+		throw SHARKEXCEPTION("[integerLabel] labels must be integral numbers");
+	return (int) value;
+}
+
+/// \brief Splits [begin,end) into at most maxParts ranges of roughly equal size which start at the beginning of a line.
+///
+/// The returned vector holds the boundaries of the ranges, the i-th range is [bounds[i],bounds[i+1]).
+inline std::vector<char const*> splitAtLines(char const* begin, char const* end, std::size_t maxParts){
+	std::vector<char const*> bounds(1,begin);
+	std::size_t partSize = (end-begin)/maxParts+1;
+	char const* pos = begin;
+	while(end - pos > std::ptrdiff_t(partSize)){
+		pos = findLineEnd(pos+partSize, end);
+		while(pos != end && isLineBreak(*pos)) ++pos;
+		if(pos != end)
+			bounds.push_back(pos);
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+/// \brief Parses the lines in [begin,end) in parallel.
+///
+/// The range is split into line aligned parts which are handed to parser(partBegin, partEnd, result)
+/// together with an own result object, results are stored in the order of the parts.
+/// Exceptions thrown by the parser are rethrown after all parts are processed.
+template<class Result, class Parser>
+void parseLinesInParallel(char const* begin, char const* end, Parser const& parser, std::vector<Result>& results){
+	//parts should be large enough to be worth a thread, but small enough to balance the work
+	std::size_t const minimumPartSize = 1 << 16;
+	std::size_t maxParts = std::min<std::size_t>(4*SHARK_NUM_THREADS, (end-begin)/minimumPartSize+1);
+	std::vector<char const*> bounds = splitAtLines(begin, end, maxParts);
+	std::size_t parts = bounds.size()-1;
+	results.clear();
+	results.resize(parts);
+	std::vector<std::string> errors(parts);
+	SHARK_PARALLEL_FOR_DYNAMIC(int i = 0; i < (int)parts; ++i){
+		try{
+			parser(bounds[i], bounds[i+1], results[i]);
+		}catch(std::exception const& e){
+			errors[i] = e.what();
+		}
+	}
+	for(std::size_t i = 0; i != parts; ++i){
+		if(!errors[i].empty())
+			throw SHARKEXCEPTION(errors[i]);
+	}
+}
+
+/// \brief Reads a stream in chunks of complete lines.
+///
+/// Every chunk has about the given size, only lines longer than a chunk lead to larger chunks.
+/// This allows to process arbitrarily large files with bounded memory.
+class LineChunkReader{
+public:
+	LineChunkReader(std::istream& stream, std::size_t chunkSize = std::size_t(1) << 24)
+	: m_stream(stream), m_chunkSize(chunkSize){}
+
+	/// \brief Reads the next chunk. Returns false if the stream is exhausted.
+	bool read(std::string& chunk){
+		chunk.swap(m_remainder);
+		m_remainder.clear();
+		while(m_stream){
+			std::size_t start = chunk.size();
+			chunk.resize(start + m_chunkSize);
+			m_stream.read(&chunk[start], m_chunkSize);
+			chunk.resize(start + std::size_t(m_stream.gcount()));
+			if(!m_stream)//end of file, the chunk holds the rest of the stream
+				break;
+			std::size_t lastBreak = chunk.find_last_of("\r\n");
+			if(lastBreak != std::string::npos){
+				m_remainder.assign(chunk, lastBreak+1, std::string::npos);
+				chunk.resize(lastBreak+1);
+				break;
+			}
+			//no line break yet, the line continues in the next block
+		}
+		return !chunk.empty();
+	}
+private:
+	std::istream& m_stream;
+	std::size_t m_chunkSize;
+	/// beginning of the line which was cut at the end of the last chunk
+	std::string m_remainder;
+};
+
+}}
+#endif
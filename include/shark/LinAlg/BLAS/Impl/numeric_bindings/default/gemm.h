@@ -32,10 +32,14 @@
 #ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMM_HPP
 #define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMM_HPP
 
+#include "gemmKernel.h"
+
 namespace shark { namespace blas { namespace bindings {
 
 // C <- alpha * op (A) * op (B) + beta * C
 // op (A) == A || A^T || A^H
+// All matrices must be dense. The product is computed by a cache blocked kernel working
+// directly on the storage of the matrices, so no temporary copies of the arguments are needed.
 template <typename T, typename MatA, typename MatB, typename MatC>
 void gemm(
 T alpha, matrix_expression<MatA> const &matA, 
@@ -43,32 +47,23 @@ matrix_expression<MatB> const &matB,
 T beta, 
 matrix_expression<MatC>& matC
 ) {
-	if(alpha != 1.0){
-		beta /= alpha;
-	}
-	if ( beta != 1.0){
+	typedef typename MatC::value_type value_type;
+	std::size_t m = matC().size1();
+	std::size_t n = matC().size2();
+	std::size_t k = matA().size2();
+	SIZE_CHECK(matA().size1() == m);
+	SIZE_CHECK(matB().size1() == k);
+	SIZE_CHECK(matB().size2() == n);
+
+	if(beta != 1.0){
 		matC()*=beta;
 	}
-	if(traits::isRowMajor(matB)){
-		axpy_prod(matA(),matB(),matC(),false);
-	}
-	else{
-		if(traits::isRowMajor(matA)){
-			noalias(matC())+=prod(matA,matB);	
-		}else{
-			if(matA().size2()> 100){
-				matrix<typename MatB::value_type, row_major> temp=matA;
-				noalias(matC())+=prod(temp,matB);	
-			}
-			else
-			{
-				axpy_prod(matA(),matB(),matC(),false);
-			}
-		}
-	}
-	if(alpha != 1.0){
-		matC() *= alpha;
-	}
+	detail::gemmBlocked<value_type>(
+		m, n, k, alpha,
+		traits::matrix_storage(matA), traits::matrix_stride1(matA), traits::matrix_stride2(matA),
+		traits::matrix_storage(matB), traits::matrix_stride1(matB), traits::matrix_stride2(matB),
+		traits::matrix_storage(matC), traits::matrix_stride1(matC), traits::matrix_stride2(matC)
+	);
 }
 
 }}}
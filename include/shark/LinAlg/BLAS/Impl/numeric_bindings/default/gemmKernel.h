@@ -0,0 +1,318 @@
+/*!
+ *  \brief Cache blocked matrix-matrix multiplication used when no external BLAS is available.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMMKERNEL_H
+#define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMMKERNEL_H
+
+#include <shark/Core/OpenMP.h>
+#include "simd.h"
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+namespace shark { namespace blas { namespace bindings { namespace detail{
+
+///\brief Block sizes of the blocked matrix-matrix multiplication.
+///
+///A block of kc x mc elements of the left matrix is packed into a buffer, that should fit into the L2 cache,
+///kc x nc elements of the right matrix are packed into a buffer that should fit into the L3 cache.
+///The micro kernel computes mr x nr elements of the result, which are kept in registers.
+struct GemmBlockSizes{
+	static const std::size_t mr = 4;
+	static const std::size_t nr = 8;
+	static const std::size_t kc = 256;
+	static const std::size_t mc = 128;
+	static const std::size_t nc = 2048;
+};
+
+///\brief Packs a block of m x k elements of A into panels of mr rows.
+///
+///Panel r stores the elements A(r*mr+i,p) at position p*mr+i. Missing rows of the last panel are filled with zeros.
+template<class T>
+void gemmPackA(
+	T const* A, std::ptrdiff_t stride1, std::ptrdiff_t stride2,
+	std::size_t m, std::size_t k, T* buffer
+){
+	std::size_t const mr = GemmBlockSizes::mr;
+	for(std::size_t i0 = 0; i0 < m; i0 += mr){
+		std::size_t rows = std::min(mr, m-i0);
+		for(std::size_t p = 0; p != k; ++p){
+			T const* column = A + i0*stride1 + p*stride2;
+			for(std::size_t i = 0; i != rows; ++i){
+				buffer[i] = column[i*stride1];
+			}
+			for(std::size_t i = rows; i != mr; ++i){
+				buffer[i] = T();
+			}
+			buffer += mr;
+		}
+	}
+}
+
+///\brief Packs a block of k x n elements of B into panels of nr columns.
+///
+///Panel r stores the elements B(p,r*nr+j) at position p*nr+j. Missing columns of the last panel are filled with zeros.
+template<class T>
+void gemmPackB(
+	T const* B, std::ptrdiff_t stride1, std::ptrdiff_t stride2,
+	std::size_t k, std::size_t n, T* buffer
+){
+	std::size_t const nr = GemmBlockSizes::nr;
+	for(std::size_t j0 = 0; j0 < n; j0 += nr){
+		std::size_t columns = std::min(nr, n-j0);
+		for(std::size_t p = 0; p != k; ++p){
+			T const* row = B + p*stride1 + j0*stride2;
+			for(std::size_t j = 0; j != columns; ++j){
+				buffer[j] = row[j*stride2];
+			}
+			for(std::size_t j = columns; j != nr; ++j){
+				buffer[j] = T();
+			}
+			buffer += nr;
+		}
+	}
+}
+
+///\brief Computes the mr x nr product of a packed panel of A and a packed panel of B.
+///
+///The result is stored row major in tile. This is the portable version, used for all types without a SIMD kernel.
+template<class T>
+void gemmMicroKernel(std::size_t k, T const* a, T const* b, T* tile){
+	std::size_t const mr = GemmBlockSizes::mr;
+	std::size_t const nr = GemmBlockSizes::nr;
+	T accumulator[mr*nr];
+	std::fill(accumulator, accumulator+mr*nr, T());
+	for(std::size_t p = 0; p != k; ++p, a += mr, b += nr){
+		for(std::size_t i = 0; i != mr; ++i){
+			for(std::size_t j = 0; j != nr; ++j){
+				accumulator[i*nr+j] += a[i]*b[j];
+			}
+		}
+	}
+	std::copy(accumulator, accumulator+mr*nr, tile);
+}
+
+#ifdef SHARK_BLAS_DEFAULT_SSE2
+///\brief Micro kernel for double using SSE2.
+///
+///The eight columns are processed in two halves, so that the 4x4 accumulators fit into the registers.
+inline void gemmMicroKernelSSE2(std::size_t k, double const* a, double const* b, double* tile){
+	for(std::size_t half = 0; half != 2; ++half){
+		__m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+		__m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+		__m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+		__m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+		double const* pa = a;
+		double const* pb = b + 4*half;
+		for(std::size_t p = 0; p != k; ++p, pa += 4, pb += 8){
+			__m128d b0 = _mm_loadu_pd(pb);
+			__m128d b1 = _mm_loadu_pd(pb+2);
+			__m128d a0 = _mm_set1_pd(pa[0]);
+			c00 = _mm_add_pd(c00, _mm_mul_pd(a0,b0));
+			c01 = _mm_add_pd(c01, _mm_mul_pd(a0,b1));
+			__m128d a1 = _mm_set1_pd(pa[1]);
+			c10 = _mm_add_pd(c10, _mm_mul_pd(a1,b0));
+			c11 = _mm_add_pd(c11, _mm_mul_pd(a1,b1));
+			__m128d a2 = _mm_set1_pd(pa[2]);
+			c20 = _mm_add_pd(c20, _mm_mul_pd(a2,b0));
+			c21 = _mm_add_pd(c21, _mm_mul_pd(a2,b1));
+			__m128d a3 = _mm_set1_pd(pa[3]);
+			c30 = _mm_add_pd(c30, _mm_mul_pd(a3,b0));
+			c31 = _mm_add_pd(c31, _mm_mul_pd(a3,b1));
+		}
+		double* t = tile + 4*half;
+		_mm_storeu_pd(t, c00);    _mm_storeu_pd(t+2, c01);
+		_mm_storeu_pd(t+8, c10);  _mm_storeu_pd(t+10, c11);
+		_mm_storeu_pd(t+16, c20); _mm_storeu_pd(t+18, c21);
+		_mm_storeu_pd(t+24, c30); _mm_storeu_pd(t+26, c31);
+	}
+}
+#endif
+
+#ifdef SHARK_BLAS_DEFAULT_AVX2
+///\brief Micro kernel for double using AVX2 and FMA, the 4x8 accumulators use eight registers.
+__attribute__((target("avx2,fma")))
+inline void gemmMicroKernelAVX2(std::size_t k, double const* a, double const* b, double* tile){
+	__m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+	__m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+	__m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+	__m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+	for(std::size_t p = 0; p != k; ++p, a += 4, b += 8){
+		__m256d b0 = _mm256_loadu_pd(b);
+		__m256d b1 = _mm256_loadu_pd(b+4);
+		__m256d a0 = _mm256_broadcast_sd(a);
+		c00 = _mm256_fmadd_pd(a0,b0,c00);
+		c01 = _mm256_fmadd_pd(a0,b1,c01);
+		__m256d a1 = _mm256_broadcast_sd(a+1);
+		c10 = _mm256_fmadd_pd(a1,b0,c10);
+		c11 = _mm256_fmadd_pd(a1,b1,c11);
+		__m256d a2 = _mm256_broadcast_sd(a+2);
+		c20 = _mm256_fmadd_pd(a2,b0,c20);
+		c21 = _mm256_fmadd_pd(a2,b1,c21);
+		__m256d a3 = _mm256_broadcast_sd(a+3);
+		c30 = _mm256_fmadd_pd(a3,b0,c30);
+		c31 = _mm256_fmadd_pd(a3,b1,c31);
+	}
+	_mm256_storeu_pd(tile, c00);    _mm256_storeu_pd(tile+4, c01);
+	_mm256_storeu_pd(tile+8, c10);  _mm256_storeu_pd(tile+12, c11);
+	_mm256_storeu_pd(tile+16, c20); _mm256_storeu_pd(tile+20, c21);
+	_mm256_storeu_pd(tile+24, c30); _mm256_storeu_pd(tile+28, c31);
+}
+#endif
+
+typedef void (*DoubleGemmMicroKernel)(std::size_t, double const*, double const*, double*);
+
+///\brief Chooses the fastest micro kernel for double supported by the processor.
+inline DoubleGemmMicroKernel selectGemmMicroKernel(){
+#ifdef SHARK_BLAS_DEFAULT_AVX2
+	if(cpuSupportsAVX2())
+		return &gemmMicroKernelAVX2;
+#endif
+#ifdef SHARK_BLAS_DEFAULT_SSE2
+	return &gemmMicroKernelSSE2;
+#else
+	return &gemmMicroKernel<double>;
+#endif
+}
+
+///\brief Micro kernel for double, dispatches to the SIMD kernel chosen on first use.
+inline void gemmMicroKernel(std::size_t k, double const* a, double const* b, double* tile){
+	static DoubleGemmMicroKernel const kernel = selectGemmMicroKernel();
+	kernel(k, a, b, tile);
+}
+
+///\brief Computes C += alpha * A * B for packed blocks of A (m x k) and B (k x n).
+template<class T>
+void gemmMacroKernel(
+	std::size_t m, std::size_t n, std::size_t k, T alpha,
+	T const* packedA, T const* packedB,
+	T* C, std::ptrdiff_t stride1, std::ptrdiff_t stride2
+){
+	std::size_t const mr = GemmBlockSizes::mr;
+	std::size_t const nr = GemmBlockSizes::nr;
+	T tile[mr*nr];
+	for(std::size_t j0 = 0; j0 < n; j0 += nr){
+		std::size_t columns = std::min(nr, n-j0);
+		for(std::size_t i0 = 0; i0 < m; i0 += mr){
+			std::size_t rows = std::min(mr, m-i0);
+			gemmMicroKernel(k, packedA + i0*k, packedB + j0*k, tile);
+			T* block = C + i0*stride1 + j0*stride2;
+			for(std::size_t i = 0; i != rows; ++i){
+				for(std::size_t j = 0; j != columns; ++j){
+					block[i*stride1+j*stride2] += alpha*tile[i*nr+j];
+				}
+			}
+		}
+	}
+}
+
+///\brief Packs a block of rows of A into the buffer packedA and multiplies it with the packed block of B.
+template<class T>
+void gemmRowBlock(
+	std::size_t m, std::size_t n, std::size_t k, T alpha,
+	T const* A, std::ptrdiff_t strideA1, std::ptrdiff_t strideA2,
+	T const* packedB, T* packedA,
+	T* C, std::ptrdiff_t strideC1, std::ptrdiff_t strideC2
+){
+	gemmPackA(A, strideA1, strideA2, m, k, packedA);
+	gemmMacroKernel(m, n, k, alpha, packedA, packedB, C, strideC1, strideC2);
+}
+
+///\brief Computes C += alpha * A * B for dense matrices given by their storage and strides.
+///
+///The strides are the distances in memory between two rows (stride1) and two columns (stride2),
+///so every orientation and transposition of the arguments is handled by the same code.
+///The blocks of rows of C are processed in parallel when the product is large enough and
+///the function is not called from a parallel region. Every thread packs the blocks of A into
+///its own buffer, which is allocated once per call.
+template<class T>
+void gemmBlocked(
+	std::size_t m, std::size_t n, std::size_t k, T alpha,
+	T const* A, std::ptrdiff_t strideA1, std::ptrdiff_t strideA2,
+	T const* B, std::ptrdiff_t strideB1, std::ptrdiff_t strideB2,
+	T* C, std::ptrdiff_t strideC1, std::ptrdiff_t strideC2
+){
+	std::size_t const mc = GemmBlockSizes::mc;
+	std::size_t const nc = GemmBlockSizes::nc;
+	std::size_t const kc = GemmBlockSizes::kc;
+	std::size_t const mr = GemmBlockSizes::mr;
+	std::size_t const nr = GemmBlockSizes::nr;
+	if(m == 0 || n == 0 || k == 0) return;
+
+	std::vector<T> packedB(kc*((std::min(n,nc)+nr-1)/nr*nr));
+	//small products are not worth starting threads
+	bool parallel = m > mc && double(m)*n*k > 1.e6 && !SHARK_IN_PARALLEL;
+	std::size_t packedASize = std::min(kc,k)*((std::min(m,mc)+mr-1)/mr*mr);
+	std::vector<std::vector<T> > packedA(parallel? SHARK_NUM_THREADS : 1, std::vector<T>(packedASize));
+	for(std::size_t j0 = 0; j0 < n; j0 += nc){
+		std::size_t columns = std::min(nc, n-j0);
+		for(std::size_t p0 = 0; p0 < k; p0 += kc){
+			std::size_t depth = std::min(kc, k-p0);
+			gemmPackB(B + p0*strideB1 + j0*strideB2, strideB1, strideB2, depth, columns, &packedB[0]);
+			int numBlocks = (int)((m+mc-1)/mc);
+			if(parallel){
+				SHARK_PARALLEL_FOR(int block = 0; block < numBlocks; ++block){
+					std::size_t i0 = block*mc;
+					gemmRowBlock(
+						std::min(mc, m-i0), columns, depth, alpha,
+						A + i0*strideA1 + p0*strideA2, strideA1, strideA2,
+						&packedB[0], &packedA[SHARK_THREAD_NUM][0],
+						C + i0*strideC1 + j0*strideC2, strideC1, strideC2
+					);
+				}
+			}else{
+				for(int block = 0; block < numBlocks; ++block){
+					std::size_t i0 = block*mc;
+					gemmRowBlock(
+						std::min(mc, m-i0), columns, depth, alpha,
+						A + i0*strideA1 + p0*strideA2, strideA1, strideA2,
+						&packedB[0], &packedA[0][0],
+						C + i0*strideC1 + j0*strideC2, strideC1, strideC2
+					);
+				}
+			}
+		}
+	}
+}
+
+///\brief Computes the upper triangle of C += alpha * A * A^T for a dense m x k matrix A.
+///
+///C is processed in blocks of columns. For every block the rows above and including the diagonal block
+///are computed with the blocked gemm, so only the lower half of the diagonal blocks is computed needlessly.
+template<class T>
+void syrkBlocked(
+	std::size_t m, std::size_t k, T alpha,
+	T const* A, std::ptrdiff_t strideA1, std::ptrdiff_t strideA2,
+	T* C, std::ptrdiff_t strideC1, std::ptrdiff_t strideC2
+){
+	std::size_t const blockSize = 2*GemmBlockSizes::mc;
+	for(std::size_t j0 = 0; j0 < m; j0 += blockSize){
+		std::size_t columns = std::min(blockSize, m-j0);
+		//C(0:j0+columns, j0:j0+columns) += A(0:j0+columns,:) * A(j0:j0+columns,:)^T
+		gemmBlocked(
+			j0+columns, columns, k, alpha,
+			A, strideA1, strideA2,
+			A + j0*strideA1, strideA2, strideA1,
+			C + j0*strideC2, strideC1, strideC2
+		);
+	}
+}
+
+}}}}
+#endif
@@ -31,36 +31,33 @@
 #ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMV_H
 #define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMV_H
 
+#include "gemvKernel.h"
+#include <shark/LinAlg/BLAS/traits/matrix_raw.hpp>
+#include <shark/LinAlg/BLAS/traits/vector_raw.hpp>
+
 namespace shark {namespace blas {namespace bindings {
 
 // y <- alpha * op (A) * x + beta * y
 // op (A) == A || A^T || A^H
+// All arguments must be dense. Row major and column major A are handled by
+// vectorized kernels working directly on the storage.
 template <typename T, typename MatA, typename VectorB, typename VectorC>
 void gemv(
 T alpha, matrix_expression<MatA> const &matA, 
 vector_expression<VectorB> const &vecB,
 T beta, vector_expression<VectorC> &vecC
 ) {
-	if(alpha != 1.0){
-		beta /= alpha;
-	}
+	SIZE_CHECK(matA().size1() == vecC().size());
+	SIZE_CHECK(matA().size2() == vecB().size());
 	if ( beta != 1.0){
 		vecC()*=beta;
 	}
-
-	if(!traits::isRowMajor(matA)){
-		//there is no reasonable fast operation for A^Tx in uBLAS. yes, that is indeed scary
-		for(std::size_t i = 0; i != matA().size2(); ++i){
-			vecC()+=vecB()(i)*column(matA(),i);
-		}
-	}
-	else{
-		vecC()+=prod(matA,vecB);
-	}
-	
-	if(alpha != 1.0){
-		vecC() *= alpha;
-	}
+	detail::gemvStrided<typename VectorC::value_type>(
+		matA().size1(), matA().size2(), alpha,
+		traits::matrix_storage(matA), traits::matrix_stride1(matA), traits::matrix_stride2(matA),
+		traits::vector_storage(vecB), traits::vector_stride(vecB),
+		traits::vector_storage(vecC), traits::vector_stride(vecC)
+	);
 }
 
 }}}
@@ -0,0 +1,239 @@
+/*!
+ *  \brief Matrix-vector multiplication used when no external BLAS is available.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMVKERNEL_H
+#define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_GEMVKERNEL_H
+
+#include "simd.h"
+#include <vector>
+#include <cstddef>
+
+namespace shark { namespace blas { namespace bindings { namespace detail{
+
+///\brief Computes the inner products of four contiguous rows with x.
+template<class T>
+void gemvDot4(std::size_t n, T const* a0, T const* a1, T const* a2, T const* a3, T const* x, T* result){
+	T r0 = T(), r1 = T(), r2 = T(), r3 = T();
+	for(std::size_t j = 0; j != n; ++j){
+		T xj = x[j];
+		r0 += a0[j]*xj;
+		r1 += a1[j]*xj;
+		r2 += a2[j]*xj;
+		r3 += a3[j]*xj;
+	}
+	result[0] = r0;
+	result[1] = r1;
+	result[2] = r2;
+	result[3] = r3;
+}
+
+///\brief Computes y += c[0]*a0 + c[1]*a1 + c[2]*a2 + c[3]*a3 for four contiguous columns.
+template<class T>
+void gemvAxpy4(std::size_t m, T const* a0, T const* a1, T const* a2, T const* a3, T const* c, T* y){
+	T c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+	for(std::size_t i = 0; i != m; ++i){
+		y[i] += c0*a0[i] + c1*a1[i] + c2*a2[i] + c3*a3[i];
+	}
+}
+
+#ifdef SHARK_BLAS_DEFAULT_SSE2
+inline void gemvDot4SSE2(std::size_t n, double const* a0, double const* a1, double const* a2, double const* a3, double const* x, double* result){
+	__m128d r0 = _mm_setzero_pd(), r1 = _mm_setzero_pd(), r2 = _mm_setzero_pd(), r3 = _mm_setzero_pd();
+	std::size_t j = 0;
+	for(; j+2 <= n; j += 2){
+		__m128d xj = _mm_loadu_pd(x+j);
+		r0 = _mm_add_pd(r0, _mm_mul_pd(_mm_loadu_pd(a0+j), xj));
+		r1 = _mm_add_pd(r1, _mm_mul_pd(_mm_loadu_pd(a1+j), xj));
+		r2 = _mm_add_pd(r2, _mm_mul_pd(_mm_loadu_pd(a2+j), xj));
+		r3 = _mm_add_pd(r3, _mm_mul_pd(_mm_loadu_pd(a3+j), xj));
+	}
+	double sums[8];
+	_mm_storeu_pd(sums, r0);
+	_mm_storeu_pd(sums+2, r1);
+	_mm_storeu_pd(sums+4, r2);
+	_mm_storeu_pd(sums+6, r3);
+	for(std::size_t k = 0; k != 4; ++k){
+		result[k] = sums[2*k] + sums[2*k+1];
+	}
+	for(; j != n; ++j){
+		result[0] += a0[j]*x[j];
+		result[1] += a1[j]*x[j];
+		result[2] += a2[j]*x[j];
+		result[3] += a3[j]*x[j];
+	}
+}
+
+inline void gemvAxpy4SSE2(std::size_t m, double const* a0, double const* a1, double const* a2, double const* a3, double const* c, double* y){
+	__m128d c0 = _mm_set1_pd(c[0]), c1 = _mm_set1_pd(c[1]), c2 = _mm_set1_pd(c[2]), c3 = _mm_set1_pd(c[3]);
+	std::size_t i = 0;
+	for(; i+2 <= m; i += 2){
+		__m128d sum = _mm_add_pd(_mm_mul_pd(c0,_mm_loadu_pd(a0+i)), _mm_mul_pd(c1,_mm_loadu_pd(a1+i)));
+		sum = _mm_add_pd(sum, _mm_add_pd(_mm_mul_pd(c2,_mm_loadu_pd(a2+i)), _mm_mul_pd(c3,_mm_loadu_pd(a3+i))));
+		_mm_storeu_pd(y+i, _mm_add_pd(_mm_loadu_pd(y+i), sum));
+	}
+	for(; i != m; ++i){
+		y[i] += c[0]*a0[i] + c[1]*a1[i] + c[2]*a2[i] + c[3]*a3[i];
+	}
+}
+#endif
+
+#ifdef SHARK_BLAS_DEFAULT_AVX2
+__attribute__((target("avx2,fma")))
+inline void gemvDot4AVX2(std::size_t n, double const* a0, double const* a1, double const* a2, double const* a3, double const* x, double* result){
+	__m256d r0 = _mm256_setzero_pd(), r1 = _mm256_setzero_pd(), r2 = _mm256_setzero_pd(), r3 = _mm256_setzero_pd();
+	std::size_t j = 0;
+	for(; j+4 <= n; j += 4){
+		__m256d xj = _mm256_loadu_pd(x+j);
+		r0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0+j), xj, r0);
+		r1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1+j), xj, r1);
+		r2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2+j), xj, r2);
+		r3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3+j), xj, r3);
+	}
+	//after the horizontal adds, the four sums are stored in order
+	__m256d s01 = _mm256_hadd_pd(r0, r1);
+	__m256d s23 = _mm256_hadd_pd(r2, r3);
+	__m256d swapped = _mm256_permute2f128_pd(s01, s23, 0x21);
+	__m256d blended = _mm256_blend_pd(s01, s23, 0xC);
+	_mm256_storeu_pd(result, _mm256_add_pd(swapped, blended));
+	for(; j != n; ++j){
+		result[0] += a0[j]*x[j];
+		result[1] += a1[j]*x[j];
+		result[2] += a2[j]*x[j];
+		result[3] += a3[j]*x[j];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+inline void gemvAxpy4AVX2(std::size_t m, double const* a0, double const* a1, double const* a2, double const* a3, double const* c, double* y){
+	__m256d c0 = _mm256_broadcast_sd(c), c1 = _mm256_broadcast_sd(c+1);
+	__m256d c2 = _mm256_broadcast_sd(c+2), c3 = _mm256_broadcast_sd(c+3);
+	std::size_t i = 0;
+	for(; i+4 <= m; i += 4){
+		__m256d sum = _mm256_loadu_pd(y+i);
+		sum = _mm256_fmadd_pd(c0, _mm256_loadu_pd(a0+i), sum);
+		sum = _mm256_fmadd_pd(c1, _mm256_loadu_pd(a1+i), sum);
+		sum = _mm256_fmadd_pd(c2, _mm256_loadu_pd(a2+i), sum);
+		sum = _mm256_fmadd_pd(c3, _mm256_loadu_pd(a3+i), sum);
+		_mm256_storeu_pd(y+i, sum);
+	}
+	for(; i != m; ++i){
+		y[i] += c[0]*a0[i] + c[1]*a1[i] + c[2]*a2[i] + c[3]*a3[i];
+	}
+}
+#endif
+
+typedef void (*DoubleGemvKernel)(std::size_t, double const*, double const*, double const*, double const*, double const*, double*);
+
+///\brief Chooses the fastest version of a kernel supported by the processor.
+inline DoubleGemvKernel selectGemvKernel(DoubleGemvKernel portable, DoubleGemvKernel sse2, DoubleGemvKernel avx2){
+#ifdef SHARK_BLAS_DEFAULT_AVX2
+	if(cpuSupportsAVX2())
+		return avx2;
+#endif
+	return sse2? sse2 : portable;
+}
+
+inline void gemvDot4(std::size_t n, double const* a0, double const* a1, double const* a2, double const* a3, double const* x, double* result){
+#if defined(SHARK_BLAS_DEFAULT_AVX2)
+	static DoubleGemvKernel const kernel = selectGemvKernel(&gemvDot4<double>, &gemvDot4SSE2, &gemvDot4AVX2);
+#elif defined(SHARK_BLAS_DEFAULT_SSE2)
+	static DoubleGemvKernel const kernel = selectGemvKernel(&gemvDot4<double>, &gemvDot4SSE2, 0);
+#else
+	static DoubleGemvKernel const kernel = &gemvDot4<double>;
+#endif
+	kernel(n, a0, a1, a2, a3, x, result);
+}
+
+inline void gemvAxpy4(std::size_t m, double const* a0, double const* a1, double const* a2, double const* a3, double const* c, double* y){
+#if defined(SHARK_BLAS_DEFAULT_AVX2)
+	static DoubleGemvKernel const kernel = selectGemvKernel(&gemvAxpy4<double>, &gemvAxpy4SSE2, &gemvAxpy4AVX2);
+#elif defined(SHARK_BLAS_DEFAULT_SSE2)
+	static DoubleGemvKernel const kernel = selectGemvKernel(&gemvAxpy4<double>, &gemvAxpy4SSE2, 0);
+#else
+	static DoubleGemvKernel const kernel = &gemvAxpy4<double>;
+#endif
+	kernel(m, a0, a1, a2, a3, c, y);
+}
+
+///\brief Computes y += alpha * A * x for dense A, x and y given by their storage and strides.
+///
+///If the rows of A are contiguous, four rows at a time are multiplied with x. If the columns
+///are contiguous, four scaled columns at a time are added to y. Vectors with a stride
+///other than one are copied into contiguous temporaries first.
+template<class T>
+void gemvStrided(
+	std::size_t m, std::size_t n, T alpha,
+	T const* A, std::ptrdiff_t stride1, std::ptrdiff_t stride2,
+	T const* x, std::ptrdiff_t strideX,
+	T* y, std::ptrdiff_t strideY
+){
+	if(m == 0 || n == 0) return;
+	if(strideX != 1){
+		std::vector<T> xContiguous(n);
+		for(std::size_t j = 0; j != n; ++j) xContiguous[j] = x[j*strideX];
+		gemvStrided(m, n, alpha, A, stride1, stride2, &xContiguous[0], 1, y, strideY);
+		return;
+	}
+	if(strideY != 1){
+		std::vector<T> yContiguous(m, T());
+		gemvStrided(m, n, alpha, A, stride1, stride2, x, 1, &yContiguous[0], 1);
+		for(std::size_t i = 0; i != m; ++i) y[i*strideY] += yContiguous[i];
+		return;
+	}
+
+	if(stride2 == 1){
+		//rows are contiguous
+		T result[4];
+		std::size_t i = 0;
+		for(; i+4 <= m; i += 4){
+			T const* row = A + i*stride1;
+			gemvDot4(n, row, row+stride1, row+2*stride1, row+3*stride1, x, result);
+			for(std::size_t k = 0; k != 4; ++k) y[i+k] += alpha*result[k];
+		}
+		for(; i != m; ++i){
+			T const* row = A + i*stride1;
+			T sum = T();
+			for(std::size_t j = 0; j != n; ++j) sum += row[j]*x[j];
+			y[i] += alpha*sum;
+		}
+	}else if(stride1 == 1){
+		//columns are contiguous
+		T c[4];
+		std::size_t j = 0;
+		for(; j+4 <= n; j += 4){
+			T const* col = A + j*stride2;
+			for(std::size_t k = 0; k != 4; ++k) c[k] = alpha*x[j+k];
+			gemvAxpy4(m, col, col+stride2, col+2*stride2, col+3*stride2, c, y);
+		}
+		for(; j != n; ++j){
+			T const* col = A + j*stride2;
+			T cj = alpha*x[j];
+			for(std::size_t i = 0; i != m; ++i) y[i] += cj*col[i];
+		}
+	}else{
+		for(std::size_t i = 0; i != m; ++i){
+			T sum = T();
+			for(std::size_t j = 0; j != n; ++j) sum += A[i*stride1+j*stride2]*x[j];
+			y[i] += alpha*sum;
+		}
+	}
+}
+
+}}}}
+#endif
@@ -0,0 +1,53 @@
+/*!
+ *  \brief Detection of the SIMD instruction sets used by the kernels of the default bindings.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_SIMD_H
+#define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_SIMD_H
+
+//SSE2 is part of every x86-64 processor. AVX2 kernels are compiled with a function specific
+//target, so that they can be selected at runtime without compiling everything for AVX2.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHARK_BLAS_DEFAULT_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(SHARK_BLAS_DEFAULT_SSE2) && (defined(__x86_64__) || defined(__i386__)) \
+	&& (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SHARK_BLAS_DEFAULT_AVX2
+#include <immintrin.h>
+#endif
+
+namespace shark { namespace blas { namespace bindings { namespace detail{
+
+#ifdef SHARK_BLAS_DEFAULT_AVX2
+///\brief Queries the processor for AVX2 and FMA support.
+inline bool detectAVX2(){
+	//the first use may happen during static initialization, before libgcc has initialized the cpu model
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+///\brief Returns true if the processor supports AVX2 and FMA.
+inline bool cpuSupportsAVX2(){
+	static bool const supported = detectAVX2();
+	return supported;
+}
+#endif
+
+}}}}
+#endif
@@ -33,30 +33,37 @@
 #define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_SYRK_H
 
 #include "ublasTags.h"
+#include "gemmKernel.h"
 #include <shark/LinAlg/BLAS/Tools.h>
+#include <shark/LinAlg/BLAS/traits/matrix_raw.hpp>
 
 namespace shark {namespace blas {namespace bindings {
 
+// C <- alpha * A * A^T + beta * C
+// Only one triangle of C is computed: the upper one for upper == false, as in the cblas bindings.
 template <bool upper,typename T, typename MatA, typename TriangularC>
 inline void syrk (
 	T alpha,matrix_expression<MatA> const& matA, 
 	T beta,matrix_expression<TriangularC>& matC
 ){
+	SIZE_CHECK(matC().size1() == matC().size2());
+	SIZE_CHECK(matC().size1() == matA().size1());
 
-	if(alpha != 1.0){
-		beta /= alpha;
-	}
 	if(beta == 0)
 		zero(matC);
 	else if ( beta != 1.0){
 		matC()*=beta;
 	}
-	blas::matrix_transpose<const MatA> transA = trans(matA);
-//	blas::triangular_adaptor<TriangularC, typename TriangularTag<upper,false>::TraitsType > triangularC(matC());
-	axpy_prod(matA,transA,matC(),false);
-	if(alpha != 1.0){
-		matC() *= alpha;
-	}
+	//the lower triangle of C is the upper triangle of C^T
+	std::ptrdiff_t strideC1 = traits::matrix_stride1(matC);
+	std::ptrdiff_t strideC2 = traits::matrix_stride2(matC);
+	if(upper)
+		std::swap(strideC1,strideC2);
+	detail::syrkBlocked<typename TriangularC::value_type>(
+		matA().size1(), matA().size2(), alpha,
+		traits::matrix_storage(matA), traits::matrix_stride1(matA), traits::matrix_stride2(matA),
+		traits::matrix_storage(matC), strideC1, strideC2
+	);
 }
 
 }}}
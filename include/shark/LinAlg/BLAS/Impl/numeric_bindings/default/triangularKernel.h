@@ -0,0 +1,151 @@
+/*!
+ *  \brief Blocked solvers for triangular systems used when no external BLAS is available.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRIANGULARKERNEL_H
+#define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRIANGULARKERNEL_H
+
+#include "gemmKernel.h"
+#include "gemvKernel.h"
+#include <algorithm>
+#include <vector>
+
+namespace shark { namespace blas { namespace bindings { namespace detail{
+
+///\brief Number of rows of the diagonal blocks which are solved without blocking.
+enum{ TriangularBlockSize = 64 };
+
+///\brief Solves Ax=b in place for a dense triangular n x n matrix A.
+///
+///The system is solved block by block. Before a diagonal block is solved, the contribution
+///of all previously solved variables is subtracted with the vectorized gemv kernel, so only
+///the small diagonal blocks are solved by scalar substitution.
+template<class T>
+void trsvBlocked(
+	std::size_t n, bool upper, bool unit,
+	T const* A, std::ptrdiff_t stride1, std::ptrdiff_t stride2,
+	T* b, std::ptrdiff_t strideB
+){
+	if(n == 0) return;
+	if(strideB != 1){
+		std::vector<T> bContiguous(n);
+		for(std::size_t i = 0; i != n; ++i) bContiguous[i] = b[i*strideB];
+		trsvBlocked(n, upper, unit, A, stride1, stride2, &bContiguous[0], 1);
+		for(std::size_t i = 0; i != n; ++i) b[i*strideB] = bContiguous[i];
+		return;
+	}
+
+	std::size_t const blockSize = TriangularBlockSize;
+	std::size_t numBlocks = (n+blockSize-1)/blockSize;
+	for(std::size_t block = 0; block != numBlocks; ++block){
+		if(!upper){
+			std::size_t k0 = block*blockSize;
+			std::size_t k1 = std::min(k0+blockSize, n);
+			//b(k0:k1) -= A(k0:k1,0:k0) x(0:k0)
+			gemvStrided<T>(k1-k0, k0, T(-1), A+k0*stride1, stride1, stride2, b, 1, b+k0, 1);
+			for(std::size_t i = k0; i != k1; ++i){
+				T sum = b[i];
+				for(std::size_t j = k0; j != i; ++j)
+					sum -= A[i*stride1+j*stride2]*b[j];
+				b[i] = unit? sum : sum/A[i*(stride1+stride2)];
+			}
+		}else{
+			std::size_t k1 = n-block*blockSize;
+			std::size_t k0 = k1 > blockSize? k1-blockSize : 0;
+			//b(k0:k1) -= A(k0:k1,k1:n) x(k1:n)
+			gemvStrided<T>(k1-k0, n-k1, T(-1), A+k0*stride1+k1*stride2, stride1, stride2, b+k1, 1, b+k0, 1);
+			for(std::size_t i = k1; i != k0; --i){
+				std::size_t row = i-1;
+				T sum = b[row];
+				for(std::size_t j = row+1; j != k1; ++j)
+					sum -= A[row*stride1+j*stride2]*b[j];
+				b[row] = unit? sum : sum/A[row*(stride1+stride2)];
+			}
+		}
+	}
+}
+
+///\brief Solves AX=B in place for a dense triangular n x n matrix A and a dense n x m matrix B.
+///
+///As in trsvBlocked, the contribution of the solved rows of X to the next block of rows
+///is subtracted by a matrix-matrix product, which is computed by the blocked gemm.
+template<class T>
+void trsmBlocked(
+	std::size_t n, std::size_t m, bool upper, bool unit,
+	T const* A, std::ptrdiff_t strideA1, std::ptrdiff_t strideA2,
+	T* B, std::ptrdiff_t strideB1, std::ptrdiff_t strideB2
+){
+	if(n == 0 || m == 0) return;
+	std::size_t const blockSize = TriangularBlockSize;
+	std::size_t numBlocks = (n+blockSize-1)/blockSize;
+	for(std::size_t block = 0; block != numBlocks; ++block){
+		if(!upper){
+			std::size_t k0 = block*blockSize;
+			std::size_t k1 = std::min(k0+blockSize, n);
+			//B(k0:k1,:) -= A(k0:k1,0:k0) X(0:k0,:)
+			gemmBlocked<T>(
+				k1-k0, m, k0, T(-1),
+				A+k0*strideA1, strideA1, strideA2,
+				B, strideB1, strideB2,
+				B+k0*strideB1, strideB1, strideB2
+			);
+			for(std::size_t i = k0; i != k1; ++i){
+				T* rowI = B+i*strideB1;
+				for(std::size_t j = k0; j != i; ++j){
+					T a = A[i*strideA1+j*strideA2];
+					T const* rowJ = B+j*strideB1;
+					for(std::size_t c = 0; c != m; ++c)
+						rowI[c*strideB2] -= a*rowJ[c*strideB2];
+				}
+				if(!unit){
+					T diagonal = A[i*(strideA1+strideA2)];
+					for(std::size_t c = 0; c != m; ++c)
+						rowI[c*strideB2] /= diagonal;
+				}
+			}
+		}else{
+			std::size_t k1 = n-block*blockSize;
+			std::size_t k0 = k1 > blockSize? k1-blockSize : 0;
+			//B(k0:k1,:) -= A(k0:k1,k1:n) X(k1:n,:)
+			gemmBlocked<T>(
+				k1-k0, m, n-k1, T(-1),
+				A+k0*strideA1+k1*strideA2, strideA1, strideA2,
+				B+k1*strideB1, strideB1, strideB2,
+				B+k0*strideB1, strideB1, strideB2
+			);
+			for(std::size_t i = k1; i != k0; --i){
+				std::size_t row = i-1;
+				T* rowI = B+row*strideB1;
+				for(std::size_t j = row+1; j != k1; ++j){
+					T a = A[row*strideA1+j*strideA2];
+					T const* rowJ = B+j*strideB1;
+					for(std::size_t c = 0; c != m; ++c)
+						rowI[c*strideB2] -= a*rowJ[c*strideB2];
+				}
+				if(!unit){
+					T diagonal = A[row*(strideA1+strideA2)];
+					for(std::size_t c = 0; c != m; ++c)
+						rowI[c*strideB2] /= diagonal;
+				}
+			}
+		}
+	}
+}
+
+}}}}
+#endif
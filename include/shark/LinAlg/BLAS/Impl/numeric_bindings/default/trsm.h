@@ -32,40 +32,39 @@
 #ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRSM_H
 #define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRSM_H
 
-#include "ublasTags.h"
+#include "triangularKernel.h"
+#include <shark/LinAlg/BLAS/traits/matrix_raw.hpp>
 ///solves systems of triangular matrices
 
 namespace shark {namespace blas {namespace bindings {
 
-template <typename SymmA, typename MatB,typename Tag>
-void trsm(
-	matrix_expression<SymmA> const &matA,
-	matrix_expression<MatB> &matB,
-	Tag type,
-	boost::mpl::true_
-){
-	inplace_solve (matA(), matB(), type);
-}
-
-template <typename SymmA, typename MatB,typename Tag>
-void trsm(
-	matrix_expression<SymmA> const &matA,
-	matrix_expression<MatB> &matB,
-	Tag type,
-	boost::mpl::false_
-){
-	matrix<typename MatB::value_type> transB = trans(matB);//hack!!!
-	//matrix_unary2<MatB, scalar_identity<typename MatB::value_type> > transB=trans(matB());
-	inplace_solve (trans(matA), transB, type);
-	noalias(matB()) = trans(transB);
-}
-
 template <bool upper, bool left, bool unit,typename SymmA, typename MatB>
 void trsm(
 	matrix_expression<SymmA> const &matA,
 	matrix_expression<MatB> &matB
 ){
-	trsm(matA,matB,typename TriangularTag<upper,unit,left>::type(),boost::mpl::bool_<left>());
+	SIZE_CHECK(matA().size1() == matA().size2());
+	std::size_t n = matA().size1();
+	std::ptrdiff_t strideA1 = traits::matrix_stride1(matA);
+	std::ptrdiff_t strideA2 = traits::matrix_stride2(matA);
+	std::ptrdiff_t strideB1 = traits::matrix_stride1(matB);
+	std::ptrdiff_t strideB2 = traits::matrix_stride2(matB);
+	if(left){
+		SIZE_CHECK(matB().size1() == n);
+		detail::trsmBlocked<typename MatB::value_type>(
+			n, matB().size2(), upper, unit,
+			traits::matrix_storage(matA), strideA1, strideA2,
+			traits::matrix_storage(matB), strideB1, strideB2
+		);
+	}else{
+		//XA=B is solved as A^TX^T=B^T, the transpositions only swap the strides
+		SIZE_CHECK(matB().size2() == n);
+		detail::trsmBlocked<typename MatB::value_type>(
+			n, matB().size1(), !upper, unit,
+			traits::matrix_storage(matA), strideA2, strideA1,
+			traits::matrix_storage(matB), strideB2, strideB1
+		);
+	}
 }
 
 }}}
@@ -32,7 +32,9 @@
 #ifndef SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRSV_H
 #define SHARK_LINALG_IMPL_NUMERIC_BINDINGS_DEFAULT_TRSV_H
 
-#include "ublasTags.h"
+#include "triangularKernel.h"
+#include <shark/LinAlg/BLAS/traits/matrix_raw.hpp>
+#include <shark/LinAlg/BLAS/traits/vector_raw.hpp>
 ///solves systems of triangular matrices
 
 namespace shark {namespace blas {namespace bindings {
@@ -42,7 +44,13 @@ void trsv(
 	matrix_expression<SymmA> const &matA, 
 	vector_expression<VecB> &vecB
 ){
-	inplace_solve (matA(), vecB(), typename TriangularTag<upper,unit>::type());
+	SIZE_CHECK(matA().size1() == matA().size2());
+	SIZE_CHECK(matA().size2() == vecB().size());
+	detail::trsvBlocked<typename VecB::value_type>(
+		matA().size1(), upper, unit,
+		traits::matrix_storage(matA), traits::matrix_stride1(matA), traits::matrix_stride2(matA),
+		traits::vector_storage(vecB), traits::vector_stride(vecB)
+	);
 }
 
 }}}
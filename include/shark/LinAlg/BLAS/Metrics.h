@@ -287,7 +287,33 @@ namespace detail{
 		}
 	}
 	
+	///\brief Adds the squared row norms of X and Y to the inner products -2<x_i,y_j> and clamps the result at zero.
+	///
+	///Computing (a-b)^2 = a^2 -2ab +b^2 suffers from cancellation when a and b are close,
+	///which can lead to small negative results. Those are set to zero.
+	template<class Result, class VectorX, class VectorY>
+	void addRowNormsAndClamp(Result& distances, VectorX const& xSqr, VectorY const& ySqr){
+		typedef typename Result::value_type value_type;
+		for(std::size_t i = 0; i != distances.size1(); ++i){
+			for(std::size_t j = 0; j != distances.size2(); ++j){
+				value_type d = distances(i,j) + xSqr(i) + ySqr(j);
+				distances(i,j) = d > 0? d : value_type(0);
+			}
+		}
+	}
+	
+	///\brief Computes the squared norms of the rows of a matrix.
+	template<class MatrixT, class VectorR>
+	void rowNormsSqr(MatrixT const& X, VectorR& norms){
+		for(std::size_t i = 0; i != X.size1(); ++i){
+			norms(i) = norm_sqr(row(X,i));
+		}
+	}
+	
 	///\brief implementation for two dense input blocks
+	///
+	///The inner products of all pairs of rows are computed by a single matrix-matrix product,
+	///so the distances are computed at the speed of the BLAS gemm.
 	template<class MatrixX,class MatrixY, class Result>
 	void distanceSqrBlockBlock(
 		MatrixX const& X,
@@ -305,20 +331,70 @@ namespace detail{
 		}
 		//fast blockwise iteration
 		//uses: (a-b)^2 = a^2 -2ab +b^2
-		fast_prod(X,trans(Y),distances);
-		distances*=-2;
-		//first a^2+b^2 
+		fast_prod(X,trans(Y),distances,false,-2.0);
+		vector<value_type> xSqr(sizeX);
 		vector<value_type> ySqr(sizeY);
-		for(std::size_t i = 0; i != sizeY; ++i){
-			ySqr(i) = norm_sqr(row(Y,i));
+		rowNormsSqr(X,xSqr);
+		rowNormsSqr(Y,ySqr);
+		addRowNormsAndClamp(distances,xSqr,ySqr);
+	}
+	
+	///\brief implementation for a sparse and a dense input block
+	///
+	///The dense block is transposed once, then for every nonzero element x_ik of the sparse block
+	///the k-th row of the transposed block is added to the inner products of x_i with all rows of Y.
+	///The costs are proportional to the number of nonzero elements times the number of rows of Y.
+	template<class MatrixX,class MatrixY, class Result>
+	void distanceSqrBlockBlock(
+		MatrixX const& X,
+		MatrixY const& Y,
+		Result& distances,
+		boost::mpl::true_,//first argument sparse
+		boost::mpl::false_//second argument dense
+	){
+		typedef typename Result::value_type value_type;
+		std::size_t sizeX=X.size1();
+		std::size_t sizeY=Y.size1();
+		if(sizeX < 10 || sizeY<10){
+			distanceSqrBlockBlockRowWise(X,Y,distances);
+			return;
 		}
-		//initialize d_ij=x_i^2+y_i^2
+		matrix<value_type> transY = trans(Y);
+		blas::zero(distances);
+		vector<value_type> xSqr(sizeX);
 		for(std::size_t i = 0; i != sizeX; ++i){
-			value_type xSqr = norm_sqr(row(X,i));
-			noalias(row(distances,i)) += repeat(xSqr,sizeY) + ySqr;
+			typedef typename matrix_row<MatrixX const>::const_iterator iterator;
+			matrix_row<MatrixX const> xRow = row(X,i);
+			matrix_row<Result> distanceRow = row(distances,i);
+			value_type norm = 0;
+			for(iterator pos = xRow.begin(); pos != xRow.end(); ++pos){
+				value_type value = *pos;
+				norm += value*value;
+				noalias(distanceRow) += (-2*value)*row(transY,pos.index());
+			}
+			xSqr(i) = norm;
 		}
+		vector<value_type> ySqr(sizeY);
+		rowNormsSqr(Y,ySqr);
+		addRowNormsAndClamp(distances,xSqr,ySqr);
 	}
-	//\brief default implementation used, when one of the arguments is not dense
+	
+	///\brief implementation for a dense and a sparse input block
+	template<class MatrixX,class MatrixY, class Result>
+	void distanceSqrBlockBlock(
+		MatrixX const& X,
+		MatrixY const& Y,
+		Result& distances,
+		boost::mpl::false_ flagX,//first argument dense
+		boost::mpl::true_ flagY//second argument sparse
+	){
+		typedef typename Result::value_type value_type;
+		matrix<value_type> transDistances(Y.size1(),X.size1());
+		distanceSqrBlockBlock(Y,X,transDistances,flagY,flagX);
+		noalias(distances) = trans(transDistances);
+	}
+	
+	///\brief implementation for two sparse input blocks
 	template<class MatrixX,class MatrixY,class Result>
 	void distanceSqrBlockBlock(
 		MatrixX const& X,
@@ -119,12 +119,28 @@ public:
 	/// \param  noClasses  number of clases in the dataset, default 0 means that the number is computed 
 	void initFromData(ClassificationDataset const& data, unsigned noClusters = 0, unsigned noClasses = 0);
 
-	/// initialize centroids from unlabeled data: 
-	/// take a random subset of data points
+	/// \brief Methods to choose initial centroids from unlabeled data.
+	enum InitializationMethod{
+		/// random subset of the data points
+		RandomSubset,
+		/// k-means++: every further centroid is a data point drawn with probability
+		/// proportional to its squared distance to the closest chosen centroid
+		/// (Arthur and Vassilvitskii, 2007)
+		KMeansPlusPlus,
+		/// k-means||: a few passes over the data oversample about 2k candidates per pass,
+		/// which are reduced to k centroids by weighted k-means++ (Bahmani et al., 2012).
+		/// It needs far less passes over the data than k-means++ for large k.
+		KMeansParallel
+	};
+
+	/// initialize centroids from unlabeled data
+	///
+	/// The distances to the chosen centroids are computed batch-wise and in parallel over the batches.
 	///
 	/// \param  dataset dataset from which to take the centroids
 	/// \param  noClusters  number of centroids in the model
-	void initFromData(Data<RealVector> const& dataset, unsigned noClusters);
+	/// \param  method  how the centroids are chosen
+	void initFromData(Data<RealVector> const& dataset, unsigned noClusters, InitializationMethod method = KMeansPlusPlus);
 
 protected:
 	/// Compute unnormalized membership from distance.
@@ -64,6 +64,11 @@ public:
 		std::size_t r;//TODO: remove this
 		double g;//TODO: remove this
 
+		//the trainers of the forests do not set all fields, they must not be serialized uninitialized
+		SplitInfo()
+		: nodeId(0), attributeIndex(0), attributeValue(0)
+		, leftNodeId(0), rightNodeId(0), label(), misclassProp(0), r(0), g(0){}
+
 	   template<class Archive>
 	   void serialize(Archive & ar, const unsigned int version){
 			ar & nodeId;
@@ -130,6 +135,11 @@ public:
 		optimizeSplitMatrix(m_splitMatrix);
 	}
 	
+	/// \brief Returns the split matrix, in which the child ids are indices into the matrix.
+	SplitMatrixType const& splitMatrix()const{
+		return m_splitMatrix;
+	}
+	
 	/// \brief The model does not have any parameters.
 	std::size_t numberOfParameters()const{
 		return 0;
@@ -28,11 +28,7 @@
 #define SHARK_MODELS_TREES_RFCLASSIFIER_H
 
 #include <shark/Models/Trees/CARTClassifier.h>
-
-//#include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
-//#include <shark/ObjectiveFunctions/Loss/SquaredLoss.h>
-
-//#include <boost/unordered_map.hpp>
+#include <algorithm>
 
 namespace shark {
 
@@ -60,7 +56,7 @@ public:
 	typedef CARTClassifier<RealVector>::SplitInfo SplitInfo;
 	
 	/// Constructor
-	RFClassifier(){
+	RFClassifier():m_OOBError(0){
 	}
 
 	/// \brief From INameable: return the class name.
@@ -75,16 +71,33 @@ public:
 	// In the regression case the function returns the average vector.
 	using AbstractModel<RealVector, RealVector >::eval;
 	void eval(const BatchInputType& patterns, BatchOutputType& outputs)const{
+		std::size_t numPatterns = shark::size(patterns);
+		std::size_t numTrees = m_treeRoots.size();
 		// Prepare the output
-		ensureSize(outputs,size(patterns),m_labelDimension);
+		ensureSize(outputs,numPatterns,m_labelDimension);
 		zero(outputs);
 
-		//For each tree in the forest and every input pattern
-		for(std::size_t i = 0; i != m_forest.size(); i++){
-			noalias(outputs) += m_forest[i](patterns);
+		//the patterns are processed in blocks. All trees are evaluated on a block
+		//before the next block is processed, so that the nodes of a tree stay in cache
+		for(std::size_t start = 0; start < numPatterns; start += EvalBlockSize){
+			std::size_t end = std::min(start + EvalBlockSize, numPatterns);
+			for(std::size_t t = 0; t != numTrees; ++t){
+				for(std::size_t i = start; i != end; ++i){
+					std::size_t node = m_treeRoots[t];
+					while(m_nodeChildren[node] != 0){
+						//the right child is stored directly after the left child
+						bool right = !(patterns(i,m_nodeAttributes[node]) <= m_nodeThresholds[node]);
+						node = m_nodeChildren[node] + right;
+					}
+					double const* leaf = &m_leafValues[m_nodeAttributes[node] * m_labelDimension];
+					for(std::size_t k = 0; k != m_labelDimension; ++k){
+						outputs(i,k) += leaf[k];
+					}
+				}
+			}
 		}
 
-		outputs /= m_forest.size();
+		outputs /= numTrees;
 	}
 	
 	void eval(const BatchInputType& patterns, BatchOutputType& outputs, State & state)const{
@@ -105,6 +118,7 @@ public:
 	/// from ISerializable, reads a model from an archive
 	void read(InArchive& archive){
 		archive >> m_forest;
+		compileForest();
 	}
 
 	/// from ISerializable, writes a model to an archive
@@ -118,23 +132,7 @@ public:
 	void addTree(SplitMatrixType const& splitMatrix){
 		/// Add the tree to the ensemble
 		m_forest.push_back(splitMatrix);
-
-//		//TODO: O.K. : Is this needed at all? It is not used.
-//		// Update OOB error
-//		for(std::size_t i=0; i<testSet.size(); i++){
-//			RealVector prediction = m_forest.back()(testSet[i].input);
-//			std::size_t index = testSet.index(i);
-//			if(m_OOBHashTable.find(index) == m_OOBHashTable.end()){
-//				m_OOBHits.push_back(1);
-//				m_OOBPrediction.push_back(prediction);
-//				m_OOBLabel.push_back(testSet[i].label);
-//				m_OOBHashTable[index] = m_OOBLabel.size()-1;
-//			}else{
-//				std::size_t id = m_OOBHashTable[index];
-//				m_OOBPrediction[id] += prediction;
-//				m_OOBHits[id]++;
-//			}
-//		}
+		compileTree(m_forest.back().splitMatrix());
 	}
 
 	/// Set the dimension of the labels
@@ -142,25 +140,123 @@ public:
 		m_labelDimension = in;
 	}
 
+	/// \brief Out-of-bag error of the forest, as estimated by the RFTrainer.
+	///
+	/// Every element of the training set is predicted by the trees that were not grown on it.
+	/// The error is the fraction of misclassified elements in the classification case
+	/// and the mean squared error in the regression case. The value is not serialized.
+	double OOBerror()const{
+		return m_OOBError;
+	}
+
+	/// \brief Permutation importance of the attributes, as estimated by the RFTrainer.
+	///
+	/// The importance of an attribute is the increase of the out-of-bag error of a tree
+	/// when the values of this attribute are permuted among its out-of-bag elements,
+	/// averaged over all trees. The values are not serialized.
+	RealVector const& featureImportances()const{
+		return m_featureImportances;
+	}
+
+	/// Set the out-of-bag error, used by the trainer.
+	void setOOBerror(double error){
+		m_OOBError = error;
+	}
+
+	/// Set the permutation importances of the attributes, used by the trainer.
+	void setFeatureImportances(RealVector const& importances){
+		m_featureImportances = importances;
+	}
+
 protected:
+	/// number of patterns evaluated together in eval
+	static const std::size_t EvalBlockSize = 64;
+
 	/// collection of trees. Each tree consists of a split matrix.
 	std::vector< CARTClassifier<RealVector> > m_forest;
 
 	// Dimension of label in the regression case, number of classes in the classification case.
 	std::size_t m_labelDimension;
-	
-//	//TODO: O.K. : Is this needed at all? It is not used(applies to the remaining stuff)
-//	/// Hash table; so constant lookup can be applied when calculating the OOB error
-//	boost::unordered_map< std::size_t, std::size_t > m_OOBHashTable;
 
-//	// predicted labels of each node
-//	std::vector< RealVector > m_OOBPrediction;
+	/// \name Compiled forest
+	/// The nodes of all trees are stored in contiguous arrays, which are used for evaluation.
+	/// An inner node stores the index of its left child, the right child is stored directly after it.
+	/// A leaf is marked by the child index 0 and its attribute index is the index of its label in m_leafValues.
+	///@{
+
+	/// index of the root node of every tree
+	std::vector<std::size_t> m_treeRoots;
+	/// attribute tested in a node, or the leaf index for leaves
+	std::vector<std::size_t> m_nodeAttributes;
+	/// a pattern goes to the left child if the attribute is smaller or equal to the threshold
+	std::vector<double> m_nodeThresholds;
+	/// index of the left child, 0 for leaves
+	std::vector<std::size_t> m_nodeChildren;
+	/// labels of the leaves, stored row wise with m_labelDimension entries each
+	std::vector<double> m_leafValues;
+	///@}
+
+	/// \brief Appends a tree to the compiled forest.
+	///
+	/// The split matrix must be optimized, i.e. the child ids are indices into the matrix.
+	void compileTree(SplitMatrixType const& splitMatrix){
+		std::size_t root = m_nodeChildren.size();
+		m_treeRoots.push_back(root);
+		appendNodes(1);
+
+		//pairs of (index in the split matrix, index in the compiled forest)
+		std::vector<std::pair<std::size_t, std::size_t> > stack(1, std::make_pair(std::size_t(0), root));
+		while(!stack.empty()){
+			SplitInfo const& info = splitMatrix[stack.back().first];
+			std::size_t node = stack.back().second;
+			stack.pop_back();
+			if(info.leftNodeId == 0){
+				m_nodeAttributes[node] = m_leafValues.size() / m_labelDimension;
+				SIZE_CHECK(info.label.size() == m_labelDimension);
+				m_leafValues.insert(m_leafValues.end(), info.label.begin(), info.label.end());
+				continue;
+			}
+			std::size_t left = m_nodeChildren.size();
+			appendNodes(2);
+			m_nodeAttributes[node] = info.attributeIndex;
+			m_nodeThresholds[node] = info.attributeValue;
+			m_nodeChildren[node] = left;
+			stack.push_back(std::make_pair(info.rightNodeId, left+1));
+			stack.push_back(std::make_pair(info.leftNodeId, left));
+		}
+	}
+
+	/// \brief Recreates the compiled forest from the trees.
+	void compileForest(){
+		m_treeRoots.clear();
+		m_nodeAttributes.clear();
+		m_nodeThresholds.clear();
+		m_nodeChildren.clear();
+		m_leafValues.clear();
+		if(m_forest.empty()) return;
+
+		//the label dimension is not stored, it is restored from the label of a leaf
+		SplitMatrixType const& splitMatrix = m_forest[0].splitMatrix();
+		std::size_t leaf = 0;
+		while(splitMatrix[leaf].leftNodeId != 0) ++leaf;
+		m_labelDimension = splitMatrix[leaf].label.size();
+		for(std::size_t t = 0; t != m_forest.size(); ++t){
+			compileTree(m_forest[t].splitMatrix());
+		}
+	}
+
+	/// \brief Appends uninitialized leaf nodes to the compiled forest.
+	void appendNodes(std::size_t n){
+		m_nodeAttributes.resize(m_nodeAttributes.size()+n, 0);
+		m_nodeThresholds.resize(m_nodeThresholds.size()+n, 0.0);
+		m_nodeChildren.resize(m_nodeChildren.size()+n, 0);
+	}
 
-//	/// number of predicted hits at each node
-//	std::vector< std::size_t > m_OOBHits;
+	/// out-of-bag error estimated during training
+	double m_OOBError;
 
-//	// labels
-//	std::vector< RealVector > m_OOBLabel;
+	/// permutation importance of every attribute estimated during training
+	RealVector m_featureImportances;
 };
 
 
@@ -89,7 +89,11 @@ namespace shark {
 /// IS_CONSTRAINED_FEATURE: The function has constraints and isFeasible might return false;
 /// CAN_PROPOSE_STARTING_POINT: the function can return a possibly randomized starting point;
 /// CAN_PROVIDE_CLOSEST_FEASIBLE: if the function is constrained, closest feasible can be
-/// called to construct a feasible point.
+/// called to construct a feasible point;
+/// IS_THREAD_SAFE: eval can be called concurrently from several threads. Optimizers which
+/// evaluate whole populations, like the CMA-ES variants and the MO-CMA-ES, then evaluate the
+/// offspring in parallel. The flag is opt-in, a function must only set it if all of its
+/// state, including the evaluation counter, is safe to be accessed concurrently.
 
 /// Calling the derivatives, proposeStartingPoint or closestFeasible when the flags are not set
 /// will throw an exception.
@@ -163,7 +167,9 @@ public:
 	}
 	
 	/// \brief Returns true, when the function can be usd in parallel threads.
-	bool isThreadSafe()const{
+	///
+	/// Functions whose thread safety depends on the number of threads override this.
+	virtual bool isThreadSafe()const{
 		return m_features & IS_THREAD_SAFE;
 	}
 
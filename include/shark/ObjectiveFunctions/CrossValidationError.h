@@ -32,6 +32,9 @@
 #include <shark/Algorithms/AbstractSingleObjectiveOptimizer.h>
 #include <shark/ObjectiveFunctions/AbstractCost.h>
 #include <shark/Data/CVDatasetTools.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Core/Exception.h>
+#include <string>
 
 namespace shark {
 
@@ -59,6 +62,25 @@ namespace shark {
 /// IParameterizable object, a model, a trainer, a data set,
 /// and a cost function.
 ///
+/// \par
+/// The folds can be trained concurrently. For this, independent
+/// copies of the meta object, the model and the trainer are
+/// registered with addWorker. Every worker trains its own subset
+/// of the folds, and the fold errors are summed up in the same
+/// order as in the sequential case, so the result does not depend
+/// on the number of workers as long as the trainer is deterministic.
+/// The cost function is shared by all workers and must be safe
+/// to evaluate concurrently.
+///
+/// \par
+/// The workers also allow to evaluate several points concurrently,
+/// e.g., the offspring of a CMA or the points of a GridSearch.
+/// When eval is called inside a parallel region, the thread with
+/// number i trains all folds with the i-th set of objects, where
+/// the set 0 are the objects of the constructor. Thus the function
+/// is thread-safe as long as there are at least as many sets of
+/// objects as threads.
+///
 template<class ModelTypeT, class LabelTypeT = typename ModelTypeT::OutputType>
 class CrossValidationError : public AbstractObjectiveFunction< VectorSpace<double>, double >
 {
@@ -75,11 +97,41 @@ private:
 	typedef AbstractObjectiveFunction< VectorSpace<double>, double > base_type;
 
 
+	/// \brief Copy of the objects needed to train a fold.
+	struct Worker{
+		IParameterizable* meta;
+		ModelType* model;
+		TrainerType* trainer;
+	};
+
 	FoldsType m_folds;
 	IParameterizable* mep_meta;
 	ModelType* mep_model;
 	TrainerType* mep_trainer;
 	CostType* mep_cost;
+	std::vector<Worker> m_workers; ///< additional workers for concurrent training of the folds
+
+	/// \brief Trains the model of the worker on the training part of a fold and returns the validation error.
+	double evalFold(std::size_t setID, ModelType* model, TrainerType* trainer) const{
+		DatasetType train =  m_folds.training(setID);
+		DatasetType validation =  m_folds.validation(setID);
+		trainer->train(*model, train);
+		Data<OutputType> output = (*model)(validation.inputs());
+		return mep_cost->eval(validation.labels(), output);
+	}
+
+	/// \brief Trains all folds with one set of objects and returns the sum of the errors.
+	double evalWithWorker(RealVector const& parameters, std::size_t worker)const{
+		IParameterizable* meta = (worker == 0) ? mep_meta : m_workers[worker-1].meta;
+		ModelType* model = (worker == 0) ? mep_model : m_workers[worker-1].model;
+		TrainerType* trainer = (worker == 0) ? mep_trainer : m_workers[worker-1].trainer;
+		meta->setParameterVector(parameters);
+		double ret = 0.0;
+		for (size_t setID=0; setID != m_folds.size(); ++setID) {
+			ret += evalFold(setID, model, trainer);
+		}
+		return ret;
+	}
 
 public:
 
@@ -112,20 +164,80 @@ public:
 		return mep_meta->numberOfParameters();
 	}
 
+	/// \brief Adds a worker which trains folds concurrently to the others.
+	///
+	/// The meta object, model and trainer must be independent copies
+	/// of the ones given in the constructor, i.e., they must not share
+	/// any state which is changed during training. Typically the
+	/// trainer is the meta object. The objects are not owned by
+	/// the cross-validation error.
+	void addWorker(IParameterizable* meta, ModelType* model, TrainerType* trainer){
+		SHARK_CHECK(meta->numberOfParameters() == mep_meta->numberOfParameters(), "[CrossValidationError::addWorker] meta object has a different number of parameters");
+		Worker worker = {meta, model, trainer};
+		m_workers.push_back(worker);
+	}
+
+	/// \brief Number of folds which are trained concurrently.
+	std::size_t numberOfWorkers()const{
+		return m_workers.size() + 1;
+	}
+
+	/// \brief Returns true if every thread of a parallel region has its own set of objects.
+	///
+	/// The number of threads is queried on every call, so the result
+	/// follows changes of the number of threads after the workers were added.
+	bool isThreadSafe()const{
+		return numberOfWorkers() >= SHARK_NUM_THREADS;
+	}
+
 	/// Evaluate the cross-validation error:
 	/// train sub-models, evaluate objective,
 	/// return the average.
 	double eval(RealVector const& parameters) const {
-		this->m_evaluationCounter++;
-		mep_meta->setParameterVector(parameters);
+		SHARK_CRITICAL_REGION{
+			this->m_evaluationCounter++;
+		}
+
+		// concurrent evaluations of several points use the set of objects of their thread
+		if (SHARK_IN_PARALLEL) {
+			std::size_t worker = SHARK_THREAD_NUM;
+			if (worker >= numberOfWorkers())
+				throw SHARKEXCEPTION("[CrossValidationError::eval] more threads evaluate points concurrently than there are workers");
+			return evalWithWorker(parameters, worker) / m_folds.size();
+		}
+
+		if (m_workers.empty()) {
+			return evalWithWorker(parameters, 0) / m_folds.size();
+		}
 
 		double ret = 0.0;
+		mep_meta->setParameterVector(parameters);
+
+		for (std::size_t w = 0; w != m_workers.size(); ++w)
+			m_workers[w].meta->setParameterVector(parameters);
+
+		// worker w trains the folds w, w+workers, w+2*workers, ...
+		// exceptions must not leave the parallel region, they are rethrown afterwards
+		std::size_t workers = numberOfWorkers();
+		std::vector<double> foldError(m_folds.size());
+		std::vector<std::string> errors(workers);
+		SHARK_PARALLEL_FOR(int w = 0; w < (int)workers; ++w) {
+			ModelType* model = (w == 0) ? mep_model : m_workers[w-1].model;
+			TrainerType* trainer = (w == 0) ? mep_trainer : m_workers[w-1].trainer;
+			try {
+				for (std::size_t setID = w; setID < m_folds.size(); setID += workers) {
+					foldError[setID] = evalFold(setID, model, trainer);
+				}
+			} catch (std::exception const& e) {
+				errors[w] = e.what();
+			}
+		}
+		for (std::size_t w = 0; w != workers; ++w) {
+			if (!errors[w].empty())
+				throw SHARKEXCEPTION(errors[w]);
+		}
 		for (size_t setID=0; setID != m_folds.size(); ++setID) {
-			DatasetType train =  m_folds.training(setID);
-			DatasetType validation =  m_folds.validation(setID);
-			mep_trainer->train(*mep_model, train);
-			Data<OutputType> output = (*mep_model)(validation.inputs());
-			ret += mep_cost->eval(validation.labels(), output);
+			ret += foldError[setID];
 		}
 		return ret / m_folds.size();
 	}
@@ -256,6 +256,16 @@ protected:
 
 
 ///\brief Implementation of the ErrorFunction using AbstractLoss for parallelizable computations
+///
+/// The batches are split into a few more contiguous blocks than there are threads. The blocks
+/// are scheduled dynamically, thus threads which are done early take over the remaining blocks
+/// when the batches differ in size or cost, as the sequences of a recurrent network do.
+/// Every block accumulates its error and derivative in its own buffer, which is kept between
+/// calls, and the buffers are summed up pairwise afterwards. Thus the result only depends on
+/// the number of threads and not on the schedule.
+///
+/// Because of these buffers, eval and evalDerivative must not be called concurrently on the
+/// same object. Use a copy per thread instead, copies do not share their buffers.
 template<class InputType, class LabelType,class OutputType>
 class ParallelLossBasedErrorFunctionImpl:public ErrorFunctionWrapper<InputType,LabelType,OutputType>{
 public:
@@ -280,69 +290,102 @@ public:
 		SHARK_FEATURE_CHECK(HAS_FIRST_DERIVATIVE);
 		mep_model->setParameterVector(input);
 
-		std::size_t numBatches = m_dataset.numberOfBatches();
-		std::size_t numElements = m_dataset.numberOfElements();
-		std::size_t numThreads = std::min(SHARK_NUM_THREADS,numBatches);
-		//calculate optimal partitioning
-		std::size_t batchesPerThread = numBatches/numThreads;
-		std::size_t leftOver = numBatches - batchesPerThread*numThreads;
-		double error = 0;
-		SHARK_PARALLEL_FOR(int ti = 0; ti < (int)numThreads; ++ti){//MSVC does not support unsigned integrals in paralll loops
-			std::size_t t = ti;
-			LossBasedErrorFunctionImpl<InputType,LabelType,OutputType> errorFunc(mep_model,mep_loss);
-			//get start and end index of batch-range
-			std::size_t start = t*batchesPerThread+std::min(t,leftOver);
-			std::size_t end = (t+1)*batchesPerThread+std::min(t+1,leftOver);
-			LabeledData<InputType, LabelType> threadData = rangeSubset(m_dataset,start,end);//threadsafe!
-			errorFunc.setDataset(threadData);
-			errorFunc.setDataset(rangeSubset(m_dataset,start,end));//threadsafe!
-			double threadError = errorFunc.evalPointSet();//threadsafe!
-			//we need to weight the error and derivativs with the number of samples in the split.
-			double weightFactor = double(threadData.numberOfElements())/numElements;
-			SHARK_CRITICAL_REGION{
-				error += weightFactor * threadError;
-			}
+		std::size_t blocks = numberOfBlocks();
+		m_blockErrors.resize(blocks);
+		SHARK_PARALLEL_FOR_DYNAMIC(int b = 0; b < (int)blocks; ++b){//MSVC does not support unsigned integrals in paralll loops
+			m_blockErrors[b] = evalBlock(b, blocks);
 		}
-		return error;
+		double error = 0;
+		for(std::size_t b = 0; b != blocks; ++b)
+			error += m_blockErrors[b];
+		return error/m_dataset.numberOfElements();
 	}
 
 	ResultType evalDerivative( const SearchPointType & point, FirstOrderDerivative & derivative ) const {
 		SHARK_FEATURE_CHECK(HAS_FIRST_DERIVATIVE);
 		mep_model->setParameterVector(point);
-		derivative.resize(mep_model->numberOfParameters());
-		derivative.clear();
-		
-		std::size_t numBatches = m_dataset.numberOfBatches();
-		std::size_t numElements = m_dataset.numberOfElements();
-		std::size_t numThreads = std::min(SHARK_NUM_THREADS,numBatches);
-		//calculate optimal partitioning
-		std::size_t batchesPerThread = numBatches/numThreads;
-		std::size_t leftOver = numBatches - batchesPerThread*numThreads;
-		double error = 0;
-		SHARK_PARALLEL_FOR(int ti = 0; ti < (int)numThreads; ++ti){//MSVC does not support unsigned integrals in paralll loops
-			std::size_t t = ti;
-			FirstOrderDerivative threadDerivative;
-			LossBasedErrorFunctionImpl<InputType,LabelType,OutputType> errorFunc(mep_model,mep_loss);
-			//get start and end index of batch-range
-			std::size_t start = t*batchesPerThread+std::min(t,leftOver);
-			std::size_t end = (t+1)*batchesPerThread+std::min(t+1,leftOver);
-			LabeledData<InputType, LabelType> threadData = rangeSubset(m_dataset,start,end);//threadsafe!
-			errorFunc.setDataset(threadData);
-			double threadError = errorFunc.evalDerivativePointSet(threadDerivative);//threadsafe!
-			//we need to weight the error and derivativs with the number of samples in the split.
-			double weightFactor = double(threadData.numberOfElements())/numElements;
-			SHARK_CRITICAL_REGION{
-				error += weightFactor*threadError;
-				noalias(derivative) += weightFactor*threadDerivative;
+
+		std::size_t blocks = numberOfBlocks();
+		m_blockErrors.resize(blocks);
+		m_blockDerivatives.resize(blocks);
+		m_blockGradients.resize(blocks);
+		SHARK_PARALLEL_FOR_DYNAMIC(int b = 0; b < (int)blocks; ++b){
+			m_blockErrors[b] = evalDerivativeBlock(b, blocks);
+		}
+
+		//sum up the partial results pairwise, the sums of one level are independent
+		for(std::size_t step = 1; step < blocks; step *= 2){
+			int stride = (int)(2*step);
+			SHARK_PARALLEL_FOR(int b = 0; b < (int)(blocks-step); b += stride){
+				m_blockErrors[b] += m_blockErrors[b+step];
+				noalias(m_blockDerivatives[b]) += m_blockDerivatives[b+step];
 			}
 		}
-		return error;
+		std::size_t numElements = m_dataset.numberOfElements();
+		derivative = m_blockDerivatives[0] / double(numElements);
+		return m_blockErrors[0] / numElements;
 	}
 
 protected:
 	using base_type::mep_model;
 	using base_type::m_dataset;
 	AbstractLoss<LabelType, OutputType>* mep_loss;
+
+private:
+	/// \brief Number of blocks the batches are split into.
+	///
+	/// More blocks than threads are needed to balance the load, but every block
+	/// needs its own derivative buffer which has to be summed up in the end.
+	std::size_t numberOfBlocks()const{
+		//always checked, an empty dataset would read the buffer of a non-existing block
+		THROW_IF(m_dataset.numberOfBatches() == 0, "[ParallelLossBasedErrorFunctionImpl] the dataset is empty");
+		return std::min(4*SHARK_NUM_THREADS, m_dataset.numberOfBatches());
+	}
+
+	std::size_t blockStart(std::size_t block, std::size_t blocks)const{
+		return block*m_dataset.numberOfBatches()/blocks;
+	}
+
+	/// \brief Sum of the losses of the batches of a block.
+	double evalBlock(std::size_t block, std::size_t blocks)const{
+		typename Batch<OutputType>::type prediction;
+		boost::shared_ptr<State> state = mep_model->createState();
+		double error = 0.0;
+		for(std::size_t i = blockStart(block,blocks); i != blockStart(block+1,blocks); ++i){
+			const_reference batch = m_dataset.batch(i);
+			mep_model->eval(batch.input, prediction,*state);
+			error += mep_loss->eval(batch.label, prediction);
+		}
+		return error;
+	}
+
+	/// \brief Sum of the losses of the batches of a block, the sum of the derivatives is stored in the buffer of the block.
+	double evalDerivativeBlock(std::size_t block, std::size_t blocks)const{
+		RealVector& derivative = m_blockDerivatives[block];
+		RealVector& dataGradient = m_blockGradients[block];
+		derivative.resize(mep_model->numberOfParameters());
+		derivative.clear();
+
+		typename Batch<OutputType>::type prediction;
+		typename Batch<OutputType>::type errorDerivative;
+		boost::shared_ptr<State> state = mep_model->createState();
+		double error = 0.0;
+		for(std::size_t i = blockStart(block,blocks); i != blockStart(block+1,blocks); ++i){
+			const_reference batch = m_dataset.batch(i);
+			// calculate model output for the batch as well as the derivative
+			mep_model->eval(batch.input, prediction,*state);
+			error += mep_loss->evalDerivative(batch.label, prediction,errorDerivative);
+			//calculate the gradient using the chain rule
+			mep_model->weightedParameterDerivative(batch.input,errorDerivative,*state,dataGradient);
+			noalias(derivative) += dataGradient;
+		}
+		return error;
+	}
+
+	//buffers of the blocks, they are kept between calls to avoid reallocations
+	mutable std::vector<double> m_blockErrors;
+	mutable std::vector<RealVector> m_blockDerivatives;
+	mutable std::vector<RealVector> m_blockGradients;
 };
 
 } // namespace detail
@@ -401,7 +444,8 @@ ErrorFunction<InputType,LabelType>::ErrorFunction(const ErrorFunction& op)
 template<class InputType,class LabelType>
 ErrorFunction<InputType,LabelType>& ErrorFunction<InputType,LabelType>::operator = (const ErrorFunction<InputType,LabelType>& op){
 	ErrorFunction<InputType,LabelType> copy(op);
-	swap(copy.mp_wrapper,*this);
+	swap(copy.mp_wrapper,mp_wrapper);
+	this -> m_features = mp_wrapper -> features();
 	return *this;
 }
 
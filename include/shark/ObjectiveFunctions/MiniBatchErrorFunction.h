@@ -0,0 +1,180 @@
+/*!
+ *
+ *  \brief Error function which evaluates one mini-batch of an epoch per call
+ *
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_OBJECTIVEFUNCTIONS_MINIBATCHERRORFUNCTION_H
+#define SHARK_OBJECTIVEFUNCTIONS_MINIBATCHERRORFUNCTION_H
+
+#include <shark/ObjectiveFunctions/ErrorFunction.h>
+#include <shark/Data/BatchPrefetcher.h>
+#include <shark/Core/OpenMP.h>
+
+#include <boost/scoped_ptr.hpp>
+
+namespace shark{
+
+///\brief Error function which evaluates the next mini-batch of a shuffled dataset on every call.
+///
+///In contrast to the NoisyErrorFunction, which draws every batch independently, the
+///elements are drawn without replacement: the dataset is shuffled and every call of eval
+///or evalDerivative processes the next batchSize elements, thus every element is used
+///once per epoch. The last batch of an epoch holds the remaining elements if the batch
+///size does not divide the size of the dataset. The batches are gathered by a
+///BatchPrefetcher in a background thread while the optimizer works on the previous batch.
+///
+///A batch is evaluated by an ErrorFunction. The batch is split into one part per thread,
+///thus the gradients of the parts are computed in parallel and averaged, if Shark is
+///compiled with OpenMP and the model is not sequential.
+///
+///Together with the stochastic gradient methods, e.g. Adam, Adagrad or SteepestDescent with
+///momentum, this allows to train models on datasets which are too large for full-batch methods.
+template<class InputType = RealVector, class LabelType = RealVector>
+class MiniBatchErrorFunction : public SupervisedObjectiveFunction<InputType,LabelType>
+{
+public:
+	typedef SupervisedObjectiveFunction<InputType,LabelType> base_type;
+	typedef typename base_type::SearchPointType SearchPointType;
+	typedef typename base_type::ResultType ResultType;
+	typedef typename base_type::FirstOrderDerivative FirstOrderDerivative;
+	typedef typename base_type::SecondOrderDerivative SecondOrderDerivative;
+	typedef LabeledData<InputType,LabelType> DatasetType;
+
+	template<class OutputType>
+	MiniBatchErrorFunction(AbstractModel<InputType,OutputType>* model,AbstractLoss<LabelType,OutputType>* loss, std::size_t batchSize = 32)
+	: m_error(model,loss), m_batchSize(batchSize), m_subBatches(SHARK_NUM_THREADS), m_queueSize(2){
+		this->m_features = m_error.features();
+	}
+
+	MiniBatchErrorFunction(MiniBatchErrorFunction const& op)
+	: base_type(op)
+	, m_error(op.m_error), m_dataset(op.m_dataset)
+	, m_batchSize(op.m_batchSize), m_subBatches(op.m_subBatches), m_queueSize(op.m_queueSize){
+		restart();
+	}
+
+	MiniBatchErrorFunction& operator=(MiniBatchErrorFunction const& op){
+		base_type::operator=(op);
+		m_error = op.m_error;
+		m_dataset = op.m_dataset;
+		m_batchSize = op.m_batchSize;
+		m_subBatches = op.m_subBatches;
+		m_queueSize = op.m_queueSize;
+		restart();
+		return *this;
+	}
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "MiniBatchErrorFunction"; }
+
+	void updateFeatures(){
+		m_error.updateFeatures();
+		this->m_features = m_error.features();
+	}
+
+	void configure( const PropertyTree & node ){
+		m_error.configure(node);
+		m_batchSize = node.get("batchSize",m_batchSize);
+		this->m_features = m_error.features();
+		restart();
+	}
+
+	///\brief Sets the training data and starts the first epoch.
+	void setDataset(DatasetType const& dataset){
+		m_dataset = dataset;
+		restart();
+	}
+
+	std::size_t batchSize()const{
+		return m_batchSize;
+	}
+	///\brief Sets the number of elements of a batch and starts a new epoch.
+	void setBatchSize(std::size_t batchSize){
+		m_batchSize = batchSize;
+		restart();
+	}
+
+	///\brief Number of parts a batch is split into, by default the number of threads.
+	std::size_t subBatches()const{
+		return m_subBatches;
+	}
+	void setSubBatches(std::size_t subBatches){
+		m_subBatches = subBatches;
+		restart();
+	}
+
+	///\brief Number of batches which are prepared in advance.
+	std::size_t queueSize()const{
+		return m_queueSize;
+	}
+	void setQueueSize(std::size_t queueSize){
+		m_queueSize = queueSize;
+		restart();
+	}
+
+	///\brief Number of completed epochs of the background thread.
+	std::size_t epoch()const{
+		return mp_prefetcher ? mp_prefetcher->epoch() : 0;
+	}
+
+	void proposeStartingPoint( SearchPointType & startingPoint)const{
+		m_error.proposeStartingPoint(startingPoint);
+	}
+	std::size_t numberOfVariables()const{
+		return m_error.numberOfVariables();
+	}
+
+	///\brief Mean loss on the next batch.
+	double eval(RealVector const& input)const{
+		++this->m_evaluationCounter;
+		nextBatch();
+		return m_error.eval(input);
+	}
+
+	///\brief Mean loss and derivative on the next batch.
+	ResultType evalDerivative( SearchPointType const& input, FirstOrderDerivative & derivative )const{
+		++this->m_evaluationCounter;
+		nextBatch();
+		return m_error.evalDerivative(input,derivative);
+	}
+
+private:
+	//starts a new prefetcher, which is needed whenever the data or the batches change
+	void restart(){
+		mp_prefetcher.reset();
+		if(m_dataset.numberOfElements() == 0)
+			return;
+		mp_prefetcher.reset(new BatchPrefetcher<DatasetType>(m_dataset,m_batchSize,m_subBatches,m_queueSize));
+	}
+
+	void nextBatch()const{
+		SHARK_CHECK(mp_prefetcher, "[MiniBatchErrorFunction] no dataset set");
+		m_error.setDataset(mp_prefetcher->next());
+	}
+
+	mutable ErrorFunction<InputType,LabelType> m_error;
+	DatasetType m_dataset;
+	boost::scoped_ptr<BatchPrefetcher<DatasetType> > mp_prefetcher;
+	std::size_t m_batchSize;
+	std::size_t m_subBatches;
+	std::size_t m_queueSize;
+};
+
+}
+#endif
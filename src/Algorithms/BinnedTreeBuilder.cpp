@@ -0,0 +1,322 @@
+//===========================================================================
+/*!
+ *  \brief Histogram based growing of CART trees on quantized attributes.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#include <shark/Algorithms/Trainers/Impl/BinnedTreeBuilder.h>
+#include <shark/Core/OpenMP.h>
+#include <algorithm>
+#include <limits>
+#include <set>
+
+using namespace shark;
+using namespace shark::detail;
+
+void BinnedAttributes::create(Data<RealVector> const& inputs, std::size_t maxBins){
+	SHARK_CHECK(maxBins >= 2 && maxBins <= 256, "[BinnedAttributes::create] the number of bins must be in [2,256]");
+	m_numElements = inputs.numberOfElements();
+	std::size_t numAttributes = dataDimension(inputs);
+	m_bins.resize(m_numElements*numAttributes);
+	m_thresholds.resize(numAttributes);
+
+	//copy the data column wise
+	std::vector<double> columns(m_numElements*numAttributes);
+	std::size_t i = 0;
+	for(std::size_t b = 0; b != inputs.numberOfBatches(); ++b){
+		Data<RealVector>::const_batch_reference batch = inputs.batch(b);
+		for(std::size_t k = 0; k != batch.size1(); ++k, ++i){
+			for(std::size_t j = 0; j != numAttributes; ++j){
+				columns[j*m_numElements+i] = batch(k,j);
+			}
+		}
+	}
+
+	SHARK_PARALLEL_FOR(int j = 0; j < (int)numAttributes; ++j){
+		double const* column = &columns[j*m_numElements];
+		std::vector<double> values(column,column+m_numElements);
+		std::sort(values.begin(),values.end());
+		std::size_t numDistinct = std::unique(values.begin(),values.end()) - values.begin();
+
+		//find the upper edges of the bins
+		std::vector<double>& thresholds = m_thresholds[j];
+		thresholds.clear();
+		if(numDistinct <= maxBins){
+			thresholds.assign(values.begin(),values.begin()+numDistinct);
+		}else{
+			//every bin but the last gets at least binSize elements
+			values.assign(column,column+m_numElements);
+			std::sort(values.begin(),values.end());
+			std::size_t binSize = (m_numElements+maxBins-1)/maxBins;
+			std::size_t binStart = 0;
+			for(std::size_t k = 0; k != m_numElements; ++k){
+				bool lastCopy = k+1 == m_numElements || values[k+1] != values[k];
+				if(lastCopy && (k+1-binStart >= binSize || k+1 == m_numElements)){
+					thresholds.push_back(values[k]);
+					binStart = k+1;
+				}
+			}
+		}
+
+		//map the values to their bins
+		unsigned char* bins = &m_bins[j*m_numElements];
+		for(std::size_t k = 0; k != m_numElements; ++k){
+			bins[k] = (unsigned char)(std::lower_bound(thresholds.begin(),thresholds.end(),column[k])-thresholds.begin());
+		}
+	}
+}
+
+BinnedTreeBuilder::BinnedTreeBuilder(BinnedAttributes const& attributes, std::vector<unsigned int> const& labels, std::size_t numberOfClasses)
+: m_attributes(attributes)
+, mep_classLabels(&labels)
+, mep_regressionLabels(0)
+, mep_multiplicities(0)
+, m_regression(false)
+, m_labelDimension(numberOfClasses)
+, m_stride(numberOfClasses)
+, m_nodeSize(1)
+, m_try(0){
+	SIZE_CHECK(labels.size() == attributes.numberOfElements());
+}
+
+BinnedTreeBuilder::BinnedTreeBuilder(BinnedAttributes const& attributes, std::vector<RealVector> const& labels)
+: m_attributes(attributes)
+, mep_classLabels(0)
+, mep_regressionLabels(&labels)
+, mep_multiplicities(0)
+, m_regression(true)
+, m_labelDimension(labels[0].size())
+, m_stride(labels[0].size()+2)
+, m_nodeSize(1)
+, m_try(0){
+	SIZE_CHECK(labels.size() == attributes.numberOfElements());
+}
+
+BinnedTreeBuilder::SplitMatrixType BinnedTreeBuilder::buildTree(std::vector<std::size_t> const& elements, Rng::rng_type& rng){
+	std::size_t numAttributes = m_attributes.numberOfAttributes();
+	m_offsets.resize(numAttributes);
+	m_histogramSize = 0;
+	for(std::size_t j = 0; j != numAttributes; ++j){
+		m_offsets[j] = m_histogramSize;
+		m_histogramSize += m_attributes.numberOfBins(j)*m_stride;
+	}
+
+	m_elements = elements;
+	std::vector<double> histograms;
+	if(searchesAllAttributes()){
+		std::vector<std::size_t> attributes(numAttributes);
+		for(std::size_t j = 0; j != numAttributes; ++j){
+			attributes[j] = j;
+		}
+		histograms.resize(m_histogramSize,0.0);
+		fillHistograms(histograms,0,m_elements.size(),attributes);
+	}else{
+		m_scratch.resize(m_histogramSize);
+	}
+	return buildNode(0,m_elements.size(),0,histograms,rng);
+}
+
+BinnedTreeBuilder::SplitMatrixType BinnedTreeBuilder::buildNode(
+	std::size_t begin, std::size_t end, std::size_t nodeId,
+	std::vector<double>& histograms, Rng::rng_type& rng
+){
+	std::size_t numAttributes = m_attributes.numberOfAttributes();
+
+	//statistics of the whole node
+	std::vector<double> nodeStatistics(m_stride,0.0);
+	for(std::size_t i = begin; i != end; ++i){
+		addElement(&nodeStatistics[0],m_elements[i]);
+	}
+	//number of elements, counted with their multiplicities
+	double n = count(&nodeStatistics[0]);
+
+	CARTClassifier<RealVector>::SplitInfo splitInfo;
+	splitInfo.nodeId = nodeId;
+	splitInfo.leftNodeId = 0;
+	splitInfo.rightNodeId = 0;
+	setNodeInfo(splitInfo,&nodeStatistics[0]);
+
+	SplitMatrixType splitMatrix;
+	double nodeCost = cost(&nodeStatistics[0]);
+	if(n <= m_nodeSize || nodeCost <= 0){
+		splitMatrix.push_back(splitInfo);
+		return splitMatrix;
+	}
+
+	//choose the attributes to search
+	std::vector<std::size_t> attributes;
+	if(searchesAllAttributes()){
+		attributes.resize(numAttributes);
+		for(std::size_t j = 0; j != numAttributes; ++j){
+			attributes[j] = j;
+		}
+	}else{
+		std::set<std::size_t> drawn;
+		DiscreteUniform<Rng::rng_type> uni(rng, 0, numAttributes-1);
+		while(drawn.size() < m_try){
+			drawn.insert(uni());
+		}
+		attributes.assign(drawn.begin(),drawn.end());
+		for(std::size_t a = 0; a != attributes.size(); ++a){
+			std::size_t j = attributes[a];
+			std::fill(
+				m_scratch.begin()+m_offsets[j],
+				m_scratch.begin()+m_offsets[j]+m_attributes.numberOfBins(j)*m_stride,
+				0.0
+			);
+		}
+		fillHistograms(m_scratch,begin,end,attributes);
+	}
+	std::vector<double> const& searchHistograms = searchesAllAttributes()? histograms : m_scratch;
+
+	//sweep over the bins of every attribute
+	double bestCost = std::numeric_limits<double>::max();
+	std::size_t bestAttribute = 0;
+	std::size_t bestBin = 0;
+	bool doSplit = false;
+	std::vector<double> left(m_stride);
+	std::vector<double> right(m_stride);
+	for(std::size_t a = 0; a != attributes.size(); ++a){
+		std::size_t j = attributes[a];
+		double const* histogram = &searchHistograms[m_offsets[j]];
+		std::fill(left.begin(),left.end(),0.0);
+		for(std::size_t bin = 0; bin+1 < m_attributes.numberOfBins(j); ++bin){
+			double const* binStatistics = histogram+bin*m_stride;
+			for(std::size_t k = 0; k != m_stride; ++k){
+				left[k] += binStatistics[k];
+				right[k] = nodeStatistics[k]-left[k];
+			}
+			double nLeft = count(&left[0]);
+			if(nLeft == 0) continue;
+			if(nLeft == n) break;
+
+			double splitCost = cost(&left[0])+cost(&right[0]);
+			if(splitCost < bestCost){
+				bestCost = splitCost;
+				bestAttribute = j;
+				bestBin = bin;
+				doSplit = true;
+			}
+		}
+	}
+
+	if(!doSplit){
+		splitMatrix.push_back(splitInfo);
+		return splitMatrix;
+	}
+
+	//partition the elements of the node in place
+	unsigned char const* column = m_attributes.column(bestAttribute);
+	std::size_t split = begin;
+	for(std::size_t i = begin; i != end; ++i){
+		if(column[m_elements[i]] <= bestBin){
+			std::swap(m_elements[i],m_elements[split]);
+			++split;
+		}
+	}
+	splitInfo.attributeIndex = bestAttribute;
+	splitInfo.attributeValue = m_attributes.threshold(bestAttribute,bestBin);
+
+	//histograms of the children: compute the smaller child and subtract it from the parent
+	std::vector<double> leftHistograms;
+	std::vector<double> rightHistograms;
+	if(searchesAllAttributes()){
+		bool leftIsSmaller = split-begin <= end-split;
+		std::vector<double>& smaller = leftIsSmaller? leftHistograms: rightHistograms;
+		std::vector<double>& larger = leftIsSmaller? rightHistograms: leftHistograms;
+		smaller.resize(m_histogramSize,0.0);
+		if(leftIsSmaller)
+			fillHistograms(smaller,begin,split,attributes);
+		else
+			fillHistograms(smaller,split,end,attributes);
+		larger.swap(histograms);
+		for(std::size_t k = 0; k != m_histogramSize; ++k){
+			larger[k] -= smaller[k];
+		}
+	}
+
+	splitInfo.leftNodeId = nodeId+1;
+	SplitMatrixType lSplitMatrix = buildNode(begin,split,splitInfo.leftNodeId,leftHistograms,rng);
+	std::vector<double>().swap(leftHistograms);
+	splitInfo.rightNodeId = splitInfo.leftNodeId+lSplitMatrix.size();
+	SplitMatrixType rSplitMatrix = buildNode(split,end,splitInfo.rightNodeId,rightHistograms,rng);
+
+	splitMatrix.push_back(splitInfo);
+	splitMatrix.insert(splitMatrix.end(), lSplitMatrix.begin(), lSplitMatrix.end());
+	splitMatrix.insert(splitMatrix.end(), rSplitMatrix.begin(), rSplitMatrix.end());
+	return splitMatrix;
+}
+
+void BinnedTreeBuilder::fillHistograms(
+	std::vector<double>& histograms, std::size_t begin, std::size_t end,
+	std::vector<std::size_t> const& attributes
+)const{
+	for(std::size_t a = 0; a != attributes.size(); ++a){
+		std::size_t j = attributes[a];
+		unsigned char const* column = m_attributes.column(j);
+		double* histogram = &histograms[m_offsets[j]];
+		for(std::size_t i = begin; i != end; ++i){
+			std::size_t element = m_elements[i];
+			addElement(histogram+column[element]*m_stride,element);
+		}
+	}
+}
+
+double BinnedTreeBuilder::count(double const* statistics)const{
+	if(m_regression)
+		return statistics[0];
+	double n = 0;
+	for(std::size_t c = 0; c != m_stride; ++c){
+		n += statistics[c];
+	}
+	return n;
+}
+
+double BinnedTreeBuilder::cost(double const* statistics)const{
+	double n = count(statistics);
+	if(n == 0) return 0;
+	double sumSqr = 0;
+	if(m_regression){
+		for(std::size_t k = 0; k != m_labelDimension; ++k){
+			sumSqr += sqr(statistics[2+k]);
+		}
+		//n times the total sum of squares, cancellation can make the result slightly negative
+		return n*std::max(statistics[1]-sumSqr/n,0.0);
+	}
+	//n times the Gini impurity 1-sum_c p_c^2
+	for(std::size_t c = 0; c != m_stride; ++c){
+		sumSqr += sqr(statistics[c]);
+	}
+	return n - sumSqr/n;
+}
+
+void BinnedTreeBuilder::setNodeInfo(CARTClassifier<RealVector>::SplitInfo& info, double const* statistics)const{
+	double n = count(statistics);
+	info.label.resize(m_labelDimension);
+	if(m_regression){
+		for(std::size_t k = 0; k != m_labelDimension; ++k){
+			info.label(k) = statistics[2+k]/n;
+		}
+		info.misclassProp = cost(statistics)/n;
+	}else{
+		for(std::size_t c = 0; c != m_labelDimension; ++c){
+			info.label(c) = statistics[c]/n;
+		}
+		info.misclassProp = 1-*std::max_element(info.label.begin(),info.label.end());
+	}
+}
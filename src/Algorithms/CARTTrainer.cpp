@@ -6,9 +6,11 @@
  */
 
 #include <shark/Algorithms/Trainers/CARTTrainer.h>
+#include <shark/Algorithms/Trainers/Impl/BinnedTreeBuilder.h>
 #include <shark/Data/CVDatasetTools.h>
 #include <shark/ObjectiveFunctions/Loss/SquaredLoss.h>
 #include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
+#include <boost/range/algorithm_ext/iota.hpp>
 
 using namespace shark;
 using namespace std;
@@ -24,6 +26,7 @@ void CARTTrainer::train(ModelType& model, RegressionDataset const& dataset)
 
 	// create cross-validation folds
 	RegressionDataset set=dataset;
+	set.makeIndependent();//the folds are created by reordering the set
 	unsigned int numberOfFolds= 10;
 	CVFolds<RegressionDataset > folds = createCVSameSize(set, numberOfFolds);
 	double bestErrorRate = std::numeric_limits<double>::max();
@@ -35,12 +38,25 @@ void CARTTrainer::train(ModelType& model, RegressionDataset const& dataset)
 		RegressionDataset dataTest = folds.validation(fold);
 		std::size_t numTrainElements = dataTrain.numberOfElements();
 
-		AttributeTables tables = createAttributeTables(dataTrain.inputs());
-
 		std::vector < RealVector > labels(numTrainElements);
 		boost::copy(dataTrain.labels().elements(),labels.begin());
+
 		//Build tree form this fold
-		CARTClassifier<RealVector>::SplitMatrixType splitMatrix = buildTree(tables, dataTrain, labels, 0, dataTrain.numberOfElements());
+		CARTClassifier<RealVector>::SplitMatrixType splitMatrix;
+		if(m_histogramBins){
+			detail::BinnedAttributes attributes(dataTrain.inputs(), m_histogramBins);
+			detail::BinnedTreeBuilder builder(attributes, labels);
+			builder.setNodeSize(m_nodeSize);
+			std::vector<std::size_t> elements(numTrainElements);
+			boost::iota(elements,0);
+			splitMatrix = builder.buildTree(elements, Rng::globalRng);
+		}else{
+			AttributeTables tables = createAttributeTables(dataTrain.inputs());
+			PartitionBuffer buffer;
+			buffer.goesLeft.resize(numTrainElements);
+			buffer.entries.resize(numTrainElements);
+			splitMatrix = buildTree(tables, 0, numTrainElements, labels, 0, numTrainElements, buffer);
+		}
 		//Add the tree to the model and prune
 		model.setSplitMatrix(splitMatrix);
 		while(splitMatrix.size()!=1){
@@ -84,12 +100,27 @@ void CARTTrainer::train(ModelType& model, ClassificationDataset const& dataset){
 		//Create attribute tables
 		//O.K. stores how often label(i) can be found in the dataset
 		//O.K. TODO: std::vector<unsigned int> is sufficient
-		boost::unordered_map<std::size_t, std::size_t> cAbove = createCountMatrix(dataTrain);
-		AttributeTables tables = createAttributeTables(dataTrain.inputs());
-		
+		std::size_t numTrainElements = dataTrain.numberOfElements();
+		std::vector<unsigned int> labels(numTrainElements);
+		boost::copy(dataTrain.labels().elements(),labels.begin());
 
 		//create initial split matrix for the fold
-		CARTClassifier<RealVector>::SplitMatrixType splitMatrix = buildTree(tables, dataTrain, cAbove, 0);
+		CARTClassifier<RealVector>::SplitMatrixType splitMatrix;
+		if(m_histogramBins){
+			detail::BinnedAttributes attributes(dataTrain.inputs(), m_histogramBins);
+			detail::BinnedTreeBuilder builder(attributes, labels, m_maxLabel+1);
+			builder.setNodeSize(m_nodeSize);
+			std::vector<std::size_t> elements(numTrainElements);
+			boost::iota(elements,0);
+			splitMatrix = builder.buildTree(elements, Rng::globalRng);
+		}else{
+			boost::unordered_map<std::size_t, std::size_t> cAbove = createCountMatrix(labels);
+			AttributeTables tables = createAttributeTables(dataTrain.inputs());
+			PartitionBuffer buffer;
+			buffer.goesLeft.resize(numTrainElements);
+			buffer.entries.resize(numTrainElements);
+			splitMatrix = buildTree(tables, 0, numTrainElements, labels, cAbove, 0, buffer);
+		}
 		model.setSplitMatrix(splitMatrix);
 		
         while(splitMatrix.size()!=1){
@@ -192,8 +223,7 @@ void CARTTrainer::measureStrenght(SplitMatrixType& splitMatrix, std::size_t node
 }
 
 //Classification case
-CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& tables, ClassificationDataset const& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId ){
-	std::cout<<nodeId<<std::endl;
+CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables& tables, std::size_t begin, std::size_t end, std::vector<unsigned int> const& labels, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId, PartitionBuffer& buffer){
 	//Construct split matrix
 	ModelType::SplitInfo splitInfo;
 	splitInfo.nodeId = nodeId;
@@ -209,7 +239,7 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 	//calculate leaves from the data
 	
 	//n = Total number of cases in the split
-	std::size_t n = tables[0].size();
+	std::size_t n = end-begin;
 
 	if(!(gini(cAbove,n)==0 || n <= m_nodeSize)){
 		//Count matrices
@@ -224,16 +254,16 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 			AttributeTable const& table = tables[attributeIndex];
 			boost::unordered_map<std::size_t, std::size_t> cTmpAbove = cAbove;
 			boost::unordered_map<std::size_t, std::size_t> cBelow;
-			for(std::size_t i=0; i<n-1; i++){//go through all possible splits
+			for(std::size_t i=begin; i<end-1; i++){//go through all possible splits
 				//Update the count classes of both splits after element i moved to the left split
-				unsigned int label = dataset.element(table[i].id).label;
+				unsigned int label = labels[table[i].id];
 				cBelow[label]++;
 				cTmpAbove[label]--;
 
 				if(table[i].value != table[i+1].value){
 					//n1 = Number of cases to the left child node
 					//n2 = number of cases to the right child node
-					std::size_t n1 = i+1;
+					std::size_t n1 = i+1-begin;
 					std::size_t n2 = n-n1;
 
 					//Calculate the Gini impurity of the split
@@ -250,11 +280,10 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 			}
 		}
 
-		//std::cout<<"impurity"<<bestImpurity<<" "<<n+1<<std::endl;
 		if(bestImpurity<n+1){
 			double bestAttributeVal = tables[bestAttributeIndex][bestAttributeValIndex].value;
-			AttributeTables rTables, lTables;
-			splitAttributeTables(tables, bestAttributeIndex, bestAttributeValIndex, lTables, rTables);
+			std::size_t splitPoint = bestAttributeValIndex+1;
+			splitAttributeTables(tables, begin, end, bestAttributeIndex, splitPoint, buffer);
 			//Continue recursively
 			splitInfo.attributeIndex = bestAttributeIndex;
 			splitInfo.attributeValue = bestAttributeVal;
@@ -262,9 +291,9 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 
 			//Store entry in the splitMatrix table
 			splitInfo.leftNodeId = nodeId+1;
-			SplitMatrixType lSplitMatrix = buildTree(lTables, dataset, cBestBelow, splitInfo.leftNodeId);
+			SplitMatrixType lSplitMatrix = buildTree(tables, begin, splitPoint, labels, cBestBelow, splitInfo.leftNodeId, buffer);
 			splitInfo.rightNodeId = splitInfo.leftNodeId+lSplitMatrix.size();
-			SplitMatrixType rSplitMatrix = buildTree(rTables, dataset, cBestAbove, splitInfo.rightNodeId);
+			SplitMatrixType rSplitMatrix = buildTree(tables, splitPoint, end, labels, cBestAbove, splitInfo.rightNodeId, buffer);
 			
 			SplitMatrixType splitMatrix;
 			splitMatrix.push_back(splitInfo);
@@ -297,36 +326,39 @@ RealVector CARTTrainer::hist(boost::unordered_map<std::size_t, std::size_t> coun
 
 
 //Build CART tree in the regression case
-CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& tables, RegressionDataset const& dataset, std::vector<RealVector> const& labels, std::size_t nodeId, std::size_t trainSize){
+CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables& tables, std::size_t begin, std::size_t end, std::vector<RealVector> const& labels, std::size_t nodeId, std::size_t trainSize, PartitionBuffer& buffer){
+
+	//n = Total number of cases in the node
+	//n1 = Number of cases to the left child node
+	//n2 = number of cases to the right child node
+	std::size_t n, n1, n2;
+
+	n = end-begin;
+
+	//sum and sum of squared norms of the labels in the node
+	RealVector labelSum(m_labelDimension,0.0);
+	double labelSumOfSquares = 0;
+	for(std::size_t i = begin; i != end; ++i){
+		RealVector const& label = labels[tables[0][i].id];
+		noalias(labelSum) += label;
+		labelSumOfSquares += norm_sqr(label);
+	}
 
 	//Construct split matrix
 	CARTClassifier<RealVector>::SplitInfo splitInfo;
 
 	splitInfo.nodeId = nodeId;
-	splitInfo.label = mean(labels);
+	splitInfo.label = labelSum/n;
 	splitInfo.leftNodeId = 0;
 	splitInfo.rightNodeId = 0;
 
 	//Store the Total Sum of Squares (TSS)
-	RealVector labelSum = labels[0];
-	for(std::size_t i=1; i< labels.size(); i++){
-		labelSum += labels[0];
-	}
-
-	splitInfo.misclassProp = totalSumOfSquares(labels, 0, labels.size(), labelSum)*((double)dataset.numberOfElements()/trainSize);
+	splitInfo.misclassProp = totalSumOfSquares(labelSumOfSquares, labelSum, n)*((double)labels.size()/trainSize);
 
 	SplitMatrixType splitMatrix, lSplitMatrix, rSplitMatrix;
 
-	//n = Total number of cases in the dataset
-	//n1 = Number of cases to the left child node
-	//n2 = number of cases to the right child node
-	std::size_t n, n1, n2;
-
-	n = tables[0].size();
-
 	if(n > m_nodeSize){
-		//label vectors
-		std::vector<RealVector> bestLabels, tmpLabels;
+		//label sums of the left (below) and right (above) part of the split
 		RealVector labelSumAbove(m_labelDimension), labelSumBelow(m_labelDimension);
 
 		//Index of attributes
@@ -339,26 +371,27 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 		std::size_t prev;
 		bool doSplit = false;
 		for ( attributeIndex = 0; attributeIndex< m_inputDimension; attributeIndex++){
+			AttributeTable const& table = tables[attributeIndex];
 
 			labelSumBelow.clear();
-			labelSumAbove.clear();
-
-			tmpLabels.clear();
-			//Create a labels table, that corresponds to the sorted attribute
-			for(std::size_t k=0; k<tables[attributeIndex].size(); k++){
-				tmpLabels.push_back(dataset.element(tables[attributeIndex][k].id).label);
-				labelSumBelow += dataset.element(tables[attributeIndex][k].id).label;
-			}
-			labelSumAbove += tmpLabels[0];
-			labelSumBelow -= tmpLabels[0];
+			noalias(labelSumAbove) = labelSum;
+			double sumOfSquaresBelow = 0;
 
-			for(std::size_t i=1; i<n; i++){
+			for(std::size_t i=begin+1; i<end; i++){
 				prev = i-1;
-				if(tables[attributeIndex][prev].value!=tables[attributeIndex][i].value){
-					n1=i;
+				RealVector const& label = labels[table[prev].id];
+				noalias(labelSumBelow) += label;
+				noalias(labelSumAbove) -= label;
+				sumOfSquaresBelow += norm_sqr(label);
+
+				if(table[prev].value!=table[i].value){
+					n1 = i-begin;
 					n2 = n-n1;
 					//Calculate the squared error of the split
-					impurity = (n1*totalSumOfSquares(tmpLabels,0,n1,labelSumAbove)+n2*totalSumOfSquares(tmpLabels,n1,n2,labelSumBelow))/(double)(n);
+					impurity = (
+						n1*totalSumOfSquares(sumOfSquaresBelow,labelSumBelow,n1)
+						+n2*totalSumOfSquares(labelSumOfSquares-sumOfSquaresBelow,labelSumAbove,n2)
+					)/(double)(n);
 
 					if(impurity<bestImpurity || bestImpurity<0){
 						//Found a more pure split, store the attribute index and value
@@ -366,39 +399,25 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 						bestImpurity = impurity;
 						bestAttributeIndex = attributeIndex;
 						bestAttributeValIndex = prev;
-						bestAttributeVal = tables[attributeIndex][bestAttributeValIndex].value;
-						bestLabels = tmpLabels;
+						bestAttributeVal = table[prev].value;
 					}
 				}
-
-				labelSumAbove += tmpLabels[i];
-				labelSumBelow -= tmpLabels[i];
 			}
 		}
 
 		if(doSplit){
 
 			//Split the attribute tables
-			AttributeTables rTables, lTables;
-			splitAttributeTables(tables, bestAttributeIndex, bestAttributeValIndex, lTables, rTables);
-
-			//Split the labels
-			std::vector<RealVector> lLabels, rLabels;
-			for(std::size_t i = 0; i <= bestAttributeValIndex; i++){
-				lLabels.push_back(bestLabels[i]);
-			}
-			for(std::size_t i = bestAttributeValIndex+1; i < bestLabels.size(); i++){
-				rLabels.push_back(bestLabels[i]);
-			}
+			std::size_t splitPoint = bestAttributeValIndex+1;
+			splitAttributeTables(tables, begin, end, bestAttributeIndex, splitPoint, buffer);
 
 			//Continue recursively
 			splitInfo.attributeIndex = bestAttributeIndex;
 			splitInfo.attributeValue = bestAttributeVal;
-			splitInfo.leftNodeId = 2*nodeId+1;
-			splitInfo.rightNodeId = 2*nodeId+2;
-
-			lSplitMatrix = buildTree(lTables, dataset, lLabels, splitInfo.leftNodeId, trainSize);
-			rSplitMatrix = buildTree(rTables, dataset, rLabels, splitInfo.rightNodeId, trainSize);
+			splitInfo.leftNodeId = nodeId+1;
+			lSplitMatrix = buildTree(tables, begin, splitPoint, labels, splitInfo.leftNodeId, trainSize, buffer);
+			splitInfo.rightNodeId = splitInfo.leftNodeId+lSplitMatrix.size();
+			rSplitMatrix = buildTree(tables, splitPoint, end, labels, splitInfo.rightNodeId, trainSize, buffer);
 		}
 	}
 
@@ -412,66 +431,44 @@ CARTTrainer::SplitMatrixType CARTTrainer::buildTree(AttributeTables const& table
 
 }
 
-
-
-
-/**
- * Returns the mean vector of a vector of real vectors
- */
-RealVector CARTTrainer::mean(std::vector<RealVector> const& labels){
-	RealVector avg(labels[0]);
-	for(std::size_t i = 1; i < labels.size(); i++){
-		avg += labels[i];
-	}
-	return avg/labels.size();
-}
-
 /**
- * Returns the Total Sum of Squares
+ * Returns the Total Sum of Squares of n labels,
+ * sum_i ||y_i||^2 - ||sum_i y_i||^2/n
  */
-double CARTTrainer::totalSumOfSquares(std::vector<RealVector> const& labels, std::size_t start, std::size_t length, const RealVector& sumLabel){
-	if (length < 1)
-		throw SHARKEXCEPTION("[CARTTrainer::totalSumOfSquares] length < 1");
-	if (start+length > labels.size())
-		throw SHARKEXCEPTION("[CARTTrainer::totalSumOfSquares] start+length > labels.size()");
+double CARTTrainer::totalSumOfSquares(double sumOfSquares, const RealVector& sumLabel, std::size_t n){
+	if (n < 1)
+		throw SHARKEXCEPTION("[CARTTrainer::totalSumOfSquares] n < 1");
 
-	RealVector labelAvg(sumLabel);
-	labelAvg /= length;
-
-	double sumOfSquares = 0;
-
-	for(std::size_t i = 0; i < length; i++){
-		sumOfSquares += norm_sqr(labels[start+i]-labelAvg);
-	}
-	return sumOfSquares;
+	//cancellation can make the result slightly negative
+	return std::max(sumOfSquares - norm_sqr(sumLabel)/n, 0.0);
 }
 
 /**
- * Returns two attribute tables: LAttrbuteTables and RAttrbuteTables
- * Calculated from splitting tables at (index, valIndex)
+ * Partitions the range [begin,end) of all tables in place.
+ * The left part is given by the entries [begin,splitPoint) of table index.
  */
-void CARTTrainer::splitAttributeTables(AttributeTables const& tables, std::size_t index, std::size_t valIndex, AttributeTables& LAttributeTables, AttributeTables& RAttributeTables){
-	AttributeTable table;
-
-	//Build a hash table for fast lookup
-	boost::unordered_map<std::size_t, bool> hash;
-	for(std::size_t i = 0; i< tables[index].size(); i++){
-		hash[tables[index][i].id] = i<=valIndex;
+void CARTTrainer::splitAttributeTables(AttributeTables& tables, std::size_t begin, std::size_t end, std::size_t index, std::size_t splitPoint, PartitionBuffer& buffer){
+	//Mark the elements moving to the left child
+	for(std::size_t i = begin; i != end; ++i){
+		buffer.goesLeft[tables[index][i].id] = i < splitPoint;
 	}
 
-	for(std::size_t i = 0; i < tables.size(); i++){
-		//For each attribute table
-		LAttributeTables.push_back(table);
-		RAttributeTables.push_back(table);
-		for(std::size_t j = 0; j < tables[i].size(); j++){
-			if(hash[tables[i][j].id]){
-				//Left
-				LAttributeTables[i].push_back(tables[i][j]);
+	for(std::size_t j = 0; j < tables.size(); j++){
+		//the table of the split attribute is already partitioned
+		if(j == index) continue;
+
+		//stable partition, the entries of the right child are moved to the buffer
+		AttributeTable& table = tables[j];
+		std::size_t left = begin;
+		std::size_t right = 0;
+		for(std::size_t i = begin; i != end; ++i){
+			if(buffer.goesLeft[table[i].id]){
+				table[left++] = table[i];
 			}else{
-				//Right
-				RAttributeTables[i].push_back(tables[i][j]);
+				buffer.entries[right++] = table[i];
 			}
 		}
+		std::copy(buffer.entries.begin(), buffer.entries.begin()+right, table.begin()+left);
 	}
 }
 
@@ -498,28 +495,29 @@ CARTTrainer::AttributeTables CARTTrainer::createAttributeTables(Data<RealVector>
 	std::size_t inputDimension = dataDimension(dataset);
 	//for each input dimension an attribute table is created and stored in tables
 	AttributeTables tables(inputDimension, AttributeTable(numElements));
-	//For each column
-	for(std::size_t j=0; j<inputDimension; j++){
-		//For each row
-		for(std::size_t i=0; i<numElements; i++){
-			//Store Attribute value, class and element id
-			tables[j][i].value = dataset.element(i)[j];
-			tables[j][i].id = i;
+	//For each row, batch by batch
+	std::size_t i = 0;
+	for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+		Data<RealVector>::const_batch_reference batch = dataset.batch(b);
+		for(std::size_t k = 0; k != batch.size1(); ++k, ++i){
+			//Store Attribute value and element id
+			for(std::size_t j=0; j<inputDimension; j++){
+				tables[j][i].value = batch(k,j);
+				tables[j][i].id = i;
+			}
 		}
+	}
+	//the tables are sorted once, splitting keeps them sorted
+	for(std::size_t j=0; j<inputDimension; j++){
 		std::sort(tables[j].begin(), tables[j].end());
 	}
 	return tables;
 }
 
-boost::unordered_map<std::size_t, std::size_t> CARTTrainer::createCountMatrix(ClassificationDataset const& dataset){
+boost::unordered_map<std::size_t, std::size_t> CARTTrainer::createCountMatrix(std::vector<unsigned int> const& labels){
 	boost::unordered_map<std::size_t, std::size_t> cAbove;
-	for(std::size_t i = 0 ; i < dataset.numberOfElements(); i++){
-		cAbove[dataset.element(i).label]++;
+	for(std::size_t i = 0 ; i < labels.size(); i++){
+		cAbove[labels[i]]++;
 	}
 	return cAbove;
 }
-
-
-
-
-
@@ -269,19 +269,16 @@ void CMA::step(ObjectiveFunctionType const& function){
 
 	std::vector< TypedIndividual<RealVector, RealVector> > offspring( m_lambda );
 
-	shark::soo::PenalizingEvaluator penalizingEvaluator;
 	for( unsigned int i = 0; i < offspring.size(); i++ ) {
 		MultiVariateNormalDistribution::ResultType sample = m_chromosome.m_mutationDistribution();
 		offspring[ i ].get<0>() = sample.second;
 		*offspring[i] = m_chromosome.m_mean + m_chromosome.m_sigma * sample.first;
-
-		boost::tuple< ObjectiveFunctionType::ResultType, ObjectiveFunctionType::ResultType > evalResult;
-		evalResult = penalizingEvaluator( function, *offspring[i] );
-
-		offspring[i].fitness( shark::tag::UnpenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::UNPENALIZED_RESULT >( evalResult );
-		offspring[i].fitness( shark::tag::PenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::PENALIZED_RESULT >( evalResult );
 	}
 
+	// the offspring are evaluated as a batch, concurrently if the function is thread-safe
+	shark::soo::PenalizingEvaluator penalizingEvaluator;
+	penalizingEvaluator( function, offspring.begin(), offspring.end() );
+
 	// Selection
 	std::vector< TypedIndividual<RealVector, RealVector> > parents( m_mu );
 	select_mu_komma_lambda_p( 
@@ -94,20 +94,17 @@ void CMSA::init( ObjectiveFunctionType const& function, SearchPointType const& p
 void CMSA::step(ObjectiveFunctionType const& function){
 	std::vector< CMSA::Individual > offspring( m_lambda );
 
-	shark::soo::PenalizingEvaluator penalizingEvaluator;
 	for( unsigned int i = 0; i < offspring.size(); i++ ) {		    
 		MultiVariateNormalDistribution::ResultType sample = m_chromosome.m_mutationDistribution();
 		offspring[i].get<0>().m_sigma = m_chromosome.m_sigma * ::exp( m_chromosome.m_cSigma * Rng::gauss( 0, 1 ) );
 		offspring[i].get<0>().m_step = sample.first;
 		*offspring[i] = m_chromosome.m_mean + offspring[i].get<0>().m_sigma * sample.first;
-		boost::tuple< ObjectiveFunctionType::ResultType, ObjectiveFunctionType::ResultType > evalResult;
-		evalResult = penalizingEvaluator( function, *offspring[i] );
-
-		offspring[i].fitness( shark::tag::UnpenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::UNPENALIZED_RESULT >( evalResult );
-		offspring[i].fitness( shark::tag::PenalizedFitness() )[0] = boost::get< shark::soo::PenalizingEvaluator::PENALIZED_RESULT >( evalResult );		    
-
 	}
 
+	// the offspring are evaluated as a batch, concurrently if the function is thread-safe
+	shark::soo::PenalizingEvaluator penalizingEvaluator;
+	penalizingEvaluator( function, offspring.begin(), offspring.end() );
+
 	// Selection
 	std::sort( offspring.begin(), offspring.end(), FitnessComparator() );
 	std::vector< CMSA::Individual > parentsNew( offspring.begin(), offspring.begin() + m_mu );
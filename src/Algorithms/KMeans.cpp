@@ -35,15 +35,247 @@
 
 
 #include <shark/Algorithms/KMeans.h>
-#include <shark/Models/Clustering/HardClusteringModel.h>
-#include <shark/Data/DataView.h>
+#include <shark/Core/OpenMP.h>
 
-#include <boost/range/algorithm/equal.hpp>
 #include <limits>
+#include <cmath>
+#include <algorithm>
 using namespace shark;
 
+namespace{
 
-std::size_t shark::kMeans(Data<RealVector> const& dataset, std::size_t k, Centroids& centroids, std::size_t maxIterations){
+/// Elkan's algorithm is chosen by KMeansAuto starting from this number of clusters
+std::size_t const minimumClustersForElkan = 20;
+/// Maximum memory for the lower bounds of Elkan's algorithm chosen by KMeansAuto
+std::size_t const maximumElkanBoundMemory = std::size_t(1) << 30;
+
+struct MembershipChange{
+	std::size_t element;//index of the element in its batch
+	unsigned int oldCluster;
+	unsigned int newCluster;
+};
+
+/// \brief Cluster assignments and distance bounds of all points.
+///
+/// For every point, m_upper holds an upper bound of the distance to its centroid.
+/// Hamerly's algorithm stores a lower bound of the distance to the second closest centroid,
+/// Elkan's algorithm stores a lower bound of the distance to every centroid.
+/// A point keeps its cluster as long as the upper bound is smaller than all lower bounds.
+/// The points are processed in parallel over the batches of the dataset.
+class KMeansAssignment{
+public:
+	KMeansAssignment(Data<RealVector> const& dataset, std::size_t k, KMeansAlgorithm algorithm)
+	: m_dataset(dataset), m_k(k), m_algorithm(algorithm), m_distanceComputations(0){
+		std::size_t numBatches = dataset.numberOfBatches();
+		m_batchStart.resize(numBatches+1,0);
+		for(std::size_t b = 0; b != numBatches; ++b)
+			m_batchStart[b+1] = m_batchStart[b] + dataset.batch(b).size1();
+		std::size_t ell = m_batchStart.back();
+		m_cluster.resize(ell);
+		m_upper.resize(ell);
+		if(algorithm == KMeansHamerly)
+			m_lower.resize(ell);
+		else if(algorithm == KMeansElkan)
+			m_lower.resize(ell*k);
+		m_changes.resize(numBatches);
+	}
+
+	unsigned int cluster(std::size_t batch, std::size_t i)const{
+		return m_cluster[m_batchStart[batch]+i];
+	}
+	std::size_t distanceComputations()const{
+		return m_distanceComputations;
+	}
+	/// changes of the clusters of the points of the batch in the last call of update
+	std::vector<MembershipChange> const& changes(std::size_t batch)const{
+		return m_changes[batch];
+	}
+
+	/// \brief Assigns all points to their closest centroid and initializes the bounds.
+	void initialize(RealMatrix const& centers){
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)m_dataset.numberOfBatches(); ++b){
+			RealMatrix const& batch = m_dataset.batch(b);
+			RealMatrix distances = sqrt(distanceSqr(batch,centers));
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				std::size_t p = m_batchStart[b]+i;
+				std::size_t best = 0;
+				double second = std::numeric_limits<double>::max();
+				for(std::size_t j = 1; j != m_k; ++j){
+					if(distances(i,j) < distances(i,best)){
+						second = distances(i,best);
+						best = j;
+					}else
+						second = std::min(second,distances(i,j));
+				}
+				m_cluster[p] = (unsigned int)best;
+				m_upper[p] = distances(i,best);
+				if(m_algorithm == KMeansHamerly)
+					m_lower[p] = second;
+			}
+			if(m_algorithm == KMeansElkan){
+				for(std::size_t i = 0; i != batch.size1(); ++i){
+					for(std::size_t j = 0; j != m_k; ++j)
+						m_lower[(m_batchStart[b]+i)*m_k+j] = distances(i,j);
+				}
+			}
+		}
+		m_distanceComputations += m_cluster.size()*m_k;
+	}
+
+	/// \brief Updates the bounds after the centroids moved and reassigns the points.
+	///
+	/// \param centers  new centroids
+	/// \param drift    distances between the old and the new centroids
+	/// \return         number of points that changed their cluster
+	std::size_t update(RealMatrix const& centers, RealVector const& drift){
+		std::size_t numBatches = m_dataset.numberOfBatches();
+		computeCenterDistances(centers);
+		//the lower bound of Hamerly's algorithm decreases by the largest drift of the other centroids
+		std::size_t maxDriftCluster = arg_max(drift);
+		double maxDrift = drift(maxDriftCluster);
+		double secondMaxDrift = 0;
+		for(std::size_t j = 0; j != m_k; ++j){
+			if(j != maxDriftCluster)
+				secondMaxDrift = std::max(secondMaxDrift, drift(j));
+		}
+
+		std::vector<std::size_t> distanceComputations(numBatches,0);
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)numBatches; ++b){
+			RealMatrix const& batch = m_dataset.batch(b);
+			m_changes[b].clear();
+			//Lloyd's algorithm needs all distances, which are computed for the whole batch at once
+			RealMatrix distances;
+			if(m_algorithm == KMeansLloyd)
+				distances = distanceSqr(batch,centers);
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				std::size_t p = m_batchStart[b]+i;
+				unsigned int oldCluster = m_cluster[p];
+				m_upper[p] += drift(oldCluster);
+				if(m_algorithm == KMeansLloyd)
+					distanceComputations[b] += assignLloyd(distances,i,p);
+				else if(m_algorithm == KMeansHamerly){
+					m_lower[p] -= oldCluster == maxDriftCluster? secondMaxDrift : maxDrift;
+					distanceComputations[b] += assignHamerly(row(batch,i),centers,p);
+				}else{
+					for(std::size_t j = 0; j != m_k; ++j){
+						double& lower = m_lower[p*m_k+j];
+						lower = std::max(lower-drift(j), 0.0);
+					}
+					distanceComputations[b] += assignElkan(row(batch,i),centers,p);
+				}
+				if(m_cluster[p] != oldCluster){
+					MembershipChange change = {i, oldCluster, m_cluster[p]};
+					m_changes[b].push_back(change);
+				}
+			}
+		}
+		std::size_t numChanges = 0;
+		for(std::size_t b = 0; b != numBatches; ++b){
+			m_distanceComputations += distanceComputations[b];
+			numChanges += m_changes[b].size();
+		}
+		return numChanges;
+	}
+private:
+	typedef blas::matrix_row<RealMatrix const> ConstRow;
+
+	/// \brief Computes the distances between the centroids and half the distance of every centroid to its closest neighbour.
+	void computeCenterDistances(RealMatrix const& centers){
+		m_halfMinCenterDistance.resize(m_k);
+		if(m_algorithm == KMeansLloyd) return;
+		m_centerDistances = sqrt(distanceSqr(centers,centers));
+		for(std::size_t j = 0; j != m_k; ++j){
+			double minDistance = std::numeric_limits<double>::max();
+			for(std::size_t l = 0; l != m_k; ++l){
+				if(l != j)
+					minDistance = std::min(minDistance,m_centerDistances(j,l));
+			}
+			m_halfMinCenterDistance(j) = 0.5*minDistance;
+		}
+	}
+
+	/// \brief Assigns the point to the closest centroid given the squared distances of the batch to all centroids.
+	std::size_t assignLloyd(RealMatrix const& distances, std::size_t i, std::size_t p){
+		std::size_t best = arg_min(row(distances,i));
+		m_cluster[p] = (unsigned int)best;
+		m_upper[p] = std::sqrt(distances(i,best));
+		return m_k;
+	}
+
+	std::size_t assignHamerly(ConstRow const& point, RealMatrix const& centers, std::size_t p){
+		unsigned int a = m_cluster[p];
+		double bound = std::max(m_halfMinCenterDistance(a), m_lower[p]);
+		if(m_upper[p] <= bound) return 0;
+		//tighten the upper bound and test again
+		m_upper[p] = blas::distance(point,row(centers,a));
+		if(m_upper[p] <= bound) return 1;
+
+		std::size_t best = a;
+		double bestDistance = m_upper[p];
+		double second = std::numeric_limits<double>::max();
+		for(std::size_t j = 0; j != m_k; ++j){
+			if(j == a) continue;
+			double d = blas::distance(point,row(centers,j));
+			if(d < bestDistance){
+				second = bestDistance;
+				bestDistance = d;
+				best = j;
+			}else
+				second = std::min(second,d);
+		}
+		m_cluster[p] = (unsigned int)best;
+		m_upper[p] = bestDistance;
+		m_lower[p] = second;
+		return m_k;
+	}
+
+	std::size_t assignElkan(ConstRow const& point, RealMatrix const& centers, std::size_t p){
+		unsigned int a = m_cluster[p];
+		if(m_upper[p] <= m_halfMinCenterDistance(a)) return 0;
+		double* lower = &m_lower[p*m_k];
+		std::size_t computations = 0;
+		bool tight = false;
+		for(std::size_t j = 0; j != m_k; ++j){
+			if(j == a || m_upper[p] <= lower[j] || m_upper[p] <= 0.5*m_centerDistances(a,j))
+				continue;
+			if(!tight){
+				m_upper[p] = lower[a] = blas::distance(point,row(centers,a));
+				tight = true;
+				++computations;
+				if(m_upper[p] <= lower[j] || m_upper[p] <= 0.5*m_centerDistances(a,j))
+					continue;
+			}
+			double d = lower[j] = blas::distance(point,row(centers,j));
+			++computations;
+			if(d < m_upper[p]){
+				a = (unsigned int)j;
+				m_upper[p] = d;
+			}
+		}
+		m_cluster[p] = a;
+		return computations;
+	}
+
+	Data<RealVector> const& m_dataset;
+	std::size_t m_k;
+	KMeansAlgorithm m_algorithm;
+	std::size_t m_distanceComputations;
+
+	std::vector<std::size_t> m_batchStart;
+	std::vector<unsigned int> m_cluster;
+	std::vector<double> m_upper;
+	std::vector<double> m_lower;
+	std::vector<std::vector<MembershipChange> > m_changes;
+
+	RealMatrix m_centerDistances;
+	RealVector m_halfMinCenterDistance;
+};
+}
+
+std::size_t shark::kMeans(
+	Data<RealVector> const& dataset, std::size_t k, Centroids& centroids, std::size_t maxIterations,
+	KMeansAlgorithm algorithm, KMeansStatistics* statistics
+){
 	SIZE_CHECK(k <= dataset.numberOfElements());
 	if(!maxIterations)
 		maxIterations = std::numeric_limits<std::size_t>::max();
@@ -51,48 +283,78 @@ std::size_t shark::kMeans(Data<RealVector> const& dataset, std::size_t k, Centro
 	// initialization
 	std::size_t ell = dataset.numberOfElements();
 	std::size_t dimension = dataDimension(dataset);
+	if(algorithm == KMeansAuto){
+		bool useElkan = k >= minimumClustersForElkan && ell <= maximumElkanBoundMemory/(k*sizeof(double));
+		algorithm = useElkan? KMeansElkan : KMeansHamerly;
+	}
 	
 	//if the centers are not already initialized, do it now
 	if (centroids.numberOfClusters() != k){
 		centroids.initFromData(dataset,k);
 	}
-	HardClusteringModel<RealVector> model(&centroids);
-	ClassificationDataset clusterMembership(dataset,model(dataset));
-	typedef ClassificationDataset::const_element_reference ConstReference;
+	RealMatrix centers(k,dimension);
+	for(std::size_t j = 0; j != k; ++j)
+		noalias(row(centers,j)) = centroids.centroids().element(j);
+
+	KMeansAssignment assignment(dataset,k,algorithm);
+	assignment.initialize(centers);
+
+	//the sums of the points in every cluster are updated with the changes of the assignments
+	RealMatrix clusterSums(k,dimension,0.0);
+	std::vector<std::size_t> numPoints(k,0);
+	for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+		RealMatrix const& batch = dataset.batch(b);
+		for(std::size_t i = 0; i != batch.size1(); ++i){
+			unsigned int j = assignment.cluster(b,i);
+			noalias(row(clusterSums,j)) += row(batch,i);
+			++numPoints[j];
+		}
+	}
 
 	// k-means loop
 	std::size_t iter = 0;
 	bool equal = false;
+	RealMatrix newCenters(k,dimension);
+	RealVector drift(k);
 	for(; iter != maxIterations && !equal; ++iter) {
 		// compute new centers
-		std::vector<std::size_t> numPoints(k,0); // number of points in each cluster
-		std::vector<RealVector> newCenters(k,RealVector(dimension,0.0));
-			
-		BOOST_FOREACH(ConstReference element,clusterMembership.elements()){
-			std::size_t j = element.label;
-			noalias(newCenters[j]) += element.input;
-			numPoints[j]++;
-		}
 		for (std::size_t j=0; j<k; j++) {
 			if (numPoints[j] == 0) {
 				// empty cluster - assign random training point
 				std::size_t index = Rng::discrete(0, ell-1);
-				newCenters[j] = dataset.element(index);
+				noalias(row(newCenters,j)) = dataset.element(index);
 			}
 			else {
-				newCenters[j] /= (double)numPoints[j];
+				noalias(row(newCenters,j)) = row(clusterSums,j) / (double)numPoints[j];
 			}
+			drift(j) = blas::distance(row(newCenters,j),row(centers,j));
 		}
-		centroids.setCentroids(createDataFromRange(newCenters));
+		swap(centers,newCenters);
 		
-		//compute new cluster memberships and check whether they are 
-		// equal to the old one, in that case we stop after this iteration
-		Data<unsigned int> newClusterMembership = model(dataset);
-		equal = boost::equal(
-			newClusterMembership.elements(),
-			clusterMembership.labels().elements()
-		);
-		clusterMembership.labels() = newClusterMembership;
+		//compute new cluster memberships, if no point changed its cluster
+		//we stop after this iteration
+		equal = assignment.update(centers,drift) == 0;
+		for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b){
+			RealMatrix const& batch = dataset.batch(b);
+			std::vector<MembershipChange> const& changes = assignment.changes(b);
+			for(std::size_t c = 0; c != changes.size(); ++c){
+				noalias(row(clusterSums,changes[c].oldCluster)) -= row(batch,changes[c].element);
+				noalias(row(clusterSums,changes[c].newCluster)) += row(batch,changes[c].element);
+				--numPoints[changes[c].oldCluster];
+				++numPoints[changes[c].newCluster];
+			}
+		}
+	}
+	
+	std::vector<RealVector> finalCenters(k);
+	for(std::size_t j = 0; j != k; ++j)
+		finalCenters[j] = row(centers,j);
+	centroids.setCentroids(createDataFromRange(finalCenters));
+
+	if(statistics){
+		statistics->iterations = iter;
+		statistics->distanceComputations = assignment.distanceComputations();
+		statistics->lloydDistanceComputations = (iter+1)*ell*k;
 	}
 
 	// return the number of iterations
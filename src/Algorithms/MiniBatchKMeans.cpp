@@ -0,0 +1,102 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Mini-batch k-means for large and streamed datasets
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#include <shark/Algorithms/Trainers/MiniBatchKMeans.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Rng/GlobalRng.h>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+
+using namespace shark;
+
+namespace{
+/// number of points which are assigned to the centroids by one thread
+std::size_t const assignmentBlockSize = 256;
+}
+
+void MiniBatchKMeans::train(Centroids& model, UnlabeledData<RealVector> const& inputs){
+	std::size_t k = m_numberOfClusters? m_numberOfClusters : model.numberOfClusters();
+	SHARK_CHECK(k > 0, "[MiniBatchKMeans::train] number of clusters must be positive");
+	SIZE_CHECK(k <= inputs.numberOfElements());
+	if(model.numberOfClusters() != k)
+		model.initFromData(inputs,(unsigned int)k);
+	resetCounts();
+
+	std::vector<std::size_t> order(inputs.numberOfBatches());
+	for(std::size_t b = 0; b != order.size(); ++b)
+		order[b] = b;
+	DiscreteUniform<Rng::rng_type> uni(Rng::globalRng,0,order.size()-1);
+	for(std::size_t epoch = 0; epoch != m_epochs; ++epoch){
+		std::random_shuffle(order.begin(),order.end(),uni);
+		for(std::size_t b = 0; b != order.size(); ++b)
+			update(model, inputs.batch(order[b]));
+	}
+}
+
+void MiniBatchKMeans::update(Centroids& model, RealMatrix const& batch){
+	std::size_t k = model.numberOfClusters();
+	std::size_t dimension = model.dimension();
+	SHARK_CHECK(k > 0, "[MiniBatchKMeans::update] the centroids of the model must be initialized");
+	SIZE_CHECK(batch.size2() == dimension);
+	if(m_counts.size() != k)
+		m_counts.assign(k,0);
+
+	RealVector parameters = model.parameterVector();
+	RealMatrix centers(k,dimension);
+	for(std::size_t j = 0; j != k; ++j)
+		noalias(row(centers,j)) = subrange(parameters,j*dimension,(j+1)*dimension);
+
+	//assign the points of the batch to the current centroids
+	std::size_t size = batch.size1();
+	std::size_t numBlocks = (size+assignmentBlockSize-1)/assignmentBlockSize;
+	std::vector<std::size_t> assignment(size);
+	SHARK_PARALLEL_FOR(int block = 0; block < (int)numBlocks; ++block){
+		std::size_t start = block*assignmentBlockSize;
+		std::size_t end = std::min(start+assignmentBlockSize,size);
+		RealMatrix distances = distanceSqr(subrange(batch,start,end,0,dimension),centers);
+		for(std::size_t i = start; i != end; ++i)
+			assignment[i] = arg_min(row(distances,i-start));
+	}
+
+	//move the centroids towards their points with the per-centroid learning rate
+	for(std::size_t i = 0; i != size; ++i){
+		std::size_t j = assignment[i];
+		++m_counts[j];
+		double learningRate = 1.0/m_counts[j];
+		noalias(row(centers,j)) += learningRate*(row(batch,i)-row(centers,j));
+	}
+
+	for(std::size_t j = 0; j != k; ++j)
+		noalias(subrange(parameters,j*dimension,(j+1)*dimension)) = row(centers,j);
+	model.setParameterVector(parameters);
+}
+
+void MiniBatchKMeans::read(InArchive& archive){
+	archive & m_numberOfClusters;
+	archive & m_epochs;
+	archive & m_counts;
+}
+
+void MiniBatchKMeans::write(OutArchive& archive) const{
+	archive & m_numberOfClusters;
+	archive & m_epochs;
+	archive & m_counts;
+}
@@ -24,9 +24,12 @@
 
 #include <shark/Algorithms/Trainers/RFTrainer.h>
 #include <shark/Models/Trees/RFClassifier.h>
+#include <shark/Algorithms/Trainers/Impl/BinnedTreeBuilder.h>
+#include <shark/Algorithms/Trainers/Impl/SortedTreeBuilder.h>
+#include <shark/Core/OpenMP.h>
 #include <boost/range/algorithm_ext/iota.hpp>
-#include <boost/range/algorithm/random_shuffle.hpp>
-#include <shark/Data/DataView.h>
+#include <boost/range/algorithm/copy.hpp>
+#include <algorithm>
 #include <set>
 #include <iostream>
 
@@ -40,6 +43,9 @@ RFTrainer::RFTrainer(){
 	m_B = 0;
 	m_nodeSize = 0;
 	m_OOBratio = 0;
+	m_histogramBins = 0;
+	m_computeFeatureImportances = false;
+	m_sampleWithReplacement = false;
 	m_regressionLearner = false;
 }
 
@@ -70,6 +76,135 @@ void RFTrainer::setDefaults(){
 	}
 }
 
+namespace{
+///loss of a single out-of-bag prediction in the classification case
+double oobLoss(RealVector const& prediction, unsigned int label){
+	return arg_max(prediction) != label ? 1.0 : 0.0;
+}
+///loss of a single out-of-bag prediction in the regression case
+double oobLoss(RealVector const& prediction, RealVector const& label){
+	return norm_sqr(prediction - label);
+}
+
+///mean loss of the predictions of the elements with the given indices
+template<class Label>
+double meanOOBLoss(RealMatrix const& predictions, std::vector<Label> const& labels, std::vector<std::size_t> const& indices){
+	double error = 0;
+	for(std::size_t i = 0; i != indices.size(); ++i){
+		error += oobLoss(RealVector(row(predictions,i)), labels[indices[i]]);
+	}
+	return error/indices.size();
+}
+}
+
+void RFTrainer::createElementPositions(Data<RealVector> const& inputs, ElementPositions& positions){
+	positions.clear();
+	positions.reserve(inputs.numberOfElements());
+	for(std::size_t b = 0; b != inputs.numberOfBatches(); ++b){
+		for(std::size_t k = 0; k != shark::size(inputs.batch(b)); ++k){
+			positions.push_back(std::make_pair(b,k));
+		}
+	}
+}
+
+void RFTrainer::initOOBStatistics(OOBStatistics& statistics, std::size_t numElements, std::size_t labelDimension)const{
+	statistics.predictions = RealMatrix(numElements, labelDimension, 0.0);
+	statistics.hits.assign(numElements, 0);
+	statistics.importances = RealVector(m_inputDimension, 0.0);
+	statistics.pending.assign(m_B, TreeOOBResults());
+	statistics.finished.assign(m_B, 0);
+	statistics.nextTree = 0;
+}
+
+template<class Label>
+void RFTrainer::computeOOBResults(
+	RFClassifier::SplitMatrixType const& tree,
+	Data<RealVector> const& inputs, ElementPositions const& positions, std::vector<Label> const& labels,
+	std::vector<std::size_t> const& subsetIndices, Rng::rng_type& rng, TreeOOBResults& results
+)const{
+	//the elements not used for growing the tree are out of bag
+	std::vector<char> inBag(labels.size(), 0);
+	for(std::size_t i = 0; i != subsetIndices.size(); ++i){
+		inBag[subsetIndices[i]] = 1;
+	}
+	std::vector<std::size_t>& oobIndices = results.indices;
+	oobIndices.clear();
+	for(std::size_t i = 0; i != labels.size(); ++i){
+		if(!inBag[i]) oobIndices.push_back(i);
+	}
+	std::size_t numOOB = oobIndices.size();
+	if(numOOB == 0) return;
+
+	RealMatrix oobInputs(numOOB, m_inputDimension);
+	for(std::size_t i = 0; i != numOOB; ++i){
+		std::pair<std::size_t, std::size_t> const& pos = positions[oobIndices[i]];
+		noalias(row(oobInputs,i)) = row(inputs.batch(pos.first), pos.second);
+	}
+	CARTClassifier<RealVector> cart(tree);
+	results.predictions = cart(oobInputs);
+	RealMatrix const& predictions = results.predictions;
+
+	//permute every attribute the tree uses among the oob elements and measure the increase of the error.
+	//Attributes not used by the tree do not change its predictions and have importance 0.
+	if(m_computeFeatureImportances){
+		RealVector& importances = results.importances;
+		importances = RealVector(m_inputDimension, 0.0);
+		std::set<std::size_t> attributes;
+		for(std::size_t i = 0; i != tree.size(); ++i){
+			if(tree[i].leftNodeId != 0) attributes.insert(tree[i].attributeIndex);
+		}
+		double error = meanOOBLoss(predictions, labels, oobIndices);
+		RealVector original(numOOB);
+		std::vector<std::size_t> permutation(numOOB);
+		DiscreteUniform<Rng::rng_type> uni(rng, 0, 1);
+		for(std::set<std::size_t>::const_iterator it = attributes.begin(); it != attributes.end(); ++it){
+			std::size_t j = *it;
+			noalias(original) = column(oobInputs,j);
+			boost::iota(permutation,0);
+			std::random_shuffle(permutation.begin(), permutation.end(), uni);
+			for(std::size_t i = 0; i != numOOB; ++i){
+				oobInputs(i,j) = original(permutation[i]);
+			}
+			importances(j) = meanOOBLoss(cart(oobInputs), labels, oobIndices) - error;
+			noalias(column(oobInputs,j)) = original;
+		}
+	}
+}
+
+void RFTrainer::addOOBResults(std::size_t t, TreeOOBResults& results, OOBStatistics& statistics)const{
+	SHARK_CRITICAL_REGION{
+		swap(statistics.pending[t].indices, results.indices);
+		swap(statistics.pending[t].predictions, results.predictions);
+		swap(statistics.pending[t].importances, results.importances);
+		statistics.finished[t] = 1;
+		//floating point sums depend on the order, so the trees are added in the order of their index
+		for(; statistics.nextTree != m_B && statistics.finished[statistics.nextTree]; ++statistics.nextTree){
+			TreeOOBResults& next = statistics.pending[statistics.nextTree];
+			for(std::size_t i = 0; i != next.indices.size(); ++i){
+				noalias(row(statistics.predictions, next.indices[i])) += row(next.predictions,i);
+				++statistics.hits[next.indices[i]];
+			}
+			if(!next.importances.empty())
+				noalias(statistics.importances) += next.importances;
+			next = TreeOOBResults();
+		}
+	}
+}
+
+template<class Label>
+void RFTrainer::setOOBResults(RFClassifier& model, OOBStatistics const& statistics, std::vector<Label> const& labels)const{
+	double error = 0;
+	std::size_t numPredicted = 0;
+	for(std::size_t i = 0; i != labels.size(); ++i){
+		if(!statistics.hits[i]) continue;
+		RealVector prediction = row(statistics.predictions,i) / double(statistics.hits[i]);
+		error += oobLoss(prediction, labels[i]);
+		++numPredicted;
+	}
+	model.setOOBerror(numPredicted? error/numPredicted : 0.0);
+	model.setFeatureImportances(statistics.importances / double(m_B));
+}
+
 void RFTrainer::train(RFClassifier& model, const RegressionDataset& dataset)
 {
 	//TODO O.K.: i am just fixing these things for now so that they are working.
@@ -84,38 +219,61 @@ void RFTrainer::train(RFClassifier& model, const RegressionDataset& dataset)
 	m_regressionLearner = true;
 	setDefaults();
 	
-	
-	//we need direct element access sicne we need to generate elementwise subsets
-	std::size_t subsetSize = dataset.numberOfElements()*m_OOBratio;
-	DataView<RegressionDataset const> elements(dataset);
-
+	//we need direct element access to the labels
+	std::size_t numElements = dataset.numberOfElements();
+	std::vector<RealVector> labels(numElements);
+	boost::copy(dataset.labels().elements(),labels.begin());
+
+	//the attributes are sorted or quantized only once and shared by all trees
+	detail::SortedAttributes sortedAttributes;
+	detail::BinnedAttributes binnedAttributes;
+	if(m_histogramBins)
+		binnedAttributes.create(dataset.inputs(), m_histogramBins);
+	else
+		sortedAttributes.create(dataset.inputs());
+
+	//every tree gets its own random number generator, so the result does not depend on the number of threads
+	std::vector<Rng::rng_type::result_type> seeds = generateTreeSeeds();
+	std::vector<RFClassifier::SplitMatrixType> forest(m_B);
+
+	//the out-of-bag predictions are collected while the trees are grown
+	ElementPositions positions;
+	createElementPositions(dataset.inputs(), positions);
+	OOBStatistics oobStatistics;
+	initOOBStatistics(oobStatistics, numElements, m_labelDimension);
 
 	//Generate m_B trees
-	while(m_B){
+	SHARK_PARALLEL_FOR_DYNAMIC(int t = 0; t < (int)m_B; ++t){
+		Rng::rng_type rng(seeds[t]);
 		//For each tree generate a subset of the dataset
 		//generate indices of the dataset (pick k out of n elements)
-		std::vector<std::size_t> subsetIndices(elements.size());
-		boost::iota(subsetIndices,0);
-		boost::random_shuffle(subsetIndices);
-		subsetIndices.erase(subsetIndices.begin()+subsetSize,subsetIndices.end());
-		//generate the dataset by copying (TODO: this is a quick fix!
-		RegressionDataset dataTrain = toDataset(subset(elements,subsetIndices));
-		
-		std::size_t elements = dataTrain.numberOfElements();
-
-		RealVector cAbove;
-		AttributeTables tables;
-		createAttributeTables(dataTrain.inputs(), tables);
-
-		std::vector < RealVector > labels;
-		for(std::size_t i=0; i<elements; i++){
-			labels.push_back(dataTrain.element(i).label);
+		std::vector<std::size_t> subsetIndices;
+		std::vector<unsigned int> multiplicities;
+		generateSubsetIndices(subsetIndices, multiplicities, numElements, rng);
+
+		if(m_histogramBins){
+			detail::BinnedTreeBuilder builder(binnedAttributes, labels);
+			builder.setNodeSize(m_nodeSize);
+			builder.setMTry(m_try);
+			builder.setMultiplicities(multiplicities);
+			forest[t] = builder.buildTree(subsetIndices, rng);
+		}else{
+			detail::SortedTreeBuilder builder(sortedAttributes, labels);
+			builder.setNodeSize(m_nodeSize);
+			builder.setMTry(m_try);
+			builder.setMultiplicities(multiplicities);
+			forest[t] = builder.buildTree(subsetIndices, rng);
 		}
-
-		RFClassifier::SplitMatrixType splitMatrix = buildTree(tables, dataTrain, labels, 0);
-		model.addTree(splitMatrix);
-		m_B--;
+		TreeOOBResults oobResults;
+		computeOOBResults(forest[t], dataset.inputs(), positions, labels, subsetIndices, rng, oobResults);
+		addOOBResults(t, oobResults, oobStatistics);
+	}
+	
+	//add the trees in order of their index, so that the model is reproducible
+	for(std::size_t t = 0; t != forest.size(); ++t){
+		model.addTree(forest[t]);
 	}
+	setOOBResults(model, oobStatistics, labels);
 }
 
 
@@ -132,30 +290,61 @@ void RFTrainer::train(RFClassifier& model, const ClassificationDataset& dataset)
 
 	setDefaults();
 
-	//we need direct element access since we need to generate elementwise subsets
-	std::size_t subsetSize = dataset.numberOfElements()*m_OOBratio;
-	DataView<ClassificationDataset const> elements(dataset);
+	//we need direct element access to the labels
+	std::size_t numElements = dataset.numberOfElements();
+	std::vector<unsigned int> labels(numElements);
+	boost::copy(dataset.labels().elements(),labels.begin());
+
+	//the attributes are sorted or quantized only once and shared by all trees
+	detail::SortedAttributes sortedAttributes;
+	detail::BinnedAttributes binnedAttributes;
+	if(m_histogramBins)
+		binnedAttributes.create(dataset.inputs(), m_histogramBins);
+	else
+		sortedAttributes.create(dataset.inputs());
+
+	//every tree gets its own random number generator, so the result does not depend on the number of threads
+	std::vector<Rng::rng_type::result_type> seeds = generateTreeSeeds();
+	std::vector<RFClassifier::SplitMatrixType> forest(m_B);
+
+	//the out-of-bag predictions are collected while the trees are grown
+	ElementPositions positions;
+	createElementPositions(dataset.inputs(), positions);
+	OOBStatistics oobStatistics;
+	initOOBStatistics(oobStatistics, numElements, m_maxLabel+1);
 
 	//Generate m_B trees
-	while(m_B){
+	SHARK_PARALLEL_FOR_DYNAMIC(int t = 0; t < (int)m_B; ++t){
+		Rng::rng_type rng(seeds[t]);
 		//For each tree generate a subset of the dataset
 		//generate indices of the dataset (pick k out of n elements)
-		std::vector<std::size_t> subsetIndices(dataset.numberOfElements());
-		boost::iota(subsetIndices,0);
-		boost::random_shuffle(subsetIndices);
-		subsetIndices.erase(subsetIndices.begin()+subsetSize,subsetIndices.end());
-		//generate the dataset by copying (TODO: this is a quick fix!
-		ClassificationDataset dataTrain = toDataset(subset(elements,subsetIndices));
-		//Create attribute tables
-		boost::unordered_map<std::size_t, std::size_t> cAbove;
-		AttributeTables tables;
-		createAttributeTables(dataTrain.inputs(), tables);
-		createCountMatrix(dataTrain, cAbove);
-
-		RFClassifier::SplitMatrixType splitMatrix = buildTree(tables, dataTrain, cAbove, 0);
-		model.addTree(splitMatrix);
-		m_B--;
+		std::vector<std::size_t> subsetIndices;
+		std::vector<unsigned int> multiplicities;
+		generateSubsetIndices(subsetIndices, multiplicities, numElements, rng);
+
+		if(m_histogramBins){
+			detail::BinnedTreeBuilder builder(binnedAttributes, labels, m_maxLabel+1);
+			builder.setNodeSize(m_nodeSize);
+			builder.setMTry(m_try);
+			builder.setMultiplicities(multiplicities);
+			forest[t] = builder.buildTree(subsetIndices, rng);
+		}else{
+			detail::SortedTreeBuilder builder(sortedAttributes, labels, m_maxLabel+1);
+			builder.setNodeSize(m_nodeSize);
+			builder.setMTry(m_try);
+			builder.setMultiplicities(multiplicities);
+			forest[t] = builder.buildTree(subsetIndices, rng);
+		}
+		TreeOOBResults oobResults;
+		computeOOBResults(forest[t], dataset.inputs(), positions, labels, subsetIndices, rng, oobResults);
+		addOOBResults(t, oobResults, oobStatistics);
+	}
+
+	//add the trees in order of their index, so that the model is reproducible
+	for(std::size_t t = 0; t != forest.size(); ++t){
+		model.addTree(forest[t]);
 	}
+	setOOBResults(model, oobStatistics, labels);
 }
 
 void RFTrainer::setMTry(std::size_t mtry){
@@ -174,385 +363,50 @@ void RFTrainer::setOOBratio(double ratio){
 	m_OOBratio = ratio;
 }
 
-
-
-RFClassifier::SplitMatrixType RFTrainer::buildTree(const AttributeTables& tables, const ClassificationDataset& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove, std::size_t nodeId ){
-
-	RFClassifier::SplitMatrixType lSplitMatrix, rSplitMatrix;
-
-	//Construct split matrix
-	RFClassifier::SplitInfo splitInfo;
-
-	splitInfo.nodeId = nodeId;
-	splitInfo.leftNodeId = 0;
-	splitInfo.rightNodeId = 0;
-
-	//n = Total number of cases in the dataset
-	//n1 = Number of cases to the left child node
-	//n2 = number of cases to the right child node
-	unsigned int n, n1, n2;
-
-	n = tables[0].size();
-
-	bool isLeaf = false;
-	if(gini(cAbove,tables[0].size())==0 || n <= m_nodeSize){
-		isLeaf = true;
-	}else{
-		//Count matrices
-		boost::unordered_map<std::size_t, std::size_t> cBelow, cBestBelow, cTmpAbove, cBestAbove;
-
-		//Randomly select the attributes to test for split
-		set<std::size_t> tableIndicies;
-		generateRandomTableIndicies(tableIndicies);
-
-		//Iterate over the chosen attributes
-		set<std::size_t>::iterator it;
-
-		//Index of attributes
-		std::size_t attributeIndex, bestAttributeIndex, bestAttributeValIndex;
-
-		//Attribute values
-		double bestAttributeVal;
-		double impurity, bestImpurity = n+1;
-
-		std::size_t prev;
-
-		for ( it=tableIndicies.begin() ; it != tableIndicies.end(); it++ ){
-			attributeIndex = *it;
-			cTmpAbove = cAbove;
-			cBelow.clear();
-			for(std::size_t i=1; i<n; i++){
-				prev = i-1;
-
-				//Update the count of the label
-				cBelow[dataset.element(tables[attributeIndex][prev][1]).label]++;
-				cTmpAbove[dataset.element(tables[attributeIndex][prev][1]).label]--;
-
-				if(tables[attributeIndex][prev][0]!=tables[attributeIndex][i][0]){
-					//n1 = Number of cases to the left child node
-					//n2 = number of cases to the right child node
-					n1 = i;
-					n2 = n-n1;
-
-					//Calculate the Gini impurity of the split
-					impurity = n1*gini(cBelow,n1)+n2*gini(cTmpAbove,n2);
-					if(impurity<bestImpurity){
-						//Found a more pure split, store the attribute index and value
-						bestImpurity = impurity;
-						bestAttributeIndex = attributeIndex;
-						bestAttributeValIndex = prev;
-						bestAttributeVal = tables[attributeIndex][bestAttributeValIndex][0];
-						cBestAbove = cTmpAbove;
-						cBestBelow = cBelow;
-					}
-				}
-			}
-		}
-
-		if(bestImpurity<n+1){
-			AttributeTables rTables, lTables;
-			splitAttributeTables(tables, bestAttributeIndex, bestAttributeValIndex, lTables, rTables);
-			//Continue recursively
-
-			splitInfo.attributeIndex = bestAttributeIndex;
-			splitInfo.attributeValue = bestAttributeVal;
-			splitInfo.leftNodeId = 2*nodeId+1;
-			splitInfo.rightNodeId = 2*nodeId+2;
-
-			lSplitMatrix = buildTree(lTables, dataset, cBestBelow, splitInfo.leftNodeId);
-			rSplitMatrix = buildTree(rTables, dataset, cBestAbove, splitInfo.rightNodeId);
-		}else{
-			//Leaf node
-			isLeaf = true;
-		}
-
-	}
-
-	//Store entry in the splitMatrix table
-	RFClassifier::SplitMatrixType splitMatrix;
-
-	if(isLeaf){
-		splitInfo.label = hist(cAbove);
-		splitMatrix.push_back(splitInfo);
-		return splitMatrix;
-	}
-
-	splitMatrix.push_back(splitInfo);
-	splitMatrix.insert(splitMatrix.end(), lSplitMatrix.begin(), lSplitMatrix.end());
-	splitMatrix.insert(splitMatrix.end(), rSplitMatrix.begin(), rSplitMatrix.end());
-
-	return splitMatrix;
+void RFTrainer::setSampleWithReplacement(bool replace){
+	m_sampleWithReplacement = replace;
 }
 
-RealVector RFTrainer::hist(boost::unordered_map<std::size_t, std::size_t> countMatrix){
-
-	std::vector<unsigned int> histogram(m_maxLabel+1);
-
-	unsigned int totalElements = 0;
-
-	boost::unordered_map<std::size_t, std::size_t>::iterator it;
-	for ( it=countMatrix.begin() ; it != countMatrix.end(); it++ ){
-		histogram[it->first] = it->second;
-		totalElements += it->second;
-	}
-
-	RealVector normHist(histogram.size());
-	for(std::size_t n = 0; n < histogram.size(); n++){
-		normHist[n] = double(histogram[n]) / double(totalElements);
-	}
-
-	return normHist;
+void RFTrainer::setComputeFeatureImportances(bool compute){
+	m_computeFeatureImportances = compute;
 }
 
-RFClassifier::SplitMatrixType RFTrainer::buildTree(const AttributeTables& tables, const RegressionDataset& dataset, const std::vector<RealVector>& labels, std::size_t nodeId ){
-
-	//Construct split matrix
-	RFClassifier::SplitInfo splitInfo;
-
-
-	splitInfo.nodeId = nodeId;
-	splitInfo.leftNodeId = 0;
-	splitInfo.rightNodeId = 0;
-	splitInfo.label = average(labels);
-
-	RFClassifier::SplitMatrixType splitMatrix, lSplitMatrix, rSplitMatrix;
-
-	//n = Total number of cases in the dataset
-	//n1 = Number of cases to the left child node
-	//n2 = number of cases to the right child node
-	std::size_t n, n1, n2;
-
-	n = tables[0].size();
-	bool isLeaf = false;
-	if(n <= m_nodeSize){
-		isLeaf = true;
-	}else{
-
-		//label vectors
-		std::vector<RealVector> bestLabels, tmpLabels;
-		RealVector labelSumAbove(m_labelDimension), labelSumBelow(m_labelDimension);
-
-		//Randomly select the attributes to test for split
-		set<std::size_t> tableIndicies;
-		generateRandomTableIndicies(tableIndicies);
-
-		//Iterate over the chosen attributes
-		set<std::size_t>::iterator it;
-
-		//Index of attributes
-		std::size_t attributeIndex, bestAttributeIndex, bestAttributeValIndex;
-
-		//Attribute values
-		double bestAttributeVal;
-		double impurity, bestImpurity = -1;
-
-		std::size_t prev;
-		bool doSplit = false;
-		for ( it=tableIndicies.begin() ; it != tableIndicies.end(); it++ ){
-			attributeIndex = *it;
-
-			labelSumBelow.clear();
-			labelSumAbove.clear();
-			tmpLabels.clear();
-
-			//Create a labels table, that corresponds to the sorted attribute
-			for(std::size_t k=0; k<tables[attributeIndex].size(); k++){
-				tmpLabels.push_back(dataset.element(tables[attributeIndex][k][1]).label);
-				labelSumBelow += dataset.element(tables[attributeIndex][k][1]).label;
-			}
-			labelSumAbove += tmpLabels[0];
-			labelSumBelow -= tmpLabels[0];
-
-			for(std::size_t i=1; i<n; i++){
-				prev = i-1;
-				if(tables[attributeIndex][prev][0]!=tables[attributeIndex][i][0]){
-					n1=i;
-					n2 = n-n1;
-					//Calculate the squared error of the split
-					impurity = (n1*totalSumOfSquares(tmpLabels,0,n1,labelSumAbove)+n2*totalSumOfSquares(tmpLabels,n1,n2,labelSumBelow))/(double)(n);
-
-					if(impurity<bestImpurity || bestImpurity<0){
-						//Found a more pure split, store the attribute index and value
-						doSplit = true;
-						bestImpurity = impurity;
-						bestAttributeIndex = attributeIndex;
-						bestAttributeValIndex = prev;
-						bestAttributeVal = tables[attributeIndex][bestAttributeValIndex][0];
-						bestLabels = tmpLabels;
-					}
-				}
-
-				labelSumAbove += tmpLabels[i];
-				labelSumBelow -= tmpLabels[i];
-			}
-		}
-
-		if(doSplit){
-
-			//Split the attribute tables
-			AttributeTables rTables, lTables;
-			splitAttributeTables(tables, bestAttributeIndex, bestAttributeValIndex, lTables, rTables);
-
-			//Split the labels
-			std::vector<RealVector> lLabels, rLabels;
-			for(std::size_t i = 0; i <= bestAttributeValIndex; i++){
-				lLabels.push_back(bestLabels[i]);
-			}
-			for(std::size_t i = bestAttributeValIndex+1; i < bestLabels.size(); i++){
-				rLabels.push_back(bestLabels[i]);
-			}
-
-			//Continue recursively
-			splitInfo.attributeIndex = bestAttributeIndex;
-			splitInfo.attributeValue = bestAttributeVal;
-			splitInfo.leftNodeId = 2*nodeId+1;
-			splitInfo.rightNodeId = 2*nodeId+2;
-
-			lSplitMatrix = buildTree(lTables, dataset, lLabels, splitInfo.leftNodeId);
-			rSplitMatrix = buildTree(rTables, dataset, rLabels, splitInfo.rightNodeId);
-		}else{
-			//Leaf node
-			isLeaf = true;
-		}
-
-	}
-
-	if(isLeaf){
-		splitMatrix.push_back(splitInfo);
-		return splitMatrix;
-	}
-
-	splitMatrix.push_back(splitInfo);
-	splitMatrix.insert(splitMatrix.end(), lSplitMatrix.begin(), lSplitMatrix.end());
-	splitMatrix.insert(splitMatrix.end(), rSplitMatrix.begin(), rSplitMatrix.end());
-
-	//Store entry in the splitMatrix table
-	return splitMatrix;
-
+void RFTrainer::setHistogramBins(std::size_t bins){
+	SHARK_CHECK(bins == 0 || (bins >= 2 && bins <= 256), "[RFTrainer::setHistogramBins] the number of bins must be 0 or in [2,256]");
+	m_histogramBins = bins;
 }
 
-
-
-/**
- * Returns the average vector of a vector of real vectors
- */
-RealVector RFTrainer::average(const std::vector<RealVector>& labels){
-	RealVector avg(labels[0]);
-	for(std::size_t i = 1; i < labels.size(); i++){
-		avg += labels[i];
-	}
-	return avg/labels.size();
-}
-
-double RFTrainer::totalSumOfSquares(std::vector<RealVector>& labels, std::size_t start, std::size_t length, const RealVector& sumLabel){
-	if (length < 1)
-		throw SHARKEXCEPTION("[RFTrainer::totalSumOfSquares] length < 1");
-	if (start+length > labels.size())
-		throw SHARKEXCEPTION("[RFTrainer::totalSumOfSquares] start+length > labels.size()");
-
-	RealVector labelAvg(sumLabel);
-	labelAvg /= length;
-
-	double sumOfSquares = 0;
-
-	for(std::size_t i = 0; i < length; i++){
-		sumOfSquares += norm_sqr(labels[start+i]-labelAvg);
-	}
-	return sumOfSquares;
-}
-
-/**
- * Returns two attribute tables: LAttrbuteTables and RAttrbuteTables
- * Calculated from splitting tables at (index, valIndex)
- */
-void RFTrainer::splitAttributeTables(const AttributeTables& tables, std::size_t index, std::size_t valIndex, AttributeTables& LAttributeTables, AttributeTables& RAttributeTables){
-	AttributeTable table;
-
-	//Build a hash table for fast lookup
-	boost::unordered_map<std::size_t, bool> hash;
-	for(std::size_t i = 0; i< tables[index].size(); i++){
-		hash[tables[index][i][1]] = i<=valIndex;
-	}
-
-	for(std::size_t i = 0; i < tables.size(); i++){
-		//For each attribute table
-		LAttributeTables.push_back(table);
-		RAttributeTables.push_back(table);
-		for(std::size_t j = 0; j < tables[i].size(); j++){
-			if(hash[tables[i][j][1]]){
-				//Left
-				LAttributeTables[i].push_back(tables[i][j]);
-			}else{
-				//Right
-				RAttributeTables[i].push_back(tables[i][j]);
-			}
+///Picks subsetSize = m_OOBratio*numElements indices without replacement,
+///or numElements indices with replacement.
+///The subset indices contain every drawn element once, sorted by index.
+void RFTrainer::generateSubsetIndices(std::vector<std::size_t>& subsetIndices, std::vector<unsigned int>& multiplicities, std::size_t numElements, Rng::rng_type& rng){
+	multiplicities.assign(numElements, 0);
+	if(m_sampleWithReplacement){
+		DiscreteUniform<Rng::rng_type> uni(rng, 0, numElements-1);
+		for(std::size_t i = 0; i != numElements; ++i){
+			++multiplicities[uni()];
 		}
-	}
-}
-
-
-///Generates a random set of indices
-void RFTrainer::generateRandomTableIndicies(set<std::size_t>& tableIndicies){
-	//Draw the m_try Generate the random attributes to search for the split
-	while(tableIndicies.size()<m_try){
-		tableIndicies.insert( rand() % m_inputDimension);
-	}
-}
-
-///Calculates the Gini impurity of a node. The impurity is defined as
-///1-sum_j p(j|t)^2
-///i.e the 1 minus the sum of the squared probability of observing class j in node t
-double RFTrainer::gini(boost::unordered_map<std::size_t, std::size_t>& countMatrix, std::size_t n){
-	double res = 0;
-	boost::unordered_map<std::size_t, std::size_t>::iterator it;
-	if(n){
-		n = n*n;
-		for ( it=countMatrix.begin() ; it != countMatrix.end(); it++ ){
-			res += sqr(it->second)/(double)n;
+	}else{
+		std::size_t subsetSize = numElements*m_OOBratio;
+		std::vector<std::size_t> permutation(numElements);
+		boost::iota(permutation,0);
+		DiscreteUniform<Rng::rng_type> uni(rng, 0, 1);
+		std::random_shuffle(permutation.begin(), permutation.end(), uni);
+		for(std::size_t i = 0; i != subsetSize; ++i){
+			multiplicities[permutation[i]] = 1;
 		}
 	}
-	return 1-res;
-}
-
-
-/// Creates the attribute tables, and in the process creates a count Matrix (cAbove).
-/// A dataset consisting of m input variables has m attribute tables.
-/// [attribute | class/value | rid ]
-void RFTrainer::createAttributeTables(Data<RealVector> const& dataset, AttributeTables& tables){
-	std::size_t elements = dataset.numberOfElements();
-	//Each entry in the outer vector is an attribute table
-	AttributeTable table;
-	RealVector tmpRow(3);
-	//For each column
-	for(std::size_t j=0; j<m_inputDimension; j++){
-		table.clear();
-		//For each row
-		for(std::size_t i=0; i<elements; i++){
-			//Store Attribute value, class and rid
-			tmpRow[0] = dataset.element(i)[j];
-			tmpRow[1] = i;
-			table.push_back(tmpRow);
-		}
-		std::sort(table.begin(), table.end(), tableSort);
-		//Store this attributes attribute table
-		tables.push_back(table);
+	subsetIndices.clear();
+	for(std::size_t i = 0; i != numElements; ++i){
+		if(multiplicities[i]) subsetIndices.push_back(i);
 	}
 }
 
-
-void RFTrainer::createCountMatrix(const ClassificationDataset& dataset, boost::unordered_map<std::size_t, std::size_t>& cAbove){
-	std::size_t elements = dataset.numberOfElements();
-	for(std::size_t i = 0 ; i < elements; i++){
-		cAbove[dataset.element(i).label]++;
+///The seeds are drawn sequentially, so the forest only depends on the state of the global Rng
+std::vector<Rng::rng_type::result_type> RFTrainer::generateTreeSeeds()const{
+	std::vector<Rng::rng_type::result_type> seeds(m_B);
+	for(std::size_t t = 0; t != m_B; ++t){
+		seeds[t] = Rng::globalRng();
 	}
+	return seeds;
 }
-
-bool RFTrainer::tableSort(const RealVector& v1, const RealVector& v2) {
-	return v1[0] < v2[0];
-}
-
-
-
-
-
-
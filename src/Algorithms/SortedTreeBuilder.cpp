@@ -0,0 +1,353 @@
+//===========================================================================
+/*!
+ *  \brief Level-wise growing of CART trees on attributes sorted once for all trees.
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#include <shark/Algorithms/Trainers/Impl/SortedTreeBuilder.h>
+#include <shark/Core/OpenMP.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+using namespace shark;
+using namespace shark::detail;
+
+void SortedAttributes::create(Data<RealVector> const& inputs){
+	m_numElements = inputs.numberOfElements();
+	std::size_t numAttributes = dataDimension(inputs);
+	m_tables.assign(numAttributes, std::vector<Entry>(m_numElements));
+	m_values.resize(numAttributes*m_numElements);
+
+	std::size_t i = 0;
+	for(std::size_t b = 0; b != inputs.numberOfBatches(); ++b){
+		Data<RealVector>::const_batch_reference batch = inputs.batch(b);
+		for(std::size_t k = 0; k != batch.size1(); ++k, ++i){
+			for(std::size_t j = 0; j != numAttributes; ++j){
+				m_tables[j][i].value = batch(k,j);
+				m_tables[j][i].id = i;
+				m_values[j*m_numElements+i] = batch(k,j);
+			}
+		}
+	}
+
+	//the attributes are sorted independently
+	SHARK_PARALLEL_FOR(int j = 0; j < (int)numAttributes; ++j){
+		std::sort(m_tables[j].begin(), m_tables[j].end());
+	}
+}
+
+SortedTreeBuilder::SortedTreeBuilder(SortedAttributes const& attributes, std::vector<unsigned int> const& labels, std::size_t numberOfClasses)
+: m_attributes(attributes)
+, mep_classLabels(&labels)
+, mep_regressionLabels(0)
+, mep_multiplicities(0)
+, m_regression(false)
+, m_labelDimension(numberOfClasses)
+, m_stride(numberOfClasses)
+, m_nodeSize(1)
+, m_try(0){
+	SIZE_CHECK(labels.size() == attributes.numberOfElements());
+}
+
+SortedTreeBuilder::SortedTreeBuilder(SortedAttributes const& attributes, std::vector<RealVector> const& labels)
+: m_attributes(attributes)
+, mep_classLabels(0)
+, mep_regressionLabels(&labels)
+, mep_multiplicities(0)
+, m_regression(true)
+, m_labelDimension(labels[0].size())
+, m_stride(labels[0].size()+2)
+, m_nodeSize(1)
+, m_try(0){
+	SIZE_CHECK(labels.size() == attributes.numberOfElements());
+}
+
+SortedTreeBuilder::SplitMatrixType SortedTreeBuilder::buildTree(std::vector<std::size_t> const& elements, Rng::rng_type& rng){
+	std::size_t const numAttributes = m_attributes.numberOfAttributes();
+	unsigned int const none = std::numeric_limits<unsigned int>::max();
+
+	//position in the current level of the node of every element,
+	//none for elements which are not used by the tree or which are in a finished leaf
+	std::vector<unsigned int> levelNode(m_attributes.numberOfElements(), none);
+	std::vector<unsigned int> nextLevelNode(m_attributes.numberOfElements(), none);
+
+	//the root is the only node of the first level
+	std::vector<Node> nodes(1);
+	std::vector<std::size_t> level(1, 0);
+	std::vector<std::size_t> nodeSizes(1, elements.size());
+	std::vector<double> statistics(m_stride, 0.0);
+	for(std::size_t i = 0; i != elements.size(); ++i){
+		levelNode[elements[i]] = 0;
+		addElement(&statistics[0], elements[i]);
+	}
+
+	std::vector<std::size_t> attributes;
+	//nodes of the level which search an attribute
+	std::vector<std::vector<std::size_t> > attributeNodes(numAttributes);
+	m_right.resize(m_stride);
+	while(!level.empty()){
+		std::size_t levelSize = level.size();
+
+		//create the nodes and choose the attributes to search
+		double sortCost = 0;
+		for(std::size_t k = 0; k != levelSize; ++k){
+			Node& node = nodes[level[k]];
+			double const* nodeStatistics = &statistics[k*m_stride];
+			node.left = 0;
+			node.right = 0;
+			setNodeInfo(node.info, nodeStatistics);
+			if(count(nodeStatistics) <= m_nodeSize || cost(nodeStatistics) <= 0)
+				continue;
+			drawAttributes(attributes, rng);
+			for(std::size_t a = 0; a != attributes.size(); ++a){
+				attributeNodes[attributes[a]].push_back(k);
+			}
+			sortCost += attributes.size()*nodeSizes[k]*std::log(nodeSizes[k]+1.0);
+		}
+		double scanCost = 0;
+		for(std::size_t j = 0; j != numAttributes; ++j){
+			if(!attributeNodes[j].empty())
+				scanCost += m_attributes.numberOfElements();
+		}
+
+		//find the best split of every node, the deep levels with few elements are cheaper to sort than to scan
+		std::vector<SplitSearch> searches(levelSize);
+		for(std::size_t k = 0; k != levelSize; ++k){
+			searches[k].found = false;
+			searches[k].cost = std::numeric_limits<double>::max();
+		}
+		if(sortCost < scanCost)
+			sortNodes(elements, levelNode, nodeSizes, statistics, attributeNodes, searches);
+		else
+			scanTables(levelNode, statistics, attributeNodes, searches);
+
+		//create the children of the split nodes, they form the next level
+		std::vector<std::size_t> nextLevel;
+		std::vector<std::size_t> firstChild(levelSize);
+		for(std::size_t k = 0; k != levelSize; ++k){
+			if(!searches[k].found) continue;
+			Node& node = nodes[level[k]];
+			node.info.attributeIndex = searches[k].attribute;
+			node.info.attributeValue = searches[k].value;
+			node.left = nodes.size();
+			node.right = nodes.size()+1;
+			firstChild[k] = nextLevel.size();
+			nextLevel.push_back(node.left);
+			nextLevel.push_back(node.right);
+			nodes.resize(nodes.size()+2);
+		}
+
+		//move the elements of the split nodes to the children, the other elements are in finished leaves
+		std::vector<double> nextStatistics(nextLevel.size()*m_stride, 0.0);
+		std::vector<std::size_t> nextNodeSizes(nextLevel.size(), 0);
+		for(std::size_t i = 0; i != elements.size(); ++i){
+			std::size_t element = elements[i];
+			std::size_t k = levelNode[element];
+			nextLevelNode[element] = none;
+			if(k == none || !searches[k].found) continue;
+			double value = m_attributes.value(searches[k].attribute, element);
+			std::size_t child = firstChild[k] + (value <= searches[k].value? 0 : 1);
+			nextLevelNode[element] = (unsigned int)child;
+			++nextNodeSizes[child];
+			addElement(&nextStatistics[child*m_stride], element);
+		}
+
+		level.swap(nextLevel);
+		levelNode.swap(nextLevelNode);
+		nodeSizes.swap(nextNodeSizes);
+		statistics.swap(nextStatistics);
+	}
+
+	SplitMatrixType splitMatrix;
+	splitMatrix.reserve(nodes.size());
+	storeSubtree(nodes, 0, splitMatrix);
+	return splitMatrix;
+}
+
+void SortedTreeBuilder::scanTables(
+	std::vector<unsigned int> const& levelNode, std::vector<double> const& statistics,
+	std::vector<std::vector<std::size_t> >& attributeNodes, std::vector<SplitSearch>& searches
+){
+	std::size_t levelSize = searches.size();
+	std::vector<char> isSearching(levelSize, 0);
+	std::vector<double> left(levelSize*m_stride);
+	for(std::size_t j = 0; j != attributeNodes.size(); ++j){
+		std::vector<std::size_t>& searching = attributeNodes[j];
+		if(searching.empty()) continue;
+		for(std::size_t s = 0; s != searching.size(); ++s){
+			std::size_t k = searching[s];
+			isSearching[k] = 1;
+			searches[k].started = false;
+			std::fill(left.begin()+k*m_stride, left.begin()+(k+1)*m_stride, 0.0);
+		}
+
+		//the elements of all nodes are visited in the order of the attribute, the other elements are skipped
+		std::vector<SortedAttributes::Entry> const& table = m_attributes.table(j);
+		for(std::size_t i = 0; i != table.size(); ++i){
+			std::size_t k = levelNode[table[i].id];
+			if(k >= levelSize || !isSearching[k]) continue;
+			searchElement(searches[k], &left[k*m_stride], &statistics[k*m_stride], j, table[i]);
+		}
+
+		for(std::size_t s = 0; s != searching.size(); ++s){
+			isSearching[searching[s]] = 0;
+		}
+		searching.clear();
+	}
+}
+
+void SortedTreeBuilder::sortNodes(
+	std::vector<std::size_t> const& elements, std::vector<unsigned int> const& levelNode,
+	std::vector<std::size_t> const& nodeSizes, std::vector<double> const& statistics,
+	std::vector<std::vector<std::size_t> >& attributeNodes, std::vector<SplitSearch>& searches
+){
+	std::size_t levelSize = searches.size();
+
+	//group the elements by their node
+	std::vector<std::size_t> offsets(levelSize+1, 0);
+	for(std::size_t k = 0; k != levelSize; ++k){
+		offsets[k+1] = offsets[k]+nodeSizes[k];
+	}
+	std::vector<std::size_t> nodeElements(offsets[levelSize]);
+	std::vector<std::size_t> positions(offsets.begin(), offsets.end()-1);
+	for(std::size_t i = 0; i != elements.size(); ++i){
+		std::size_t k = levelNode[elements[i]];
+		if(k < levelSize)
+			nodeElements[positions[k]++] = elements[i];
+	}
+
+	std::vector<SortedAttributes::Entry> entries;
+	std::vector<double> left(m_stride);
+	for(std::size_t j = 0; j != attributeNodes.size(); ++j){
+		std::vector<std::size_t>& searching = attributeNodes[j];
+		for(std::size_t s = 0; s != searching.size(); ++s){
+			std::size_t k = searching[s];
+			entries.resize(nodeSizes[k]);
+			for(std::size_t i = 0; i != entries.size(); ++i){
+				entries[i].id = nodeElements[offsets[k]+i];
+				entries[i].value = m_attributes.value(j, entries[i].id);
+			}
+			std::sort(entries.begin(), entries.end());
+
+			searches[k].started = false;
+			std::fill(left.begin(), left.end(), 0.0);
+			for(std::size_t i = 0; i != entries.size(); ++i){
+				searchElement(searches[k], &left[0], &statistics[k*m_stride], j, entries[i]);
+			}
+		}
+		searching.clear();
+	}
+}
+
+void SortedTreeBuilder::searchElement(
+	SplitSearch& search, double* left, double const* nodeStatistics,
+	std::size_t attribute, SortedAttributes::Entry const& entry
+){
+	//the previous elements of the node form the left child of a split before this element
+	if(search.started && entry.value != search.lastValue){
+		for(std::size_t c = 0; c != m_stride; ++c){
+			m_right[c] = nodeStatistics[c]-left[c];
+		}
+		double splitCost = cost(left)+cost(&m_right[0]);
+		if(splitCost < search.cost){
+			search.found = true;
+			search.cost = splitCost;
+			search.attribute = attribute;
+			search.value = search.lastValue;
+		}
+	}
+	addElement(left, entry.id);
+	search.lastValue = entry.value;
+	search.started = true;
+}
+
+void SortedTreeBuilder::drawAttributes(std::vector<std::size_t>& attributes, Rng::rng_type& rng)const{
+	std::size_t numAttributes = m_attributes.numberOfAttributes();
+	if(m_try == 0 || m_try >= numAttributes){
+		attributes.resize(numAttributes);
+		for(std::size_t j = 0; j != numAttributes; ++j){
+			attributes[j] = j;
+		}
+		return;
+	}
+	std::set<std::size_t> drawn;
+	DiscreteUniform<Rng::rng_type> uni(rng, 0, numAttributes-1);
+	while(drawn.size() < m_try){
+		drawn.insert(uni());
+	}
+	attributes.assign(drawn.begin(),drawn.end());
+}
+
+void SortedTreeBuilder::storeSubtree(std::vector<Node> const& nodes, std::size_t node, SplitMatrixType& splitMatrix)const{
+	std::size_t nodeId = splitMatrix.size();
+	splitMatrix.push_back(nodes[node].info);
+	splitMatrix[nodeId].nodeId = nodeId;
+	if(!nodes[node].left)
+		return;
+
+	splitMatrix[nodeId].leftNodeId = splitMatrix.size();
+	storeSubtree(nodes, nodes[node].left, splitMatrix);
+	splitMatrix[nodeId].rightNodeId = splitMatrix.size();
+	storeSubtree(nodes, nodes[node].right, splitMatrix);
+}
+
+double SortedTreeBuilder::count(double const* statistics)const{
+	if(m_regression)
+		return statistics[0];
+	double n = 0;
+	for(std::size_t c = 0; c != m_stride; ++c){
+		n += statistics[c];
+	}
+	return n;
+}
+
+double SortedTreeBuilder::cost(double const* statistics)const{
+	double n = count(statistics);
+	if(n == 0) return 0;
+	double sumSqr = 0;
+	if(m_regression){
+		for(std::size_t k = 0; k != m_labelDimension; ++k){
+			sumSqr += sqr(statistics[2+k]);
+		}
+		//n times the total sum of squares, cancellation can make the result slightly negative
+		return n*std::max(statistics[1]-sumSqr/n,0.0);
+	}
+	//n times the Gini impurity 1-sum_c p_c^2
+	for(std::size_t c = 0; c != m_stride; ++c){
+		sumSqr += sqr(statistics[c]);
+	}
+	return n - sumSqr/n;
+}
+
+void SortedTreeBuilder::setNodeInfo(CARTClassifier<RealVector>::SplitInfo& info, double const* statistics)const{
+	double n = count(statistics);
+	info.label.resize(m_labelDimension);
+	if(m_regression){
+		for(std::size_t k = 0; k != m_labelDimension; ++k){
+			info.label(k) = statistics[2+k]/n;
+		}
+		info.misclassProp = cost(statistics)/n;
+	}else{
+		for(std::size_t c = 0; c != m_labelDimension; ++c){
+			info.label(c) = statistics[c]/n;
+		}
+		info.misclassProp = 1-*std::max_element(info.label.begin(),info.label.end());
+	}
+}
@@ -0,0 +1,557 @@
+//===========================================================================
+/*!
+ *
+ *  \brief Implementation of the binary dataset format
+ *
+ *  <BR><HR>
+ *  This file is part of Shark. This library is free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software
+ *  Foundation; either version 3, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#include <shark/Data/Binary.h>
+#include <shark/Core/OpenMP.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/cstdint.hpp>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+using namespace shark;
+
+namespace {
+
+typedef boost::uint64_t uint64;
+typedef boost::uint32_t uint32;
+
+char const fileMagic[8] = {'S','H','A','R','K','D','A','T'};
+uint32 const byteOrderMark = 0x01020304;
+/// the contents of every batch start at a multiple of this
+std::size_t const batchAlignment = 64;
+
+enum SectionType{
+	DenseSection = 1,
+	SparseSection = 2,
+	LabelSection = 3
+};
+
+struct FileHeader{
+	char magic[8];
+	uint32 version;
+	uint32 byteOrder;
+	uint32 numberOfSections;
+	uint32 reserved;
+};
+
+struct SectionHeader{
+	uint32 type;
+	uint32 reserved;
+	uint64 numberOfBatches;
+	uint64 dimension;
+};
+
+struct BatchEntry{
+	uint64 rows;
+	uint64 nonZeros;
+	uint64 offset;
+};
+
+/// \brief Computes a*b+c, returns false if the result does not fit into 64 bit.
+///
+/// The sizes in the batch table of a corrupted file can be arbitrarily large,
+/// so they are checked before any size is computed from them.
+bool multiplyAdd(uint64 a, uint64 b, uint64 c, uint64& result){
+	uint64 const maximum = std::numeric_limits<uint64>::max();
+	if(b != 0 && a > (maximum - c)/b)
+		return false;
+	result = a*b+c;
+	return true;
+}
+
+/// \brief Layout of a Data object in the file.
+struct Section{
+	SectionHeader header;
+	std::vector<BatchEntry> batches;
+	/// size of the contents of every batch in bytes
+	std::vector<uint64> bytes;
+};
+
+/// \brief Describes how the batches of a type are stored.
+template<class BatchType>
+struct BatchFormat;
+
+template<>
+struct BatchFormat<RealMatrix>{
+	static const uint32 type = DenseSection;
+
+	static std::size_t rows(RealMatrix const& batch){
+		return batch.size1();
+	}
+	static std::size_t nonZeros(RealMatrix const& batch){
+		return batch.size1()*batch.size2();
+	}
+	static std::size_t dimension(RealMatrix const& batch){
+		return batch.size2();
+	}
+	static bool bytes(uint64, uint64 nonZeros, uint64& bytes){
+		return multiplyAdd(nonZeros, sizeof(double), 0, bytes);
+	}
+	static void write(std::ostream& out, RealMatrix const& batch){
+		if(batch.size1() != 0 && batch.size2() != 0)
+			out.write(reinterpret_cast<char const*>(&batch(0,0)), nonZeros(batch)*sizeof(double));
+	}
+	static bool read(char const* contents, BatchEntry const& entry, std::size_t dimension, RealMatrix& batch){
+		uint64 elements;
+		if(!multiplyAdd(entry.rows, dimension, 0, elements) || elements != entry.nonZeros)
+			return false;
+		batch.resize(entry.rows, dimension, false);
+		if(entry.nonZeros != 0)
+			std::memcpy(&batch(0,0), contents, entry.nonZeros*sizeof(double));
+		return true;
+	}
+};
+
+template<>
+struct BatchFormat<blas::compressed_matrix<double> >{
+	typedef blas::compressed_matrix<double> BatchType;
+	static const uint32 type = SparseSection;
+
+	static std::size_t rows(BatchType const& batch){
+		return batch.size1();
+	}
+	static std::size_t nonZeros(BatchType const& batch){
+		return batch.filled2();
+	}
+	static std::size_t dimension(BatchType const& batch){
+		return batch.size2();
+	}
+	static bool bytes(uint64 rows, uint64 nonZeros, uint64& bytes){
+		uint64 rowBytes;
+		return multiplyAdd(rows, sizeof(uint64), sizeof(uint64), rowBytes)
+			&& multiplyAdd(nonZeros, sizeof(uint64)+sizeof(double), rowBytes, bytes);
+	}
+	static void write(std::ostream& out, BatchType const& batch){
+		std::size_t rows = batch.size1();
+		std::size_t filled = batch.filled2();
+		//rows after the last filled row do not have an entry in the index array
+		std::vector<uint64> rowStarts(rows+1);
+		for(std::size_t i = 0; i <= rows; ++i)
+			rowStarts[i] = i < batch.filled1()? batch.index1_data()[i] : filled;
+		std::vector<uint64> columns(batch.index2_data().begin(), batch.index2_data().begin()+filled);
+		out.write(reinterpret_cast<char const*>(&rowStarts[0]), rowStarts.size()*sizeof(uint64));
+		if(filled != 0){
+			out.write(reinterpret_cast<char const*>(&columns[0]), filled*sizeof(uint64));
+			out.write(reinterpret_cast<char const*>(&batch.value_data()[0]), filled*sizeof(double));
+		}
+	}
+	static bool read(char const* contents, BatchEntry const& entry, std::size_t dimension, BatchType& batch){
+		std::size_t rows = entry.rows;
+		std::size_t filled = entry.nonZeros;
+		uint64 const* rowStarts = reinterpret_cast<uint64 const*>(contents);
+		uint64 const* columns = rowStarts+rows+1;
+		double const* values = reinterpret_cast<double const*>(columns+filled);
+		//check the structure, so that a corrupted file can not lead to an invalid matrix
+		if(rowStarts[0] != 0 || rowStarts[rows] != filled)
+			return false;
+		for(std::size_t i = 0; i != rows; ++i){
+			if(rowStarts[i] > rowStarts[i+1])
+				return false;
+			for(uint64 k = rowStarts[i]; k != rowStarts[i+1]; ++k){
+				if(columns[k] >= dimension || (k != rowStarts[i] && columns[k] <= columns[k-1]))
+					return false;
+			}
+		}
+		batch.resize(rows, dimension, false);
+		batch.reserve(filled, false);
+		std::copy(rowStarts, rowStarts+rows+1, batch.index1_data().begin());
+		std::copy(columns, columns+filled, batch.index2_data().begin());
+		std::copy(values, values+filled, batch.value_data().begin());
+		batch.set_filled(rows+1, filled);
+		return true;
+	}
+};
+
+template<>
+struct BatchFormat<UIntVector>{
+	static const uint32 type = LabelSection;
+
+	static std::size_t rows(UIntVector const& batch){
+		return batch.size();
+	}
+	static std::size_t nonZeros(UIntVector const& batch){
+		return batch.size();
+	}
+	static std::size_t dimension(UIntVector const&){
+		return 0;
+	}
+	static bool bytes(uint64 rows, uint64, uint64& bytes){
+		return multiplyAdd(rows, sizeof(uint32), 0, bytes);
+	}
+	static void write(std::ostream& out, UIntVector const& batch){
+		std::vector<uint32> labels(batch.begin(), batch.end());
+		if(!labels.empty())
+			out.write(reinterpret_cast<char const*>(&labels[0]), labels.size()*sizeof(uint32));
+	}
+	static bool read(char const* contents, BatchEntry const& entry, std::size_t, UIntVector& batch){
+		if(entry.nonZeros != entry.rows)
+			return false;
+		uint32 const* labels = reinterpret_cast<uint32 const*>(contents);
+		batch.resize(entry.rows, false);
+		std::copy(labels, labels+entry.rows, batch.begin());
+		return true;
+	}
+};
+
+template<class T>
+Section describeSection(Data<T> const& data){
+	typedef BatchFormat<typename Batch<T>::type> Format;
+	Section section;
+	section.header.type = Format::type;
+	section.header.reserved = 0;
+	section.header.numberOfBatches = data.numberOfBatches();
+	section.header.dimension = 0;
+	for(std::size_t b = 0; b != data.numberOfBatches(); ++b){
+		BatchEntry entry;
+		entry.rows = Format::rows(data.batch(b));
+		entry.nonZeros = Format::nonZeros(data.batch(b));
+		entry.offset = 0;
+		section.batches.push_back(entry);
+		uint64 bytes = 0;
+		Format::bytes(entry.rows, entry.nonZeros, bytes);//batches in memory are small enough
+		section.bytes.push_back(bytes);
+		section.header.dimension = std::max<uint64>(section.header.dimension, Format::dimension(data.batch(b)));
+	}
+	return section;
+}
+
+uint64 align(uint64 offset){
+	return (offset+batchAlignment-1)/batchAlignment*batchAlignment;
+}
+
+/// \brief Computes the file offsets of all batches and writes the header and the tables of all sections.
+void writeHeaders(std::ostream& out, std::vector<Section>& sections){
+	uint64 offset = sizeof(FileHeader);
+	for(std::size_t s = 0; s != sections.size(); ++s)
+		offset += sizeof(SectionHeader)+sections[s].batches.size()*sizeof(BatchEntry);
+	for(std::size_t s = 0; s != sections.size(); ++s){
+		for(std::size_t b = 0; b != sections[s].batches.size(); ++b){
+			offset = align(offset);
+			sections[s].batches[b].offset = offset;
+			offset += sections[s].bytes[b];
+		}
+	}
+
+	FileHeader header;
+	std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.version = BinaryFormatVersion;
+	header.byteOrder = byteOrderMark;
+	header.numberOfSections = (uint32)sections.size();
+	header.reserved = 0;
+	out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	for(std::size_t s = 0; s != sections.size(); ++s){
+		out.write(reinterpret_cast<char const*>(&sections[s].header), sizeof(SectionHeader));
+		if(!sections[s].batches.empty())
+			out.write(reinterpret_cast<char const*>(&sections[s].batches[0]), sections[s].batches.size()*sizeof(BatchEntry));
+	}
+}
+
+template<class T>
+void writeBatches(std::ostream& out, Data<T> const& data, Section const& section){
+	typedef BatchFormat<typename Batch<T>::type> Format;
+	for(std::size_t b = 0; b != data.numberOfBatches(); ++b){
+		//pad with zeros up to the start of the batch
+		std::size_t padding = std::size_t(section.batches[b].offset - uint64(out.tellp()));
+		char const zeros[batchAlignment] = {0};
+		out.write(zeros, padding);
+		Format::write(out, data.batch(b));
+	}
+}
+
+template<class T>
+void exportData(Data<T> const& data, std::string const& fn){
+	std::ofstream out(fn.c_str(), std::ios::binary);
+	if(!out)
+		throw SHARKEXCEPTION("[export_binary] file can not be opened for writing");
+	std::vector<Section> sections(1, describeSection(data));
+	writeHeaders(out, sections);
+	writeBatches(out, data, sections[0]);
+	if(!out)
+		throw SHARKEXCEPTION("[export_binary] error while writing file");
+}
+
+template<class I, class L>
+void exportLabeledData(LabeledData<I,L> const& dataset, std::string const& fn){
+	std::ofstream out(fn.c_str(), std::ios::binary);
+	if(!out)
+		throw SHARKEXCEPTION("[export_binary] file can not be opened for writing");
+	std::vector<Section> sections;
+	sections.push_back(describeSection(dataset.inputs()));
+	sections.push_back(describeSection(dataset.labels()));
+	writeHeaders(out, sections);
+	writeBatches(out, dataset.inputs(), sections[0]);
+	writeBatches(out, dataset.labels(), sections[1]);
+	if(!out)
+		throw SHARKEXCEPTION("[export_binary] error while writing file");
+}
+
+/// \brief A file mapped read only into memory.
+class MappedFile{
+public:
+	MappedFile(std::string const& fn){
+		try{
+			boost::interprocess::file_mapping file(fn.c_str(), boost::interprocess::read_only);
+			boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+			m_region.swap(region);
+		}catch(boost::interprocess::interprocess_exception const&){
+			throw SHARKEXCEPTION("[import_binary] file can not be opened for reading");
+		}
+		m_position = 0;
+	}
+
+	char const* data()const{
+		return static_cast<char const*>(m_region.get_address());
+	}
+	std::size_t size()const{
+		return m_region.get_size();
+	}
+
+	/// \brief Copies the next object of the header into value.
+	template<class T>
+	void read(T& value){
+		if(m_position + sizeof(T) > size())
+			throw SHARKEXCEPTION("[import_binary] unexpected end of file");
+		std::memcpy(&value, data()+m_position, sizeof(T));
+		m_position += sizeof(T);
+	}
+
+	/// \brief Moves the read position forward without copying.
+	void skip(uint64 bytes){
+		if(bytes > size() - m_position)
+			throw SHARKEXCEPTION("[import_binary] unexpected end of file");
+		m_position += std::size_t(bytes);
+	}
+private:
+	boost::interprocess::mapped_region m_region;
+	std::size_t m_position;
+};
+
+/// \brief Checks the file header and returns the number of sections.
+uint32 readFileHeader(MappedFile& file){
+	FileHeader header;
+	file.read(header);
+	if(std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+		throw SHARKEXCEPTION("[import_binary] file is not a binary dataset");
+	if(header.byteOrder != byteOrderMark)
+		throw SHARKEXCEPTION("[import_binary] file was written on a machine with different byte order");
+	if(header.version > BinaryFormatVersion)
+		throw SHARKEXCEPTION("[import_binary] file was written by a newer version of Shark");
+	return header.numberOfSections;
+}
+
+void readFileHeader(MappedFile& file, uint32 numberOfSections){
+	if(readFileHeader(file) != numberOfSections)
+		throw SHARKEXCEPTION("[import_binary] file does not contain the requested type of dataset");
+}
+
+/// \brief Skips the header and batch table of a section of any type.
+void skipSectionHeader(MappedFile& file){
+	SectionHeader header;
+	file.read(header);
+	if(header.numberOfBatches > file.size()/sizeof(BatchEntry))
+		throw SHARKEXCEPTION("[import_binary] unexpected end of file");
+	file.skip(header.numberOfBatches*sizeof(BatchEntry));
+}
+
+/// \brief Reads the header and batch table of a section.
+template<class T>
+Section readSectionHeader(MappedFile& file){
+	typedef BatchFormat<typename Batch<T>::type> Format;
+	Section section;
+	file.read(section.header);
+	if(section.header.type != Format::type)
+		throw SHARKEXCEPTION("[import_binary] file does not contain the requested type of dataset");
+	if(section.header.numberOfBatches > file.size()/sizeof(BatchEntry))
+		throw SHARKEXCEPTION("[import_binary] unexpected end of file");
+	section.batches.resize(section.header.numberOfBatches);
+	for(std::size_t b = 0; b != section.batches.size(); ++b){
+		BatchEntry& entry = section.batches[b];
+		file.read(entry);
+		uint64 bytes;
+		if(!Format::bytes(entry.rows, entry.nonZeros, bytes))
+			throw SHARKEXCEPTION("[import_binary] file is corrupted");
+		if(entry.offset % batchAlignment != 0 || entry.offset > file.size() || bytes > file.size() - entry.offset)
+			throw SHARKEXCEPTION("[import_binary] file is corrupted");
+	}
+	return section;
+}
+
+/// \brief Copies one batch of a section from the mapped file.
+template<class BatchType>
+bool readBatch(MappedFile const& file, Section const& section, std::size_t b, BatchType& batch){
+	BatchEntry const& entry = section.batches[b];
+	return BatchFormat<BatchType>::read(file.data()+entry.offset, entry, section.header.dimension, batch);
+}
+
+/// \brief Copies the given batches of a section from the mapped file in parallel.
+template<class T>
+void readBatches(MappedFile const& file, Section const& section, std::vector<std::size_t> const& batches, Data<T>& data){
+	std::size_t numberOfBatches = batches.size();
+	data = Data<T>(numberOfBatches);
+	std::vector<char> valid(numberOfBatches, 1);
+	SHARK_PARALLEL_FOR(int b = 0; b < (int)numberOfBatches; ++b){
+		valid[b] = readBatch(file, section, batches[b], data.batch(b));
+	}
+	if(std::find(valid.begin(), valid.end(), 0) != valid.end())
+		throw SHARKEXCEPTION("[import_binary] file is corrupted");
+}
+
+template<class T>
+void readBatches(MappedFile const& file, Section const& section, Data<T>& data){
+	std::vector<std::size_t> batches(section.batches.size());
+	for(std::size_t b = 0; b != batches.size(); ++b)
+		batches[b] = b;
+	readBatches(file, section, batches, data);
+}
+
+template<class T>
+void importData(Data<T>& data, std::string const& fn){
+	MappedFile file(fn);
+	readFileHeader(file, 1);
+	Section section = readSectionHeader<T>(file);
+	readBatches(file, section, data);
+}
+
+template<class I, class L>
+void importLabeledData(LabeledData<I,L>& dataset, std::string const& fn){
+	MappedFile file(fn);
+	readFileHeader(file, 2);
+	Section inputSection = readSectionHeader<I>(file);
+	Section labelSection = readSectionHeader<L>(file);
+	if(inputSection.batches.size() != labelSection.batches.size())
+		throw SHARKEXCEPTION("[import_binary] file is corrupted");
+	for(std::size_t b = 0; b != inputSection.batches.size(); ++b){
+		if(inputSection.batches[b].rows != labelSection.batches[b].rows)
+			throw SHARKEXCEPTION("[import_binary] file is corrupted");
+	}
+	Data<I> inputs;
+	Data<L> labels;
+	readBatches(file, inputSection, inputs);
+	readBatches(file, labelSection, labels);
+	dataset = LabeledData<I,L>(inputs, labels);
+}
+
+}
+
+template<class T>
+struct shark::BinaryDataFile<T>::Impl{
+	Impl(std::string const& fn):file(fn){}
+	MappedFile file;
+	Section section;
+};
+
+template<class T>
+shark::BinaryDataFile<T>::BinaryDataFile(std::string const& fn, std::size_t section){
+	boost::shared_ptr<Impl> impl(new Impl(fn));
+	if(section >= readFileHeader(impl->file))
+		throw SHARKEXCEPTION("[BinaryDataFile] file does not contain the requested section");
+	for(std::size_t s = 0; s != section; ++s)
+		skipSectionHeader(impl->file);
+	impl->section = readSectionHeader<T>(impl->file);
+	mp_impl = impl;
+}
+
+template<class T>
+std::size_t shark::BinaryDataFile<T>::numberOfBatches()const{
+	return mp_impl->section.batches.size();
+}
+
+template<class T>
+std::size_t shark::BinaryDataFile<T>::numberOfElements()const{
+	std::size_t elements = 0;
+	for(std::size_t b = 0; b != numberOfBatches(); ++b)
+		elements += batchSize(b);
+	return elements;
+}
+
+template<class T>
+std::size_t shark::BinaryDataFile<T>::batchSize(std::size_t b)const{
+	RANGE_CHECK(b < numberOfBatches());
+	return std::size_t(mp_impl->section.batches[b].rows);
+}
+
+template<class T>
+void shark::BinaryDataFile<T>::readBatch(std::size_t b, BatchType& batch)const{
+	RANGE_CHECK(b < numberOfBatches());
+	if(!::readBatch(mp_impl->file, mp_impl->section, b, batch))
+		throw SHARKEXCEPTION("[BinaryDataFile] file is corrupted");
+}
+
+template<class T>
+Data<T> shark::BinaryDataFile<T>::data(std::vector<std::size_t> const& batches)const{
+	for(std::size_t b = 0; b != batches.size(); ++b)
+		RANGE_CHECK(batches[b] < numberOfBatches());
+	Data<T> result;
+	readBatches(mp_impl->file, mp_impl->section, batches, result);
+	return result;
+}
+
+template<class T>
+Data<T> shark::BinaryDataFile<T>::data()const{
+	Data<T> result;
+	readBatches(mp_impl->file, mp_impl->section, result);
+	return result;
+}
+
+template class shark::BinaryDataFile<RealVector>;
+template class shark::BinaryDataFile<CompressedRealVector>;
+template class shark::BinaryDataFile<unsigned int>;
+
+void shark::export_binary(Data<RealVector> const& data, std::string const& fn){
+	exportData(data, fn);
+}
+void shark::export_binary(Data<CompressedRealVector> const& data, std::string const& fn){
+	exportData(data, fn);
+}
+void shark::export_binary(Data<unsigned int> const& data, std::string const& fn){
+	exportData(data, fn);
+}
+void shark::export_binary(LabeledData<RealVector, unsigned int> const& dataset, std::string const& fn){
+	exportLabeledData(dataset, fn);
+}
+void shark::export_binary(LabeledData<CompressedRealVector, unsigned int> const& dataset, std::string const& fn){
+	exportLabeledData(dataset, fn);
+}
+void shark::export_binary(LabeledData<RealVector, RealVector> const& dataset, std::string const& fn){
+	exportLabeledData(dataset, fn);
+}
+
+void shark::import_binary(Data<RealVector>& data, std::string const& fn){
+	importData(data, fn);
+}
+void shark::import_binary(Data<CompressedRealVector>& data, std::string const& fn){
+	importData(data, fn);
+}
+void shark::import_binary(Data<unsigned int>& data, std::string const& fn){
+	importData(data, fn);
+}
+void shark::import_binary(LabeledData<RealVector, unsigned int>& dataset, std::string const& fn){
+	importLabeledData(dataset, fn);
+}
+void shark::import_binary(LabeledData<CompressedRealVector, unsigned int>& dataset, std::string const& fn){
+	importLabeledData(dataset, fn);
+}
+void shark::import_binary(LabeledData<RealVector, RealVector>& dataset, std::string const& fn){
+	importLabeledData(dataset, fn);
+}
@@ -32,174 +32,397 @@
  *  along with this library; if not, see <http://www.gnu.org/licenses/>.
  *
  */
-//===========================================================================
 #include <limits>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/fusion/adapted/std_pair.hpp>
 #include <shark/Data/Csv.h>
+#include <shark/Data/Impl/TextParsing.h>
+#include <deque>
 #include <vector>
 
 namespace {
 
-template<class T>
-inline std::vector<T> importCSVReaderSingleValue(
-	std::string const& contents,
-	char comment = '#'
-) {
-	std::string::const_iterator first = contents.begin();
-	std::string::const_iterator last = contents.end();
-	
-	using namespace boost::spirit::qi;
-	std::vector<T>  fileContents;
-	
-	bool r = phrase_parse(
-		first, last, 
-		auto_ % (eol|eoi),
-		(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)), fileContents
-	);
-
-	if(!r || first != last)
-		throw SHARKEXCEPTION("[import_libsvm_reader_value] problems parsing file");
-	
-	return fileContents;
+using namespace shark::detail;
+
+/// \brief Size of the pieces of a file or string which are parsed at once.
+std::size_t const chunkSize = std::size_t(1) << 24;
+
+/// \brief Values of the rows of a part of a csv file, stored one row after another.
+struct CsvRows{
+	std::vector<double> values;
+	/// start of every row in values, one more entry than rows
+	std::vector<std::size_t> rowStarts;
+
+	CsvRows():rowStarts(1,0){}
+
+	std::size_t size()const{
+		return rowStarts.size()-1;
+	}
+	std::size_t rowSize(std::size_t i)const{
+		return rowStarts[i+1]-rowStarts[i];
+	}
+	double const* row(std::size_t i)const{
+		return &values[0]+rowStarts[i];
+	}
+};
+
+/// \brief Parses lines of values separated by a character or by whitespace if the separator is 0.
+///
+/// Blanks around the values are ignored, empty values and '?' denote missing values, which are stored as NaN.
+/// Everything following the comment character up to the end of the line is ignored, as are empty lines.
+struct CsvParser{
+	CsvParser(char separator, char comment):m_separator(separator),m_comment(comment){}
+
+	void operator()(char const* pos, char const* end, CsvRows& rows)const{
+		while(pos != end){
+			char const* lineEnd = findLineEnd(pos,end);
+			parseLine(pos, lineEnd, rows);
+			pos = lineEnd;
+			while(pos != end && isLineBreak(*pos)) ++pos;
+		}
+	}
+private:
+	void parseLine(char const* pos, char const* end, CsvRows& rows)const{
+		if(m_comment != 0)
+			end = std::find(pos,end,m_comment);
+		skipBlanks(pos,end);
+		if(pos == end) return;//empty line
+
+		if(m_separator == 0){
+			while(pos != end){
+				char const* fieldEnd = pos;
+				while(fieldEnd != end && !isBlank(*fieldEnd)) ++fieldEnd;
+				rows.values.push_back(parseField(pos,fieldEnd));
+				pos = fieldEnd;
+				skipBlanks(pos,end);
+			}
+		}else{
+			while(true){
+				char const* fieldEnd = std::find(pos,end,m_separator);
+				rows.values.push_back(parseField(pos,fieldEnd));
+				if(fieldEnd == end) break;
+				pos = fieldEnd+1;
+			}
+		}
+		rows.rowStarts.push_back(rows.values.size());
+	}
+
+	double parseField(char const* pos, char const* end)const{
+		skipBlanks(pos,end);
+		while(end != pos && isBlank(*(end-1))) --end;
+		if(pos == end || (end - pos == 1 && *pos == '?'))
+			return std::numeric_limits<double>::quiet_NaN();
+		double value;
+		if(!parseDouble(pos,end,value) || pos != end)
+			throw SHARKEXCEPTION("[import_csv] problems parsing file: invalid number");
+		return value;
+	}
+
+	char m_separator;
+	char m_comment;
+};
+
+/// \brief Stores the rows of a csv file in batches of at most maximumBatchSize rows.
+///
+/// The RowWriter checks the rows and writes them straight into the batches, so the values
+/// are stored only once. A batch is allocated when its first row arrives, with room for maximumBatchSize
+/// rows or, if the batch size is unlimited, with a capacity which is doubled when it is exhausted.
+/// All batches but the last are full. The batches are kept in a deque, so they are never
+/// copied when batches are added.
+template<class RowWriter>
+class CsvBatches{
+public:
+	typedef typename RowWriter::batch_type batch_type;
+
+	CsvBatches(RowWriter const& writer, std::size_t maximumBatchSize)
+	: m_writer(writer)
+	, m_maximumBatchSize(maximumBatchSize == 0? std::numeric_limits<std::size_t>::max() : maximumBatchSize)
+	, m_rows(0), m_capacity(0){}
+
+	void append(CsvRows const& rows){
+		for(std::size_t i = 0; i != rows.size(); ++i){
+			m_writer.checkRow(rows.rowSize(i));
+			if(m_batches.empty() || m_rows == m_maximumBatchSize){
+				m_batches.push_back(batch_type());
+				m_rows = 0;
+				m_capacity = 0;
+			}
+			if(m_rows == m_capacity){
+				m_capacity = std::min(m_maximumBatchSize, std::max<std::size_t>(2*m_capacity, 256));
+				m_writer.resize(m_batches.back(), m_capacity);
+			}
+			m_writer.write(m_batches.back(), m_rows, rows.row(i));
+			++m_rows;
+		}
+	}
+
+	/// \brief Shrinks the last batch to the number of rows it holds.
+	void finish(){
+		if(m_rows != m_capacity)
+			m_writer.resize(m_batches.back(), m_rows);
+	}
+
+	std::size_t size()const{
+		return m_batches.size();
+	}
+	batch_type& batch(std::size_t i){
+		return m_batches[i];
+	}
+private:
+	RowWriter m_writer;
+	std::deque<batch_type> m_batches;
+	std::size_t m_maximumBatchSize;
+	std::size_t m_rows;///< number of rows in the last batch
+	std::size_t m_capacity;///< number of rows the last batch can hold
+};
+
+/// \brief Parses the contents of a csv file in line aligned chunks and stores the rows in batches.
+template<class Batches>
+void parseCsvString(std::string const& contents, char separator, char comment, Batches& batches){
+	char const* begin = contents.data();
+	char const* end = begin+contents.size();
+	std::vector<char const*> chunks = splitAtLines(begin, end, contents.size()/chunkSize+1);
+	std::vector<CsvRows> parts;
+	for(std::size_t c = 0; c+1 < chunks.size(); ++c){
+		parseLinesInParallel(chunks[c], chunks[c+1], CsvParser(separator,comment), parts);
+		for(std::size_t i = 0; i != parts.size(); ++i)
+			batches.append(parts[i]);
+	}
+	batches.finish();
 }
 
-//csv input for multiple homogenous values in a row
+/// \brief Reads a csv file in chunks, parses every chunk in parallel and stores the rows in batches.
+///
+/// Besides the dataset, only a single chunk and its parsed values are held in memory.
+template<class Batches>
+void parseCsvFile(std::string const& fn, char separator, char comment, Batches& batches){
+	std::ifstream stream(fn.c_str());
+	if(!stream)
+		throw SHARKEXCEPTION("[import_csv] file can not be opened for reading");
+	LineChunkReader reader(stream, chunkSize);
+	std::string chunk;
+	std::vector<CsvRows> parts;
+	while(reader.read(chunk)){
+		parseLinesInParallel(chunk.data(), chunk.data()+chunk.size(), CsvParser(separator,comment), parts);
+		for(std::size_t i = 0; i != parts.size(); ++i)
+			batches.append(parts[i]);
+	}
+	batches.finish();
+}
+
+inline void convertValue(double value, double& result){
+	result = value;
+}
+inline void convertValue(double value, int& result){
+	result = integerLabel(value);
+}
+inline void convertValue(double value, unsigned int& result){
+	int integer = integerLabel(value);
+	if(integer < 0)
+		throw SHARKEXCEPTION("[import_csv] negative value can not be stored as unsigned integer");
+	result = integer;
+}
+
+/// \brief Writes rows consisting of a single value into the batches of a Data<T>.
 template<class T>
-inline std::vector<std::vector<T> > importCSVReaderSingleValues(
-	std::string const& contents,
-	char separator,
-	char comment = '#'
-) {
-	std::string::const_iterator first = contents.begin();
-	std::string::const_iterator last = contents.end();
-	
-	using namespace boost::spirit::qi;
-	std::vector<std::vector<T> >  fileContents;
-	
-	bool r;
-	if( separator == 0){
-		r = phrase_parse(
-			first, last, 
-			(*auto_) % (eol|eoi),
-			space-eol , fileContents
-		);
+struct ValueWriter{
+	typedef typename shark::Batch<T>::type batch_type;
+
+	void checkRow(std::size_t columns)const{
+		if(columns != 1)
+			throw SHARKEXCEPTION("[import_csv] expected a single value per row");
+	}
+	void resize(batch_type& batch, std::size_t rows)const{
+		batch.resize(rows,true);
 	}
-	else{
-		r = phrase_parse(
-			first, last, 
-			(auto_ % separator) % (eol|eoi),
-			space-eol , fileContents
-		);
+	void write(batch_type& batch, std::size_t i, double const* row)const{
+		convertValue(row[0],batch(i));
 	}
+};
 
-	if(!r || first != last)
-		throw SHARKEXCEPTION("[import_libsvm_reader_values] problems parsing file");
-	
-	return fileContents;
-}
+/// \brief Writes rows into the batches of a Data<RealVector>.
+struct VectorWriter{
+	typedef shark::RealMatrix batch_type;
 
-//csv input for point-label pairs
-typedef std::pair<int, std::vector<double > > CsvPoint;
-inline std::vector<CsvPoint> import_csv_reader_points(
-	std::string const& contents,
-	shark::LabelPosition position,
-	char separator,
-	char comment = '#'
-) {
-	typedef std::string::const_iterator Iterator;
-	Iterator first = contents.begin();
-	Iterator last = contents.end();
-	std::vector<CsvPoint> fileContents;
-	
-	using namespace boost::spirit::qi;
-	using boost::spirit::_1;
-	using namespace boost::phoenix;
-	
-	double qnan = std::numeric_limits<double>::quiet_NaN();
-	
-	bool r = false;
-	if(separator == 0 && position == shark::FIRST_COLUMN){
-		r = phrase_parse(
-			first, last, 
-			(
-				lexeme[int_ >> -(lit('.')>>*lit('0'))] 
-				>> * (double_ | ('?' >>  attr(qnan) ))
-			) % eol >> -eol,
-			space-eol, fileContents
-		);
+	VectorWriter():m_dimensions(0){}
+
+	void checkRow(std::size_t columns){
+		if(m_dimensions == 0)
+			m_dimensions = columns;
+		else if(columns != m_dimensions)
+			throw SHARKEXCEPTION("vectors are required to have same size");
+	}
+	void resize(batch_type& batch, std::size_t rows)const{
+		batch.resize(rows,m_dimensions,true);
+	}
+	void write(batch_type& batch, std::size_t i, double const* row)const{
+		for(std::size_t j = 0; j != m_dimensions; ++j)
+			batch(i,j) = row[j];
+	}
+private:
+	std::size_t m_dimensions;
+};
+
+/// \brief Inputs of a batch of classification data together with the labels as they are stored in the file.
+struct ClassificationBatch{
+	shark::RealMatrix inputs;
+	shark::blas::vector<int> labels;
+};
+
+/// \brief Writes rows consisting of a label and the inputs into the batches of classification data.
+struct ClassificationWriter{
+	typedef ClassificationBatch batch_type;
+
+	ClassificationWriter(shark::LabelPosition lp):m_lp(lp),m_dimensions(0){}
+
+	void checkRow(std::size_t columns){
+		if(m_dimensions == 0){
+			if(columns < 2)
+				throw SHARKEXCEPTION("[import_csv] rows must consist of a label and at least one input");
+			m_dimensions = columns-1;
+		}
+		else if(columns != m_dimensions+1)
+			throw SHARKEXCEPTION("vectors are required to have same size");
+	}
+	void resize(batch_type& batch, std::size_t rows)const{
+		batch.inputs.resize(rows,m_dimensions,true);
+		batch.labels.resize(rows,true);
+	}
+	void write(batch_type& batch, std::size_t i, double const* row)const{
+		std::size_t labelColumn = (m_lp == shark::FIRST_COLUMN)? 0 : m_dimensions;
+		std::size_t inputStart = (m_lp == shark::FIRST_COLUMN)? 1 : 0;
+		batch.labels(i) = integerLabel(row[labelColumn]);
+		for(std::size_t j = 0; j != m_dimensions; ++j)
+			batch.inputs(i,j) = row[j+inputStart];
 	}
-	else if(separator != 0 && position == shark::FIRST_COLUMN){
-		r = phrase_parse(
-			first, last, 
-			(	
-				lexeme[int_ >> -(lit('.')>>*lit('0'))] 
-				>> *(separator >> (double_ | (-lit('?') >>  attr(qnan) ))) 
-			) % eol >> -eol,
-			space-eol , fileContents
-		);
+private:
+	shark::LabelPosition m_lp;
+	std::size_t m_dimensions;
+};
+
+/// \brief Inputs and labels of a batch of regression data.
+struct RegressionBatch{
+	shark::RealMatrix inputs;
+	shark::RealMatrix labels;
+};
+
+/// \brief Writes rows consisting of the inputs and numberOfOutputs labels into the batches of regression data.
+struct RegressionWriter{
+	typedef RegressionBatch batch_type;
+
+	RegressionWriter(shark::LabelPosition lp, std::size_t numberOfOutputs)
+	:m_lp(lp),m_numberOfOutputs(numberOfOutputs),m_numberOfInputs(0){}
+
+	void checkRow(std::size_t columns){
+		if(m_numberOfInputs == 0){
+			if(columns <= m_numberOfOutputs)
+				throw SHARKEXCEPTION("Files must have more columns than requested number of outputs");
+			m_numberOfInputs = columns-m_numberOfOutputs;
+		}
+		else if(columns != m_numberOfInputs+m_numberOfOutputs)
+			throw SHARKEXCEPTION("Detected different number of columns in a row of the file!");
 	}
-	else if(separator == 0 && position == shark::LAST_COLUMN){
-		do{
-			std::pair<std::vector<double>, int > reversed_point;
-			r = phrase_parse(
-				first, last,
-				*((double_ >> !(eol|eoi) ) | ('?' >>  attr(qnan)))
-				>> lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> (eol|eoi),
-				space-eol , reversed_point
-			);
-			fileContents.push_back(CsvPoint(reversed_point.second,reversed_point.first));
-		}while(r && first != last);
+	void resize(batch_type& batch, std::size_t rows)const{
+		batch.inputs.resize(rows,m_numberOfInputs,true);
+		batch.labels.resize(rows,m_numberOfOutputs,true);
 	}
-	else{
-		do{
-			std::pair<std::vector<double>, int > reversed_point;
-			r = phrase_parse(
-				first, last,
-				*((double_ | (-lit('?') >>  attr(qnan))) >> separator)
-				>> lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> (eol|eoi),
-				space-eol , reversed_point
-			);
-			fileContents.push_back(CsvPoint(reversed_point.second,reversed_point.first));
-		}while(r && first != last);
+	void write(batch_type& batch, std::size_t i, double const* row)const{
+		std::size_t inputStart = (m_lp == shark::FIRST_COLUMN)? m_numberOfOutputs : 0;
+		std::size_t outputStart = (m_lp == shark::FIRST_COLUMN)? 0: m_numberOfInputs;
+		for(std::size_t j = 0; j != m_numberOfInputs; ++j)
+			batch.inputs(i,j) = row[j+inputStart];
+		for(std::size_t j = 0; j != m_numberOfOutputs; ++j)
+			batch.labels(i,j) = row[j+outputStart];
 	}
-	std::cout<<std::string(first,last)<<std::endl;
-	if(!r || first != last)
-		throw SHARKEXCEPTION("[import_csv_reader_points] problems parsing file");
-	
-	
-	return fileContents;
+private:
+	shark::LabelPosition m_lp;
+	std::size_t m_numberOfOutputs;
+	std::size_t m_numberOfInputs;
+};
+
+/// \brief Moves the batches into the dataset.
+template<class T, class RowWriter>
+void batchesToData(shark::Data<T>& data, CsvBatches<RowWriter>& batches){
+	data = shark::Data<T>(batches.size());
+	for(std::size_t b = 0; b != batches.size(); ++b)
+		swap(data.batch(b),batches.batch(b));
 }
 
-template<class T>
-void csvStringToDataImpl(
-    shark::Data<T> &data,
-    std::string const& contents,
-    char separator,
-    char comment,
-    std::size_t maximumBatchSize
+/// \brief Moves the batches into the dataset and maps the labels to classes 0,1,...
+void batchesToData(
+	shark::LabeledData<shark::RealVector, unsigned int>& dataset,
+	CsvBatches<ClassificationWriter>& batches
 ){
-	std::vector<T> rows = importCSVReaderSingleValue<T>(contents, separator);
-	if(rows.empty()){//empty file leads to empty data object.
-		data = shark::Data<T>();
-		return;
+	//check labels for conformity
+	bool binaryLabels = false;
+	int minPositiveLabel = std::numeric_limits<int>::max();
+	{
+		int maxPositiveLabel = -1;
+		for(std::size_t b = 0; b != batches.size(); ++b){
+			shark::blas::vector<int> const& labels = batches.batch(b).labels;
+			for(std::size_t i = 0; i != labels.size(); ++i){
+				int label = labels(i);
+				if(label < -1)
+					throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
+				else if(label == -1)
+					binaryLabels = true;
+				else if(label < minPositiveLabel)
+					minPositiveLabel = label;
+				else if(label > maxPositiveLabel)
+					maxPositiveLabel = label;
+			}
+		}
+		if(binaryLabels && (minPositiveLabel == 0||  maxPositiveLabel > 1))
+			throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
 	}
-	
-	//copy rows of the file into the dataset
-	std::vector<std::size_t> batchSizes = shark::detail::optimalBatchSizes(rows.size(),maximumBatchSize);
-	data = shark::Data<T>(batchSizes.size());
-	std::size_t currentRow = 0;
-	for(std::size_t b = 0; b != batchSizes.size(); ++b) {
-		typename shark::Data<T>::batch_type& batch = data.batch(b);
-		batch.resize(batchSizes[b]);
-		//copy the values into the batch
-		for(std::size_t i = 0; i != batchSizes[b]; ++i,++currentRow){
-			batch(i) = rows[currentRow];
+
+	dataset = shark::LabeledData<shark::RealVector, unsigned int>(batches.size());
+	for(std::size_t b = 0; b != batches.size(); ++b){
+		ClassificationBatch& batch = batches.batch(b);
+		swap(dataset.batch(b).input,batch.inputs);
+		shark::UIntVector& labels = dataset.batch(b).label;
+		labels.resize(batch.labels.size());
+		for(std::size_t i = 0; i != labels.size(); ++i){
+			int rawLabel = batch.labels(i);
+			labels(i) = binaryLabels? 1 + (rawLabel-1)/2 : rawLabel -minPositiveLabel;
 		}
 	}
-	SIZE_CHECK(currentRow == rows.size());
+}
+
+/// \brief Moves the batches into the dataset.
+void batchesToData(
+	shark::LabeledData<shark::RealVector, shark::RealVector>& dataset,
+	CsvBatches<RegressionWriter>& batches
+){
+	dataset = shark::LabeledData<shark::RealVector, shark::RealVector>(batches.size());
+	for(std::size_t b = 0; b != batches.size(); ++b){
+		swap(dataset.batch(b).input,batches.batch(b).inputs);
+		swap(dataset.batch(b).label,batches.batch(b).labels);
+	}
+}
+
+template<class T>
+void csvStringToValues(
+	shark::Data<T>& data,
+	std::string const& contents,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	CsvBatches<ValueWriter<T> > batches(ValueWriter<T>(),maximumBatchSize);
+	parseCsvString(contents,separator,comment,batches);
+	batchesToData(data,batches);
+}
+
+template<class T>
+void csvFileToValues(
+	shark::Data<T>& data,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	CsvBatches<ValueWriter<T> > batches(ValueWriter<T>(),maximumBatchSize);
+	parseCsvFile(fn,separator,comment,batches);
+	batchesToData(data,batches);
 }
 
 }//end unnamed namespace
@@ -213,31 +436,9 @@ void shark::csvStringToData(
     char comment,
     std::size_t maximumBatchSize
 ){
-	std::vector<std::vector<double> > rows = importCSVReaderSingleValues<double>(contents, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
-		data = Data<RealVector>();
-		return;
-	}
-	
-	//copy rows of the file into the dataset
-	std::size_t dimensions = rows[0].size();
-	std::vector<std::size_t> batchSizes = shark::detail::optimalBatchSizes(rows.size(),maximumBatchSize);
-	data = Data<RealVector>(batchSizes.size());
-	std::size_t currentRow = 0;
-	for(std::size_t b = 0; b != batchSizes.size(); ++b) {
-		RealMatrix& batch = data.batch(b);
-		batch.resize(batchSizes[b],dimensions);
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batchSizes[b]; ++i,++currentRow){
-			if(rows[currentRow].size() != dimensions)
-				throw SHARKEXCEPTION("vectors are required to have same size");
-			
-			for(std::size_t j = 0; j != dimensions; ++j){
-				batch(i,j) = rows[currentRow][j];
-			}
-		}
-	}
-	SIZE_CHECK(currentRow == rows.size());
+	CsvBatches<VectorWriter> batches(VectorWriter(),maximumBatchSize);
+	parseCsvString(contents,separator,comment,batches);
+	batchesToData(data,batches);
 }
 
 void shark::csvStringToData(
@@ -247,7 +448,7 @@ void shark::csvStringToData(
     char comment,
     std::size_t maximumBatchSize
 ){
-	csvStringToDataImpl(data,contents,separator,comment,maximumBatchSize);
+	csvStringToValues(data,contents,separator,comment,maximumBatchSize);
 }
 
 void shark::csvStringToData(
@@ -257,7 +458,7 @@ void shark::csvStringToData(
     char comment,
     std::size_t maximumBatchSize
 ){
-	csvStringToDataImpl(data,contents,separator,comment,maximumBatchSize);
+	csvStringToValues(data,contents,separator,comment,maximumBatchSize);
 }
 
 void shark::csvStringToData(
@@ -267,7 +468,7 @@ void shark::csvStringToData(
     char comment,
     std::size_t maximumBatchSize
 ){
-	csvStringToDataImpl(data,contents,separator,comment,maximumBatchSize);
+	csvStringToValues(data,contents,separator,comment,maximumBatchSize);
 }
 
 void shark::csvStringToData(
@@ -278,56 +479,9 @@ void shark::csvStringToData(
     char comment,
     std::size_t maximumBatchSize
 ){
-	std::vector<CsvPoint> rows = import_csv_reader_points(contents, lp, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
-		dataset = LabeledData<RealVector, unsigned int>();
-		return;
-	}
-	
-	//check labels for conformity
-	bool binaryLabels = false;
-	int minPositiveLabel = std::numeric_limits<int>::max();
-	{
-		
-		int maxPositiveLabel = -1;
-		for(std::size_t i = 0; i != rows.size(); ++i){
-			int label = rows[i].first;
-			if(label < -1)
-				throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
-			else if(label == -1)
-				binaryLabels = true;
-			else if(label < minPositiveLabel)
-				minPositiveLabel = label;
-			else if(label > maxPositiveLabel)
-				maxPositiveLabel = label;
-		}
-		if(binaryLabels && (minPositiveLabel == 0||  maxPositiveLabel > 1))
-			throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
-	}
-	
-	//copy rows of the file into the dataset
-	std::size_t dimensions = rows[0].second.size();
-	std::vector<std::size_t> batchSizes = shark::detail::optimalBatchSizes(rows.size(),maximumBatchSize);
-	dataset = LabeledData<RealVector, unsigned int>(batchSizes.size());
-	std::size_t currentRow = 0;
-	for(std::size_t b = 0; b != batchSizes.size(); ++b) {
-		RealMatrix& inputs = dataset.batch(b).input;
-		UIntVector& labels = dataset.batch(b).label;
-		inputs.resize(batchSizes[b],dimensions);
-		labels.resize(batchSizes[b]);
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batchSizes[b]; ++i,++currentRow){
-			if(rows[currentRow].second.size() != dimensions)
-				throw SHARKEXCEPTION("vectors are required to have same size");
-			
-			for(std::size_t j = 0; j != dimensions; ++j){
-				inputs(i,j) = rows[currentRow].second[j];
-			}
-			int rawLabel = rows[currentRow].first;
-			labels[i] = binaryLabels? 1 + (rawLabel-1)/2 : rawLabel -minPositiveLabel;
-		}
-	}
-	SIZE_CHECK(currentRow == rows.size());
+	CsvBatches<ClassificationWriter> batches(ClassificationWriter(lp),maximumBatchSize);
+	parseCsvString(contents,separator,comment,batches);
+	batchesToData(dataset,batches);
 }
 
 void shark::csvStringToData(
@@ -339,47 +493,56 @@ void shark::csvStringToData(
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::vector<std::vector<double> > rows = importCSVReaderSingleValues<double>(contents, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
-		dataset = LabeledData<RealVector, RealVector>();
-		return;
-	}
-	
-	//copy rows of the file into the dataset
-	if(rows[0].size() <= numberOfOutputs){
-		throw SHARKEXCEPTION("Files must have more columns than requested number of outputs");
-	}
-	std::size_t dimensions = rows[0].size();
-	std::size_t numberOfInputs = dimensions-numberOfOutputs;
-	std::vector<std::size_t> batchSizes = shark::detail::optimalBatchSizes(rows.size(),maximumBatchSize);
-	dataset = LabeledData<RealVector, RealVector>(batchSizes.size());
-	std::size_t inputStart = lp? numberOfOutputs : 0;
-	std::size_t outputStart = lp? 0: numberOfInputs;
-	std::size_t currentRow = 0;
-	for(std::size_t b = 0; b != batchSizes.size(); ++b) {
-		RealMatrix& inputs = dataset.batch(b).input;
-		RealMatrix& labels = dataset.batch(b).label;
-		inputs.resize(batchSizes[b],numberOfInputs);
-		labels.resize(batchSizes[b],numberOfOutputs);
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batchSizes[b]; ++i,++currentRow){
-			if(rows[currentRow].size() != dimensions)
-				throw SHARKEXCEPTION("Detected different number of columns in a row of the file!");
-			
-			for(std::size_t j = 0; j != numberOfInputs; ++j){
-				inputs(i,j) = rows[currentRow][j+inputStart];
-			}
-			for(std::size_t j = 0; j != numberOfOutputs; ++j){
-				labels(i,j) = rows[currentRow][j+outputStart];
-			}
-		}
-	}
-	SIZE_CHECK(currentRow == rows.size());
+	CsvBatches<RegressionWriter> batches(RegressionWriter(lp,numberOfOutputs),maximumBatchSize);
+	parseCsvString(contents,separator,comment,batches);
+	batchesToData(dataset,batches);
 }
 
 
 ///////////////IMPORT WRAPPERS
 
+void shark::detail::import_csv(
+	Data<RealVector>& data,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	CsvBatches<VectorWriter> batches(VectorWriter(),maximumBatchSize);
+	parseCsvFile(fn,separator,comment,batches);
+	batchesToData(data,batches);
+}
+
+void shark::detail::import_csv(
+	Data<int>& data,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	csvFileToValues(data,fn,separator,comment,maximumBatchSize);
+}
+
+void shark::detail::import_csv(
+	Data<unsigned int>& data,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	csvFileToValues(data,fn,separator,comment,maximumBatchSize);
+}
+
+void shark::detail::import_csv(
+	Data<double>& data,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	csvFileToValues(data,fn,separator,comment,maximumBatchSize);
+}
+
 void shark::import_csv(
 	LabeledData<RealVector, unsigned int>& data,
 	std::string fn,
@@ -388,15 +551,9 @@ void shark::import_csv(
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::ifstream stream(fn.c_str());
-	stream.unsetf(std::ios::skipws);
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
-	//call th actual parser
-	csvStringToData(data,contents,lp,separator,comment,maximumBatchSize);
+	CsvBatches<ClassificationWriter> batches(ClassificationWriter(lp),maximumBatchSize);
+	parseCsvFile(fn,separator,comment,batches);
+	batchesToData(data,batches);
 }
 
 
@@ -409,13 +566,7 @@ void shark::import_csv(
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::ifstream stream(fn.c_str());
-	stream.unsetf(std::ios::skipws);
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
-	//call th actual parser
-	csvStringToData(data,contents,lp, numberOfOutputs, separator,comment,maximumBatchSize);
-}
\ No newline at end of file
+	CsvBatches<RegressionWriter> batches(RegressionWriter(lp,numberOfOutputs),maximumBatchSize);
+	parseCsvFile(fn,separator,comment,batches);
+	batchesToData(data,batches);
+}
@@ -34,39 +34,131 @@
  */
 //===========================================================================
 #include <limits>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/fusion/adapted/std_pair.hpp>
+#include <algorithm>
 #include <shark/Data/Libsvm.h>
+#include <shark/Data/Impl/TextParsing.h>
+#include <shark/Core/OpenMP.h>
+#include <deque>
 
 namespace {
 
-typedef std::pair<int, std::vector<std::pair<std::size_t, double> > > LibSVMPoint;
-inline std::vector<LibSVMPoint> 
-import_libsvm_reader(
-	std::istream& stream
-) {
-	stream.unsetf(std::ios::skipws); // No white space skipping!
-	std::istream_iterator<char> streamBegin(stream);
-	std::string storage(// We will read the contents of the file here
-		streamBegin,
-		std::istream_iterator<char>()
-	);
-	
-	using namespace boost::spirit::qi;
-	std::string::const_iterator first = storage.begin();
-	std::string::const_iterator last = storage.end();
-	std::vector<LibSVMPoint>  fileContents;
-	bool r = phrase_parse(
-		first, last, 
-		*(
-			int_   >> -(lit('.')>>+lit('0'))//we also want to be able to parse 1.00000 as label 1
-			>> *(uint_ >> ':' >> double_) >> eol
-		),
-		space-eol , fileContents
-	);
-	if(!r || first != last)
-		throw SHARKEXCEPTION("[import_libsvm_reader] problems parsing file");
-	return fileContents;
+using namespace shark::detail;
+
+/// \brief Contents of a part of a LibSVM file in compressed row format.
+struct LibSVMRows{
+	std::vector<int> labels;
+	/// start of the nonzero entries of every row in indices and values, one more entry than rows
+	std::vector<std::size_t> rowStarts;
+	/// one-based indices as stored in the file
+	std::vector<unsigned int> indices;
+	std::vector<double> values;
+	unsigned int maxIndex;
+
+	LibSVMRows():rowStarts(1,0),maxIndex(0){}
+
+	std::size_t size()const{
+		return labels.size();
+	}
+
+	void swap(LibSVMRows& other){
+		labels.swap(other.labels);
+		rowStarts.swap(other.rowStarts);
+		indices.swap(other.indices);
+		values.swap(other.values);
+		std::swap(maxIndex,other.maxIndex);
+	}
+};
+
+/// \brief Parses lines of the form "label index:value index:value ..."
+struct LibSVMParser{
+	void operator()(char const* pos, char const* end, LibSVMRows& rows)const{
+		while(pos != end){
+			char const* lineEnd = findLineEnd(pos,end);
+			parseLine(pos, lineEnd, rows);
+			pos = lineEnd;
+			while(pos != end && isLineBreak(*pos)) ++pos;
+		}
+	}
+
+	void parseLine(char const* pos, char const* end, LibSVMRows& rows)const{
+		skipBlanks(pos,end);
+		if(pos == end) return;//empty line
+
+		double label;
+		if(!parseDouble(pos,end,label))
+			throw SHARKEXCEPTION("[import_libsvm] problems parsing file: expected label");
+		rows.labels.push_back(integerLabel(label));
+		while(true){
+			char const* entryStart = pos;
+			skipBlanks(pos,end);
+			if(pos == end) break;
+			if(pos == entryStart)
+				throw SHARKEXCEPTION("[import_libsvm] problems parsing file: entries must be separated by spaces");
+
+			unsigned long index = 0;
+			char const* indexStart = pos;
+			for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos){
+				index = index*10 + (*pos - '0');
+				if(index > std::numeric_limits<unsigned int>::max())
+					throw SHARKEXCEPTION("[import_libsvm] index too large");
+			}
+			if(pos == indexStart || index == 0 || pos == end || *pos != ':')
+				throw SHARKEXCEPTION("[import_libsvm] problems parsing file: expected index:value");
+			++pos;
+			double value;
+			if(!parseDouble(pos,end,value))
+				throw SHARKEXCEPTION("[import_libsvm] problems parsing file: expected value");
+			rows.indices.push_back((unsigned int)index);
+			rows.values.push_back(value);
+			rows.maxIndex = std::max(rows.maxIndex,(unsigned int)index);
+		}
+		rows.rowStarts.push_back(rows.indices.size());
+	}
+};
+
+/// \brief Appends the rows of a parsed part to the rows of a batch.
+void appendRows(LibSVMRows& batch, LibSVMRows const& part, std::size_t begin, std::size_t end){
+	std::size_t entriesBegin = part.rowStarts[begin];
+	std::size_t entriesEnd = part.rowStarts[end];
+	std::size_t offset = batch.indices.size();
+	batch.labels.insert(batch.labels.end(),part.labels.begin()+begin,part.labels.begin()+end);
+	batch.indices.insert(batch.indices.end(),part.indices.begin()+entriesBegin,part.indices.begin()+entriesEnd);
+	batch.values.insert(batch.values.end(),part.values.begin()+entriesBegin,part.values.begin()+entriesEnd);
+	for(std::size_t i = begin; i != end; ++i)
+		batch.rowStarts.push_back(part.rowStarts[i+1]-entriesBegin+offset);
+	batch.maxIndex = std::max(batch.maxIndex,part.maxIndex);
+}
+
+/// \brief Reads the stream in chunks, parses every chunk in parallel and groups the rows into batches.
+///
+/// The dimension of the inputs and the mapping of the labels is only known when the whole file is read,
+/// so the rows are kept in the compressed format of the file, one object per batch of the dataset.
+/// Besides these, only a single chunk and its parsed contents are held in memory.
+std::deque<LibSVMRows> import_libsvm_reader(std::istream& stream, std::size_t batchSize){
+	std::deque<LibSVMRows> batches;
+	LineChunkReader reader(stream);
+	std::string chunk;
+	std::vector<LibSVMRows> parts;
+	while(reader.read(chunk)){
+		parseLinesInParallel(chunk.data(), chunk.data()+chunk.size(), LibSVMParser(), parts);
+		for(std::size_t p = 0; p != parts.size(); ++p){
+			std::size_t row = 0;
+			while(row != parts[p].size()){
+				if(batches.empty() || batches.back().size() == batchSize)
+					batches.push_back(LibSVMRows());
+				std::size_t end = std::min(parts[p].size(), row + batchSize - batches.back().size());
+				appendRows(batches.back(), parts[p], row, end);
+				row = end;
+			}
+		}
+	}
+	return batches;
+}
+
+//the batch types of dense and sparse inputs only differ in how nonzeros are reserved
+inline void reserveNonZeros(shark::RealMatrix&, std::size_t){}
+inline void reserveNonZeros(shark::blas::compressed_matrix<double>& inputs, std::size_t nonZeros){
+	inputs.reserve(nonZeros,false);
 }
 
 template<class T>//We assume T to be vectorial
@@ -74,17 +166,16 @@ shark::LabeledData<T, unsigned int> libsvm_importer(
 	std::istream& stream,
 	unsigned int dimensions
 ){
-	//read contents of stream
-	std::vector<LibSVMPoint> contents = import_libsvm_reader(stream);
-	std::size_t numPoints = contents.size();
+	typedef shark::LabeledData<T, unsigned int> Dataset;
+	//read contents of stream, all batches but the last have the default size
+	std::deque<LibSVMRows> contents = import_libsvm_reader(stream, Dataset::DefaultBatchSize);
+	std::size_t numBatches = contents.size();
+	if(numBatches == 0)
+		return Dataset();
 	
-	//find data dimension by getting the maximum index
-	std::size_t maxIndex = 0;
-	for(std::size_t i = 0; i != numPoints; ++i){
-		std::vector<std::pair<std::size_t, double> > const& inputs = contents[i].second;
-		if(!inputs.empty())
-			maxIndex = std::max(maxIndex, inputs.back().first);
-	}
+	unsigned int maxIndex = 0;
+	for(std::size_t b = 0; b != numBatches; ++b)
+		maxIndex = std::max(maxIndex, contents[b].maxIndex);
 	if(dimensions == 0){
 		dimensions = maxIndex;
 	}
@@ -96,37 +187,43 @@ shark::LabeledData<T, unsigned int> libsvm_importer(
 	int minPositiveLabel = std::numeric_limits<int>::max();
 	{
 		int maxPositiveLabel = -1;
-		for(std::size_t i = 0; i != numPoints; ++i){
-			int label = contents[i].first;
-			if(label < -1)
-				throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
-			else if(label == -1)
-				binaryLabels = true;
-			else if(label < minPositiveLabel)
-				minPositiveLabel = label;
-			else if(label > maxPositiveLabel)
-				maxPositiveLabel = label;
+		for(std::size_t b = 0; b != numBatches; ++b){
+			for(std::size_t i = 0; i != contents[b].size(); ++i){
+				int label = contents[b].labels[i];
+				if(label < -1)
+					throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
+				else if(label == -1)
+					binaryLabels = true;
+				else if(label < minPositiveLabel)
+					minPositiveLabel = label;
+				else if(label > maxPositiveLabel)
+					maxPositiveLabel = label;
+			}
 		}
 		if(binaryLabels && (minPositiveLabel == 0||  maxPositiveLabel > 1))
 			throw SHARKEXCEPTION("negative labels are only allowed for classes -1/1");
 	}
 	
-	//copy contents into a new dataset
-	typename shark::LabeledData<T, unsigned int>::element_type blueprint(T(maxIndex),0);
-	shark::LabeledData<T, unsigned int> data(numPoints,blueprint);//create dataset with the right structure
-	{
-		std::size_t i = 0;
-		typedef typename shark::LabeledData<T, unsigned int>::element_reference ElemRef;
-		BOOST_FOREACH(ElemRef element, data.elements()){
-			zero(element.input);
-			//todo: check label
+	//convert the batches and release the parsed rows of every batch when it is done,
+	//so the file contents are held only once in addition to the part of the dataset created so far
+	Dataset data(numBatches);
+	SHARK_PARALLEL_FOR(int b = 0; b < (int)numBatches; ++b){
+		typename shark::Batch<T>::type& inputs = data.batch(b).input;
+		shark::UIntVector& labels = data.batch(b).label;
+		LibSVMRows rows;
+		rows.swap(contents[b]);
+		std::size_t size = rows.size();
+		
+		inputs.resize(size,dimensions,false);
+		inputs.clear();
+		reserveNonZeros(inputs,rows.indices.size());
+		labels.resize(size);
+		for(std::size_t i = 0; i != size; ++i){
 			//we subtract minPositiveLabel to ensore that class indices starting from 0 and 1 are supported
-			element.label = binaryLabels? 1 + (contents[i].first-1)/2 : contents[i].first-minPositiveLabel;
-			
-			std::vector<std::pair<std::size_t, double> > const& inputs = contents[i].second;
-			for(std::size_t j = 0; j != inputs.size(); ++j)
-				element.input(inputs[j].first-1) = inputs[j].second;//LibSVM is one-indexed
-			++i;
+			int label = rows.labels[i];
+			labels(i) = binaryLabels? 1 + (label-1)/2 : label-minPositiveLabel;
+			for(std::size_t k = rows.rowStarts[i]; k != rows.rowStarts[i+1]; ++k)
+				inputs(i,rows.indices[k]-1) = rows.values[k];//LibSVM is one-indexed
 		}
 	}
 	return data;
@@ -157,6 +254,8 @@ void shark::import_libsvm(
 	int highestIndex
 ){
 	std::ifstream ifs(fn.c_str());
+	if(!ifs)
+		throw SHARKEXCEPTION("[import_libsvm] file can not be opened for reading");
 	dataset =  libsvm_importer<RealVector>(ifs, highestIndex);
 }
 
@@ -166,5 +265,7 @@ void shark::import_libsvm(
 	int highestIndex
 ){
 	std::ifstream ifs(fn.c_str());
+	if(!ifs)
+		throw SHARKEXCEPTION("[import_libsvm] file can not be opened for reading");
 	dataset =  libsvm_importer<CompressedRealVector>(ifs, highestIndex);
 }
@@ -27,6 +27,11 @@
 #include <shark/Models/Clustering/Centroids.h>
 #include <shark/Data/DataView.h>
 #include <shark/LinAlg/BLAS/Initialize.h>
+#include <shark/Core/OpenMP.h>
+#include <shark/Rng/GlobalRng.h>
+
+#include <algorithm>
+#include <limits>
 
 using namespace shark;
 
@@ -151,6 +156,180 @@ void Centroids::initFromData(const ClassificationDataset &data, unsigned noClust
 	setCentroids(createDataFromRange(centers));
 }
 
-void Centroids::initFromData(Data<RealVector> const& dataset, unsigned noClusters) {
-	setCentroids(toDataset(randomSubset(toView(dataset),noClusters)));
+namespace{
+
+/// \brief Squared distances of the points of a dataset to their closest chosen centroid.
+class ClosestCentroidDistances{
+public:
+	ClosestCentroidDistances(Data<RealVector> const& dataset):m_dataset(dataset){
+		m_batchStart.resize(dataset.numberOfBatches()+1,0);
+		for(std::size_t b = 0; b != dataset.numberOfBatches(); ++b)
+			m_batchStart[b+1] = m_batchStart[b]+dataset.batch(b).size1();
+		m_distances.resize(m_batchStart.back(),std::numeric_limits<double>::infinity());
+	}
+
+	std::size_t size()const{
+		return m_distances.size();
+	}
+	std::vector<double> const& distances()const{
+		return m_distances;
+	}
+
+	/// \brief Returns the i-th point of the dataset.
+	blas::matrix_row<RealMatrix const> point(std::size_t i)const{
+		std::size_t b = std::upper_bound(m_batchStart.begin(),m_batchStart.end(),i)-m_batchStart.begin()-1;
+		return row(m_dataset.batch(b),i-m_batchStart[b]);
+	}
+
+	/// \brief Adds the rows of centroids to the chosen centroids and returns the sum of the distances.
+	double update(RealMatrix const& centroids){
+		std::size_t numBatches = m_dataset.numberOfBatches();
+		std::vector<double> batchSums(numBatches,0.0);
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)numBatches; ++b){
+			RealMatrix distances = distanceSqr(m_dataset.batch(b),centroids);
+			double sum = 0;
+			for(std::size_t i = 0; i != distances.size1(); ++i){
+				double& closest = m_distances[m_batchStart[b]+i];
+				//distanceSqr clamps the rounding errors of the block computation at zero
+				for(std::size_t j = 0; j != distances.size2(); ++j)
+					closest = std::min(closest,distances(i,j));
+				sum += closest;
+			}
+			batchSums[b] = sum;
+		}
+		double sum = 0;
+		for(std::size_t b = 0; b != numBatches; ++b)
+			sum += batchSums[b];
+		return sum;
+	}
+
+	/// \brief Computes the index of the closest centroid for every point.
+	std::vector<std::size_t> closestCentroids(RealMatrix const& centroids)const{
+		std::vector<std::size_t> closest(size());
+		SHARK_PARALLEL_FOR(int b = 0; b < (int)m_dataset.numberOfBatches(); ++b){
+			RealMatrix distances = distanceSqr(m_dataset.batch(b),centroids);
+			for(std::size_t i = 0; i != distances.size1(); ++i)
+				closest[m_batchStart[b]+i] = arg_min(row(distances,i));
+		}
+		return closest;
+	}
+private:
+	Data<RealVector> const& m_dataset;
+	std::vector<std::size_t> m_batchStart;
+	std::vector<double> m_distances;
+};
+
+/// \brief Draws an index with probability proportional to its weight, uniformly if all weights are zero.
+std::size_t drawProportional(std::vector<double> const& weights, double total){
+	if(!(total > 0))
+		return Rng::discrete(0,weights.size()-1);
+	double u = Rng::uni(0,total);
+	double sum = 0;
+	std::size_t last = 0;
+	for(std::size_t i = 0; i != weights.size(); ++i){
+		if(weights[i] <= 0) continue;
+		sum += weights[i];
+		last = i;
+		if(u < sum) return i;
+	}
+	//rounding errors
+	return last;
+}
+
+/// \brief k-means++ on weighted points, returns the indices of the chosen points.
+std::vector<std::size_t> weightedKMeansPlusPlus(RealMatrix const& points, std::vector<double> const& weights, std::size_t k){
+	std::size_t n = points.size1();
+	std::vector<double> closest(n,std::numeric_limits<double>::infinity());
+	std::vector<double> scores(weights);
+	double total = 0;
+	for(std::size_t i = 0; i != n; ++i)
+		total += weights[i];
+	std::vector<std::size_t> chosen;
+	while(true){
+		std::size_t index = drawProportional(scores,total);
+		chosen.push_back(index);
+		if(chosen.size() == k) break;
+		RealVector distances = distanceSqr(points,row(points,index));
+		total = 0;
+		for(std::size_t i = 0; i != n; ++i){
+			closest[i] = std::min(closest[i],distances(i));
+			scores[i] = weights[i]*closest[i];
+			total += scores[i];
+		}
+	}
+	return chosen;
+}
+
+RealMatrix toMatrix(std::vector<RealVector> const& points){
+	RealMatrix matrix(points.size(),points.empty()? 0 : points[0].size());
+	for(std::size_t i = 0; i != points.size(); ++i)
+		noalias(row(matrix,i)) = points[i];
+	return matrix;
+}
+
+std::vector<RealVector> kMeansPlusPlus(Data<RealVector> const& dataset, std::size_t k){
+	ClosestCentroidDistances distances(dataset);
+	std::vector<RealVector> centroids;
+	RealMatrix newCentroid(1,dataDimension(dataset));
+	std::size_t index = Rng::discrete(0,distances.size()-1);
+	while(true){
+		noalias(row(newCentroid,0)) = distances.point(index);
+		centroids.push_back(row(newCentroid,0));
+		if(centroids.size() == k) break;
+		double total = distances.update(newCentroid);
+		index = drawProportional(distances.distances(),total);
+	}
+	return centroids;
+}
+
+std::vector<RealVector> kMeansParallel(Data<RealVector> const& dataset, std::size_t k){
+	std::size_t const rounds = 5;
+	double const oversampling = 2.0*k;
+
+	ClosestCentroidDistances distances(dataset);
+	std::size_t n = distances.size();
+	std::vector<RealVector> candidates(1,distances.point(Rng::discrete(0,n-1)));
+	RealMatrix newCandidates = toMatrix(candidates);
+	for(std::size_t round = 0; round != rounds; ++round){
+		double total = distances.update(newCandidates);
+		if(!(total > 0)) break;
+		//every point becomes a candidate with probability proportional to its squared distance
+		std::vector<RealVector> sampled;
+		for(std::size_t i = 0; i != n; ++i){
+			double probability = oversampling*distances.distances()[i]/total;
+			if(probability >= 1 || Rng::coinToss(probability))
+				sampled.push_back(distances.point(i));
+		}
+		if(sampled.empty()) break;
+		candidates.insert(candidates.end(),sampled.begin(),sampled.end());
+		newCandidates = toMatrix(sampled);
+	}
+	//not enough distinct points in the dataset
+	while(candidates.size() < k)
+		candidates.push_back(distances.point(Rng::discrete(0,n-1)));
+	if(candidates.size() == k)
+		return candidates;
+
+	//weight every candidate by the number of points closest to it and recluster the candidates
+	RealMatrix candidateMatrix = toMatrix(candidates);
+	std::vector<std::size_t> closest = distances.closestCentroids(candidateMatrix);
+	std::vector<double> weights(candidates.size(),0.0);
+	for(std::size_t i = 0; i != n; ++i)
+		weights[closest[i]] += 1.0;
+	std::vector<std::size_t> chosen = weightedKMeansPlusPlus(candidateMatrix,weights,k);
+	std::vector<RealVector> centroids(k);
+	for(std::size_t j = 0; j != k; ++j)
+		centroids[j] = candidates[chosen[j]];
+	return centroids;
+}
+}
+
+void Centroids::initFromData(Data<RealVector> const& dataset, unsigned noClusters, InitializationMethod method) {
+	SIZE_CHECK(noClusters <= dataset.numberOfElements());
+	if(method == RandomSubset || noClusters == 0)
+		setCentroids(toDataset(randomSubset(toView(dataset),noClusters)));
+	else if(method == KMeansPlusPlus)
+		setCentroids(createDataFromRange(kMeansPlusPlus(dataset,noClusters)));
+	else
+		setCentroids(createDataFromRange(kMeansParallel(dataset,noClusters)));
 }
\ No newline at end of file